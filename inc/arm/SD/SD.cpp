@@ -3,6 +3,11 @@
  * and http://alumni.cs.ucr.edu/~amitra/sdcard/Additional/sdcard_appnote_foust.pdf
  * and https://github.com/LonelyWolf/stm32/blob/master/cube-usb-msc/sdcard-sdio.c
  */
+#include "stm32f4xx_hal.h"
+
+//Only built into projects which enable the HAL SD module (the F410 has no SDIO at all)
+#ifdef HAL_SD_MODULE_ENABLED
+
 #include "SD.h"
 #include <stdlib.h>
 #include <util/delay.h>
@@ -289,3 +294,5 @@ uint16_t SD::read(uint8_t* a, uint16_t len){
 uint8_t SD::write(uint8_t b) {
 	return 0;
 }
+
+#endif
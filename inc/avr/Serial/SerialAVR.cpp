@@ -2,8 +2,13 @@
 #include <util/delay.h>
 using namespace digitalcave;
 
-SerialAVR::SerialAVR(uint32_t baud, uint8_t dataBits, uint8_t parity, uint8_t stopBits, uint8_t serialPort, uint8_t bufferSize):
-	rxBuffer(bufferSize) {
+SerialAVR::SerialAVR(uint32_t baud, uint8_t dataBits, uint8_t parity, uint8_t stopBits, uint8_t serialPort, uint16_t bufferSize, uint16_t txBufferSize):
+	rxBuffer(bufferSize),
+	txBuffer(txBufferSize ? txBufferSize : 1),
+	txBuffered(txBufferSize > 1),
+	txPolicy(SERIAL_AVR_TX_BLOCK),
+	txDropped(0),
+	rxDropped(0) {
 	if (serialPort == 0){
 #ifdef UDR0
 		UBRRH = &UBRR0H;
@@ -20,6 +25,7 @@ SerialAVR::SerialAVR(uint32_t baud, uint8_t dataBits, uint8_t parity, uint8_t st
 		RXEN = RXEN0;
 		TXEN = TXEN0;
 		RXCIE = RXCIE0;
+		UDRIE = UDRIE0;
 		U2X = U2X0;
 		MPCM = MPCM0;
 		UPM0 = UPM00;
@@ -42,6 +48,7 @@ SerialAVR::SerialAVR(uint32_t baud, uint8_t dataBits, uint8_t parity, uint8_t st
 		RXEN = RXEN1;
 		TXEN = TXEN1;
 		RXCIE = RXCIE1;
+		UDRIE = UDRIE1;
 		U2X = U2X1;
 		MPCM = MPCM1;
 		UPM0 = UPM10;
@@ -85,7 +92,7 @@ SerialAVR::SerialAVR(uint32_t baud, uint8_t dataBits, uint8_t parity, uint8_t st
 	//Parity, Stop bits
 	*UCSRC |= (parity << UPM0) | ((stopBits - 1) << USBS);
 
-	//Enable Rx (interrupt) / Tx (blocking)
+	//Enable Rx (interrupt) / Tx (blocking, or interrupt once there is something in the buffer)
 	*UCSRB |= _BV(RXEN) | _BV(TXEN) | _BV(RXCIE);
 
 	//Enable interrupts if the NO_INTERRUPT_ENABLE define is not set.  If it is, you need to call sei() elsewhere.
@@ -107,12 +114,57 @@ uint8_t SerialAVR::read(uint8_t *c){
 }
 
 uint8_t SerialAVR::write(uint8_t b){
-	//Nop loop to wait until last transmission has completed
-	while (!(*UCSRA & _BV(UDRE)));
-	*UDR = b;
+	if (!txBuffered){
+		//Nop loop to wait until last transmission has completed
+		while (!(*UCSRA & _BV(UDRE)));
+		*UDR = b;
+		return 1;
+	}
+
+	*UCSRB &= ~_BV(UDRIE); //Temporarily disable UDRE interrupts so we don't get interrupted
+	while (txBuffer.isFull()){
+		if (txPolicy != SERIAL_AVR_TX_BLOCK){
+			txDropped++;
+			*UCSRB |= _BV(UDRIE);
+			return txPolicy == SERIAL_AVR_TX_DROP;
+		}
+
+		//Make room.  Send directly rather than waiting for the ISR, which also works with interrupts disabled.
+		while (!(*UCSRA & _BV(UDRE)));
+		txIsr();
+	}
+	txBuffer.write(b);
+	*UCSRB |= _BV(UDRIE); //Re-enable interrupts; the UDRE interrupt will fire and start sending
 	return 1;
 }
 
+void SerialAVR::flush(){
+	if (!txBuffered) return;
+
+	while (1){
+		*UCSRB &= ~_BV(UDRIE);
+		if (txBuffer.isEmpty()) break;
+
+		//With interrupts disabled nothing would empty the buffer; do it here instead
+		if (!(SREG & _BV(SREG_I))){
+			while (!(*UCSRA & _BV(UDRE)));
+			txIsr();
+		}
+		*UCSRB |= _BV(UDRIE);
+	}
+}
+
 void SerialAVR::isr(){
-	rxBuffer.write(*UDR);
+	if (!rxBuffer.write(*UDR)) rxDropped++;
+}
+
+void SerialAVR::txIsr(){
+	uint8_t b;
+	if (txBuffer.read(&b)){
+		*UDR = b;
+	}
+	else {
+		//Buffer is empty; disable UDRE interrupts until there is something else to write
+		*UCSRB &= ~_BV(UDRIE);
+	}
 }
@@ -9,6 +9,14 @@
  *			// for serial port 1, etc.
  *			serial.isr();
  * 		}
+ *
+ * If you give the constructor a transmit buffer size, write() queues bytes and returns; they are sent from the
+ * USART Data Register Empty interrupt, which you also need to forward:
+ *		ISR(USART1_UDRE_vect){
+ *			serial.txIsr();
+ *		}
+ * What happens when the transmit buffer is full is set by setTxPolicy().  Without a transmit buffer, write()
+ * blocks until each byte is sent (as it always has).
  */
 
 #ifndef SERIAL_AVR_H
@@ -20,11 +28,21 @@
 #include <Stream.h>
 #include <ArrayStream.h>
 
+//What to do when writing to a full transmit buffer
+#define SERIAL_AVR_TX_BLOCK		0	//Wait until there is space
+#define SERIAL_AVR_TX_DROP		1	//Discard the byte, but return success
+#define SERIAL_AVR_TX_REPORT	2	//Discard the byte, and return 0 from write()
+
 namespace digitalcave {
 
 	class SerialAVR : public Stream {
 		private:
 			ArrayStream rxBuffer;
+			ArrayStream txBuffer;
+			uint8_t txBuffered;
+			uint8_t txPolicy;
+			uint16_t txDropped;
+			uint16_t rxDropped;
 
 			//Register variables, to allow different serial port instances to point at different hardware ports
 			volatile uint8_t* UBRRH;
@@ -41,6 +59,7 @@ namespace digitalcave {
 			uint8_t RXEN;
 			uint8_t TXEN;
 			uint8_t RXCIE;
+			uint8_t UDRIE;
 			uint8_t U2X;
 			uint8_t MPCM;
 			uint8_t UPM0;
@@ -49,15 +68,38 @@ namespace digitalcave {
 
 		public:
 			//Initialize specifying baud rate and all other optional parameters
-			SerialAVR(uint32_t baud, uint8_t dataBits = 8, uint8_t parity = 0, uint8_t stopBits = 1, uint8_t serialPort = 0, uint8_t bufferSize = 64);
+			SerialAVR(uint32_t baud, uint8_t dataBits = 8, uint8_t parity = 0, uint8_t stopBits = 1, uint8_t serialPort = 0, uint16_t bufferSize = 64, uint16_t txBufferSize = 0);
 
 			// Implementation of virtual functions declared in superclass
 			uint8_t read(uint8_t *b);
 			uint8_t write(uint8_t data);
 
+			/*
+			 * Waits until everything in the transmit buffer has been sent.
+			 */
+			void flush();
+
+			/*
+			 * Sets what write() does when the transmit buffer is full; one of SERIAL_AVR_TX_*.  The default
+			 * is SERIAL_AVR_TX_BLOCK.
+			 */
+			void setTxPolicy(uint8_t policy) { txPolicy = policy; }
+
+			//Bytes discarded because the transmit buffer was full (DROP / REPORT policies)
+			uint16_t getTxDropped() { return txDropped; }
+			//Bytes discarded because the receive buffer was full
+			uint16_t getRxDropped() { return rxDropped; }
+			//Most bytes queued at once in each buffer
+			uint16_t getTxHighWater() { return txBuffer.getHighWater(); }
+			uint16_t getRxHighWater() { return rxBuffer.getHighWater(); }
+
 			//Notify serial library that there is a byte ready for reading.  This MUST be called by the serial read ISR.
 			void isr();
 
+			//Notify serial library that the transmit register is empty.  This MUST be called by the UDRE ISR if
+			// there is a transmit buffer.
+			void txIsr();
+
 			using Stream::skip;
 			using Stream::reset;
 			using Stream::read; // Allow other overloaded functions from superclass to show up in subclass.
@@ -391,6 +391,44 @@ uint8_t SerialUSB::read(uint8_t* b)
 	return 1;
 }
 
+// read up to len bytes, a whole bank at a time.  Returns the number of bytes read, which
+// is 0 if nothing has been received; does not wait for more data to arrive.
+uint16_t SerialUSB::readBlock(uint8_t* buffer, uint16_t len)
+{
+	uint8_t c, n, intr_state;
+	uint16_t count = 0;
+
+	while (count < len) {
+		intr_state = SREG;
+		cli();
+		if (!usb_configuration) {
+			SREG = intr_state;
+			break;
+		}
+		UENUM = CDC_RX_ENDPOINT;
+		c = UEINTX;
+		if (!(c & (1<<RWAL))) {
+			// no data in this bank; release it if it is an empty packet, and try the other one
+			if (c & (1<<RXOUTI)) {
+				UEINTX = 0x6B;
+				SREG = intr_state;
+				continue;
+			}
+			SREG = intr_state;
+			break;
+		}
+		// drain as much of the bank as will fit
+		n = UEBCLX;
+		if (n > len - count) n = len - count;
+		count += n;
+		while (n--) *buffer++ = UEDATX;
+		// if bank completely used, release it so the host can refill it while we use the other one
+		if (!(UEINTX & (1<<RWAL))) UEINTX = 0x6B;
+		SREG = intr_state;
+	}
+	return count;
+}
+
 // number of bytes available in the receive buffer
 uint8_t SerialUSB::available()
 {
@@ -515,8 +553,14 @@ int8_t usb_serial_write_b_nowait(uint8_t c)
 // controller in the PC will not allocate bandwitdh without a pending read request.
 // (thanks to Victor Suarez for testing and feedback and initial code)
 
-uint8_t SerialUSB::write(uint8_t* buffer, uint8_t size){
+uint16_t SerialUSB::write(uint8_t* buffer, uint16_t size){
+	return writeBlock(buffer, size);
+}
+
+// Returns the number of bytes which were written; less than size on timeout or error
+uint16_t SerialUSB::writeBlock(uint8_t* buffer, uint16_t size){
 	uint8_t timeout, intr_state, write_size;
+	uint16_t len = size;
 
 	// if we're not online (enumerated and configured), error
 	if (!usb_configuration) return 0;
@@ -546,10 +590,10 @@ uint8_t SerialUSB::write(uint8_t* buffer, uint8_t size){
 			// is not running an application that is listening
 			if (UDFNUML == timeout) {
 				transmit_previous_timeout = 1;
-				return -1;
+				return len - size;
 			}
 			// has the USB gone offline?
-			if (!usb_configuration) return -1;
+			if (!usb_configuration) return len - size;
 			// get ready to try checking again
 			intr_state = SREG;
 			cli();
@@ -641,7 +685,7 @@ uint8_t SerialUSB::write(uint8_t* buffer, uint8_t size){
 		transmit_flush_timer = TRANSMIT_FLUSH_TIMEOUT;
 		SREG = intr_state;
 	}
-	return 1;
+	return len;
 }
 
 
@@ -964,7 +1008,13 @@ ISR(USB_COM_vect)
 	UECONX = (1<<STALLRQ) | (1<<EPEN);	// stall
 }
 #else
-uint8_t SerialUSB::write(uint8_t* buffer, uint8_t size){
+uint16_t SerialUSB::write(uint8_t* buffer, uint16_t size){
+	return 0;
+}
+uint16_t SerialUSB::writeBlock(uint8_t* buffer, uint16_t size){
+	return 0;
+}
+uint16_t SerialUSB::readBlock(uint8_t* buffer, uint16_t len){
 	return 0;
 }
 #endif
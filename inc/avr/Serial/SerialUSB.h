@@ -93,8 +93,20 @@ namespace digitalcave {
 			uint8_t read(uint8_t *b);
 			uint8_t write(uint8_t data);
 
-			//Override write buffer function
-			uint8_t write(uint8_t* data, uint8_t len);
+			//Override write buffer function.  Same as writeBlock(): returns the number of bytes written,
+			// which is less than len (0 if not connected) if the host stops listening.
+			uint16_t write(uint8_t* data, uint16_t len);
+
+			//Bulk transfers.  These move a whole endpoint bank (64 bytes, or 32 on the smaller chips)
+			// per iteration, rather than selecting the endpoint and checking its state for every byte;
+			// the data endpoints are double banked, so the host can fill / drain one bank while we
+			// work on the other.  Use these for anything more than a few bytes at a time.
+			//readBlock() copies up to len bytes of whatever has been received, and returns the number
+			// of bytes read; it does not wait for more.  It is not null terminated (unlike Stream::read()).
+			uint16_t readBlock(uint8_t* data, uint16_t len);
+			//writeBlock() queues len bytes, waiting for free banks as needed, and returns the number of
+			// bytes written, which is less than len if the host stops listening.
+			uint16_t writeBlock(uint8_t* data, uint16_t len);
 
 			using Stream::skip;
 			using Stream::reset;
@@ -5,6 +5,7 @@ using namespace digitalcave;
 
 FlashStream::FlashStream(uint16_t position) {
 	this->position = position;
+	this->mark = position;
 }
 FlashStream::~FlashStream() {
 }
@@ -14,6 +15,11 @@ uint16_t FlashStream::skip(uint16_t n) {
 	return n;
 }
 
+uint8_t FlashStream::reset() {
+	this->position = mark;
+	return 1;
+}
+
 uint8_t FlashStream::read(uint8_t* b){
 	*b = pgm_read_byte_near(position++);
 	return 1;
@@ -16,6 +16,7 @@ namespace digitalcave {
 
 			uint8_t read(uint8_t *b);
 			uint16_t skip(uint16_t n);
+			uint8_t reset();
 			uint8_t write(uint8_t b);
 			using Stream::read;
 	};
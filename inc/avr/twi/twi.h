@@ -29,6 +29,14 @@
 //TWI_MASTER_RX_READER			Set a reader function to handle each byte as it comes in.  See twi_attach_master_rx_reader
 //TWI_SLAVE_TX_WRITER			Set a writer function to supply each byte as it is sent.  See twi_attach_slave_tx_writer
 //TWI_MASTER_TX_WRITER			Set a writer function to supply each byte as it is sent.  See twi_attach_slave_tx_writer
+//TWI_TIMEOUT					How many times the blocking calls poll a transaction before assuming the bus is stuck.  Defaults to 0xFFFF
+//
+//Master transfers go through a transaction queue.  Each transaction is a read or a write of any length, from / to
+// a list of buffers (scatter / gather), and is processed entirely in the TWI interrupt; when it is done its status is
+// set and its callback (if any) is called from the ISR.  The next queued transaction starts straight away, with a
+// repeated start if the previous one asked for it.  The blocking twi_read_from / twi_write_to calls are wrappers
+// around this.  Master mode bus timing (from the clock given to twi_set_clock) is recorded per transaction and in
+// the statistics.
 
 #ifndef TWI_H
 #define TWI_H
@@ -57,10 +65,58 @@
 #define TWI_SRX	 3
 #define TWI_STX	 4
 
+#ifndef TWI_TIMEOUT
+#define TWI_TIMEOUT 0xFFFF
+#endif
+
+//Transaction flags
+#define TWI_WRITE				0x00
+#define TWI_READ				0x01
+#define TWI_REPEATED_START		0x02	//Don't send a stop at the end; the next transaction starts with a repeated start
+
+//Transaction status; these are also the return values of twi_write_to()
+#define TWI_SUCCESS				0
+#define TWI_ERROR_LENGTH		1		//Data does not fit into the buffer (non-blocking twi_write_to only)
+#define TWI_ERROR_ADDRESS_NACK	2
+#define TWI_ERROR_DATA_NACK		3
+#define TWI_ERROR_OTHER			4		//Lost arbitration
+#define TWI_ERROR_BUS			5		//Illegal start / stop on the bus
+#define TWI_ERROR_TIMEOUT		6		//The bus was stuck, and has been recovered
+#define TWI_PENDING				0xFF	//Queued or in progress
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+//One piece of a transaction's data
+typedef struct twi_buffer_t {
+	uint8_t* data;
+	uint16_t length;
+} twi_buffer_t;
+
+typedef struct twi_transaction_t {
+	uint8_t address;				//7 bit slave address
+	uint8_t flags;					//TWI_WRITE or TWI_READ, optionally with TWI_REPEATED_START
+	twi_buffer_t* buffers;			//Data is written from / read into each of these in turn
+	uint8_t buffer_count;
+	void (*callback)(struct twi_transaction_t*);	//Called from the ISR when the transaction is done, or NULL
+	void* context;					//For use by the callback
+	volatile uint8_t status;		//TWI_PENDING until done, then TWI_SUCCESS or TWI_ERROR_*
+	volatile uint16_t transferred;	//Bytes actually transferred
+	uint16_t start;					//Clock (see twi_set_clock) when the transaction started on the bus
+	uint16_t duration;				//Clock ticks from start to completion
+	struct twi_transaction_t* next;	//Used by the queue
+} twi_transaction_t;
+
+typedef struct twi_stats_t {
+	uint16_t transactions;			//Master transactions completed (including failures)
+	uint16_t errors;				//Of which failed
+	uint16_t recoveries;			//Times the bus was unstuck by twi_recover()
+	uint32_t bytes;					//Master bytes transferred
+	uint32_t time_total;			//Sum of transaction durations, in clock ticks
+	uint16_t time_max;				//Longest transaction
+} twi_stats_t;
+
 /*
  * Override the default buffers with your own buffers.  This gives you more control over how the
  * buffers are constructed.
@@ -95,14 +151,40 @@ void twi_attach_master_tx_writer( uint8_t (*function)(uint16_t) );
 void twi_init();
 
 //Master mode, read from the given address, to the given data buffer, for the given number of
-// bytes, and either TWI_STOP or TWI_NO_STOP when completed.
-uint8_t twi_read_from(uint8_t address, uint8_t* data, uint16_t length, uint8_t send_stop);
+// bytes, and either TWI_STOP or TWI_NO_STOP when completed.  Blocks until done; returns the number
+// of bytes read.
+uint16_t twi_read_from(uint8_t address, uint8_t* data, uint16_t length, uint8_t send_stop);
 
 //Master mode, write to the given slave address, from the given data buffer, for the given number of
 // bytes.  If block is TWI_BLOCK (not TWI_NO_BLOCK) then this function blocks until the write is
-// completed.  If send_stop is TWI_STOP then we send the stop byte when completed.
+// completed.  If send_stop is TWI_STOP then we send the stop byte when completed.  Without blocking,
+// the data is copied into an internal buffer, so it must fit into TWI_BUFFER_LENGTH (and the result
+// is TWI_SUCCESS as long as it was queued); otherwise there is no length limit.
 uint8_t twi_write_to(uint8_t address, uint8_t* data, uint16_t length, uint8_t block, uint8_t send_stop);
 
+//Queue a master transaction.  The transaction (and its buffers) must stay valid until its status
+// is no longer TWI_PENDING.  Reads must be at least one byte long.
+void twi_queue(twi_transaction_t* transaction);
+
+//Wait for a queued transaction to finish, and return its status.  If it takes more than TWI_TIMEOUT
+// polls the bus is assumed to be stuck; it is recovered, and TWI_ERROR_TIMEOUT is returned.
+uint8_t twi_wait(twi_transaction_t* transaction);
+
+//Returns non-zero if master transactions are queued or in progress.
+uint8_t twi_busy();
+
+//Free a stuck bus: abandon the current transaction, clock SCL until the slave releases SDA, send a
+// stop, and re-initialize the TWI hardware.  Queued transactions carry on afterwards.
+void twi_recover();
+
+//Set the clock used for transaction timing; e.g. a function which returns TCNT1.  Without one,
+// no timing is recorded.
+void twi_set_clock(uint16_t (*clock)(void));
+
+//Get / reset the master transaction statistics
+void twi_get_stats(twi_stats_t* stats);
+void twi_reset_stats();
+
 //Slave mode, start listening on the specified address.
 void twi_set_slave_address(uint8_t);
 
@@ -2,15 +2,36 @@
 
 using namespace digitalcave;
 
+typedef struct dfplayermini_command_t {
+	uint8_t command;
+	uint16_t arg;
+	uint8_t sends;			//How many more times it can be sent
+	uint8_t timeout;		//How long to wait for the acknowledgement each time, in ms
+	uint32_t queued;		//When it was queued, for the latency stats
+} dfplayermini_command_t;
+
 static Stream* _serial = NULL;
-static ArrayStream buffer(64);
+static uint32_t (*_clock)() = NULL;
+
+static dfplayermini_command_t queue[DFPLAYER_QUEUE_SIZE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static uint8_t sent = 0;				//The command at the head of the queue has been sent, and is waiting to be acknowledged
+static uint32_t sentTime = 0;
+
+static uint16_t volume = 0xFFFF;		//The last volume the module acknowledged; 0xFFFF if not known
 
 static uint8_t request[10];
 static uint8_t response[10];
+static uint8_t responseLength = 0;
+
+static dfplayermini_stats_t stats;
 
+static uint8_t enqueue(uint8_t command, uint16_t arg, uint8_t sends, uint8_t timeout);
 
-void dfplayermini_init(Stream* serial){
+void dfplayermini_init(Stream* serial, uint32_t (*clock)()){
 	_serial = serial;
+	_clock = clock;
 
 	//Empty the serial buffer
 	uint8_t b;
@@ -22,18 +43,16 @@ void dfplayermini_init(Stream* serial){
 	request[2] = 0x06;	//Length (constant)
 	request[9] = 0xEF;	//End byte
 
-	//Wait until the module comes online, for a max of 2 seconds (20 * 50ms)
-	for (uint8_t i = 0; i < 40; i++){
-		//We can either wait for it to send a 0x3F init command...
-		if (dfplayermini_poll() && response[3] == DFPLAYER_COMMAND_GET_INIT_PARM){
-			break;
-		}
-		//.. or we can ask for it and get a 0x41 success command back
-		else if (dfplayermini_send_command(DFPLAYER_COMMAND_GET_INIT_PARM)){
-			break;
-		}
-		delay_ms(50);
-	}
+	queueHead = 0;
+	queueCount = 0;
+	sent = 0;
+	volume = 0xFFFF;
+	responseLength = 0;
+	dfplayermini_reset_stats();
+
+	//Ask until the module comes online, for a max of 2 seconds (40 * 50ms).  It also sends a 0x3F frame
+	// by itself when it is ready, which is returned from dfplayermini_poll() like any other.
+	enqueue(DFPLAYER_COMMAND_GET_INIT_PARM, 0, DFPLAYER_BOOT_RETRIES, DFPLAYER_BOOT_TIMEOUT);
 
 	//Finish initializing the module
 	dfplayermini_send_command(DFPLAYER_COMMAND_STANDBY_OFF);		//Turn off standby
@@ -42,52 +61,180 @@ void dfplayermini_init(Stream* serial){
 	dfplayermini_send_command(DFPLAYER_COMMAND_MODE_SET, 0);		//Repeat
 }
 
+static uint8_t enqueue(uint8_t command, uint16_t arg, uint8_t sends, uint8_t timeout){
+	if (queueCount >= DFPLAYER_QUEUE_SIZE) return 0;
+
+	dfplayermini_command_t* c = &queue[(queueHead + queueCount) % DFPLAYER_QUEUE_SIZE];
+	c->command = command;
+	c->arg = arg;
+	c->sends = sends;
+	c->timeout = timeout;
+	c->queued = _clock();
+	queueCount++;
+	return 1;
+}
+
 uint8_t dfplayermini_send_command(uint8_t command, uint16_t arg){
-	uint8_t feedback = 0x01;	//(command >= 0x3C ? 0x01 : 0x00);		//Commands over 0x3C have a return code
+	if (command == DFPLAYER_COMMAND_VOL_SET){
+		//If there is a volume change waiting which hasn't been sent yet, just change that one.
+		uint8_t waiting = 0;
+		for (uint8_t i = 0; i < queueCount; i++){
+			dfplayermini_command_t* c = &queue[(queueHead + i) % DFPLAYER_QUEUE_SIZE];
+			if (c->command != DFPLAYER_COMMAND_VOL_SET) continue;
+			waiting = 1;
+			if (i == 0 && sent) continue;
+			c->arg = arg;
+			stats.coalesced++;
+			return 1;
+		}
+		//If there is none, and the module already has this volume, there is nothing to do
+		if (!waiting && arg == volume){
+			stats.coalesced++;
+			return 1;
+		}
+	}
 
-	request[3] = command;
-	request[4] = feedback;	//Feedback requested
-	request[5] = (arg >> 8) & 0xFF;	//High byte
-	request[6] = arg & 0xFF;			//Low byte
+	return enqueue(command, arg, DFPLAYER_RETRIES, DFPLAYER_ACK_TIMEOUT);
+}
+
+//Sends the command at the head of the queue
+static void send(){
+	dfplayermini_command_t* c = &queue[queueHead];
+
+	request[3] = c->command;
+	request[4] = 0x01;	//Feedback requested
+	request[5] = (c->arg >> 8) & 0xFF;	//High byte
+	request[6] = c->arg & 0xFF;			//Low byte
 	uint16_t checksum = 0 - (request[1] + request[2] + request[3] + request[4] + request[5] + request[6]);
 	request[7] = (checksum >> 8) & 0xFF;
 	request[8] = checksum & 0xFF;
 	_serial->write(request, 10);
 
-	delay_ms(20);	//Wait a bit longer - at 9600 baud one message takes about 10 ms to send, and another 10 to recieve.  Give it an extra 10 for good measure.
-	while (dfplayermini_poll() != NULL){
-		if (response[3] == 0x40){
-			dfplayermini_send_command(command, arg);		//0x40 indicates the command should be re-sent
+	c->sends--;
+	sent = 1;
+	sentTime = _clock();
+}
+
+//Finishes the command at the head of the queue, whether it was acknowledged or given up on
+static void complete(uint8_t acknowledged){
+	dfplayermini_command_t* c = &queue[queueHead];
+
+	if (acknowledged){
+		uint32_t latency = _clock() - c->queued;
+		stats.commands++;
+		stats.latencyTotal += latency;
+		if (latency > stats.latencyMax) stats.latencyMax = latency;
+
+		if (c->command == DFPLAYER_COMMAND_VOL_SET) volume = c->arg;
+		else if (c->command == DFPLAYER_COMMAND_VOL_UP || c->command == DFPLAYER_COMMAND_VOL_DOWN || c->command == DFPLAYER_COMMAND_RESET) volume = 0xFFFF;
+	}
+	else {
+		stats.failures++;
+		//We don't know whether a volume change got through
+		if (c->command == DFPLAYER_COMMAND_VOL_SET) volume = 0xFFFF;
+	}
+
+	queueHead = (queueHead + 1) % DFPLAYER_QUEUE_SIZE;
+	queueCount--;
+	sent = 0;
+}
+
+//Sends the command at the head of the queue again, or gives up on it
+static void retry(){
+	if (queue[queueHead].sends == 0){
+		complete(0);
+	}
+	else {
+		stats.retries++;
+		sent = 0;		//It goes again from dfplayermini_poll()
+	}
+}
+
+//Returns 1 if response[] holds a whole, valid frame
+static uint8_t valid(){
+	uint16_t checksum = 0 - (response[1] + response[2] + response[3] + response[4] + response[5] + response[6]);
+	return response[1] == 0xFF && response[2] == 0x06 && response[9] == 0xEF
+			&& response[7] == ((checksum >> 8) & 0xFF) && response[8] == (checksum & 0xFF);
+}
+
+//Adds a byte from the module to the frame being received.  Returns 1 if it completes a frame which should
+// be returned from dfplayermini_poll().
+static uint8_t receive(uint8_t b){
+	//Frames start with 0x7E; anything else between frames is noise
+	if (responseLength == 0 && b != 0x7E) return 0;
+	response[responseLength++] = b;
+	if (responseLength < 10) return 0;
+	responseLength = 0;
+
+	if (!valid()){
+		stats.badFrames++;
+		//Start again from the next start byte in what we have, in case a byte was lost
+		for (uint8_t i = 1; i < 10; i++){
+			if (response[i] == 0x7E){
+				for (uint8_t j = i; j < 10; j++){
+					response[responseLength++] = response[j];
+				}
+				break;
+			}
 		}
-		else if (response[3] == 0x41){		//0x41 is success
-			return 1;
+		return 0;
+	}
+
+	if (response[3] == DFPLAYER_RESPONSE_ACK){
+		if (sent) complete(1);
+		return 0;
+	}
+	if (response[3] == DFPLAYER_RESPONSE_ERROR && sent){
+		//The module was busy, or didn't understand the frame; send it again
+		if (response[6] == DFPLAYER_ERROR_BUSY || response[6] == DFPLAYER_ERROR_FRAME || response[6] == DFPLAYER_ERROR_CHECKSUM){
+			retry();
+			return 0;
 		}
+		//Anything else (e.g. no such track) won't get better; return it, and move on
+		complete(0);
 	}
 
-	return 0;
+	stats.events++;
+	return 1;
 }
 
 uint8_t* dfplayermini_poll(){
-	uint8_t b = 0;
-	//Read anything from the serial port into a buffer
-	while (_serial->read(&b)){
-		buffer.write(b);
-	}
+	uint8_t* result = NULL;
+	uint8_t b;
 
-	//Discard bytes until we have less than 2 messages, and find a start byte
-	while ((buffer.peek(&b) && b != 0x7E) || buffer.size() > 20){
-		buffer.read(&b);
+	//Parse what has arrived, stopping at a frame to return (the rest waits in the serial buffer until next time)
+	while (_serial->read(&b)){
+		if (receive(b)){
+			result = response;
+			break;
+		}
 	}
 
-	if (buffer.size() > 10){
-		//Copy 10 bytes of buffer to response
-		for (uint8_t i = 0; i < 10; i++){
-			buffer.read(&b);
-			response[i] = b;
-		}
-		return response;
+	if (sent && _clock() - sentTime >= queue[queueHead].timeout){
+		retry();
 	}
-	else {
-		return NULL;	//Not a full message in the queue
+	if (!sent && queueCount){
+		send();
 	}
+
+	return result;
+}
+
+uint8_t dfplayermini_pending(){
+	return queueCount;
+}
+
+dfplayermini_stats_t* dfplayermini_get_stats(){
+	return &stats;
+}
+
+void dfplayermini_reset_stats(){
+	stats.commands = 0;
+	stats.retries = 0;
+	stats.failures = 0;
+	stats.coalesced = 0;
+	stats.badFrames = 0;
+	stats.events = 0;
+	stats.latencyTotal = 0;
+	stats.latencyMax = 0;
 }
@@ -1,15 +1,18 @@
 /*
  * Library for using DFPlayer Mini chip.
+ *
+ * Nothing here waits for the module.  Commands are put into a queue and sent one at a time; each one
+ * is sent again if the module doesn't acknowledge it within DFPLAYER_ACK_TIMEOUT (or says it was busy),
+ * up to DFPLAYER_RETRIES times.  A volume change replaces one which is still waiting to be sent, so
+ * ramping the volume never gets more than one command behind.  Frames from the module are parsed as
+ * the bytes arrive, and checked against their checksum.  All of this happens in dfplayermini_poll(),
+ * which must be called regularly from the main loop.
  */
 
 #ifndef DFPLAYER_MINI_H
 #define DFPLAYER_MINI_H
 
-#include <stdlib.h>
-#include <math.h>
-#include <dctypes.h>
-#include <dcutil/delay.h>
-#include <Stream/ArrayStream.h>
+#include <stdint.h>
 #include <Stream/Stream.h>
 
 #define DFPLAYER_COMMAND_NEXT			0x01
@@ -32,6 +35,8 @@
 
 #define DFPLAYER_RESPONSE_TRACK_DONE	0x3D
 #define DFPLAYER_COMMAND_GET_INIT_PARM	0x3F
+#define DFPLAYER_RESPONSE_ERROR			0x40
+#define DFPLAYER_RESPONSE_ACK			0x41
 #define DFPLAYER_COMMAND_GET_STATUS		0x42
 #define DFPLAYER_COMMAND_GET_VOLUME		0x43
 #define DFPLAYER_COMMAND_GET_EQ			0x44
@@ -39,12 +44,50 @@
 #define DFPLAYER_COMMAND_GET_SW_VER		0x46
 #define DFPLAYER_COMMAND_GET_FILE_COUNT	0x47
 
-//Resets the module and performs initial setup
-void dfplayermini_init(digitalcave::Stream* serial);
+//Error codes (the argument of a DFPLAYER_RESPONSE_ERROR frame).  The first three are worth sending again.
+#define DFPLAYER_ERROR_BUSY				0x01
+#define DFPLAYER_ERROR_FRAME			0x03
+#define DFPLAYER_ERROR_CHECKSUM			0x04
 
+//Commands which can be waiting at once
+#ifndef DFPLAYER_QUEUE_SIZE
+#define DFPLAYER_QUEUE_SIZE				8
+#endif
+//How long to wait for the module to acknowledge a command, in ms, and how many times to send it.  At
+// 9600 baud a frame takes about 10ms each way.
+#define DFPLAYER_ACK_TIMEOUT			100
+#define DFPLAYER_RETRIES				3
+//The module takes a second or two to start up; until then the first command is sent every 50ms
+#define DFPLAYER_BOOT_TIMEOUT			50
+#define DFPLAYER_BOOT_RETRIES			40
+
+typedef struct dfplayermini_stats_t {
+	uint32_t commands;				//Commands acknowledged
+	uint32_t retries;				//Commands sent again, after no acknowledgement or a busy error
+	uint32_t failures;				//Commands given up on
+	uint32_t coalesced;				//Volume changes merged into a waiting one, or dropped as unchanged
+	uint32_t badFrames;				//Frames from the module dropped for a bad checksum or framing
+	uint32_t events;				//Frames returned from dfplayermini_poll()
+	uint32_t latencyTotal;			//Time from queueing each acknowledged command to its acknowledgement, in ms
+	uint32_t latencyMax;
+} dfplayermini_stats_t;
+
+//Resets the state and queues the initial setup.  The clock function returns the time in ms.
+void dfplayermini_init(digitalcave::Stream* serial, uint32_t (*clock)());
+
+//Queues a command.  Returns 1 if it was queued (or merged with a waiting one), 0 if the queue is full.
 uint8_t dfplayermini_send_command(uint8_t command, uint16_t arg = 0x00);
 
-//Looks for a response.  If there is one, return the response object.  Otherwise, return NULL.
+//Reads and parses whatever the module has sent, sends the next command when the last one is acknowledged,
+// and handles retries.  If the module sent something other than an acknowledgement (a track finishing,
+// the answer to a query, an error), returns that 10 byte frame (byte 3 is the command, 5 and 6 the
+// argument); otherwise returns NULL.  Call it again until it returns NULL to get everything.
 uint8_t* dfplayermini_poll();
 
+//Returns the number of commands waiting or in progress
+uint8_t dfplayermini_pending();
+
+dfplayermini_stats_t* dfplayermini_get_stats();
+void dfplayermini_reset_stats();
+
 #endif
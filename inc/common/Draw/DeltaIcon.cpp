@@ -0,0 +1,131 @@
+#include "DeltaIcon.h"
+
+using namespace digitalcave;
+
+DeltaIcon::DeltaIcon(Stream* stream) {
+	this->stream = stream;
+	this->palette = NULL;
+	readHeader();
+}
+
+DeltaIcon::~DeltaIcon() {
+	if (palette != NULL) free(palette);
+}
+
+uint8_t DeltaIcon::next() {
+	uint8_t b = 0;
+	stream->read(&b);
+	return b;
+}
+
+uint8_t DeltaIcon::readHeader() {
+	width = next();
+	height = next();
+	config = next();
+	colors = next();
+	last = 0;
+
+	//The palette size does not change when rewinding, so only allocate it once
+	if (colors > 0 && palette == NULL) palette = (uint8_t*) malloc(colors * 3);
+	for (uint16_t i = 0; i < colors * 3; i++) {
+		uint8_t b = next();
+		if (palette != NULL) palette[i] = b;
+	}
+
+	return isValid();
+}
+
+uint8_t DeltaIcon::getWidth() {
+	return width;
+}
+
+uint8_t DeltaIcon::getHeight() {
+	return height;
+}
+
+uint8_t DeltaIcon::isValid() {
+	return (config & DELTA_ICON_CONFIG) && (colors == 0 || palette != NULL);
+}
+
+uint8_t DeltaIcon::hasMore() {
+	return last & 0x40;
+}
+
+uint8_t DeltaIcon::hasLoop() {
+	return last & 0x80;
+}
+
+uint8_t DeltaIcon::getDelay() {
+	return last & 0x3f;
+}
+
+uint16_t DeltaIcon::getDelayMs() {
+	return (last & 0x3f) * 50;
+}
+
+uint8_t DeltaIcon::rewind() {
+	if (!stream->reset()) return 0;
+	return readHeader();
+}
+
+void DeltaIcon::readColor(Draw* draw) {
+	if (colors == 0) {
+		uint8_t r = next();
+		uint8_t g = next();
+		draw->setColor(r, g, next());
+	}
+	else {
+		//An index past the end of the palette only comes from a corrupt icon; draw it black
+		uint8_t i = next();
+		if (i >= colors) {
+			draw->setColor(0, 0, 0);
+			return;
+		}
+		uint8_t* c = palette + i * 3;
+		draw->setColor(c[0], c[1], c[2]);
+	}
+}
+
+void DeltaIcon::plot(Draw* draw, int16_t x, int16_t y, uint8_t orientation, uint8_t px, uint8_t py) {
+	if (orientation == DRAW_ORIENTATION_90) draw->setPixel(x + height - 1 - py, y + px);
+	else if (orientation == DRAW_ORIENTATION_180) draw->setPixel(x + width - 1 - px, y + height - 1 - py);
+	else if (orientation == DRAW_ORIENTATION_270) draw->setPixel(x + py, y + width - 1 - px);
+	else draw->setPixel(x + px, y + py);
+}
+
+void DeltaIcon::draw(Draw* draw, int16_t x, int16_t y, uint8_t orientation) {
+	if (!isValid()) return;
+
+	//Position within the frame; row order
+	uint8_t px = 0;
+	uint8_t py = 0;
+
+	while (py < height) {
+		uint8_t c = next();
+		if ((c & 0x80) == DELTA_ICON_SKIP) {
+			uint16_t n = px + c + 1;
+			while (n >= width) {
+				n -= width;
+				py++;
+			}
+			px = n;
+			continue;
+		}
+
+		uint8_t n = (c & 0x3f) + 1;
+		uint8_t repeat = (c & 0xC0) == DELTA_ICON_REPEAT;
+		if (repeat) readColor(draw);
+		for (uint8_t j = 0; j < n && py < height; j++) {
+			if (!repeat) readColor(draw);
+			plot(draw, x, y, orientation, px, py);
+			if (++px == width) {
+				px = 0;
+				py++;
+			}
+		}
+	}
+
+	uint8_t footer = next();
+	if (footer & 0x80) rewind();
+	last = footer;
+}
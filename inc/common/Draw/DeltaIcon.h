@@ -0,0 +1,84 @@
+#ifndef DELTA_ICON_H
+#define DELTA_ICON_H
+
+#include <stdint.h>
+#include <Draw.h>
+#include <Stream.h>
+
+//Set in the config byte of the header to mark a delta / RLE encoded icon
+#define DELTA_ICON_CONFIG		0x80
+
+//Run control bytes; the low bits are the run length - 1
+#define DELTA_ICON_SKIP			0x00	//0xxxxxxx: 1-128 pixels unchanged since the last frame
+#define DELTA_ICON_REPEAT		0x80	//10xxxxxx: 1-64 pixels of the one color which follows
+#define DELTA_ICON_LITERAL		0xC0	//11xxxxxx: 1-64 pixels, each color follows
+
+#define DELTA_ICON_SKIP_MAX		128
+#define DELTA_ICON_RUN_MAX		64
+
+namespace digitalcave {
+	/*
+	 * Draws a run length / delta compressed icon.
+	 * Like Icon this streams one frame at a time, so it works from resettable (flash, SD) or
+	 * non-resettable (wifi, serial) streams, but each frame only contains the pixels which
+	 * changed since the previous frame, and runs of the same color are stored once.  Drawing
+	 * a frame only calls setPixel() for the changed pixels, so the target must still hold the
+	 * previous frame (i.e. don't clear between frames).
+	 *
+	 * Icon data consists of a 4 byte header (width, height, config, palette size), then the
+	 * palette (3 bytes RGB per entry), then for each frame the pixel runs and a 1 byte footer.
+	 * The config byte is compressed [7] (DELTA_ICON_CONFIG), unused [6:0].
+	 * A palette size of 0 means there is no palette and each color is 3 bytes RGB; otherwise
+	 * each color is a 1 byte palette index (an index past the end of the palette is drawn black).
+	 * The pixel runs cover width * height pixels in row order, and use the DELTA_ICON_SKIP,
+	 * _REPEAT and _LITERAL control bytes.  The first frame should not skip any pixels.
+	 * The footer byte is loop [7], more [6], delay (50-3150 ms) [5:0], as for Icon.
+	 *
+	 * Use icon_encode.py to create icons from a sequence of images.
+	 */
+	class DeltaIcon {
+	private:
+		Stream* stream;
+		uint8_t width;
+		uint8_t height;
+		uint8_t config;
+		uint8_t colors;		// palette entries, 0 for RGB
+		uint8_t* palette;
+		uint8_t last;		// footer of the last frame drawn
+
+		uint8_t next();
+		uint8_t readHeader();
+		void readColor(Draw* draw);
+		void plot(Draw* draw, int16_t x, int16_t y, uint8_t orientation, uint8_t px, uint8_t py);
+
+	public:
+		DeltaIcon(Stream* stream);
+		~DeltaIcon();
+
+		uint8_t getWidth();
+		uint8_t getHeight();
+
+		/* Indicates that the header was valid, i.e. the stream contains a delta encoded icon. */
+		uint8_t isValid();
+		/* Indicates that there are more frames to draw. */
+		uint8_t hasMore();
+		/* Indicates that the curent frame is the last frame and the next frame to draw will be first frame. */
+		uint8_t hasLoop();
+		/* Returns the delay to use before drawing the next frame in multiples of 50 ms; or 0 to prevent animation. */
+		uint8_t getDelay();
+		/* Returns the delay to use before drawing the next frame in ms; or 0 to prevent animation. */
+		uint16_t getDelayMs();
+
+		/*
+		 * Resets the stream so that the next frame drawn is the first frame.  Since each frame
+		 * is relative to the one before, this is the only way to go back.  Returns 0 if the
+		 * stream cannot be reset.
+		 */
+		uint8_t rewind();
+
+		/* Draws the changes for the next frame onto the draw context. */
+		void draw(Draw *draw, int16_t x, int16_t y, uint8_t orientation);
+	};
+}
+
+#endif
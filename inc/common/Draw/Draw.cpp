@@ -1,5 +1,9 @@
 #include "Draw.h"
+#if defined(__AVR__)
 #include <avr/pgmspace.h>
+#else
+#define pgm_read_byte_near(addr) (*(const uint8_t*) (addr))
+#endif
 
 using namespace digitalcave;
 
@@ -22,6 +26,16 @@ void Draw::setFont(uint8_t* font, uint8_t* codepage, uint8_t width, uint8_t heig
 	}
 }
 
+void Draw::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+	this->alpha = a;
+	setColor(r, g, b);
+}
+void Draw::setColor(uint8_t r, uint8_t g, uint8_t b) {
+	this->red = r;
+	this->green = g;
+	this->blue = b;
+}
+
 void Draw::setOverlay(uint8_t o) {
 	overlay = o;
 }
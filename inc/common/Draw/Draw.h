@@ -36,12 +36,12 @@ namespace digitalcave {
 		uint8_t font_height;
 		uint8_t* font;
 		uint8_t* font_codepage;
-		uint8_t red;
-		uint8_t green;
-		uint8_t blue;
 		uint8_t alpha;
 
 	protected:
+		uint8_t red;
+		uint8_t green;
+		uint8_t blue;
 		uint8_t overlay = DRAW_OVERLAY_REPLACE;
 
 	public:
@@ -57,6 +57,12 @@ namespace digitalcave {
 		 */
 		void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 
+		/*
+		 * Sets the color for draw operations.  Devices which support color override this
+		 * so that the color is picked up by setPixel().
+		 */
+		virtual void setColor(uint8_t r, uint8_t g, uint8_t b);
+
 		/*
 		 * Draws a bitmap from flash memory of the specified size on the screen at the specified position.
 		 * For every bit set in the bitmap a pixel of the specified value will be drawn with the specified overlay.
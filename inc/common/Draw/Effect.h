@@ -0,0 +1,43 @@
+/*
+ * Base class for anything which EffectScheduler can run.  An effect draws one whole frame
+ * per call to render(), through the Draw it is given; it should not flush, or wait.
+ */
+
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <stdint.h>
+
+#include "Draw.h"
+
+namespace digitalcave {
+	//Render statistics, kept by EffectScheduler.  Times are in the scheduler's clock units.
+	typedef struct effect_stats_t {
+		uint32_t frames;		//Frames rendered
+		uint32_t dropped;		//Frames skipped because the previous frame(s) ran late
+		uint32_t overruns;		//Renders which took longer than the frame period
+		uint32_t renderTotal;	//Total time spent rendering; divide by frames for the average
+		uint32_t renderMax;		//Longest render
+	} effect_stats_t;
+
+	class Effect {
+		protected:
+			//Not virtual, so that AVR builds don't need operator delete; effects aren't deleted through an Effect*
+			~Effect() {}
+
+		public:
+			effect_stats_t stats;
+
+			Effect() { resetStats(); }
+
+			/*
+			 * Draws the next frame.  The contents of draw are not defined beforehand (they
+			 * are usually the frame before last), so draw every pixel.
+			 */
+			virtual void render(Draw* draw) = 0;
+
+			void resetStats() { stats.frames = stats.dropped = stats.overruns = stats.renderTotal = stats.renderMax = 0; }
+	};
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "EffectScheduler.h"
+
+using namespace digitalcave;
+
+EffectScheduler::EffectScheduler(Draw* device, uint8_t width, uint8_t height, uint32_t (*clock)(), uint32_t period) :
+	back(width, height),
+	transition(width, height, 0) {
+	this->device = device;
+	this->clock = clock;
+	this->period = period;
+	this->next = clock();
+	this->effect = NULL;
+	this->outgoing = NULL;
+	this->fade = 0;
+	this->step = 0;
+}
+
+void EffectScheduler::endTransition() {
+	outgoing = NULL;
+}
+
+void EffectScheduler::setEffect(Effect* effect, uint16_t fadeFrames) {
+	endTransition();
+
+	if (fadeFrames > 0 && this->effect != NULL && this->effect != effect) {
+		if (transition.allocate()) {
+			outgoing = this->effect;
+			fade = fadeFrames;
+			step = 0;
+		}
+	}
+
+	this->effect = effect;
+	if (effect != NULL) effect->resetStats();
+}
+
+void EffectScheduler::renderTimed(Effect* e, Draw* target) {
+	uint32_t start = clock();
+	e->render(target);
+	uint32_t elapsed = clock() - start;
+
+	e->stats.frames++;
+	e->stats.renderTotal += elapsed;
+	if (elapsed > e->stats.renderMax) e->stats.renderMax = elapsed;
+	if (elapsed > period) e->stats.overruns++;
+}
+
+void EffectScheduler::blend() {
+	//Alpha of the incoming effect, 0..256
+	uint16_t alpha = ((uint32_t) step << 8) / fade;
+	uint8_t* in = back.getBuffer();
+	uint8_t* out = transition.getBuffer();
+	uint16_t count = back.getWidth() * back.getHeight() * 3;
+
+	for (uint16_t i = 0; i < count; i++) {
+		in[i] = out[i] + (((int32_t) (in[i] - out[i]) * alpha) >> 8);
+	}
+}
+
+void EffectScheduler::present() {
+	uint8_t* pixel = back.getBuffer();
+	if (pixel == NULL) return;
+	uint8_t overlay = device->getOverlay();
+
+	device->setOverlay(DRAW_OVERLAY_REPLACE);
+	for (uint8_t y = 0; y < back.getHeight(); y++) {
+		for (uint8_t x = 0; x < back.getWidth(); x++) {
+			device->setColor(pixel[0], pixel[1], pixel[2]);
+			device->setPixel(x, y);
+			pixel += 3;
+		}
+	}
+	device->setOverlay(overlay);
+	device->flush();
+}
+
+uint8_t EffectScheduler::update() {
+	uint32_t now = clock();
+	if ((int32_t) (now - next) < 0) return 0;
+
+	//Skip any whole periods we have already missed, rather than rendering them late
+	uint32_t late = (now - next) / period;
+	next += (late + 1) * period;
+
+	if (effect == NULL) return 0;
+	effect->stats.dropped += late;
+
+	renderTimed(effect, &back);
+	if (outgoing != NULL) {
+		outgoing->stats.dropped += late;
+		renderTimed(outgoing, &transition);
+		step += late + 1;
+		if (step >= fade) endTransition();
+		else blend();
+	}
+
+	present();
+	return 1;
+}
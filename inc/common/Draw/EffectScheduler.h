@@ -0,0 +1,74 @@
+/*
+ * Runs Effects at a fixed frame rate on a Draw device.  Effects render into an off screen
+ * back buffer, which is copied to the device (the front buffer) and flushed in one go, so
+ * the device never shows a half drawn frame.  If a frame is late the scheduler drops the
+ * frames it missed rather than trying to catch up, and counts them in the effect's stats.
+ *
+ * Changing effect can crossfade from the old one to the new one; during the fade both
+ * effects are rendered (the old one into a second buffer, allocated by the first crossfade
+ * and kept for the life of the scheduler) and blended.  If the back buffer can't be
+ * allocated nothing is shown.
+ *
+ * The clock is supplied by the caller and can be in any units (ms, us, timer ticks); the
+ * frame period and all stats are in the same units.
+ */
+
+#ifndef EFFECT_SCHEDULER_H
+#define EFFECT_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Draw.h"
+#include "Effect.h"
+#include "FrameBuffer.h"
+
+namespace digitalcave {
+	class EffectScheduler {
+		private:
+			Draw* device;
+			uint32_t (*clock)();
+			uint32_t period;
+			uint32_t next;
+
+			FrameBuffer back;
+			FrameBuffer transition;		//Outgoing effect during a crossfade
+
+			Effect* effect;
+			Effect* outgoing;
+			uint16_t fade;				//Length of the crossfade in frames
+			uint16_t step;				//Frames into the crossfade
+
+			void renderTimed(Effect* e, Draw* target);
+			void blend();
+			void present();
+			void endTransition();
+
+		public:
+			EffectScheduler(Draw* device, uint8_t width, uint8_t height, uint32_t (*clock)(), uint32_t period);
+
+			/*
+			 * Switches to the given effect.  If fadeFrames is non zero (and there is already an
+			 * effect running) the change is a crossfade over that many frames; otherwise the
+			 * change is immediate.  A crossfade falls back to an immediate change if the
+			 * transition buffer can't be allocated.
+			 */
+			void setEffect(Effect* effect, uint16_t fadeFrames);
+			Effect* getEffect() { return effect; }
+			uint8_t isTransitioning() { return outgoing != NULL; }
+
+			/*
+			 * Sets the target frame period, in clock units.
+			 */
+			void setPeriod(uint32_t period) { this->period = period; }
+			uint32_t getPeriod() { return period; }
+
+			/*
+			 * Call as often as possible from the main loop.  If a frame is due, renders and
+			 * shows it and returns 1; otherwise returns 0 immediately.
+			 */
+			uint8_t update();
+	};
+}
+
+#endif
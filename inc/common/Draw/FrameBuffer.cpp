@@ -0,0 +1,64 @@
+#include "FrameBuffer.h"
+
+#include <string.h>
+
+using namespace digitalcave;
+
+FrameBuffer::FrameBuffer(uint8_t width, uint8_t height, uint8_t allocateNow) {
+	this->width = width;
+	this->height = height;
+	this->buffer = NULL;
+	this->red = 0;
+	this->green = 0;
+	this->blue = 0;
+	if (allocateNow) allocate();
+}
+
+FrameBuffer::~FrameBuffer() {
+	free(buffer);
+}
+
+uint8_t FrameBuffer::allocate() {
+	if (buffer == NULL) {
+		buffer = (uint8_t*) malloc(width * height * 3);
+		clear();
+	}
+	return buffer != NULL;
+}
+
+uint8_t* FrameBuffer::getPixel(int16_t x, int16_t y) {
+	if (buffer == NULL) return NULL;
+	if (x >= width || y >= height || x < 0 || y < 0) return NULL;
+	return buffer + (y * width + x) * 3;
+}
+
+void FrameBuffer::setPixel(int16_t x, int16_t y) {
+	uint8_t* pixel = getPixel(x, y);
+	if (pixel == NULL) return;
+
+	if (overlay == DRAW_OVERLAY_REPLACE){
+		pixel[0] = red;
+		pixel[1] = green;
+		pixel[2] = blue;
+	}
+	else if (overlay == DRAW_OVERLAY_OR){
+		pixel[0] |= red;
+		pixel[1] |= green;
+		pixel[2] |= blue;
+	}
+	else if (overlay == DRAW_OVERLAY_NAND){
+		pixel[0] &= ~red;
+		pixel[1] &= ~green;
+		pixel[2] &= ~blue;
+	}
+	else if (overlay == DRAW_OVERLAY_XOR){
+		pixel[0] ^= red;
+		pixel[1] ^= green;
+		pixel[2] ^= blue;
+	}
+}
+
+void FrameBuffer::clear() {
+	if (buffer == NULL) return;
+	memset(buffer, 0, width * height * 3);
+}
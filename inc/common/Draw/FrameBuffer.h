@@ -0,0 +1,55 @@
+/*
+ * An off screen RGB Draw target, width x height x 3 bytes.  Used by EffectScheduler as the
+ * back buffer which effects render into, but it can be used on its own too.  If the buffer
+ * can't be allocated getBuffer() returns NULL and drawing does nothing.
+ */
+
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Draw.h"
+
+namespace digitalcave {
+	class FrameBuffer : public Draw {
+		private:
+			uint8_t width;
+			uint8_t height;
+			uint8_t* buffer;
+
+		public:
+			/*
+			 * Allocates the buffer now, unless allocateNow is 0, in which case it is left until
+			 * allocate() is called.
+			 */
+			FrameBuffer(uint8_t width, uint8_t height, uint8_t allocateNow = 1);
+			~FrameBuffer();
+
+			void setPixel(int16_t x, int16_t y);
+			void flush() {}
+
+			/*
+			 * Returns a pointer to the RGB triple for the given pixel, or NULL if out of bounds.
+			 */
+			uint8_t* getPixel(int16_t x, int16_t y);
+
+			/*
+			 * Allocates (and clears) the buffer if it hasn't been already; it is then kept until the
+			 * FrameBuffer is destroyed.  Returns 1 if there is a buffer, 0 if it couldn't be allocated.
+			 */
+			uint8_t allocate();
+
+			/*
+			 * Sets the whole buffer to black.
+			 */
+			void clear();
+
+			uint8_t* getBuffer() { return buffer; }
+			uint8_t getWidth() { return width; }
+			uint8_t getHeight() { return height; }
+	};
+}
+
+#endif
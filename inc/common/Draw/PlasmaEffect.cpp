@@ -0,0 +1,128 @@
+#include <math.h>
+#include <dcmath.h>
+
+#include "PlasmaEffect.h"
+
+using namespace digitalcave;
+
+//Spatial frequency of the plasma, in radians across the width of the display
+#define PLASMA_K			10.0
+//Radians to 8 bit phase
+#define PLASMA_PHASE		(256 / (2 * M_PI))
+//Time advance per frame; one radian, in 8.8 fixed point phase
+#define PLASMA_TIME_STEP	((uint16_t) (PLASMA_PHASE * 256))
+
+PlasmaEffect::PlasmaEffect(uint8_t width, uint8_t height) {
+	this->width = width;
+	this->height = height;
+	this->palette = PLASMA_PALETTE_RED_GREEN;
+	this->time = 0;
+
+	distance = (uint8_t*) malloc(256);
+	column = (uint8_t*) malloc(width);
+	columnHalf = (uint8_t*) malloc(width);
+	columnDistance = (uint16_t*) malloc(width * sizeof(uint16_t));
+	rowHalf = (uint8_t*) malloc(height);
+	rowDistance = (uint16_t*) malloc(height * sizeof(uint16_t));
+	if (distance == NULL || column == NULL || columnHalf == NULL || columnDistance == NULL || rowHalf == NULL || rowDistance == NULL) {
+		//Not enough memory; render() draws nothing
+		free(distance);
+		free(column);
+		free(columnHalf);
+		free(columnDistance);
+		free(rowHalf);
+		free(rowDistance);
+		distance = column = columnHalf = rowHalf = NULL;
+		columnDistance = rowDistance = NULL;
+		return;
+	}
+
+	//The ripple term is sin(sqrt(100 * d^2 + 1) + t), where d^2 is in the range 0..2; the
+	// table is indexed by d^2 * 128.  Only the phase (mod 256) is stored, since that is all
+	// that sin8 needs.
+	for (uint16_t i = 0; i < 256; i++) {
+		distance[i] = (uint8_t) (int16_t) (sqrt(100.0 * i / 128 + 1.0) * PLASMA_PHASE + 0.5);
+	}
+
+	for (uint8_t x = 0; x < width; x++) {
+		int16_t phase = (PLASMA_K * ((float) x / width - 0.5)) * PLASMA_PHASE;
+		column[x] = phase;
+		columnHalf[x] = phase / 2;
+	}
+	for (uint8_t y = 0; y < height; y++) {
+		int16_t phase = (PLASMA_K * ((float) y / height - 0.5)) * PLASMA_PHASE;
+		rowHalf[y] = phase / 2;
+	}
+}
+
+PlasmaEffect::~PlasmaEffect() {
+	free(distance);
+	free(column);
+	free(columnHalf);
+	free(columnDistance);
+	free(rowHalf);
+	free(rowDistance);
+}
+
+void PlasmaEffect::render(Draw* draw) {
+	if (distance == NULL) return;
+
+	uint8_t t = time >> 8;			//t
+	uint8_t tHalf = time >> 9;		//t / 2
+
+	//The ripple centre moves around as (0.5 * sin(t / 5), 0.5 * cos(t / 3)).  Find the squared
+	// distance of each column and row from it (in units where 0.5 is half the display), so
+	// that the squared distance of a pixel is just the sum.
+	int16_t cx = sin8((time / 5) >> 8);
+	int16_t cy = cos8((time / 3) >> 8);
+	for (uint8_t x = 0; x < width; x++) {
+		int16_t dx = (((int16_t) x << 8) / width) - 128 + (cx * 128) / 127;		//Q8
+		columnDistance[x] = ((int32_t) dx * dx) >> 2;
+	}
+	for (uint8_t y = 0; y < height; y++) {
+		int16_t dy = (((int16_t) y << 8) / height) - 128 + (cy * 128) / 127;
+		rowDistance[y] = ((int32_t) dy * dy) >> 2;
+	}
+
+	for (uint8_t x = 0; x < width; x++) {
+		uint8_t v1 = column[x] + t;
+		uint8_t v3 = columnHalf[x] + tHalf;
+		for (uint8_t y = 0; y < height; y++) {
+			uint16_t d = (columnDistance[x] + rowDistance[y]) >> 7;
+			if (d > 255) d = 255;
+
+			//v is the sum of four sines, each -127..127; v / 254 is the float version's v.
+			int16_t v = sin8(v1);
+			v += sin8(rowHalf[y] + tHalf);
+			v += sin8(rowHalf[y] + v3);
+			v += sin8(distance[d] + t);
+
+			//pi * v in phase units is v * 128 / 254, i.e. v * 129 / 256.
+			uint8_t p = (v * 129) >> 8;
+			uint8_t r, g, b;
+			if (palette == PLASMA_PALETTE_RED_GREEN) {
+				r = (sin8(p) + 128) >> 2;
+				g = (cos8(p) + 128) >> 2;
+				b = 0;
+			} else if (palette == PLASMA_PALETTE_RED) {
+				r = 63;
+				g = (cos8(p) + 128) >> 2;
+				b = (sin8(p) + 128) >> 2;
+			} else if (palette == PLASMA_PALETTE_RAINBOW) {
+				r = (sin8(p) + 128) >> 2;
+				g = (sin8(p + 85) + 128) >> 2;
+				b = (sin8(p + 171) + 128) >> 2;
+			} else if (palette == PLASMA_PALETTE_BANDS) {
+				r = g = b = (sin8((v * 645L) >> 8) + 128) >> 2;
+			} else {
+				//64 * (0.5 + 0.4 * v), clamped
+				int16_t c = 32 + v / 10;
+				r = g = b = (c < 0) ? 0 : (c > 63 ? 63 : c);
+			}
+			draw->setColor(r, g, b);
+			draw->setPixel(x, y);
+		}
+	}
+
+	time += PLASMA_TIME_STEP;
+}
@@ -0,0 +1,63 @@
+/*
+ * Fixed point plasma renderer (after http://www.bidouille.org/prog/plasma).  All of the
+ * per pixel work is table lookups and additions: the sine terms use the 8 bit phase
+ * sin8 / cos8 from dcmath, the per column / per row terms are computed once per frame,
+ * and the ripple term looks up its distance in a table indexed by squared distance from
+ * the (moving) centre.  The cost per frame is therefore fixed, and much lower than the
+ * float version on chips without an FPU.
+ *
+ * The output matches the float version which was used in the ledtable / ledcubicle Plasma
+ * modules: time advances by one radian per frame, and color channels are 0..63.
+ */
+
+#ifndef PLASMA_EFFECT_H
+#define PLASMA_EFFECT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Draw.h"
+#include "Effect.h"
+
+#define PLASMA_PALETTE_RED_GREEN	0		//Red and green out of phase
+#define PLASMA_PALETTE_RED			1		//Full red, green and blue out of phase
+#define PLASMA_PALETTE_RAINBOW		2		//Red, green and blue 120 degrees apart
+#define PLASMA_PALETTE_BANDS		3		//White contour bands
+#define PLASMA_PALETTE_GREY			4		//Smooth greyscale
+#define PLASMA_PALETTE_COUNT		5
+
+namespace digitalcave {
+	class PlasmaEffect : public Effect {
+		private:
+			uint8_t width;
+			uint8_t height;
+			uint8_t palette;
+			uint32_t time;			//Phase of the time term; 8.8 fixed point where 256.0 is one revolution
+
+			uint8_t* distance;		//Ripple phase, indexed by squared distance from the centre
+			uint8_t* column;		//Per column terms; phase of k*x, and half of it
+			uint8_t* columnHalf;
+			uint16_t* columnDistance;	//Per column squared distance from the centre for this frame
+			uint8_t* rowHalf;		//Per row term; half the phase of k*y
+			uint16_t* rowDistance;	//Per row squared distance from the centre for this frame
+
+		public:
+			PlasmaEffect(uint8_t width, uint8_t height);
+			~PlasmaEffect();
+
+			/*
+			 * Chooses how the plasma value is mapped to a color; one of PLASMA_PALETTE_*
+			 */
+			void setPalette(uint8_t palette) { this->palette = palette % PLASMA_PALETTE_COUNT; }
+			uint8_t getPalette() { return palette; }
+
+			/*
+			 * Draws one frame of plasma at 0,0 through the given Draw (setColor / setPixel), and
+			 * advances time to the next frame.  Does not flush.  Draws nothing if the lookup tables
+			 * couldn't be allocated.
+			 */
+			void render(Draw* draw);
+	};
+}
+
+#endif
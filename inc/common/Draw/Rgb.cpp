@@ -1,5 +1,5 @@
-#include <math.h>
 #include "Rgb.h"
+#include "led_output.h"
 
 using namespace digitalcave;
 
@@ -16,38 +16,7 @@ Rgb::Rgb(const Rgb &c) {
 }
 
 Rgb::Rgb(const Hsv &c) {
-	float s = c.getSaturation();
-	float v = c.getValue();
-	s /= 255.0;
-	v /= 255.0;
-	
-	if (s == 0) {
-		// achromatic (grey)
-		r = g = b = v * 255;
-	} else {
-		float h = c.getHue();
-		h /= 60;
-		uint8_t i = floor(h);
-		float f = h - i;
-
-		float p = v * (1.0 - s);
-		float q = v * (1.0 - (s * f));
-		float t = v * (1.0 - (s * (1.0 - f)));
-		
-		p *= 255;
-		q *= 255;
-		t *= 255;
-		v *= 255;
-		
-		switch (i) {
-			case 0: r = v; g = t; b = p; break;
-			case 1: r = q; g = v; b = p; break;
-			case 2: r = p; g = v; b = t; break;
-			case 3: r = p; g = q; b = v; break;
-			case 4: r = t; g = p; b = v; break;
-			default: r = v; g = p; b = q; break;
-		}
-	}
+	hsv2rgb(c.getHue(), c.getSaturation(), c.getValue(), &r, &g, &b);
 }
 
 Rgb::~Rgb() {
@@ -64,7 +33,7 @@ void Rgb::addRed(int8_t r) {
 	this->r += r;
 }
 
-void Rgb::setGreen(uint8_t s) {
+void Rgb::setGreen(uint8_t g) {
 	this->g = g;
 }
 uint8_t Rgb::getGreen() const {
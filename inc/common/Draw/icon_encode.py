@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+#
+# Encodes a sequence of images as a DeltaIcon (see DeltaIcon.h).  Frames are binary PPM
+# (P6) files, all the same size; to convert an animated GIF use e.g.
+#   convert anim.gif -coalesce frame%03d.ppm
+# Writes the raw icon, or with -c a C array suitable for FlashStream.
+
+import argparse
+import sys
+
+CONFIG = 0x80
+SKIP = 0x00
+REPEAT = 0x80
+LITERAL = 0xC0
+SKIP_MAX = 128
+RUN_MAX = 64
+
+def read_token(f):
+	token = b''
+	while True:
+		c = f.read(1)
+		if c == b'#':
+			f.readline()
+		elif c.isspace():
+			if token: return token
+		elif not c:
+			return token
+		else:
+			token += c
+
+def read_ppm(name):
+	with open(name, 'rb') as f:
+		if read_token(f) != b'P6': raise ValueError(name + ': not a binary PPM (P6)')
+		width = int(read_token(f))
+		height = int(read_token(f))
+		maxval = int(read_token(f))
+		data = f.read(width * height * 3)
+	if maxval != 255: data = bytes(int(b * 255 / maxval) for b in data)
+	return width, height, [tuple(data[i:i+3]) for i in range(0, len(data), 3)]
+
+def encode_frame(frame, previous, color):
+	out = []
+	i = 0
+	n = len(frame)
+	changed = lambda j: previous is None or frame[j] != previous[j]
+	while i < n:
+		if not changed(i):
+			j = i
+			while j < n and j - i < SKIP_MAX and not changed(j): j += 1
+			out.append(SKIP | (j - i - 1))
+			i = j
+			continue
+
+		# Repeat runs can carry on over unchanged pixels which are the same color anyway
+		j = i
+		while j < n and j - i < RUN_MAX and frame[j] == frame[i]: j += 1
+		if j - i > 1:
+			out.append(REPEAT | (j - i - 1))
+			out += color(frame[i])
+			i = j
+			continue
+
+		# Literal run, up to the next unchanged pixel or repeated color
+		j = i + 1
+		while j < n and j - i < RUN_MAX and changed(j) and not (j + 1 < n and frame[j] == frame[j + 1]): j += 1
+		out.append(LITERAL | (j - i - 1))
+		for k in range(i, j): out += color(frame[k])
+		i = j
+	return out
+
+def encode(frames, width, height, delay, loop, rgb):
+	colors = sorted(set(p for f in frames for p in f))
+	if rgb or len(colors) > 255:
+		palette = []
+		color = lambda p: list(p)
+	else:
+		palette = colors
+		index = dict((c, i) for i, c in enumerate(colors))
+		color = lambda p: [index[p]]
+
+	out = [width, height, CONFIG, len(palette)]
+	for c in palette: out += c
+
+	delay = min(63, max(0, (delay + 25) // 50))
+	previous = None
+	for i, frame in enumerate(frames):
+		out += encode_frame(frame, previous, color)
+		last = i == len(frames) - 1
+		out.append((0x80 if last and loop else 0) | (0 if last else 0x40) | delay)
+		previous = frame
+	return bytes(out)
+
+def main():
+	parser = argparse.ArgumentParser(description='Encodes PPM frames as a run length / delta compressed icon')
+	parser.add_argument('-o', '--output', required=True, help='output file')
+	parser.add_argument('-d', '--delay', type=int, default=100, help='delay between frames in ms (50-3150, 0 for no animation)')
+	parser.add_argument('-l', '--loop', action='store_true', help='loop back to the first frame')
+	parser.add_argument('-r', '--rgb', action='store_true', help='store 3 byte colors instead of using a palette')
+	parser.add_argument('-c', '--c-array', metavar='NAME', help='write a C array of the given name instead of binary')
+	parser.add_argument('frames', nargs='+', help='PPM (P6) frames')
+	args = parser.parse_args()
+
+	frames = []
+	for name in args.frames:
+		width, height, pixels = read_ppm(name)
+		if frames and (width, height) != size: sys.exit(name + ': frames must all be the same size')
+		if width > 255 or height > 255: sys.exit(name + ': icons are at most 255 x 255')
+		size = (width, height)
+		frames.append(pixels)
+
+	data = encode(frames, size[0], size[1], args.delay, args.loop, args.rgb)
+	raw = size[0] * size[1] * len(frames)
+	sys.stderr.write('%d frames, %d bytes (%.1f%% of 8 bits per pixel)\n' % (len(frames), len(data), 100.0 * len(data) / raw))
+
+	if args.c_array:
+		with open(args.output, 'w') as f:
+			f.write('const uint8_t %s[] PROGMEM = {\n' % args.c_array)
+			for i in range(0, len(data), 16):
+				f.write('\t' + ', '.join('0x%02x' % b for b in data[i:i+16]) + ',\n')
+			f.write('};\n')
+	else:
+		with open(args.output, 'wb') as f:
+			f.write(data)
+
+if __name__ == '__main__':
+	main()
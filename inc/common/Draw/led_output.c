@@ -0,0 +1,143 @@
+#include "led_output.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define led_output_gamma(table, i) pgm_read_word(&(table)[i])
+#else
+#define PROGMEM
+#define led_output_gamma(table, i) ((table)[i])
+#endif
+
+//Generated with:
+//    for (uint16_t i = 0; i < 256; i++){ printf("%d, ", (int) round(65280 * pow(i / 255.0, 2.8))); }
+const uint16_t led_gamma28[256] PROGMEM = {
+	0, 0, 0, 0, 1, 1, 2, 3, 4, 6, 8, 10, 13, 16, 19, 23,
+	28, 33, 39, 45, 52, 60, 68, 78, 87, 98, 109, 121, 134, 148, 163, 179,
+	195, 213, 232, 251, 272, 293, 316, 340, 365, 391, 418, 447, 477, 508, 540, 573,
+	608, 644, 682, 721, 761, 802, 846, 890, 936, 984, 1033, 1084, 1136, 1190, 1245, 1302,
+	1361, 1421, 1483, 1547, 1612, 1680, 1749, 1820, 1892, 1967, 2043, 2121, 2202, 2284, 2368, 2454,
+	2542, 2632, 2724, 2818, 2914, 3012, 3112, 3215, 3319, 3426, 3535, 3646, 3759, 3875, 3992, 4112,
+	4235, 4359, 4486, 4616, 4748, 4882, 5018, 5157, 5299, 5442, 5589, 5738, 5889, 6043, 6200, 6359,
+	6520, 6685, 6852, 7021, 7194, 7369, 7546, 7727, 7910, 8096, 8285, 8476, 8671, 8868, 9068, 9271,
+	9477, 9685, 9897, 10112, 10329, 10550, 10774, 11000, 11230, 11463, 11698, 11937, 12179, 12425, 12673, 12924,
+	13179, 13437, 13698, 13962, 14230, 14501, 14775, 15052, 15333, 15617, 15905, 16196, 16490, 16788, 17089, 17393,
+	17701, 18013, 18328, 18646, 18968, 19294, 19623, 19956, 20292, 20632, 20976, 21323, 21674, 22029, 22387, 22750,
+	23115, 23485, 23859, 24236, 24617, 25002, 25390, 25783, 26179, 26580, 26984, 27392, 27804, 28220, 28640, 29064,
+	29492, 29925, 30361, 30801, 31245, 31694, 32146, 32603, 33064, 33529, 33998, 34471, 34949, 35431, 35917, 36407,
+	36902, 37400, 37904, 38411, 38923, 39439, 39960, 40485, 41015, 41548, 42087, 42630, 43177, 43729, 44285, 44846,
+	45411, 45981, 46556, 47135, 47718, 48307, 48900, 49497, 50100, 50707, 51318, 51935, 52556, 53182, 53812, 54448,
+	55088, 55733, 56383, 57038, 57698, 58362, 59032, 59706, 60385, 61070, 61759, 62453, 63152, 63856, 64566, 65280
+};
+
+//x / 255 for 0 <= x < 65535, without a division
+static inline uint16_t div255(uint16_t x){
+	return (x + 1 + (x >> 8)) >> 8;
+}
+
+void led_output_init(led_output_t* output){
+	for (uint8_t c = 0; c < 3; c++){
+		output->gamma[c] = led_gamma28;
+		output->correction[c] = 255;
+	}
+	output->brightness = 255;
+	output->dither = 1;
+	output->budget_ma = 0;
+	output->channel_ma = 20;
+	output->idle_ma = 1;
+
+	output->frame = 0;
+	output->limit = 256;
+	output->draw_ma = 0;
+}
+
+void led_output_apply(led_output_t* output, const uint8_t* in, uint8_t* out, uint16_t count){
+	//Combined correction * brightness * power limit, per channel; 256 is full.
+	uint16_t scale[3];
+	for (uint8_t c = 0; c < 3; c++){
+		uint16_t s = ((uint16_t) (output->correction[c] + 1) * (output->brightness + 1)) >> 8;
+		scale[c] = ((uint32_t) s * output->limit) >> 8;
+	}
+
+	//Dither threshold; bit reversing the frame counter spreads the thresholds evenly over any
+	// run of frames.  Without dithering, round to nearest.
+	uint8_t threshold = 0x80;
+	if (output->dither){
+		uint8_t f = output->frame++;
+		f = (f & 0xF0) >> 4 | (f & 0x0F) << 4;
+		f = (f & 0xCC) >> 2 | (f & 0x33) << 2;
+		threshold = (f & 0xAA) >> 1 | (f & 0x55) << 1;
+	}
+
+	const uint16_t* gamma0 = output->gamma[0];
+	const uint16_t* gamma1 = output->gamma[1];
+	const uint16_t* gamma2 = output->gamma[2];
+	uint32_t total = 0;
+	for (uint16_t i = 0; i < count; i++){
+		uint8_t v;
+		v = (((uint32_t) led_output_gamma(gamma0, in[0]) * scale[0]) + ((uint16_t) threshold << 8)) >> 16;
+		total += v;
+		out[0] = v;
+		v = (((uint32_t) led_output_gamma(gamma1, in[1]) * scale[1]) + ((uint16_t) threshold << 8)) >> 16;
+		total += v;
+		out[1] = v;
+		v = (((uint32_t) led_output_gamma(gamma2, in[2]) * scale[2]) + ((uint16_t) threshold << 8)) >> 16;
+		total += v;
+		out[2] = v;
+		in += 3;
+		out += 3;
+	}
+	out -= count * 3;
+
+	uint32_t idle = (uint32_t) count * output->idle_ma;
+	if (output->budget_ma){
+		//The budget, in units of one channel step (channel_ma / 255)
+		uint32_t available = output->budget_ma > idle ? ((output->budget_ma - idle) * 255) / output->channel_ma : 0;
+		if (total > available){
+			//Brighter than the last frame allowed for; scale again, and remember for next time.
+			uint16_t f = (available << 8) / total;
+			for (uint16_t i = 0; i < count * 3; i++){
+				out[i] = ((uint16_t) out[i] * f) >> 8;
+			}
+			output->limit = ((uint32_t) output->limit * f) >> 8;
+			total = (total * f) >> 8;
+		}
+		else if (total == 0){
+			output->limit = 256;
+		}
+		else {
+			//Let the limit recover as far as this frame would allow unscaled
+			uint32_t unscaled = (total << 8) / (output->limit ? output->limit : 1);
+			output->limit = available >= unscaled ? 256 : (available << 8) / unscaled;
+		}
+	}
+	else {
+		output->limit = 256;
+	}
+
+	output->draw_ma = (total * output->channel_ma) / 255 + idle;
+}
+
+void hsv2rgb(uint16_t h, uint8_t s, uint8_t v, uint8_t* r, uint8_t* g, uint8_t* b){
+	if (s == 0){
+		*r = *g = *b = v;
+		return;
+	}
+
+	h %= 360;
+	uint8_t sector = h / 60;
+	uint8_t f = ((h - sector * 60) * 17) >> 2;		//Fraction of the sector, 0 - 255; 255 / 60 == 17 / 4
+
+	//uint16_t products: 255 * 255 would overflow a 16 bit int
+	uint8_t p = div255((uint16_t) v * (255 - s));
+	uint8_t q = div255((uint16_t) v * (255 - div255((uint16_t) s * f)));
+	uint8_t t = div255((uint16_t) v * (255 - div255((uint16_t) s * (255 - f))));
+
+	switch (sector){
+		case 0: *r = v; *g = t; *b = p; break;
+		case 1: *r = q; *g = v; *b = p; break;
+		case 2: *r = p; *g = v; *b = t; break;
+		case 3: *r = p; *g = q; *b = v; break;
+		case 4: *r = t; *g = p; *b = v; break;
+		default: *r = v; *g = p; *b = q; break;
+	}
+}
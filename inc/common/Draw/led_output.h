@@ -0,0 +1,70 @@
+/*
+ * Shared output stage for LED strips / matrices; call led_output_apply() on the frame just
+ * before sending it.  In one pass over the frame it applies, per channel:
+ *
+ *  - a gamma table (8.8 fixed point output, so that dimmed values keep their fraction)
+ *  - colour correction and global brightness
+ *  - temporal dithering of the fractional part (over successive frames the average output
+ *    matches the 8.8 value, so dim colours don't collapse to a few steps)
+ *  - a power limiter, which scales the frame down so that the estimated draw stays within
+ *    a milliamp budget.  The scale found for one frame is used for the next; if a frame is
+ *    brighter than that allows for, it is scaled again in place before returning, so the
+ *    budget is never exceeded.
+ *
+ * Frames are arrays of 3 byte LEDs; channel 0 - 2 are in the frame's own order (e.g. GRB
+ * for ws2812_t), and the gamma / correction arrays use the same order.
+ *
+ * Also provides an integer HSV to RGB conversion.
+ */
+
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+typedef struct led_output_t {
+	const uint16_t* gamma[3];	//Per channel gamma tables; 256 entries, 0 - 65280 (in flash on AVR)
+	uint8_t correction[3];		//Per channel colour correction; 255 is full
+	uint8_t brightness;			//Global brightness; 255 is full
+	uint8_t dither;				//Non-zero for temporal dithering, else values are rounded
+	uint16_t budget_ma;			//Power budget in mA; 0 is unlimited
+	uint8_t channel_ma;			//Draw of one channel at full brightness, in mA
+	uint8_t idle_ma;			//Draw of one LED when off, in mA
+
+	//State, updated by led_output_apply()
+	uint8_t frame;				//Frame counter, for dithering
+	uint16_t limit;				//Power limit scale for the next frame; 256 is unlimited
+	uint16_t draw_ma;			//Estimated draw of the last frame, in mA
+} led_output_t;
+
+/*
+ * Gamma 2.8 table (the usual choice for WS2812 and similar), for led_output_t.gamma.
+ */
+extern const uint16_t led_gamma28[256];
+
+/*
+ * Sets up output with defaults; gamma 2.8 on all channels, no colour correction, full
+ * brightness, dithering on, no power limit, and 20mA / 1mA for channel / idle draw (WS2812).
+ */
+void led_output_init(led_output_t* output);
+
+/*
+ * Converts count LEDs from in to out (which may be the same buffer), and updates draw_ma
+ * with the estimated draw of the result.
+ */
+void led_output_apply(led_output_t* output, const uint8_t* in, uint8_t* out, uint16_t count);
+
+/*
+ * Integer HSV to RGB; hue 0 - 359, saturation and value 0 - 255.
+ */
+void hsv2rgb(uint16_t h, uint8_t s, uint8_t v, uint8_t* r, uint8_t* g, uint8_t* b);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
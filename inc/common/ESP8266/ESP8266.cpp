@@ -1,212 +1,319 @@
 #include "ESP8266.h"
+#include <string.h>
 
 using namespace digitalcave;
 
-ESP8266::ESP8266(Stream* serial, uint8_t txBufferSize) :
+//Command states
+#define STATE_IDLE			0
+#define STATE_RESPONSE		1		//Waiting for OK / ERROR
+#define STATE_PROMPT		2		//Waiting for the '>' prompt to send the payload
+#define STATE_SENT			3		//Payload sent, waiting for SEND OK / SEND FAIL
+
+ESP8266::ESP8266(Stream* serial, uint32_t (*clock)(), uint16_t rxBufferSize, uint16_t txBufferSize) :
 	serial(serial),
-	txBuffer(txBufferSize)
+	clock(clock),
+	queueHead(0),
+	queueCount(0),
+	state(STATE_IDLE),
+	started(0),
+	lineLength(0),
+	ipdLink(-1),
+	ipdRemaining(0),
+	txBuffer(txBufferSize),
+	id(0),
+	event(NULL),
+	eventContext(NULL)
 {
-	at_reset();
-	at_mode();
-	at_mux();
+	//One allocation for every link's receive buffer; if it fails the data is counted as overruns
+	rxData = (uint8_t*) malloc((uint32_t) rxBufferSize * ESP8266_LINKS);
+	rxSize = rxData == NULL ? 0 : rxBufferSize;
+	for (uint8_t i = 0; i < ESP8266_LINKS; i++){
+		rxHead[i] = 0;
+		rxCount[i] = 0;
+		links[i] = ESP8266_LINK_CLOSED;
+	}
+	resetStats();
+
+	command("ATE0");
+	command("AT+CWMODE=1");
+	command("AT+CIPMUX=1");
 }
 
 ESP8266::~ESP8266() {
-	free((void*) data);
+	free(rxData);
+	while (queueCount > 0){
+		free(queue[queueHead].payload);
+		queueHead = (queueHead + 1) % ESP8266_QUEUE_SIZE;
+		queueCount--;
+	}
 }
 
-void ESP8266::at_reset() {
-	serial->write("AT+RST\r\n");
-//	_delay_ms(2000);
-	uint8_t b;
-	while (serial->read(&b));
+esp8266_command_t* ESP8266::enqueue(esp8266_callback_t callback, void* context, uint16_t timeout) {
+	if (queueCount >= ESP8266_QUEUE_SIZE) return NULL;
+
+	esp8266_command_t* c = &queue[(queueHead + queueCount) % ESP8266_QUEUE_SIZE];
+	c->text[0] = 0x00;
+	c->payload = NULL;
+	c->payloadLength = 0;
+	c->timeout = timeout;
+	c->link = -1;
+	c->callback = callback;
+	c->context = context;
+	queueCount++;
+	return c;
 }
 
-void ESP8266::at_mode() {
-	serial->write("AT+CWMODE=1\r\n");
-	at_response();
+uint8_t ESP8266::command(const char* text, esp8266_callback_t callback, void* context, uint16_t timeout) {
+	esp8266_command_t* c = enqueue(callback, context, timeout);
+	if (c == NULL) return 0;
+	strncpy(c->text, text, ESP8266_COMMAND_LENGTH - 1);
+	c->text[ESP8266_COMMAND_LENGTH - 1] = 0x00;
+	return 1;
 }
 
-void ESP8266::at_mux() {
-	serial->write("AT+CIPMUX=1\r\n");
-	at_response();
+uint8_t ESP8266::join(const char* ssid, const char* password, esp8266_callback_t callback, void* context) {
+	esp8266_command_t* c = enqueue(callback, context, ESP8266_JOIN_TIMEOUT);
+	if (c == NULL) return 0;
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CWJAP=\"%s\",\"%s\"", ssid, password);
+	return 1;
 }
 
-uint8_t ESP8266::join(char* ssid, char* password) {
-	serial->write("AT+CWJAP=\"");
-	serial->write(ssid);
-	serial->write("\",\"");
-	serial->write(password);
-	serial->write("\"\r\n");
-	return at_response();
+uint8_t ESP8266::leave(esp8266_callback_t callback, void* context) {
+	return command("AT+CWQAP", callback, context);
 }
 
-void ESP8266::leave() {
-	serial->write("AT+CWLAP\r\n");
-	at_response();
+uint8_t ESP8266::start_server(uint16_t port, esp8266_callback_t callback, void* context) {
+	esp8266_command_t* c = enqueue(callback, context);
+	if (c == NULL) return 0;
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPSERVER=1,%u", port);
+	return 1;
 }
 
-uint8_t ESP8266::at_response() {
-	// <status>\r\n 		(optional status line)
-	// \r\n					    (blank line)
-	// [OK|ERROR|ALREAY CONNECT|SEND OK]\r\n		(required status line)
-	uint8_t result;
-	uint8_t i = 0;
-	uint8_t b;
-	// read and ignore the optional status line and the blank line
-	while (1) {
-		i++;
-		serial->read(&b);
-		if (b == '\n' && i == 1) break; 	// \r\n
-		else if (b == '\n') i = 0;				// <status>\r\n
-	}
-	// use the first char of the status to determine the result
-	serial->read(&b);
-	if (b == 'O' || b == 'S') {					// OK, SEND OK
-		result = 1;
-	} else if (b == 'E' || b == 'A') {	// ERROR, ALREADY CONNECT
-		result = 0;
-	} else {
-		result = 0;
-	}
-	// read ignore the rest of the required status line
-	while (1) {
-		serial->read(&b);
-		if (b == '\n') break; 						// <status>\r\n
-	}
-	return result;
-}
-
-void ESP8266::start_server(uint16_t port) {
-	char buf[5];
-	sprintf(buf, "%d", port);
-
-	this->serial->write("AT+CIPSERVER=1,");
-	this->serial->write(buf);
-	this->serial->write("\r\n");
-	this->at_response();
-}
-
-void ESP8266::stop_server(uint16_t port) {
-	char buf[5];
-	sprintf(buf, "%d", port);
-
-	this->serial->write("AT+CIPSERVER=0,");
-	this->serial->write(buf);
-	this->serial->write("\r\n");
-	this->at_response();
-}
-
-int8_t ESP8266::open(char* address, uint16_t port) {
-	char buf[5];
-	sprintf(buf, "%d", port);
-
-	for (int8_t id = 0; id < 5; id++) {
-		this->serial->write("AT+CIPSTART=");
-		this->serial->write(48 + id);
-		this->serial->write(",\"TCP\",\"");
-		this->serial->write(address);
-		this->serial->write("\",");
-		this->serial->write(buf);
-		this->serial->write("\r\n");
-		uint8_t status = this->at_response();
-		if (status == 0) {
-			this->id = id;
-			free((void*) data);
-			data = NULL;
-			txBuffer.clear();
-			return id;
-		}
+uint8_t ESP8266::stop_server(uint16_t port, esp8266_callback_t callback, void* context) {
+	esp8266_command_t* c = enqueue(callback, context);
+	if (c == NULL) return 0;
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPSERVER=0,%u", port);
+	return 1;
+}
+
+int8_t ESP8266::open(const char* address, uint16_t port, esp8266_callback_t callback, void* context) {
+	for (uint8_t i = 0; i < ESP8266_LINKS; i++) {
+		if (links[i] != ESP8266_LINK_CLOSED) continue;
+
+		esp8266_command_t* c = enqueue(callback, context);
+		if (c == NULL) return -1;
+		snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPSTART=%u,\"TCP\",\"%s\",%u", i, address, port);
+		c->link = i;
+		links[i] = ESP8266_LINK_OPENING;
+		return i;
 	}
 	return -1;
 }
 
-uint8_t ESP8266::close(uint8_t id) {
-	this->serial->write("AT+CIPCLOSE=");
-	this->serial->write(48 + id);
-	this->serial->write("\r\n");
- 	return this->at_response();
+uint8_t ESP8266::close(uint8_t i, esp8266_callback_t callback, void* context) {
+	esp8266_command_t* c = enqueue(callback, context);
+	if (c == NULL) return 0;
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPCLOSE=%u", i);
+	return 1;
 }
 
-uint8_t ESP8266::read(uint8_t* b) {
-	if (position == length) {
-		free((void*) data);
-		data = NULL;
+uint8_t ESP8266::send(uint8_t i, uint8_t* data, uint16_t len, esp8266_callback_t callback, void* context) {
+	if (len == 0) return 1;
+
+	uint8_t* payload = (uint8_t*) malloc(len);
+	if (payload == NULL) return 0;
+
+	esp8266_command_t* c = enqueue(callback, context);
+	if (c == NULL) {
+		free(payload);
 		return 0;
 	}
-	*b = data[position++];
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPSEND=%u,%u", i, len);
+	memcpy(payload, data, len);
+	c->payload = payload;
+	c->payloadLength = len;
 	return 1;
 }
 
-void ESP8266::select(uint8_t id) {
-	this->id = id;
-	this->flush();
-	free((void*) data);
-	data = NULL;
-	txBuffer.clear();
+void ESP8266::start() {
+	esp8266_command_t* c = &queue[queueHead];
+	serial->write(c->text);
+	serial->write("\r\n");
+	started = clock();
+	state = (c->payload != NULL) ? STATE_PROMPT : STATE_RESPONSE;
+}
+
+void ESP8266::complete(uint8_t result) {
+	esp8266_command_t* c = &queue[queueHead];
+
+	uint32_t latency = clock() - started;
+	stats.commands++;
+	stats.latencyTotal += latency;
+	if (latency > stats.latencyMax) stats.latencyMax = latency;
+	if (result == ESP8266_RESULT_ERROR) stats.errors++;
+	else if (result == ESP8266_RESULT_TIMEOUT) stats.timeouts++;
+
+	if (result != ESP8266_RESULT_OK && c->link >= 0 && links[c->link] == ESP8266_LINK_OPENING) {
+		links[c->link] = ESP8266_LINK_CLOSED;
+	}
+
+	//Take it off the queue before calling back, so that the callback can queue another command
+	esp8266_callback_t callback = c->callback;
+	void* context = c->context;
+	free(c->payload);
+	c->payload = NULL;
+	queueHead = (queueHead + 1) % ESP8266_QUEUE_SIZE;
+	queueCount--;
+	state = STATE_IDLE;
+
+	if (callback != NULL) callback(context, result);
+}
+
+void ESP8266::setLink(uint8_t link, uint8_t linkState) {
+	if (link >= ESP8266_LINKS) return;
+	links[link] = linkState;
+	if (event != NULL) event(eventContext, link, linkState == ESP8266_LINK_OPEN ? ESP8266_EVENT_CONNECT : ESP8266_EVENT_CLOSED);
 }
 
-uint8_t ESP8266::select() {
-	this->flush();
-	free((void*) data);
-	data = NULL;
-	txBuffer.clear();
+uint8_t ESP8266::rxWrite(uint8_t link, uint8_t b) {
+	if (rxCount[link] >= rxSize) return 0;
+	uint16_t i = rxHead[link] + rxCount[link];
+	if (i >= rxSize) i -= rxSize;
+	rxData[link * rxSize + i] = b;
+	rxCount[link]++;
+	return 1;
+}
 
-	uint8_t state = 0; // 0 = ipd, 1 = id, 2 = len, 3 = data
+uint8_t ESP8266::rxRead(uint8_t link, uint8_t* b) {
+	if (rxCount[link] == 0) return 0;
+	*b = rxData[link * rxSize + rxHead[link]];
+	if (++rxHead[link] >= rxSize) rxHead[link] = 0;
+	rxCount[link]--;
+	return 1;
+}
+
+void ESP8266::receive(uint8_t b) {
+	// +IPD,<id>,<len>:<data>
+	if (ipdRemaining > 0) {
+		stats.rxBytes++;
+		if (!rxWrite(ipdLink, b)) stats.overruns++;
+		if (--ipdRemaining == 0 && event != NULL) event(eventContext, ipdLink, ESP8266_EVENT_DATA);
+		return;
+	}
+
+	// The prompt for data is "> ", without a line ending
+	if (b == '>' && lineLength == 0 && state == STATE_PROMPT) {
+		esp8266_command_t* c = &queue[queueHead];
+		for (uint16_t i = 0; i < c->payloadLength; i++) serial->write(c->payload[i]);
+		stats.txBytes += c->payloadLength;
+		state = STATE_SENT;
+		return;
+	}
+
+	if (b == '\n') {
+		line[lineLength] = 0x00;
+		receiveLine();
+		lineLength = 0;
+		return;
+	}
+	if (b == '\r' || (b == ' ' && lineLength == 0)) return;
+	if (lineLength < ESP8266_LINE_LENGTH - 1) line[lineLength++] = b;
+
+	if (b == ':' && strncmp(line, "+IPD,", 5) == 0) {
+		line[lineLength] = 0x00;
+		char* length = strchr(line + 5, ',');
+		uint8_t link = atoi(line + 5);
+		if (length != NULL && link < ESP8266_LINKS) {
+			ipdLink = link;
+			ipdRemaining = atoi(length + 1);
+		}
+		lineLength = 0;
+	}
+}
+
+void ESP8266::receiveLine() {
+	if (lineLength == 0) return;
+
+	// <id>,CONNECT / <id>,CLOSED / <id>,CONNECT FAIL
+	if (line[0] >= '0' && line[0] <= '9' && line[1] == ',') {
+		uint8_t link = line[0] - '0';
+		if (strcmp(line + 2, "CONNECT") == 0) setLink(link, ESP8266_LINK_OPEN);
+		else if (strncmp(line + 2, "CLOSED", 6) == 0 || strcmp(line + 2, "CONNECT FAIL") == 0) setLink(link, ESP8266_LINK_CLOSED);
+		return;
+	}
+
+	if (state == STATE_IDLE) return;
+
+	if (strcmp(line, "ERROR") == 0 || strcmp(line, "FAIL") == 0 || strcmp(line, "SEND FAIL") == 0) {
+		complete(ESP8266_RESULT_ERROR);
+	}
+	else if (state == STATE_RESPONSE && strcmp(line, "OK") == 0) {
+		complete(ESP8266_RESULT_OK);
+	}
+	else if (state == STATE_SENT && strcmp(line, "SEND OK") == 0) {
+		complete(ESP8266_RESULT_OK);
+	}
+	// Anything else (status lines, "busy p...", "Recv n bytes", the OK before the send prompt) is ignored
+}
+
+void ESP8266::poll() {
 	uint8_t b;
-	position = 0;
-
-	this->serial->write("+IPD\r\n");
-	while (1) {
-		if (serial->read(&b)) {
-			switch (state) {
-				case 0:
-					if (b == ',') state = 1;
-					break;
-				case 1:
-					if (b == ',') state = 2;
-					else this->id = b - 48;
-					break;
-				case 2:
-					if (b == ':') {
-						state = 3;
-						data = (uint8_t*) malloc(length);
-					} else {
-						length *= 10;
-						length += b - 48;
-					}
-					break;
-				default:
-					data[position++] = b;
-					if (position == length) {
-						position = 0;
-						return this->id;
-					}
-			}
+	while (serial->read(&b)) {
+		receive(b);
+	}
+
+	if (state != STATE_IDLE && clock() - started > queue[queueHead].timeout) {
+		complete(ESP8266_RESULT_TIMEOUT);
+	}
+	if (state == STATE_IDLE && queueCount > 0) {
+		start();
+	}
+}
+
+uint8_t ESP8266::select(uint8_t i) {
+	if (i >= ESP8266_LINKS) return 0;
+	//The buffered output belongs to the current link; it mustn't go out on the new one
+	if (!flush()) return 0;
+	id = i;
+	return 1;
+}
+
+int8_t ESP8266::select() {
+	for (uint8_t i = 1; i <= ESP8266_LINKS; i++) {
+		uint8_t link = (id + i) % ESP8266_LINKS;
+		if (rxCount[link] > 0) {
+			return select(link) ? link : -2;
 		}
 	}
+	return -1;
+}
+
+uint8_t ESP8266::read(uint8_t* b) {
+	return rxRead(id, b);
 }
 
 uint8_t ESP8266::write(uint8_t b) {
-	if (txBuffer.isFull()) flush();
+	if (txBuffer.isFull() && !flush()) return 0;
 	return txBuffer.write(b);
 }
 
 uint8_t ESP8266::flush() {
-	if (txBuffer.size() == 0) return 1; // nothing to write
+	uint16_t len = txBuffer.size();
+	if (len == 0) return 1; // nothing to write
 
-	uint8_t len = txBuffer.size();
-	uint8_t b;
-	char buf[3];
-	sprintf(buf, "%d", len);
-
-	serial->write("AT+CIPSEND=");
-	serial->write(buf);
-	serial->write("\r\n");
-	serial->read(&b); 			// >
-	serial->read(&b); 			// sp
-	while (txBuffer.read(&b)) {
-		serial->write(b);
+	esp8266_command_t* c = enqueue(NULL, NULL);
+	if (c == NULL) return 0;
+	c->payload = (uint8_t*) malloc(len);
+	if (c->payload == NULL) {
+		queueCount--;
+		return 0;
 	}
-	return at_response();
+	snprintf(c->text, ESP8266_COMMAND_LENGTH, "AT+CIPSEND=%u,%u", id, len);
+	for (uint16_t i = 0; i < len; i++) txBuffer.read(&c->payload[i]);
+	c->payloadLength = len;
+	return 1;
+}
+
+void ESP8266::resetStats() {
+	memset(&stats, 0, sizeof(stats));
 }
@@ -1,3 +1,14 @@
+/*
+ * Event driven driver for the ESP8266 AT firmware, in multiple connection mode.
+ *
+ * Nothing here blocks.  Commands are put into a queue and sent one at a time; the responses are parsed
+ * as the bytes arrive, and the command's callback is called with the result when it completes (or times
+ * out).  Incoming data (+IPD frames) is sorted into a receive buffer for each link.  All of this happens
+ * in poll(), which must be called regularly from the main loop.
+ *
+ * The Stream interface reads from / writes to the selected link.  Writes are buffered; flush() (or a full
+ * buffer) queues the buffered bytes to be sent.
+ */
 #ifndef ESP8266_H
 #define ESP8266_H
 
@@ -8,61 +19,185 @@
 #include <Stream.h>
 #include <ArrayStream.h>
 
+//The number of links (connection ids) supported by the module
+#ifndef ESP8266_LINKS
+#define ESP8266_LINKS					5
+#endif
+//Commands which can be waiting at once
+#ifndef ESP8266_QUEUE_SIZE
+#define ESP8266_QUEUE_SIZE				4
+#endif
+//Longest command (including SSID / password / address), and longest response line which is looked at
+#ifndef ESP8266_COMMAND_LENGTH
+#define ESP8266_COMMAND_LENGTH			64
+#endif
+#ifndef ESP8266_LINE_LENGTH
+#define ESP8266_LINE_LENGTH				32
+#endif
+//Command timeouts, in ms
+#ifndef ESP8266_TIMEOUT
+#define ESP8266_TIMEOUT					2000
+#endif
+#define ESP8266_JOIN_TIMEOUT			20000
+
+//Command results
+#define ESP8266_RESULT_OK				0
+#define ESP8266_RESULT_ERROR			1
+#define ESP8266_RESULT_TIMEOUT			2
+
+//Link events
+#define ESP8266_EVENT_CONNECT			0
+#define ESP8266_EVENT_CLOSED			1
+#define ESP8266_EVENT_DATA				2
+
+//Link states
+#define ESP8266_LINK_CLOSED				0
+#define ESP8266_LINK_OPENING			1
+#define ESP8266_LINK_OPEN				2
+
 namespace digitalcave {
+
+	//Called when a command completes, with one of the ESP8266_RESULT_ values
+	typedef void (*esp8266_callback_t)(void* context, uint8_t result);
+	//Called when something happens on a link, with one of the ESP8266_EVENT_ values
+	typedef void (*esp8266_event_t)(void* context, uint8_t link, uint8_t event);
+
+	typedef struct esp8266_command_t {
+		char text[ESP8266_COMMAND_LENGTH];
+		uint8_t* payload;				//Data to send at the '>' prompt (AT+CIPSEND), or NULL
+		uint16_t payloadLength;
+		uint16_t timeout;
+		int8_t link;					//The link this command opens, or -1
+		esp8266_callback_t callback;
+		void* context;
+	} esp8266_command_t;
+
+	typedef struct esp8266_stats_t {
+		uint32_t commands;				//Commands completed (including errors and timeouts)
+		uint32_t errors;
+		uint32_t timeouts;
+		uint32_t rxBytes;				//Data bytes received on all links
+		uint32_t txBytes;				//Data bytes sent on all links
+		uint32_t overruns;				//Data bytes lost because a link's receive buffer was full
+		uint32_t latencyTotal;			//Time from sending each command to its result, in ms
+		uint32_t latencyMax;
+	} esp8266_stats_t;
+
 	class ESP8266 : public Stream {
 
 		private:
 			Stream* serial;
+			uint32_t (*clock)();
+
+			esp8266_command_t queue[ESP8266_QUEUE_SIZE];
+			uint8_t queueHead;
+			uint8_t queueCount;
+			uint8_t state;						//Where the command at the head of the queue is up to
+			uint32_t started;					//When it was sent
+
+			char line[ESP8266_LINE_LENGTH];		//The response line being received
+			uint8_t lineLength;
+			int8_t ipdLink;						//The link +IPD data is being received for, or -1
+			uint16_t ipdRemaining;
+
+			uint8_t* rxData;					//The receive buffers for all links, in one allocation
+			uint16_t rxSize;					//Bytes per link
+			uint16_t rxHead[ESP8266_LINKS];		//Oldest byte in each link's buffer
+			uint16_t rxCount[ESP8266_LINKS];	//Bytes in each link's buffer
+			uint8_t links[ESP8266_LINKS];		//Link states
 			ArrayStream txBuffer;
+			uint8_t id;							//The selected link
 
-			uint16_t length;
-			uint16_t position;
-			uint8_t* data;
+			esp8266_event_t event;
+			void* eventContext;
 
-			int8_t id;							// the current connection id (0 - 4)
+			esp8266_stats_t stats;
 
-			void poll();						// process whatever is in the serial receive buffer
-			void at_reset();				// send AT+RST
-			void at_mode();					// send AT+CWMODE=1 to configure station mode
-			void at_mux();					// send AT+CIPMUX=1 to configure multiple connection
-			uint8_t at_response();	// handle the responses for atCommands
+			esp8266_command_t* enqueue(esp8266_callback_t callback, void* context, uint16_t timeout = ESP8266_TIMEOUT);
+			void start();						//Send the command at the head of the queue
+			void complete(uint8_t result);		//Finish the command at the head of the queue
+			void receive(uint8_t b);			//Parse one byte from the module
+			void receiveLine();					//Parse a complete response line
+			void setLink(uint8_t link, uint8_t state);
+			uint8_t rxWrite(uint8_t link, uint8_t b);
+			uint8_t rxRead(uint8_t link, uint8_t* b);
 
 		public:
-			ESP8266(Stream* serial, uint8_t txBufferSize);
+			/*
+			 * Creates the driver on the serial port the module is connected to.  The clock function returns the
+			 * time in ms.  Each link gets a receive buffer of rxBufferSize bytes; txBufferSize is the most that
+			 * is sent in one AT+CIPSEND.  The module is put into station, multiple connection mode with echo off.
+			 */
+			ESP8266(Stream* serial, uint32_t (*clock)(), uint16_t rxBufferSize = 32, uint16_t txBufferSize = 64);
 			~ESP8266();
 
-			uint8_t join(char* ssid, char* password);
-			void leave();
+			/*
+			 * Reads and parses everything the module has sent, sends the next command when the current one is
+			 * finished, and handles timeouts.  Callbacks are called from here.
+			 */
+			void poll();
 
-			/* Start a server connection listener. */
-			void start_server(uint16_t port);
-			/* Stop a server connection listener.  */
-			void stop_server(uint16_t port);
+			/*
+			 * Queues a raw AT command (without the trailing \r\n).  Returns 1 if it was queued, 0 if the queue
+			 * is full.  The callback (which may be NULL) gets the result.
+			 */
+			uint8_t command(const char* text, esp8266_callback_t callback = NULL, void* context = NULL, uint16_t timeout = ESP8266_TIMEOUT);
 
-			/* Open a client connection.
-			 * Returns the ID of the connection or -1 if the connection couldn't be opened. */
-			int8_t open(char* address, uint16_t port);
-			/* Close a client connection.
-			 * Returns 1 if the connection was closed, or 0 if it wasn't open */
-			uint8_t close(uint8_t i);
+			/*
+			 * Returns the number of commands waiting or in progress.
+			 */
+			uint8_t pending() { return queueCount; }
 
-			/* Select a connection to write to.
-			 * Output buffer is flushed and input buffer is cleared. */
-			void select(uint8_t i);
+			uint8_t join(const char* ssid, const char* password, esp8266_callback_t callback = NULL, void* context = NULL);
+			uint8_t leave(esp8266_callback_t callback = NULL, void* context = NULL);
 
-			/* Read incoming data and selects the channel the data belongs to.
-			 * Output buffer is flushed and input buffer will contain the data to read.
-			 * Returns the id of the connection that was selected. */
-			uint8_t select();
+			/* Start a server connection listener. */
+			uint8_t start_server(uint16_t port, esp8266_callback_t callback = NULL, void* context = NULL);
+			/* Stop a server connection listener.  */
+			uint8_t stop_server(uint16_t port, esp8266_callback_t callback = NULL, void* context = NULL);
+
+			/* Open a client connection on a free link.
+			 * Returns the ID of the link, or -1 if there is no free link or the queue is full.  The connection
+			 * is usable once the callback reports success (or the event callback reports the connect). */
+			int8_t open(const char* address, uint16_t port, esp8266_callback_t callback = NULL, void* context = NULL);
+			/* Close a connection.
+			 * Returns 1 if the close was queued. */
+			uint8_t close(uint8_t i, esp8266_callback_t callback = NULL, void* context = NULL);
+
+			/* Queue data to be sent on a link.  The data is copied.
+			 * Returns 1 if it was queued. */
+			uint8_t send(uint8_t i, uint8_t* data, uint16_t len, esp8266_callback_t callback = NULL, void* context = NULL);
+
+			/* Returns 1 if the link is connected. */
+			uint8_t isConnected(uint8_t i) { return i < ESP8266_LINKS && links[i] == ESP8266_LINK_OPEN; }
+			/* Returns the number of bytes received on the link and not yet read. */
+			uint16_t available(uint8_t i) { return i < ESP8266_LINKS ? rxCount[i] : 0; }
+
+			/* Sets the function which is told about links connecting, closing and receiving data. */
+			void setEventCallback(esp8266_event_t event, void* context) { this->event = event; this->eventContext = context; }
+
+			/* Select a link to read from / write to.
+			 * Anything written to the previous link is queued for sending first; if it can't be (the command
+			 * queue is full) the selected link doesn't change.  Returns 1 if the link was selected, 0 if not
+			 * (poll() and try again). */
+			uint8_t select(uint8_t i);
+
+			/* Selects the next link (after the current one) which has received data.
+			 * Returns the id of the link that was selected, -1 if none have data, or -2 if one has but
+			 * the output for the current link couldn't be queued (poll() and try again). */
+			int8_t select();
 
 			uint8_t read(uint8_t* b);
-			uint16_t read(uint8_t* a, uint16_t len);
 			uint8_t write(uint8_t b);
 
-			/* Flushes the output buffer.
-			 * Returns 1 if the data is successfuly transmitted. */
+			/* Queues the output buffer for sending.
+			 * Returns 1 if it was queued (or was empty), 0 if the command queue is full. */
 			uint8_t flush();
 
+			esp8266_stats_t getStats() { return stats; }
+			void resetStats();
+
+			using Stream::read;
 			using Stream::reset;
 			using Stream::write;
 	};
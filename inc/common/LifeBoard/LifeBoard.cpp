@@ -0,0 +1,176 @@
+#include "LifeBoard.h"
+
+using namespace digitalcave;
+
+LifeBoard::LifeBoard(uint8_t width, uint8_t height) {
+	if (width == 0) width = 1;
+	if (height == 0) height = 1;
+	this->width = width;
+	this->height = height;
+	this->words = (width + LIFE_WORD_BITS - 1) / LIFE_WORD_BITS;
+
+	uint8_t lastBits = width - (words - 1) * LIFE_WORD_BITS;
+	this->lastMask = (lastBits == LIFE_WORD_BITS) ? (life_word_t) ~0 : (((life_word_t) 1 << lastBits) - 1);
+
+	state = (life_word_t*) malloc(sizeof(life_word_t) * words * height);
+	next = (life_word_t*) malloc(sizeof(life_word_t) * words * height);
+	shifted = (life_word_t*) malloc(sizeof(life_word_t) * words * 6);
+	if (state == NULL || next == NULL || shifted == NULL) {
+		//Not enough memory; the board stays empty and doesn't change
+		free(state);
+		free(next);
+		free(shifted);
+		state = next = shifted = NULL;
+	}
+
+	clear();
+}
+
+LifeBoard::~LifeBoard() {
+	free(state);
+	free(next);
+	free(shifted);
+}
+
+uint32_t LifeBoard::hashWord(uint16_t offset, life_word_t word) {
+	//Mix the word value with its position, so that the same pattern in different places
+	// (or different patterns in the same place) give different results.
+	uint32_t h = ((uint32_t) word * 0x9E3779B1) ^ ((uint32_t) (offset + 1) * 0x85EBCA77);
+	h ^= h >> 15;
+	h *= 0x2C1B3C6D;
+	h ^= h >> 13;
+	return h;
+}
+
+void LifeBoard::clear() {
+	hash = 0;
+	if (state == NULL) return;
+	for (uint16_t i = 0; i < (uint16_t) words * height; i++) {
+		state[i] = 0;
+		hash ^= hashWord(i, 0);
+	}
+}
+
+uint8_t LifeBoard::get(uint8_t x, uint8_t y) {
+	if (state == NULL) return 0;
+	return (state[y * words + x / LIFE_WORD_BITS] >> (x % LIFE_WORD_BITS)) & 0x01;
+}
+
+void LifeBoard::set(uint8_t x, uint8_t y, uint8_t alive) {
+	if (state == NULL) return;
+	uint16_t offset = y * words + x / LIFE_WORD_BITS;
+	life_word_t old = state[offset];
+	life_word_t bit = (life_word_t) 1 << (x % LIFE_WORD_BITS);
+	life_word_t word = alive ? (old | bit) : (old & ~bit);
+	if (word != old) {
+		hash ^= hashWord(offset, old) ^ hashWord(offset, word);
+		state[offset] = word;
+	}
+}
+
+//Bit x of the result is bit x - 1 of row (i.e. the cell to the west), with bit 0 taken from
+// the last cell in the row.
+void LifeBoard::shiftEast(life_word_t* row, life_word_t* result) {
+	uint8_t last = words - 1;
+	life_word_t carry = (row[last] >> ((width - 1) % LIFE_WORD_BITS)) & 0x01;
+	for (uint8_t w = 0; w < words; w++) {
+		life_word_t word = row[w];
+		result[w] = (word << 1) | carry;
+		carry = word >> (LIFE_WORD_BITS - 1);
+	}
+	result[last] &= lastMask;
+}
+
+//Bit x of the result is bit x + 1 of row (i.e. the cell to the east), with the last cell
+// in the row taken from bit 0.
+void LifeBoard::shiftWest(life_word_t* row, life_word_t* result) {
+	uint8_t last = words - 1;
+	life_word_t carry = row[0] & 0x01;
+	for (uint8_t w = last; ; w--) {
+		life_word_t word = row[w];
+		if (w == last) {
+			result[w] = (word >> 1) | (carry << ((width - 1) % LIFE_WORD_BITS));
+		}
+		else {
+			result[w] = (word >> 1) | (carry << (LIFE_WORD_BITS - 1));
+		}
+		carry = word & 0x01;
+		if (w == 0) break;
+	}
+}
+
+void LifeBoard::step() {
+	if (state == NULL) return;
+
+	//Rolling window of east / west shifted copies for the rows above, at and below the row
+	// being calculated; when we move down a row the window shifts and only one new row needs
+	// to be shifted.
+	life_word_t* aboveE = shifted;
+	life_word_t* aboveW = shifted + words;
+	life_word_t* rowE = shifted + words * 2;
+	life_word_t* rowW = shifted + words * 3;
+	life_word_t* belowE = shifted + words * 4;
+	life_word_t* belowW = shifted + words * 5;
+
+	life_word_t* above = state + (height - 1) * words;
+	life_word_t* row = state;
+	shiftEast(above, aboveE);
+	shiftWest(above, aboveW);
+	shiftEast(row, rowE);
+	shiftWest(row, rowW);
+
+	for (uint8_t y = 0; y < height; y++) {
+		life_word_t* below = state + ((y + 1 < height) ? y + 1 : 0) * words;
+		shiftEast(below, belowE);
+		shiftWest(below, belowW);
+
+		life_word_t* result = next + y * words;
+		for (uint8_t w = 0; w < words; w++) {
+			life_word_t alive = row[w];
+
+			//Add up the eight neighbours of every cell in the word at once.  Full adders for
+			// the rows above and below, half adder for the left and right of this row...
+			life_word_t a = aboveE[w], b = above[w], c = aboveW[w];
+			life_word_t onesA = a ^ b ^ c;
+			life_word_t twosA = (a & b) | (c & (a ^ b));
+
+			a = belowE[w]; b = below[w]; c = belowW[w];
+			life_word_t onesB = a ^ b ^ c;
+			life_word_t twosB = (a & b) | (c & (a ^ b));
+
+			a = rowE[w]; b = rowW[w];
+			life_word_t onesC = a ^ b;
+			life_word_t twosC = a & b;
+
+			//... then combine the ones column (carrying into twos) ...
+			life_word_t ones = onesA ^ onesB ^ onesC;
+			life_word_t twosD = (onesA & onesB) | (onesC & (onesA ^ onesB));
+
+			//... and the four twos (carrying into fours).
+			life_word_t twosE = twosA ^ twosB ^ twosC;
+			life_word_t foursA = (twosA & twosB) | (twosC & (twosA ^ twosB));
+			life_word_t twos = twosE ^ twosD;
+			life_word_t foursB = twosE & twosD;
+
+			//A cell is alive in the next generation with a count of 3, or with a count of 2 if
+			// it is already alive; that is, the twos bit is set, no fours (or eights), and either
+			// the ones bit is set or the cell is currently alive.
+			result[w] = twos & ~(foursA | foursB) & (ones | alive);
+		}
+
+		//Slide the window down one row
+		life_word_t* t;
+		t = aboveE; aboveE = rowE; rowE = belowE; belowE = t;
+		t = aboveW; aboveW = rowW; rowW = belowW; belowW = t;
+		above = row;
+		row = below;
+	}
+
+	//Update the hash for any words which changed, and swap the buffers rather than copying
+	for (uint16_t i = 0; i < (uint16_t) words * height; i++) {
+		if (state[i] != next[i]) hash ^= hashWord(i, state[i]) ^ hashWord(i, next[i]);
+	}
+	life_word_t* t = state;
+	state = next;
+	next = t;
+}
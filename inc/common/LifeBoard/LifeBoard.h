@@ -0,0 +1,94 @@
+/*
+ * Bit-packed Game of Life board.  Each row is stored as an array of words with one bit per
+ * cell, and the next generation is computed a whole word at a time using bit-sliced adders
+ * (so a 32 bit word evaluates 32 cells at once, with no per-cell neighbour counting).  The
+ * board wraps around at all edges, and can be any size up to 255 x 255.
+ *
+ * A hash of the board is kept up to date as cells change (only words which actually changed
+ * are re-hashed), so cycle detection does not need to walk the whole board each generation.
+ */
+
+#ifndef LIFE_BOARD_H
+#define LIFE_BOARD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//The word size to pack cells into.  32 is fastest on 32 bit chips and fine on AVR; 8 uses
+// the least padding on narrow boards.
+#ifndef LIFE_WORD_BITS
+#define LIFE_WORD_BITS 32
+#endif
+
+#if LIFE_WORD_BITS == 8
+typedef uint8_t life_word_t;
+#elif LIFE_WORD_BITS == 16
+typedef uint16_t life_word_t;
+#else
+typedef uint32_t life_word_t;
+#endif
+
+namespace digitalcave {
+	class LifeBoard {
+
+		private:
+			uint8_t width;
+			uint8_t height;
+			uint8_t words;			//Words per row
+			life_word_t lastMask;	//Valid bits in the last word of each row
+
+			life_word_t* state;		//Current generation, height * words
+			life_word_t* next;		//Next generation; swapped with state after each step
+			life_word_t* shifted;	//Scratch space for the east / west shifted copies of three rows
+
+			uint32_t hash;
+
+			//Hash contribution of a single word at the given offset
+			uint32_t hashWord(uint16_t offset, life_word_t word);
+
+			//Copies of row with each cell replaced by its neighbour to the west / east (wrapping)
+			void shiftEast(life_word_t* row, life_word_t* result);
+			void shiftWest(life_word_t* row, life_word_t* result);
+
+		public:
+			LifeBoard(uint8_t width, uint8_t height);
+			~LifeBoard();
+
+			/*
+			 * Returns 0 if the board couldn't be allocated; it then has no live cells, and set() and
+			 * step() do nothing.
+			 */
+			uint8_t isValid() { return state != NULL; }
+
+			uint8_t getWidth() { return width; }
+			uint8_t getHeight() { return height; }
+
+			/*
+			 * Returns 1 if the cell is alive, 0 otherwise.  Co-ordinates must be within the board.
+			 */
+			uint8_t get(uint8_t x, uint8_t y);
+
+			/*
+			 * Sets the cell to alive (non-zero) or dead (zero).  Co-ordinates must be within the board.
+			 */
+			void set(uint8_t x, uint8_t y, uint8_t alive);
+
+			/*
+			 * Kills all cells.
+			 */
+			void clear();
+
+			/*
+			 * Advances the board by one generation.
+			 */
+			void step();
+
+			/*
+			 * Returns a hash of the current board.  Identical boards always have the same hash,
+			 * so this can be compared against previous generations to detect cycles.
+			 */
+			uint32_t getHash() { return hash; }
+	};
+}
+
+#endif
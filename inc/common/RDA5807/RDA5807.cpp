@@ -2,67 +2,207 @@
 
 using namespace digitalcave;
 
+#define RDA5807_STATE_IDLE		0
+#define RDA5807_STATE_TUNING	1
+#define RDA5807_STATE_SEEKING	2
+
+//Polls with the RDS ready flag still up, after reading a group, before reading again anyway
+#define RDA5807_RDSR_POLLS		4
+
+//Register 0x02
+#define R2_DHIZ					0x8000
+#define R2_DMUTE				0x4000
+#define R2_SEEKUP				0x0200
+#define R2_SEEK					0x0100
+#define R2_RDS_EN				0x0008
+#define R2_SOFT_RESET			0x0002
+#define R2_ENABLE				0x0001
+
+//Register 0x03
+#define R3_TUNE					0x0010
+
+//Register 0x0A
+#define RA_RDSR					0x8000
+#define RA_STC					0x4000
+#define RA_BLK_E				0x0800
+#define RA_READCHAN				0x03FF
+
+//Register 0x0B; an error count of 3 means the block could not be corrected
+#define RB_BLERA				0x000C
+#define RB_BLERB				0x0003
+
 RDA5807::RDA5807(I2C* i2c) :
-	i2c(i2c)
+	i2c(i2c),
+	dirty(0),
+	statusValid(0),
+	state(RDA5807_STATE_IDLE),
+	rdsHeld(0)
 {
+	for (uint8_t i = 0; i < 4; i++) lastGroup[i] = 0;
+
 	//Force soft reset and initial state
-	setRegister(0x02, 0xC003);
-	setRegister(0x03, 0x0000);
-	setRegister(0x04, 0x0A00);
-	setRegister(0x05, 0x0800);
-	setRegister(0x06, 0x0000);
-	setRegister(0x07, 0x4202);
+	registers[0] = 0xC003;
+	registers[1] = 0x0000;
+	registers[2] = 0x0A00;
+	registers[3] = 0x0800;
+	registers[4] = 0x0000;
+	registers[5] = 0x4202;
+	dirty = 0x3F;
+	updateRegisters();
+	delay_ms(10);
 
-	//Turn off soft reset to bring chip up
-	setRegister(0x02, 0xC005);
+	//Turn off soft reset to bring chip up, with RDS on
+	setRegister(0x02, 0xC00D);
+	updateRegisters();
+	delay_ms(10);
 }
 
 uint16_t RDA5807::getRegister(uint8_t registerNumber){
-	if (registerNumber != 0x00 && (registerNumber < 0x02 || registerNumber > 0x07) && (registerNumber < 0x0A || registerNumber > 0x0F)){
-		return 0xBEEF;
+	if (registerNumber < 0x02 || registerNumber > 0x07){
+		return 0x0000;
 	}
-	uint8_t data[2];
-	data[0] = registerNumber;
-	I2CMessage message(data, 1);
-	i2c->write(RDA5807_ADDRESS, &message);
-	message.setLength(2);
-	i2c->read(RDA5807_ADDRESS, &message);
-
-	return (((uint16_t) data[0]) << 8) | data[1];
+	return registers[registerNumber - 0x02];
 }
 
 void RDA5807::setRegister(uint8_t registerNumber, uint16_t value){
 	if (registerNumber < 0x02 || registerNumber > 0x07){
 		return;
 	}
-	uint8_t data[3];
-	data[0] = registerNumber;
-	data[1] = value >> 8;
-	data[2] = value & 0xFF;
-	I2CMessage message(data, sizeof(data));
-	i2c->write(RDA5807_ADDRESS, &message);
-	delay_ms(10);
+	uint8_t i = registerNumber - 0x02;
+	if (registers[i] != value){
+		registers[i] = value;
+		dirty |= (1 << i);
+	}
+}
+
+void RDA5807::updateRegisters(){
+	for (uint8_t i = 0; i < 6; i++){
+		if (!(dirty & (1 << i))) continue;
+
+		uint8_t data[3];
+		data[0] = i + 0x02;
+		data[1] = registers[i] >> 8;
+		data[2] = registers[i] & 0xFF;
+		I2CMessage message(data, sizeof(data));
+		i2c->write(RDA5807_ADDRESS, &message);
+	}
+	dirty = 0;
+}
+
+void RDA5807::readStatus(uint8_t count){
+	uint8_t data[12];
+	I2CMessage message(data, count * 2);
+	i2c->read(RDA5807_SEQUENTIAL_ADDRESS, &message);
+
+	for (uint8_t i = 0; i < count; i++){
+		status[i] = (((uint16_t) data[i * 2]) << 8) | data[i * 2 + 1];
+	}
+	statusValid = 1;
+}
+
+uint8_t RDA5807::checkTuned(){
+	if (state == RDA5807_STATE_IDLE){
+		return 0;
+	}
+	readStatus(1);
+	if (!(status[0] & RA_STC)){
+		return 0;
+	}
+
+	//The chip clears the seek / tune bit itself when it is done; the shadow copy just follows
+	registers[0] &= ~R2_SEEK;
+	registers[1] &= ~R3_TUNE;
+	if (state == RDA5807_STATE_SEEKING){
+		registers[1] = (registers[1] & 0x003F) | ((status[0] & RA_READCHAN) << 6);
+	}
+	state = RDA5807_STATE_IDLE;
+	return RDA5807_TUNED;
+}
+
+void RDA5807::setPowerConfig(uint16_t mask, uint16_t value){
+	//If a seek finished since we last looked, the shadow copy still has the seek bit set, and writing it
+	// would start another one.
+	if (state == RDA5807_STATE_SEEKING){
+		checkTuned();
+	}
+	setRegister(0x02, (getRegister(0x02) & ~mask) | (value & mask));
+	updateRegisters();
 }
 
 uint16_t RDA5807::getStation(){
-	//return ((getRegister(0x03) & 0xFFC0) >> 6) + MIN_STATION;
-	return (getRegister(0x0A) & 0x03FF) + MIN_STATION;
+	if (state != RDA5807_STATE_IDLE){
+		checkTuned();
+	}
+	else if (!statusValid){
+		readStatus(1);
+	}
+	return (status[0] & RA_READCHAN) + MIN_STATION;
 }
 
 void RDA5807::setStation(uint16_t station){
 	if (station > MAX_STATION || station < MIN_STATION){
 		station = MIN_STATION;
 	}
-	setRegister(0x03, ((station - MIN_STATION) << 6) | 0x10);	//Set the station as the top 10 bits in register 3, with 0x10 to indicate we want to start a tuning operation
+	//Tuning stops a seek
+	setRegister(0x02, getRegister(0x02) & ~R2_SEEK);
+	//Set the station as the top 10 bits in register 3, with the tune bit to start a tuning operation
+	setRegister(0x03, (getRegister(0x03) & 0x002F) | ((station - MIN_STATION) << 6) | R3_TUNE);
+	updateRegisters();
+
+	state = RDA5807_STATE_TUNING;
+	rds.reset();
 }
 
 void RDA5807::doScan(uint8_t direction){
-	if (direction){
-		setRegister(0x02, 0xC301);		//Start seeking up
+	uint16_t value = getRegister(0x02) & ~R2_SEEKUP;
+	setRegister(0x02, value | (direction ? R2_SEEKUP : 0x0000) | R2_SEEK);
+	updateRegisters();
+
+	state = RDA5807_STATE_SEEKING;
+	rds.reset();
+}
+
+uint8_t RDA5807::isBusy(){
+	return state != RDA5807_STATE_IDLE;
+}
+
+uint8_t RDA5807::tick(){
+	if (state != RDA5807_STATE_IDLE){
+		return checkTuned();
 	}
-	else {
-		setRegister(0x02, 0xC101);		//Start seeking down
+	if (!(getRegister(0x02) & R2_RDS_EN)){
+		return 0;
 	}
+
+	//Just the first status register, to see if there is a new group; then all of them, to get it
+	readStatus(1);
+	if (!(status[0] & RA_RDSR)){
+		rdsHeld = 0;
+		return 0;
+	}
+	//The flag stays up for about 40ms after each group (and they come every 88ms), so the group is only read
+	// when the flag goes up; unless it seems to be stuck up.
+	if (rdsHeld && rdsHeld++ < RDA5807_RDSR_POLLS){
+		return 0;
+	}
+	rdsHeld = 1;
+	readStatus(6);
+
+	//Drop groups with uncorrectable errors in A or B, and RBDS block E (which isn't a group at all)
+	if ((status[1] & RB_BLERA) == RB_BLERA || (status[1] & RB_BLERB) == RB_BLERB || (status[0] & RA_BLK_E)){
+		return 0;
+	}
+	//A stuck ready flag can give us a group we have already seen
+	uint8_t same = 1;
+	for (uint8_t i = 0; i < 4; i++){
+		if (lastGroup[i] != status[i + 2]) same = 0;
+		lastGroup[i] = status[i + 2];
+	}
+	if (same){
+		return 0;
+	}
+
+	return rds.decode(status[2], status[3], status[4], status[5]);
 }
 
 uint8_t RDA5807::getVolume(){
@@ -74,40 +214,51 @@ void RDA5807::setVolume(uint8_t volume){
 		volume = 0x0F;
 	}
 	setRegister(0x05, (getRegister(0x05) & 0xFFF0) | volume);
+	updateRegisters();
 }
 
 uint8_t RDA5807::getMute(){
-	return (getRegister(0x02) & 0x4000) ? 0 : 1;
+	return (getRegister(0x02) & R2_DMUTE) ? 0 : 1;
 }
 void RDA5807::setMute(uint8_t mute_on){
 	//The FM chip negates it, calling it "mute_disable", so we compare with mute_on == 0.
-	setRegister(0x02, ((getRegister(0x02) & ~0x4000) | (mute_on ? 0x0000 : 0x4000)));
+	setPowerConfig(R2_DMUTE, mute_on ? 0x0000 : R2_DMUTE);
 }
 
 uint8_t RDA5807::getHiZ(){
-	return (getRegister(0x02) & 0x8000) ? 0 : 1;
+	return (getRegister(0x02) & R2_DHIZ) ? 0 : 1;
 }
 void RDA5807::setHiZ(uint8_t hi_z){
 	//The FM chip negates it, calling it "1 = not hi z", so we compare with hi_z == 0.
-	setRegister(0x02, ((getRegister(0x02) & ~0x8000) | (hi_z ? 0x0000 : 0x8000)));
+	setPowerConfig(R2_DHIZ, hi_z ? 0x0000 : R2_DHIZ);
 }
 
 uint8_t RDA5807::getEnabled(){
-	return (getRegister(0x02) & 0x0001);
+	return (getRegister(0x02) & R2_ENABLE);
 }
 
 void RDA5807::setEnabled(uint8_t enabled){
-	setRegister(0x02, ((getRegister(0x02) & ~0x0001) | (enabled ? 0x0001 : 0x0000)));
+	setPowerConfig(R2_ENABLE, enabled ? R2_ENABLE : 0x0000);
 }
 
 uint8_t RDA5807::getReset(){
-	return (getRegister(0x02) & 0x0002) ? 1 : 0;
+	return (getRegister(0x02) & R2_SOFT_RESET) ? 1 : 0;
 }
 
 void RDA5807::setReset(uint8_t reset){
-	setRegister(0x02, ((getRegister(0x02) & ~0x0002) | (reset ? 0x0002 : 0x0000)));
+	setPowerConfig(R2_SOFT_RESET, reset ? R2_SOFT_RESET : 0x0000);
+}
+
+uint8_t RDA5807::getRdsEnabled(){
+	return (getRegister(0x02) & R2_RDS_EN) ? 1 : 0;
+}
+
+void RDA5807::setRdsEnabled(uint8_t enabled){
+	setPowerConfig(R2_RDS_EN, enabled ? R2_RDS_EN : 0x0000);
+	rds.reset();
 }
 
 uint8_t RDA5807::getSignalStrength(){
-	return (getRegister(0x0B) & 0xFE00) >> 9;
+	readStatus(2);
+	return (status[1] & 0xFE00) >> 9;
 }
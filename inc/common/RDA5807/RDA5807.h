@@ -1,11 +1,27 @@
+/*
+ * Driver for the RDA5807M FM tuner.
+ *
+ * The writable registers (0x02 - 0x07) are kept in a shadow copy.  Getters read from it, and setters
+ * change it and write only the registers which actually changed, one at a time through the random
+ * access address; nothing is read back first.  Only the status registers (0x0A - 0x0F) are ever
+ * read, through the sequential address, which always starts at 0x0A; so the fewer of them we need,
+ * the shorter the read.
+ *
+ * Nothing here waits for the chip.  setStation() and doScan() start the operation and return;
+ * tick() (called regularly from the main loop, every 10 - 40ms) notices when it is done, and when
+ * RDS is enabled, reads each new RDS group and passes it to the decoder.
+ */
+
 #ifndef RDA5807_h
 #define RDA5807_h
 
 #include <stdlib.h>
 #include <dcutil/delay.h>
 #include <I2C.h>
+#include <RDS.h>
 
-#define RDA5807_ADDRESS			0x11
+#define RDA5807_ADDRESS			0x11		//Random access; the first byte written is the register number
+#define RDA5807_SEQUENTIAL_ADDRESS	0x10	//Sequential access; reads start at 0x0A, writes at 0x02
 
 #define MIN_STATION				870
 #define MAX_STATION				1080
@@ -97,29 +113,69 @@ typedef struct {
 	uint8_t rF_rdsd_lsb : 8;
 } rda5807_register_fields_t;
 
+//Flag returned from tick() (along with the RDS_* flags from the decoder) when a tune or seek is done
+#define RDA5807_TUNED			0x80
+
 namespace digitalcave {
 
 	class RDA5807 {
 		private:
 			I2C* i2c;
 
-			//Returns the 16 bit value at the specified register number from the register mapping.  Returns 0x0000 if the register number is invalid.
+			//Shadow copy of registers 0x02 - 0x07, and a bit for each one which has changed since it was written
+			uint16_t registers[6];
+			uint8_t dirty;
+
+			//Registers 0x0A - 0x0F, as last read; statusValid is set once 0x0A has been read
+			uint16_t status[6];
+			uint8_t statusValid;
+
+			//RDA5807_STATE_*
+			uint8_t state;
+
+			//Polls since the last RDS group was read, while the ready flag has stayed up (0 if it went down)
+			uint8_t rdsHeld;
+			//The last RDS group, so that the same one is not decoded twice
+			uint16_t lastGroup[4];
+
+			RDS rds;
+
+			//Returns the 16 bit value of the specified register from the shadow copy.  Returns 0x0000 if the register number is not writable.
 			uint16_t getRegister(uint8_t registerNumber);
 
-			//Write the specified register with the specified value
+			//Sets the specified register in the shadow copy, marking it to be written if it changed
 			void setRegister(uint8_t registerNumber, uint16_t value);
 
+			//Writes the registers which changed to the chip
+			void updateRegisters();
+
+			//Reads the first count status registers, starting at 0x0A
+			void readStatus(uint8_t count);
+
+			//Reads the status, and finishes a tune or seek if it is done.  Returns RDA5807_TUNED if it finished one.
+			uint8_t checkTuned();
+
+			//Sets the masked bits of register 0x02.  Takes care not to start a seek again which has just finished.
+			void setPowerConfig(uint16_t mask, uint16_t value);
+
 		public:
 			//Inits the RDA5807 control object and sends the power up commands to the chip.
 			RDA5807(I2C* i2c);
 
 			//Gets / Sets the current station.  Station is specified in 100kHz; e.g. 102.1 is shown as 1021.
+			// Setting it starts tuning; tick() returns RDA5807_TUNED when it is done.
 			uint16_t getStation();
 			void setStation(uint16_t station);
 
-			//Starts scanning.  Poll getStation() to get results.
+			//Starts scanning.  Poll getStation() to get results, or wait for tick() to return RDA5807_TUNED.
 			void doScan(uint8_t direction);
 
+			//Returns 1 while tuning or scanning
+			uint8_t isBusy();
+
+			//Checks on a tune or scan, and reads new RDS data.  Returns RDA5807_TUNED and / or RDS_* flags.
+			uint8_t tick();
+
 			//Gets / Sets the current volume, from 0x00 to 0x0F.
 			uint8_t getVolume();
 			void setVolume(uint8_t volume);
@@ -140,6 +196,13 @@ namespace digitalcave {
 			uint8_t getReset();
 			void setReset(uint8_t reset);
 
+			//Gets / Sets RDS reception.  It is enabled at power up.
+			uint8_t getRdsEnabled();
+			void setRdsEnabled(uint8_t enabled);
+
+			//The RDS decoder, with the program service name, radiotext and clock time of the current station
+			RDS* getRds() { return &rds; }
+
 			//Returns the raw signal strength.
 			uint8_t getSignalStrength();
 	};
@@ -0,0 +1,133 @@
+#include "RDS.h"
+
+using namespace digitalcave;
+
+RDS::RDS(){
+	reset();
+}
+
+void RDS::reset(){
+	pi = 0;
+	psSegments = 0;
+	rtSegments = 0;
+	rtFlag = 0xFF;
+	ps[0] = 0x00;
+	rt[0] = 0x00;
+	ctValid = 0;
+	for (uint8_t i = 0; i < RDS_PS_LENGTH; i++) psNext[i] = ' ';
+	for (uint8_t i = 0; i < RDS_RT_LENGTH; i++) rtNext[i] = ' ';
+}
+
+uint8_t RDS::decode(uint16_t a, uint16_t b, uint16_t c, uint16_t d){
+	//A different PI means a different station; nothing we have so far belongs to it
+	if (pi != 0 && a != pi){
+		reset();
+	}
+	pi = a;
+
+	uint8_t type = b >> 12;
+	uint8_t versionB = (b & 0x0800) ? 1 : 0;
+
+	if (type == 0){
+		return decodeProgramService(b, d);
+	}
+	else if (type == 2){
+		return decodeRadioText(b, c, d);
+	}
+	else if (type == 4 && !versionB){
+		return decodeClockTime(b, c, d);
+	}
+	return 0;
+}
+
+//Sets dst to the null terminated src, returning 1 if it changed
+static uint8_t publish(char* dst, char* src, uint8_t length){
+	uint8_t changed = 0;
+	for (uint8_t i = 0; i < length; i++){
+		if (dst[i] != src[i]) changed = 1;
+		dst[i] = src[i];
+	}
+	if (dst[length] != 0x00) changed = 1;
+	dst[length] = 0x00;
+	return changed;
+}
+
+uint8_t RDS::decodeProgramService(uint16_t b, uint16_t d){
+	//The last two bits of B say which pair of characters is in D
+	uint8_t segment = b & 0x03;
+	psNext[segment * 2] = d >> 8;
+	psNext[segment * 2 + 1] = d & 0xFF;
+	psSegments |= (1 << segment);
+
+	if (psSegments != 0x0F) return 0;
+	psSegments = 0;
+	return publish(ps, psNext, RDS_PS_LENGTH) ? RDS_PS : 0;
+}
+
+uint8_t RDS::decodeRadioText(uint16_t b, uint16_t c, uint16_t d){
+	//2A sends four characters (in C and D) per group, 2B two (in D)
+	uint8_t versionB = (b & 0x0800) ? 1 : 0;
+	uint8_t width = versionB ? 2 : 4;
+	uint8_t flag = ((b >> 4) & 0x01) | (versionB << 1);
+	if (flag != rtFlag){
+		rtFlag = flag;
+		rtSegments = 0;
+		for (uint8_t i = 0; i < RDS_RT_LENGTH; i++) rtNext[i] = ' ';
+	}
+
+	uint8_t segment = b & 0x0F;
+	char* chars = &rtNext[segment * width];
+	if (versionB){
+		chars[0] = d >> 8;
+		chars[1] = d & 0xFF;
+	}
+	else {
+		chars[0] = c >> 8;
+		chars[1] = c & 0xFF;
+		chars[2] = d >> 8;
+		chars[3] = d & 0xFF;
+	}
+	rtSegments |= (1 << segment);
+
+	//The text is complete when every segment up to the one with the carriage return (or the last one) is in
+	uint8_t length = 16 * width;
+	for (uint8_t i = 0; i < 16 && length == 16 * width; i++){
+		if (!(rtSegments & (1 << i))) return 0;
+		for (uint8_t j = i * width; j < (i + 1) * width; j++){
+			if (rtNext[j] == 0x0D){
+				length = j;
+				break;
+			}
+		}
+	}
+	rtSegments = 0;
+
+	//Stations without the carriage return pad with spaces instead
+	while (length > 0 && rtNext[length - 1] == ' ') length--;
+	return publish(rt, rtNext, length) ? RDS_RT : 0;
+}
+
+uint8_t RDS::decodeClockTime(uint16_t b, uint16_t c, uint16_t d){
+	uint32_t mjd = (((uint32_t) (b & 0x03)) << 15) | (c >> 1);
+	uint8_t hour = ((c & 0x01) << 4) | (d >> 12);
+	uint8_t minute = (d >> 6) & 0x3F;
+	if (mjd == 0 || hour > 23 || minute > 59) return 0;
+
+	ctMJD = mjd;
+	ctHour = hour;
+	ctMinute = minute;
+	ctOffset = (d & 0x20) ? -(int8_t) (d & 0x1F) : (int8_t) (d & 0x1F);
+	ctValid = 1;
+	return RDS_CT;
+}
+
+void RDS::getDate(uint16_t* year, uint8_t* month, uint8_t* day){
+	//From annex G of the RDS standard, in fixed point
+	uint32_t y = (ctMJD * 100 - 1507820) / 36525;
+	uint32_t yDays = y * 36525 / 100;
+	uint32_t m = ((ctMJD - 14956 - yDays) * 10000 - 1000) / 306001;
+	*day = ctMJD - 14956 - yDays - m * 306001 / 10000;
+	uint8_t k = (m == 14 || m == 15) ? 1 : 0;
+	*year = 1900 + y + k;
+	*month = m - 1 - k * 12;
+}
@@ -0,0 +1,86 @@
+/*
+ * Incremental RDS / RBDS decoder, shared by the FM tuner drivers.
+ *
+ * Feed it one group (blocks A - D) at a time, as the tuner receives them; nothing waits for a
+ * whole message.  It puts together:
+ *  - the program service name (groups 0A / 0B), 8 characters sent two at a time;
+ *  - the radiotext (groups 2A / 2B), up to 64 characters sent four (2A) or two (2B) at a time,
+ *    ending early at a carriage return;
+ *  - the clock time (group 4A), sent at the start of each minute.
+ * A name or text is only published once every part of it has been received, so it never shows a
+ * mix of old and new.  Groups with uncorrectable errors should be dropped by the driver before
+ * they get here.
+ */
+
+#ifndef RDS_H
+#define RDS_H
+
+#include <stdint.h>
+
+//Flags returned from decode(), for what changed
+#define RDS_PS					0x01		//getProgramService() changed
+#define RDS_RT					0x02		//getRadioText() changed
+#define RDS_CT					0x04		//A new clock time was received
+
+#define RDS_PS_LENGTH			8
+#define RDS_RT_LENGTH			64
+
+namespace digitalcave {
+
+	class RDS {
+		public:
+			RDS();
+
+			//Forgets everything; call this after tuning to another station.
+			void reset();
+
+			//Decodes one group.  Returns RDS_* flags for what changed.
+			uint8_t decode(uint16_t a, uint16_t b, uint16_t c, uint16_t d);
+
+			//The program identification code (block A) of the last group; 0 if none yet
+			uint16_t getPI() { return pi; }
+
+			//The program service name, null terminated; empty until a whole one has been received
+			char* getProgramService() { return ps; }
+
+			//The radiotext, null terminated; empty until a whole one has been received
+			char* getRadioText() { return rt; }
+
+			//Returns 1 if a clock time has been received since the last reset().  The time is UTC; the
+			// offset to local time is in half hours.
+			uint8_t hasClockTime() { return ctValid; }
+			uint8_t getHour() { return ctHour; }
+			uint8_t getMinute() { return ctMinute; }
+			int8_t getOffset() { return ctOffset; }
+
+			//The date of the clock time, as the Modified Julian Day, or as year (e.g. 2024), month (1 - 12)
+			// and day (1 - 31).
+			uint32_t getMJD() { return ctMJD; }
+			void getDate(uint16_t* year, uint8_t* month, uint8_t* day);
+
+		private:
+			uint16_t pi;
+
+			//The name and text being put together, and which segments of them have been received
+			char psNext[RDS_PS_LENGTH];
+			uint8_t psSegments;
+			char rtNext[RDS_RT_LENGTH];
+			uint16_t rtSegments;
+			uint8_t rtFlag;			//The text A/B flag; when it changes, the station has started a new text
+
+			char ps[RDS_PS_LENGTH + 1];
+			char rt[RDS_RT_LENGTH + 1];
+
+			uint32_t ctMJD;
+			uint8_t ctHour;
+			uint8_t ctMinute;
+			int8_t ctOffset;
+			uint8_t ctValid;
+
+			uint8_t decodeProgramService(uint16_t b, uint16_t d);
+			uint8_t decodeRadioText(uint16_t b, uint16_t c, uint16_t d);
+			uint8_t decodeClockTime(uint16_t b, uint16_t c, uint16_t d);
+	};
+}
+
+#endif
@@ -2,12 +2,13 @@
 
 using namespace digitalcave;
 
-ArrayStream::ArrayStream(uint8_t capacity) {
+ArrayStream::ArrayStream(uint16_t capacity) {
 	if (capacity == 0) capacity = 1;	//Only YOU can prevent divide by zero exceptions!
 	data = (uint8_t*) malloc(capacity);
 	this->capacity = capacity;
 	head = 0x00;
 	tail = 0x00;
+	highWater = 0;
 }
 ArrayStream::~ArrayStream() {
 	free((void*) data);
@@ -18,12 +19,14 @@ void ArrayStream::clear() {
 	tail = 0x00;
 }
 
-uint8_t ArrayStream::remaining() {
-	return capacity - size();
+uint16_t ArrayStream::remaining() {
+	return capacity - 1 - size();
 }
 
-uint8_t ArrayStream::size() {
-	return (head >= tail) ? head - tail : capacity - tail + head;
+uint16_t ArrayStream::size() {
+	uint16_t h = head;
+	uint16_t t = tail;
+	return (h >= t) ? h - t : capacity - t + h;
 }
 
 uint8_t ArrayStream::isEmpty(){
@@ -31,7 +34,10 @@ uint8_t ArrayStream::isEmpty(){
 }
 
 uint8_t ArrayStream::isFull(){
-	return ((head + 1) % capacity == tail);
+	//Wrap by comparison rather than %, which is a slow 16 bit division on AVR
+	uint16_t next = head + 1;
+	if (next >= capacity) next = 0;
+	return (next == tail);
 }
 
 uint8_t ArrayStream::peek(uint8_t *b){
@@ -43,14 +49,21 @@ uint8_t ArrayStream::peek(uint8_t *b){
 
 uint8_t ArrayStream::read(uint8_t* b){
 	if (isEmpty()) return 0;
-	*b = data[tail];
-	if (++tail >= capacity) tail = 0;
+	uint16_t t = tail;
+	*b = data[t];
+	if (++t >= capacity) t = 0;
+	tail = t;
 	return 1;
 }
 
 uint8_t ArrayStream::write(uint8_t b){
 	if (isFull()) return 0;
-	data[head] = b;
-	if (++head >= capacity) head = 0;
+	uint16_t h = head;
+	data[h] = b;
+	if (++h >= capacity) h = 0;
+	head = h;
+
+	uint16_t s = size();
+	if (s > highWater) highWater = s;
 	return 1;
 }
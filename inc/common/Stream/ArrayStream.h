@@ -1,6 +1,10 @@
 /*
  * Stream implementation of a ring buffer.  The size is determined at instntiation,
  * and you can read / write to it just like any other stream.
+ *
+ * Indices are 16 bit, so buffers can be larger than 255 bytes.  On 8 bit chips the indices
+ * are no longer read atomically, so if one side of the buffer is used from an ISR the other
+ * side must keep that interrupt disabled while it accesses the buffer (as SerialAVR does).
  */
 
 #ifndef ARRAY_STREAM_H
@@ -12,12 +16,14 @@ namespace digitalcave {
 	class ArrayStream : public Stream {
 
 		private:
-			uint8_t capacity;
+			uint16_t capacity;
 			volatile uint8_t* data;
-			volatile uint8_t head;
-			volatile uint8_t tail;
+			volatile uint16_t head;
+			volatile uint16_t tail;
+			uint16_t highWater;
 		public:
-			ArrayStream(uint8_t capacity);
+			//The buffer holds at most capacity - 1 bytes
+			ArrayStream(uint16_t capacity);
 			~ArrayStream();
 
 			uint8_t read(uint8_t *b);
@@ -26,12 +32,19 @@ namespace digitalcave {
 			uint8_t peek(uint8_t *b);
 
 			void clear();
-			uint8_t remaining();
-			uint8_t size();
+			uint16_t remaining();
+			uint16_t size();
 
 			uint8_t isEmpty();
 			uint8_t isFull();
 
+			/*
+			 * Returns the most bytes which have been in the buffer at once since it was created
+			 * (or since resetHighWater()); useful for sizing buffers.
+			 */
+			uint16_t getHighWater() { return highWater; }
+			void resetHighWater() { highWater = size(); }
+
 			// Allow other overloaded functions from superclass to show up in subclass.
 			using Stream::skip;
 
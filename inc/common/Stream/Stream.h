@@ -50,14 +50,14 @@ namespace digitalcave {
 			 * sub-clases may implement this in a more efficient manner.
 			 * Returns the number of bytes successfully skipped.
 			 */
-			uint16_t skip(uint16_t b);
+			virtual uint16_t skip(uint16_t b);
 
 			/*
 			 * Resets the stream back to it's original position.
 			 * If the reset was successful return 1; otherwise return 0.
 			 * The default implementation does nothing and returns 0.
 			 */
-			uint8_t reset();
+			virtual uint8_t reset();
 		private:
 
 	};
@@ -0,0 +1,76 @@
+#include "ws2812_transpose.h"
+
+/*
+ * Transposes an 8x8 bit matrix held in two words, where byte s (lo holds bytes 0 - 3 and hi
+ * holds 4 - 7) is row s.  Afterwards byte k holds bit k of each row, with row s at bit s.
+ * From Hacker's Delight, section 7-3.
+ */
+static inline void ws2812_transpose8(uint32_t* lo, uint32_t* hi){
+	uint32_t l = *lo;
+	uint32_t h = *hi;
+	uint32_t t;
+
+	t = (l ^ (l >> 7)) & 0x00AA00AA; l ^= t ^ (t << 7);
+	t = (h ^ (h >> 7)) & 0x00AA00AA; h ^= t ^ (t << 7);
+	t = (l ^ (l >> 14)) & 0x0000CCCC; l ^= t ^ (t << 14);
+	t = (h ^ (h >> 14)) & 0x0000CCCC; h ^= t ^ (t << 14);
+	t = (l ^ (h << 4)) & 0xF0F0F0F0; l ^= t; h ^= t >> 4;
+
+	*lo = l;
+	*hi = h;
+}
+
+void ws2812_transpose(const ws2812_strip_t* strips, uint8_t strip_count, uint16_t led, uint16_t* planes){
+	//Wire order is GRB; frames are RGB
+	static const uint8_t channels[3] = { 1, 0, 2 };
+	uint16_t offset = led * 3;
+
+	for (uint8_t c = 0; c < 3; c++){
+		uint16_t* plane = planes + c * 8;
+		for (uint8_t i = 0; i < 8; i++) plane[i] = 0;
+
+		//Strips are done eight at a time, one byte (row) per strip
+		for (uint8_t group = 0; group < strip_count; group += 8){
+			uint32_t lo = 0;
+			uint32_t hi = 0;
+			for (uint8_t s = 0; s < 8 && group + s < strip_count; s++){
+				const ws2812_strip_t* strip = &strips[group + s];
+				if (led >= strip->length) continue;
+				uint32_t value = strip->frame[offset + channels[c]];
+				if (s < 4) lo |= value << (s * 8);
+				else hi |= value << ((s - 4) * 8);
+			}
+			if ((lo | hi) == 0) continue;
+
+			ws2812_transpose8(&lo, &hi);
+
+			//Byte k now holds bit k of every strip in the group; MSB goes out first.
+			for (uint8_t k = 0; k < 4; k++){
+				plane[7 - k] |= ((lo >> (k * 8)) & 0xFF) << group;
+				plane[3 - k] |= ((hi >> (k * 8)) & 0xFF) << group;
+			}
+		}
+	}
+}
+
+static uint16_t ws2812_longest(const ws2812_strip_t* strips, uint8_t strip_count){
+	uint16_t longest = 0;
+	for (uint8_t s = 0; s < strip_count; s++){
+		if (strips[s].length > longest) longest = strips[s].length;
+	}
+	return longest;
+}
+
+uint32_t ws2812_max_refresh(const ws2812_strip_t* strips, uint8_t strip_count){
+	uint32_t frame_us = (uint32_t) ws2812_longest(strips, strip_count) * WS2812_LED_US + WS2812_RESET_US;
+	return 1000000 / frame_us;
+}
+
+uint32_t ws2812_leds_per_second(const ws2812_strip_t* strips, uint8_t strip_count){
+	uint32_t total = 0;
+	for (uint8_t s = 0; s < strip_count; s++){
+		total += strips[s].length;
+	}
+	uint32_t frame_us = (uint32_t) ws2812_longest(strips, strip_count) * WS2812_LED_US + WS2812_RESET_US;
+	return (uint32_t) (((uint64_t) total * 1000000) / frame_us);
+}
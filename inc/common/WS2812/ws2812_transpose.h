@@ -0,0 +1,56 @@
+/*
+ * Platform independent helpers for driving several WS2812 strips in parallel from one GPIO
+ * port (e.g. with DMA writing a whole port register per bit).
+ *
+ * Each strip has its own RGB frame (3 bytes per LED, red first) and its own length.  For
+ * each LED position, ws2812_transpose() converts the corresponding LED of every strip into
+ * 24 bit planes in wire order (green, red, blue; MSB first); bit s of each plane is the bit
+ * for strip s.  Those words can then be shifted onto the port pins and clocked out.
+ */
+
+#ifndef WS2812_TRANSPOSE_H
+#define WS2812_TRANSPOSE_H
+
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define WS2812_MAX_STRIPS		16
+#define WS2812_BITS_PER_LED		24
+
+//Wire timing; 800kHz bits, 24 bits per LED, and the reset (latch) time after each frame
+#define WS2812_LED_US			30
+#ifndef WS2812_RESET_US
+#define WS2812_RESET_US			60
+#endif
+
+typedef struct ws2812_strip_t {
+	uint8_t* frame;			//RGB triples, 3 * length bytes
+	uint16_t length;		//Number of LEDs on this strip
+} ws2812_strip_t;
+
+/*
+ * Converts LED number led of each strip into 24 bit planes (see above).  Strips which are
+ * shorter than led + 1 contribute zero bits.  strip_count must be at most WS2812_MAX_STRIPS.
+ */
+void ws2812_transpose(const ws2812_strip_t* strips, uint8_t strip_count, uint16_t led, uint16_t* planes);
+
+/*
+ * Returns the maximum refresh rate in Hz for the given strips, when all strips are sent in
+ * parallel.  This is limited by the longest strip.
+ */
+uint32_t ws2812_max_refresh(const ws2812_strip_t* strips, uint8_t strip_count);
+
+/*
+ * Returns the number of LEDs per second that the given strips can be updated at, when
+ * running at the maximum refresh rate.
+ */
+uint32_t ws2812_leds_per_second(const ws2812_strip_t* strips, uint8_t strip_count);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
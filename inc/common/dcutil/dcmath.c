@@ -29,6 +29,12 @@ static float lookup_sin[257] = {
 	0.00000f, 0.00614f, 0.01227f, 0.01841f, 0.02454f, 0.03067f, 0.03681f, 0.04294f, 0.04907f, 0.05520f, 0.06132f, 0.06744f, 0.07356f, 0.07968f, 0.08580f, 0.09191f, 0.09802f, 0.10412f, 0.11022f, 0.11632f, 0.12241f, 0.12850f, 0.13458f, 0.14066f, 0.14673f, 0.15280f, 0.15886f, 0.16491f, 0.17096f, 0.17700f, 0.18304f, 0.18907f, 0.19509f, 0.20110f, 0.20711f, 0.21311f, 0.21910f, 0.22508f, 0.23106f, 0.23702f, 0.24298f, 0.24893f, 0.25487f, 0.26079f, 0.26671f, 0.27262f, 0.27852f, 0.28441f, 0.29028f, 0.29615f, 0.30201f, 0.30785f, 0.31368f, 0.31950f, 0.32531f, 0.33111f, 0.33689f, 0.34266f, 0.34842f, 0.35416f, 0.35990f, 0.36561f, 0.37132f, 0.37701f, 0.38268f, 0.38835f, 0.39399f, 0.39962f, 0.40524f, 0.41084f, 0.41643f, 0.42200f, 0.42756f, 0.43309f, 0.43862f, 0.44412f, 0.44961f, 0.45508f, 0.46054f, 0.46598f, 0.47140f, 0.47680f, 0.48218f, 0.48755f, 0.49290f, 0.49823f, 0.50354f, 0.50883f, 0.51410f, 0.51936f, 0.52459f, 0.52980f, 0.53500f, 0.54017f, 0.54532f, 0.55046f, 0.55557f, 0.56066f, 0.56573f, 0.57078f, 0.57581f, 0.58081f, 0.58580f, 0.59076f, 0.59570f, 0.60062f, 0.60551f, 0.61038f, 0.61523f, 0.62006f, 0.62486f, 0.62964f, 0.63439f, 0.63912f, 0.64383f, 0.64851f, 0.65317f, 0.65781f, 0.66242f, 0.66700f, 0.67156f, 0.67609f, 0.68060f, 0.68508f, 0.68954f, 0.69397f, 0.69838f, 0.70275f, 0.70711f, 0.71143f, 0.71573f, 0.72000f, 0.72425f, 0.72846f, 0.73265f, 0.73682f, 0.74095f, 0.74506f, 0.74914f, 0.75319f, 0.75721f, 0.76120f, 0.76517f, 0.76910f, 0.77301f, 0.77689f, 0.78074f, 0.78456f, 0.78835f, 0.79211f, 0.79584f, 0.79954f, 0.80321f, 0.80685f, 0.81046f, 0.81404f, 0.81758f, 0.82110f, 0.82459f, 0.82805f, 0.83147f, 0.83486f, 0.83822f, 0.84155f, 0.84485f, 0.84812f, 0.85136f, 0.85456f, 0.85773f, 0.86087f, 0.86397f, 0.86705f, 0.87009f, 0.87309f, 0.87607f, 0.87901f, 0.88192f, 0.88480f, 0.88764f, 0.89045f, 0.89322f, 0.89597f, 0.89867f, 0.90135f, 0.90399f, 0.90660f, 0.90917f, 0.91171f, 0.91421f, 0.91668f, 0.91911f, 0.92151f, 0.92388f, 0.92621f, 0.92851f, 0.93077f, 0.93299f, 0.93518f, 0.93734f, 0.93946f, 0.94154f, 0.94359f, 0.94561f, 0.94759f, 0.94953f, 0.95144f, 0.95331f, 0.95514f, 0.95694f, 0.95870f, 0.96043f, 0.96212f, 0.96378f, 0.96539f, 0.96698f, 0.96852f, 0.97003f, 0.97150f, 0.97294f, 0.97434f, 0.97570f, 0.97703f, 0.97832f, 0.97957f, 0.98079f, 0.98196f, 0.98311f, 0.98421f, 0.98528f, 0.98631f, 0.98730f, 0.98826f, 0.98918f, 0.99006f, 0.99090f, 0.99171f, 0.99248f, 0.99321f, 0.99391f, 0.99456f, 0.99518f, 0.99577f, 0.99631f, 0.99682f, 0.99729f, 0.99772f, 0.99812f, 0.99848f, 0.99880f, 0.99908f, 0.99932f, 0.99953f, 0.99970f, 0.99983f, 0.99992f, 0.99998f, 1.00000f
 };
 
+//Generated with:
+//    for (uint8_t i = 0; i <= 64; i++){ printf("%d, ", (int) round(127 * sin(i * M_PI / 128))); }
+static const int8_t lookup_sin8[65] = {
+	0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46, 49, 51, 54, 57, 60, 63, 65, 68, 71, 73, 76, 78, 81, 83, 85, 88, 90, 92, 94, 96, 98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116, 117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127, 127
+};
+
 uint8_t constrain_angle(int16_t angle, uint8_t *quadrant){
 	//Get the angle into 0..1024 segments (0..360 degrees)
 	while (angle < 0){
@@ -76,6 +82,21 @@ float sin_f(float angle_r){
 	return lookup_sin[angle] * (quadrant >= 3 ? -1 : 1);
 }
 
+int8_t sin8(uint8_t phase){
+	//The table only covers the first quadrant; mirror it for the other three.
+	uint8_t index = phase & 0x3F;
+	switch (phase >> 6){
+		case 0: return lookup_sin8[index];
+		case 1: return lookup_sin8[64 - index];
+		case 2: return -lookup_sin8[index];
+		default: return -lookup_sin8[64 - index];
+	}
+}
+
+int8_t cos8(uint8_t phase){
+	return sin8(phase + 64);
+}
+
 uint16_t sqrt_f(uint16_t q){
 	uint8_t r;
 	uint8_t mask;
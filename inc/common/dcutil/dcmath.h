@@ -30,6 +30,14 @@ float cos_f(float angle);
  */
 float sin_f(float angle);
 
+/*
+ * Integer lookup-table based sin / cos, for when floating point is too slow (e.g. per pixel
+ * effects on AVR).  The angle is an 8 bit phase, where 256 is one full revolution (so it
+ * wraps naturally), and the result is in the range -127..127.
+ */
+int8_t sin8(uint8_t phase);
+int8_t cos8(uint8_t phase);
+
 /*
  * Fast square root function; from http://www.mikrocontroller.net/articles/AVR_Arithmetik#avr-gcc_Implementierung_.2816_Bit.29
  */
@@ -3,6 +3,7 @@
 #ifndef DC_TIME_H
 #define DC_TIME_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <math.h>
 #include <time.h>
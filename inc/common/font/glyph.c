@@ -0,0 +1,98 @@
+#include "glyph.h"
+
+#include <stddef.h>
+#include <string.h>
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#define pgm_read_byte_near(addr) (*(const uint8_t*) (addr))
+#endif
+
+void glyph_cache_init(glyph_cache_t* cache) {
+	memset(cache, 0, sizeof(glyph_cache_t));
+}
+
+void glyph_rasterise(font_t* font, char c, glyph_t* glyph) {
+	uint8_t width = font->width;
+	uint8_t height = font->height < GLYPH_MAX_HEIGHT ? font->height : GLYPH_MAX_HEIGHT;
+
+	glyph->font_data = font->font_data;
+	glyph->c = c;
+	glyph->height = height;
+	memset(glyph->rows, 0, GLYPH_MAX_HEIGHT);
+
+	//Same layout as Buffer::write_char / Draw::bitmap; the glyph is a bit stream, padded
+	// at the front of the first byte.
+	uint8_t byte_count = (width * font->height) >> 3;
+	uint8_t bit_count = (width * font->height) & 0x7;
+	uint8_t bit = 7;
+	if (bit_count != 0) {
+		byte_count++;
+		bit = bit_count - 1;
+	}
+
+	uint8_t glyph_index = pgm_read_byte_near(font->codepage + (uint8_t) c);
+	if (glyph_index != 0xFF) {
+		const uint8_t* data = font->font_data + (glyph_index * byte_count);
+		uint8_t b = pgm_read_byte_near(data++);
+		for (uint8_t y = 0; y < height; y++) {
+			uint8_t row = 0;
+			for (uint8_t x = 0; x < width; x++) {
+				row <<= 1;
+				if (b & (1 << bit)) row |= 0x01;
+				if (bit == 0) {
+					b = pgm_read_byte_near(data++);
+					bit = 8;
+				}
+				bit--;
+			}
+			glyph->rows[y] = row << (8 - width);
+		}
+	}
+
+	uint8_t char_width = font->variable_width == FONT_VARIABLE_WIDTH ? pgm_read_byte_near(font->font_widths + glyph_index) : 0xFF;
+	glyph->width = (glyph_index == 0xFF || char_width == 0xFF) ? width : char_width;
+}
+
+glyph_t* glyph_get(glyph_cache_t* cache, font_t* font, char c) {
+	glyph_t* victim = cache->glyphs;
+
+	for (uint8_t i = 0; i < GLYPH_CACHE_SIZE; i++) {
+		glyph_t* glyph = &cache->glyphs[i];
+		if (glyph->font_data == font->font_data && glyph->c == c && glyph->font_data != NULL) {
+			cache->hits++;
+			if (glyph->hits == 0xFF) {
+				//Age everything so that old favourites can eventually be replaced
+				for (uint8_t j = 0; j < GLYPH_CACHE_SIZE; j++) cache->glyphs[j].hits >>= 1;
+			}
+			glyph->hits++;
+			return glyph;
+		}
+		if (glyph->hits < victim->hits) victim = glyph;
+	}
+
+	cache->misses++;
+	glyph_rasterise(font, c, victim);
+	victim->hits = 1;
+	return victim;
+}
+
+void glyph_blit(glyph_t* glyph, uint8_t* buffer, uint8_t stride, uint8_t rows, int16_t x, int16_t y) {
+	if (x <= -8 || x >= (int16_t) stride * 8) return;
+
+	int16_t column = x >> 3;		//Arithmetic shift; -1 for x in -7..-1
+	uint8_t shift = x & 0x07;
+
+	for (uint8_t r = 0; r < glyph->height; r++) {
+		int16_t row = y + r;
+		if (row < 0) continue;
+		if (row >= rows) break;
+
+		uint8_t bits = glyph->rows[r];
+		if (bits == 0) continue;
+
+		uint8_t* line = buffer + (row * stride);
+		if (column >= 0) line[column] |= bits >> shift;
+		if (shift && column + 1 < stride) line[column + 1] |= bits << (8 - shift);
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ * Glyph cache and blitter for 1 bit per pixel, row packed frame buffers (each row is
+ * width / 8 bytes, MSB is the leftmost pixel; e.g. the alarm clock display buffer).
+ *
+ * Fonts store glyphs as a bit stream (see font.h), which is slow to draw a pixel at a
+ * time.  glyph_get() unpacks a glyph once into one byte per row, already in the buffer's
+ * bit order, and keeps the most used glyphs in a small cache; glyph_blit() then ORs each
+ * row into the buffer with at most two shifted byte writes, whatever the x position.
+ */
+
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include <stdint.h>
+
+#include <font/font.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+//Glyphs may be at most 8 pixels wide and GLYPH_MAX_HEIGHT tall
+#ifndef GLYPH_MAX_HEIGHT
+#define GLYPH_MAX_HEIGHT		8
+#endif
+#ifndef GLYPH_CACHE_SIZE
+#define GLYPH_CACHE_SIZE		8
+#endif
+
+typedef struct glyph_t {
+	uint8_t* font_data;		//Identifies the font; NULL for an empty cache slot
+	char c;
+	uint8_t width;			//Advance width (excluding the 1 pixel gap)
+	uint8_t height;
+	uint8_t hits;			//Use count, for replacement
+	uint8_t rows[GLYPH_MAX_HEIGHT];	//Row packed, MSB is the leftmost pixel
+} glyph_t;
+
+typedef struct glyph_cache_t {
+	glyph_t glyphs[GLYPH_CACHE_SIZE];
+	uint32_t hits;
+	uint32_t misses;
+} glyph_cache_t;
+
+/*
+ * Empties the cache and resets the statistics.
+ */
+void glyph_cache_init(glyph_cache_t* cache);
+
+/*
+ * Unpacks character c of the font into glyph.  Characters which are not in the codepage
+ * are blank (but still have the font's width).
+ */
+void glyph_rasterise(font_t* font, char c, glyph_t* glyph);
+
+/*
+ * Returns the cached glyph for character c, unpacking it into the least used slot if it is
+ * not already cached.  The pointer is valid until the next call.
+ */
+glyph_t* glyph_get(glyph_cache_t* cache, font_t* font, char c);
+
+/*
+ * ORs the glyph into the buffer (stride bytes per row, rows rows) with its top left corner
+ * at x, y.  Parts outside of the buffer are clipped.
+ */
+void glyph_blit(glyph_t* glyph, uint8_t* buffer, uint8_t stride, uint8_t rows, int16_t x, int16_t y);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
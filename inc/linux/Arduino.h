@@ -0,0 +1,17 @@
+/*
+ * Host stand-in for the Teensy <Arduino.h>, so that library code which only needs the
+ * standard headers and Arduino types can be compiled with g++ on Linux and exercised from
+ * a main.test harness.  Hardware access (pins, SPI, timers) is left to the harness.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOW 0
+#define HIGH 1
+
+#endif
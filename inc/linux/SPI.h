@@ -0,0 +1,11 @@
+/*
+ * Host stand-in for the Teensy <SPI.h>.  Drivers compiled on the host have their transfers
+ * replaced by the test harness, so this is only here for the #include.
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+
+#endif
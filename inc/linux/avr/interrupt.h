@@ -0,0 +1,22 @@
+/*
+ * Host stand-in for <avr/interrupt.h>.  ISRs become plain functions which a test harness
+ * can call directly to simulate the interrupt firing.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include "io.h"
+
+#if defined (__cplusplus)
+#define ISR(vector, ...) extern "C" void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void); void vector(void) {}
+#else
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector) void vector(void); void vector(void) {}
+#endif
+
+#define sei() (SREG |= 0x80)
+#define cli() (SREG &= ~0x80)
+
+#endif
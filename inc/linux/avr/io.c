@@ -0,0 +1,3 @@
+#include "io.h"
+
+volatile uint8_t _sfr_mem[0x100];
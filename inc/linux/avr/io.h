@@ -0,0 +1,166 @@
+/*
+ * Host stand-in for <avr/io.h>, so that AVR driver code can be compiled with gcc / g++
+ * on Linux and exercised from a main.test harness.  Registers live in a flat array which
+ * mirrors the ATmega1284p / ATmega168 data space layout, so that code which relies on
+ * register ordering (e.g. DDRx being at PORTx - 1) behaves as it does on the chip.
+ *
+ * Link with io.c (in this directory), which provides the register storage.
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+extern volatile uint8_t _sfr_mem[0x100];
+
+#if defined (__cplusplus)
+}
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+#define _SFR_MEM8(addr) (*(volatile uint8_t*) (_sfr_mem + (addr)))
+#define _SFR_MEM16(addr) (*(volatile uint16_t*) (_sfr_mem + (addr)))
+#define _SFR_IO8(addr) _SFR_MEM8((addr) + 0x20)
+#define _SFR_IO_ADDR(sfr) ((uint8_t) (&(sfr) - _sfr_mem) - 0x20)
+
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!bit_is_set(sfr, bit))
+
+//Ports
+#define PINA _SFR_IO8(0x00)
+#define DDRA _SFR_IO8(0x01)
+#define PORTA _SFR_IO8(0x02)
+#define PINB _SFR_IO8(0x03)
+#define DDRB _SFR_IO8(0x04)
+#define PORTB _SFR_IO8(0x05)
+#define PINC _SFR_IO8(0x06)
+#define DDRC _SFR_IO8(0x07)
+#define PORTC _SFR_IO8(0x08)
+#define PIND _SFR_IO8(0x09)
+#define DDRD _SFR_IO8(0x0A)
+#define PORTD _SFR_IO8(0x0B)
+
+#define PIND0 0
+#define PIND1 1
+#define PIND2 2
+#define PIND3 3
+
+//Interrupt flags
+#define TIFR0 _SFR_IO8(0x15)
+#define TIFR1 _SFR_IO8(0x16)
+#define TIFR2 _SFR_IO8(0x17)
+#define PCIFR _SFR_IO8(0x1B)
+#define EIFR _SFR_IO8(0x1C)
+#define EIMSK _SFR_IO8(0x1D)
+
+#define INT0 0
+#define INT1 1
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIE3 3
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCIF3 3
+
+#define SREG _SFR_IO8(0x3F)
+
+#define PCICR _SFR_MEM8(0x68)
+#define EICRA _SFR_MEM8(0x69)
+#define PCMSK0 _SFR_MEM8(0x6B)
+#define PCMSK1 _SFR_MEM8(0x6C)
+#define PCMSK2 _SFR_MEM8(0x6D)
+#define TIMSK0 _SFR_MEM8(0x6E)
+#define TIMSK1 _SFR_MEM8(0x6F)
+#define TIMSK2 _SFR_MEM8(0x70)
+#define PCMSK3 _SFR_MEM8(0x73)
+
+//Timer 1
+#define TCCR1A _SFR_MEM8(0x80)
+#define TCCR1B _SFR_MEM8(0x81)
+#define TCCR1C _SFR_MEM8(0x82)
+#define TCNT1 _SFR_MEM16(0x84)
+#define ICR1 _SFR_MEM16(0x86)
+#define OCR1A _SFR_MEM16(0x88)
+#define OCR1B _SFR_MEM16(0x8A)
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define FOC1B 6
+#define FOC1A 7
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+#define ICF1 5
+
+//Timer 2
+#define TCCR2A _SFR_MEM8(0xB0)
+#define TCCR2B _SFR_MEM8(0xB1)
+#define TCNT2 _SFR_MEM8(0xB2)
+#define OCR2A _SFR_MEM8(0xB3)
+#define OCR2B _SFR_MEM8(0xB4)
+
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM21 1
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2 0
+
+//Timer 0
+#define TCCR0A _SFR_IO8(0x24)
+#define TCCR0B _SFR_IO8(0x25)
+#define TCNT0 _SFR_IO8(0x26)
+#define OCR0A _SFR_IO8(0x27)
+#define OCR0B _SFR_IO8(0x28)
+
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM01 1
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0 0
+
+//TWI
+#define TWBR _SFR_MEM8(0xB8)
+#define TWSR _SFR_MEM8(0xB9)
+#define TWAR _SFR_MEM8(0xBA)
+#define TWDR _SFR_MEM8(0xBB)
+#define TWCR _SFR_MEM8(0xBC)
+
+#define TWPS0 0
+#define TWPS1 1
+#define TWIE 0
+#define TWEN 2
+#define TWWC 3
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA 6
+#define TWINT 7
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Host stand-in for <avr/pgmspace.h>.  There is only one address space on the host, so
+ * PROGMEM is a no-op and the pgm_read_* functions are plain dereferences.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t*) (addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define pgm_read_word(addr) (*(const uint16_t*) (addr))
+#define pgm_read_dword(addr) (*(const uint32_t*) (addr))
+#define pgm_read_float(addr) (*(const float*) (addr))
+#define pgm_read_ptr(addr) (*(void* const*) (addr))
+
+#define memcpy_P(dest, src, n) memcpy((dest), (src), (n))
+#define strlen_P(s) strlen(s)
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Host stand-in for <util/crc16.h>.
+ */
+
+#ifndef HOST_UTIL_CRC16_H
+#define HOST_UTIL_CRC16_H
+
+#include <stdint.h>
+
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t a) {
+	crc ^= a;
+	for (uint8_t i = 0; i < 8; i++) {
+		if (crc & 1) crc = (crc >> 1) ^ 0xA001;
+		else crc = (crc >> 1);
+	}
+	return crc;
+}
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for <util/delay.h>.  Delays are only there to give hardware time to settle,
+ * so on the host they do nothing.
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#define _delay_us(us)
+#define _delay_ms(ms)
+
+#endif
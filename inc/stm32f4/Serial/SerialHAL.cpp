@@ -1,14 +1,38 @@
 #include "SerialHAL.h"
-#include <dcutil/delay.h>
+#include <stdlib.h>
+#include <string.h>
 
 using namespace digitalcave;
 
 SerialHAL* SerialHAL::instances[SERIAL_HAL_MAX_INSTANCES] = {NULL};
 
-SerialHAL::SerialHAL(UART_HandleTypeDef* huart, uint8_t bufferSize):
-	rxBuffer(bufferSize),
-	huart(huart)
+//The rx / tx state is shared with the ISRs; keep interrupts out while it is being updated
+static inline uint32_t serial_hal_lock(){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+static inline void serial_hal_unlock(uint32_t primask){
+	__set_PRIMASK(primask);
+}
+
+SerialHAL::SerialHAL(UART_HandleTypeDef* huart, uint16_t rxBufferSize, uint16_t txBufferSize):
+	huart(huart),
+	rxSize(rxBufferSize),
+	rxHead(0),
+	rxTail(0),
+	rxPosition(0),
+	rxIdle(0),
+	txSize(txBufferSize ? txBufferSize : rxBufferSize),
+	txHead(0),
+	txTail(0),
+	txChunk(0)
 {
+	resetStats();
+
+	rxData = (uint8_t*) malloc(rxSize);
+	txData = (huart->hdmatx != NULL) ? (uint8_t*) malloc(txSize) : NULL;
+
 	for (uint8_t i = 0; i < SERIAL_HAL_MAX_INSTANCES; i++){
 		if (instances[i] == NULL){
 			instances[i] = this;
@@ -16,81 +40,261 @@ SerialHAL::SerialHAL(UART_HandleTypeDef* huart, uint8_t bufferSize):
 		}
 	}
 
-	HAL_UART_Receive_IT(huart, &incomingByte, 1);	//Start listening
+	//Start listening
+	if (huart->hdmarx != NULL){
+		if (huart->hdmarx->Init.Mode != DMA_CIRCULAR){
+			huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+			HAL_DMA_Init(huart->hdmarx);
+		}
+		HAL_UART_Receive_DMA(huart, rxData, rxSize);
+	}
+	else {
+		HAL_UART_Receive_IT(huart, rxData, 1);
+	}
+}
+
+SerialHAL::~SerialHAL(){
+	if (huart->hdmarx != NULL || txData != NULL) HAL_UART_DMAStop(huart);
+	setIdleDetection(0);
+
+	for (uint8_t i = 0; i < SERIAL_HAL_MAX_INSTANCES; i++){
+		if (instances[i] == this){
+			//Keep the list packed, since the callbacks stop at the first empty slot
+			for (; i < SERIAL_HAL_MAX_INSTANCES - 1; i++) instances[i] = instances[i + 1];
+			instances[SERIAL_HAL_MAX_INSTANCES - 1] = NULL;
+			break;
+		}
+	}
+
+	free(rxData);
+	if (txData != NULL) free(txData);
+}
+
+//Works out how far the rx DMA has got since last time.  Must be called at least twice per trip around the
+// buffer (the half / full transfer interrupts see to that).
+void SerialHAL::updateRx(){
+	uint32_t primask = serial_hal_lock();
+	uint16_t position = rxSize - __HAL_DMA_GET_COUNTER(huart->hdmarx);
+	if (position >= rxSize) position = 0;
+
+	uint16_t received = (position >= rxPosition) ? (position - rxPosition) : (position + rxSize - rxPosition);
+	rxPosition = position;
+	rxHead += received;
+	stats.rxBytes += received;
+	serial_hal_unlock(primask);
 }
 
 uint8_t SerialHAL::read(uint8_t *c){
-	if (!rxBuffer.isEmpty()){
-		if (rxBuffer.read(c)){
-			return 1;
+	if (huart->hdmarx != NULL) updateRx();
+
+	uint32_t head = rxHead;
+	if (head == rxTail) return 0;
+
+	//The oldest bytes have been overwritten; skip to the oldest one which is still there
+	if (head - rxTail > rxSize){
+		stats.overruns += head - rxTail - rxSize;
+		rxTail = head - rxSize;
+	}
+
+	*c = rxData[rxTail % rxSize];
+	rxTail++;
+	return 1;
+}
+
+uint16_t SerialHAL::available(){
+	if (huart->hdmarx != NULL) updateRx();
+
+	uint32_t count = rxHead - rxTail;
+	return count > rxSize ? rxSize : count;
+}
+
+//Starts sending the next contiguous block of the tx ring, unless a transfer is already running
+void SerialHAL::startTx(){
+	uint32_t primask = serial_hal_lock();
+	uint32_t pending = txHead - txTail;
+	if (txChunk == 0 && pending > 0){
+		uint16_t offset = txTail % txSize;
+		uint16_t chunk = (pending < (uint32_t) (txSize - offset)) ? pending : (txSize - offset);
+		txChunk = chunk;
+		if (HAL_UART_Transmit_DMA(huart, txData + offset, chunk) != HAL_OK){
+			//UART busy (or locked); the next write(), flush() or tx complete will try again
+			txChunk = 0;
 		}
 	}
-	return 0;
+	serial_hal_unlock(primask);
 }
 
 uint8_t SerialHAL::write(uint8_t b){
-	HAL_UART_Transmit(huart, &b, 1, 1);
-	HAL_UART_Receive_IT(huart, &incomingByte, 1);	//Restart listening in case something bad happened...
+	if (txData == NULL){
+		HAL_UART_Transmit(huart, &b, 1, 1);
+		if (huart->hdmarx == NULL) HAL_UART_Receive_IT(huart, rxData + (rxHead % rxSize), 1);	//Restart listening in case something bad happened...
+		stats.txBytes++;
+		return 1;
+	}
+
+	while (txHead - txTail >= txSize){
+		startTx();
+	}
+	txData[txHead % txSize] = b;
+	txHead++;
+	startTx();
 	return 1;
 }
 
+uint16_t SerialHAL::write(uint8_t* data, uint16_t len){
+	if (txData == NULL) return Stream::write(data, len);
+
+	uint16_t i = 0;
+	while (i < len){
+		uint32_t space = txSize - (txHead - txTail);
+		if (space == 0){
+			startTx();
+			continue;
+		}
+
+		//Copy as much as fits before the end of the ring
+		uint16_t offset = txHead % txSize;
+		uint16_t count = len - i;
+		if (count > space) count = space;
+		if (count > txSize - offset) count = txSize - offset;
+		memcpy(txData + offset, data + i, count);
+		txHead += count;
+		i += count;
+	}
+	startTx();
+	return len;
+}
+
+void SerialHAL::flush(){
+	while (txData != NULL && txHead != txTail){
+		startTx();
+	}
+}
+
+void SerialHAL::setIdleDetection(uint8_t enabled){
+	if (enabled && huart->hdmarx != NULL){
+		__HAL_UART_CLEAR_IDLEFLAG(huart);
+		__HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+	}
+	else {
+		__HAL_UART_DISABLE_IT(huart, UART_IT_IDLE);
+	}
+}
+
+uint8_t SerialHAL::isIdle(){
+	uint8_t idle = rxIdle;
+	rxIdle = 0;
+	return idle;
+}
+
+serial_hal_stats_t SerialHAL::getStats(){
+	serial_hal_stats_t result;
+	uint32_t primask = serial_hal_lock();
+	result.rxBytes = stats.rxBytes;
+	result.txBytes = stats.txBytes;
+	result.overruns = stats.overruns;
+	result.isrs = stats.isrs;
+	result.idles = stats.idles;
+	serial_hal_unlock(primask);
+	return result;
+}
+
+void SerialHAL::resetStats(){
+	stats.rxBytes = 0;
+	stats.txBytes = 0;
+	stats.overruns = 0;
+	stats.isrs = 0;
+	stats.idles = 0;
+}
+
 void SerialHAL::isr(){
-	//HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_1);
-	rxBuffer.write(incomingByte);
-	HAL_UART_Receive_IT(huart, &incomingByte, 1);
+	stats.isrs++;
+	if (huart->hdmarx != NULL){
+		updateRx();
+	}
+	else {
+		rxHead++;
+		stats.rxBytes++;
+		HAL_UART_Receive_IT(huart, rxData + (rxHead % rxSize), 1);
+	}
+}
+
+void SerialHAL::txIsr(){
+	stats.isrs++;
+	if (txData == NULL) return;
+
+	txTail += txChunk;
+	stats.txBytes += txChunk;
+	txChunk = 0;
+	startTx();
+}
+
+void SerialHAL::idleIsr(){
+	stats.isrs++;
+	stats.idles++;
+	updateRx();
+	rxIdle = 1;
 }
 
 void SerialHAL::error(){
-	// HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_2);
-	// uint8_t error = huart->ErrorCode;
-	// if (error == HAL_UART_ERROR_PE) HAL_UART_Transmit(huart, (uint8_t*) "Error PE; ", 10, 1);
-	// if (error == HAL_UART_ERROR_NE) HAL_UART_Transmit(huart, (uint8_t*) "Error NE; ", 10, 1);
-	// if (error == HAL_UART_ERROR_FE) HAL_UART_Transmit(huart, (uint8_t*) "Error FE; ", 10, 1);
-	// if (error == HAL_UART_ERROR_ORE) HAL_UART_Transmit(huart, (uint8_t*) "Error ORE; ", 11, 1);
-	// if (error == HAL_UART_ERROR_DMA) HAL_UART_Transmit(huart, (uint8_t*) "Error DMA; ", 11, 1);
-	// if (error == HAL_UART_ERROR_NONE) HAL_UART_Transmit(huart, (uint8_t*) "No Error; ", 10, 1);
-	//
-	// uint8_t rxState = huart->RxState;
-	// if (rxState == HAL_UART_STATE_RESET) HAL_UART_Transmit(huart, (uint8_t*) "State Reset; ", 13, 1);
-	// if (rxState == HAL_UART_STATE_READY) HAL_UART_Transmit(huart, (uint8_t*) "State Ready; ", 13, 1);
-	// if (rxState == HAL_UART_STATE_BUSY) HAL_UART_Transmit(huart, (uint8_t*) "State Busy; ", 12, 1);
-	// if (rxState == HAL_UART_STATE_BUSY_TX) HAL_UART_Transmit(huart, (uint8_t*) "State Busy TX; ", 15, 1);
-	// if (rxState == HAL_UART_STATE_BUSY_RX) HAL_UART_Transmit(huart, (uint8_t*) "State Busy RX; ", 15, 1);
-	// if (rxState == HAL_UART_STATE_BUSY_TX_RX) HAL_UART_Transmit(huart, (uint8_t*) "State Busy TX RX; ", 18, 1);
-	// if (rxState == HAL_UART_STATE_TIMEOUT) HAL_UART_Transmit(huart, (uint8_t*) "State Timeout; ", 15, 1);
-	// if (rxState == HAL_UART_STATE_ERROR) HAL_UART_Transmit(huart, (uint8_t*) "State Error; ", 13, 1);
-	//
-	// //See https://my.st.com/public/STe2ecommunities/mcu/Lists/cortex_mx_stm32/Flat.aspx?RootFolder=https%3a%2f%2fmy%2est%2ecom%2fpublic%2fSTe2ecommunities%2fmcu%2fLists%2fcortex_mx_stm32%2fUART%20framing%20error%20on%20STM32F0%20device&FolderCTID=0x01200200770978C69A1141439FE559EB459D7580009C4E14902C3CDE46A77F0FFD06506F5B for instructions on what I did here
-	// __HAL_UART_CLEAR_OREFLAG(huart);
-	// __HAL_UART_CLEAR_NEFLAG(huart);
-	// __HAL_UART_CLEAR_FEFLAG(huart);
-	//
-	// __HAL_UART_DISABLE_IT(huart, UART_IT_ERR);
-
-	HAL_UART_Receive_IT(huart, &incomingByte, 1);
-}
-
-
-//Delegate rx events to the correct serial instance
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
+	stats.isrs++;
+	if (huart->ErrorCode & HAL_UART_ERROR_ORE) stats.overruns++;
+
+	if (huart->hdmarx == NULL){
+		HAL_UART_Receive_IT(huart, rxData + (rxHead % rxSize), 1);
+	}
+	else if ((huart->hdmarx->Instance->CR & DMA_SxCR_EN) == 0){
+		//Rx DMA was stopped by the error; restart it at the beginning of the buffer.  Anything unread is lost.
+		updateRx();
+		uint32_t lost = rxHead - rxTail;
+		stats.overruns += lost;
+		rxHead += (rxSize - (rxHead % rxSize)) % rxSize;
+		rxTail = rxHead;
+		rxPosition = 0;
+		huart->RxState = HAL_UART_STATE_READY;
+		HAL_UART_Receive_DMA(huart, rxData, rxSize);
+	}
+}
+
+
+static SerialHAL* serial_hal_find(UART_HandleTypeDef *huart){
 	for (uint8_t i = 0; i < SERIAL_HAL_MAX_INSTANCES; i++){
 		if (SerialHAL::instances[i] == NULL){
-			return;
+			return NULL;
 		}
 		else if (SerialHAL::instances[i]->getHandleTypeDef() == huart){
-			SerialHAL::instances[i]->isr();
+			return SerialHAL::instances[i];
 		}
 	}
+	return NULL;
+}
+
+//Delegate rx events to the correct serial instance.  In DMA mode these are the half / full buffer events.
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
+	SerialHAL* serial = serial_hal_find(huart);
+	if (serial != NULL) serial->isr();
+}
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart){
+	SerialHAL* serial = serial_hal_find(huart);
+	if (serial != NULL) serial->isr();
+}
+
+//Delegate tx DMA complete events to the correct serial instance
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){
+	SerialHAL* serial = serial_hal_find(huart);
+	if (serial != NULL) serial->txIsr();
 }
 
 //Delegate error events to the correct serial instance
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){
-	for (uint8_t i = 0; i < SERIAL_HAL_MAX_INSTANCES; i++){
-		if (SerialHAL::instances[i] == NULL){
-			return;
-		}
-		else if (SerialHAL::instances[i]->getHandleTypeDef() == huart){
-			SerialHAL::instances[i]->error();
-		}
+	SerialHAL* serial = serial_hal_find(huart);
+	if (serial != NULL) serial->error();
+}
+
+void serial_hal_irq(UART_HandleTypeDef* huart){
+	if (__HAL_UART_GET_FLAG(huart, UART_FLAG_IDLE) != RESET && __HAL_UART_GET_IT_SOURCE(huart, UART_IT_IDLE) != RESET){
+		__HAL_UART_CLEAR_IDLEFLAG(huart);
+		SerialHAL* serial = serial_hal_find(huart);
+		if (serial != NULL) serial->idleIsr();
 	}
 }
@@ -5,9 +5,18 @@
  * You need to enable the USART interrupt in CubeMX, under NVIC Settings for the USART.  Without this, Tx will
  * work but you will never receive anything.
  *
- * Note that this library currently uses blocking mode for writing, and non blocking (1 byte at a time) interrupt mode
- * for reading.  Some people have reported issues with reading one byte at a time when using a fast baud rate and with
- * a busy CPU; if this is encountered, we may need to look at DMA mode to a ring buffer or something.
+ * If the UART has DMA channels configured in CubeMX (Rx as circular, byte width; Tx as normal, byte width) they are
+ * used automatically:
+ *  - Rx DMA runs continuously into the receive buffer; read() takes bytes straight from it, using the DMA counter
+ *    to find out how far it has got, so there is no interrupt per byte.  The half / full transfer interrupts keep
+ *    track of the buffer wrapping, so the buffer must be read at least once per buffer length of incoming data to
+ *    avoid overruns (which are counted).
+ *  - write() copies into a transmit ring buffer and returns; the buffer is sent in chunks by DMA.  write() only
+ *    blocks if the ring is full.
+ * Without DMA the driver falls back to receiving one byte per interrupt and blocking writes.
+ *
+ * To detect the end of a burst of incoming data (line idle), call serial_hal_irq() from the USER CODE section at
+ * the start of the USARTx_IRQHandler, and enable it with setIdleDetection().
  */
 
 #ifndef SERIAL_HAL_H
@@ -16,24 +25,64 @@
 #include "stm32f4xx_hal.h"
 
 #include <Stream.h>
-#include <ArrayStream.h>
 
 #define SERIAL_HAL_MAX_INSTANCES			8
 
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * Handles the line idle interrupt for the given UART.  Call from USARTx_IRQHandler before HAL_UART_IRQHandler().
+ */
+void serial_hal_irq(UART_HandleTypeDef* huart);
+
+#if defined (__cplusplus)
+}
+#endif
+
 namespace digitalcave {
 
+	typedef struct serial_hal_stats_t {
+		uint32_t rxBytes;		//Bytes received
+		uint32_t txBytes;		//Bytes sent
+		uint32_t overruns;		//Receive buffer overruns (bytes lost before they were read) plus UART overrun errors
+		uint32_t isrs;			//Interrupts handled (rx, tx, idle and error)
+		uint32_t idles;			//Line idle events
+	} serial_hal_stats_t;
+
 	class SerialHAL : public Stream {
 		private:
-			ArrayStream rxBuffer;
-			uint8_t incomingByte;
 			UART_HandleTypeDef* huart;
 
+			uint8_t* rxData;
+			uint16_t rxSize;
+			volatile uint32_t rxHead;		//Total bytes received
+			uint32_t rxTail;				//Total bytes read
+			volatile uint16_t rxPosition;	//Last DMA position seen, 0 .. rxSize - 1
+			volatile uint8_t rxIdle;
+
+			uint8_t* txData;
+			uint16_t txSize;
+			volatile uint32_t txHead;		//Total bytes queued
+			volatile uint32_t txTail;		//Total bytes sent
+			volatile uint16_t txChunk;		//Bytes in the DMA transfer in progress, or 0
+
+			volatile serial_hal_stats_t stats;
+
+			void updateRx();
+			void startTx();
+
 		public:
 			//Keep track of instantiated instances, to delegate isr() and error() calls
 			static SerialHAL* instances[SERIAL_HAL_MAX_INSTANCES];
 
-			//Initialize specifying baud rate and all other optional parameters
-			SerialHAL(UART_HandleTypeDef* huart, uint8_t bufferSize);
+			/*
+			 * Creates the serial port on an initialized UART.  The transmit buffer is only used with DMA; if
+			 * txBufferSize is 0 it is the same size as the receive buffer.
+			 */
+			SerialHAL(UART_HandleTypeDef* huart, uint16_t rxBufferSize, uint16_t txBufferSize = 0);
+			~SerialHAL();
 
 			//Return the pointer to the UART; can be used to verify that the ISR only fires on this serial port
 			UART_HandleTypeDef* getHandleTypeDef() { return huart; }
@@ -42,8 +91,39 @@ namespace digitalcave {
 			uint8_t read(uint8_t *b);
 			uint8_t write(uint8_t data);
 
-			//Notify serial library that there is a byte ready for reading.  This MUST be called by the serial read ISR.
+			/*
+			 * Queues the array for sending.  With DMA this is a block copy into the transmit buffer.
+			 */
+			uint16_t write(uint8_t* data, uint16_t len);
+
+			/*
+			 * Returns the number of bytes waiting to be read.
+			 */
+			uint16_t available();
+
+			/*
+			 * Waits until all queued bytes have been handed to the UART.
+			 */
+			void flush();
+
+			/*
+			 * Enables / disables the line idle interrupt; see above.
+			 */
+			void setIdleDetection(uint8_t enabled);
+
+			/*
+			 * Returns 1 if the line has gone idle since the last call (i.e. the end of a burst of data has been
+			 * received), and clears the flag.
+			 */
+			uint8_t isIdle();
+
+			serial_hal_stats_t getStats();
+			void resetStats();
+
+			//Notify serial library of rx / tx progress.  These are called from the HAL callbacks below.
 			void isr();
+			void txIsr();
+			void idleIsr();
 			void error();
 
 			using Stream::read; // Allow other overloaded functions from superclass to show up in subclass.
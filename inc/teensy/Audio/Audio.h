@@ -88,6 +88,7 @@
 #include "play_sd_raw.h"
 #include "play_sd_wav.h"
 #include "play_serialflash_raw.h"
+#include "profiler.h"
 #include "record_queue.h"
 #include "synth_tonesweep.h"
 #include "synth_sine.h"
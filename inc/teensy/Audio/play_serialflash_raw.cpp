@@ -27,11 +27,22 @@
 
 #include "play_serialflash_raw.h"
 #include "spi_interrupt.h"
+#include "utility/voice_mix.h"
 
 extern "C" {
 extern const int16_t lsx_ulaw2linear16[256];
 };
 
+AudioPlaySerialflashRaw * AudioPlaySerialflashRaw::first = NULL;
+uint16_t AudioPlaySerialflashRaw::flash_cycles = 0;
+uint16_t AudioPlaySerialflashRaw::flash_cycles_max = 0;
+uint8_t AudioPlaySerialflashRaw::flash_voices = 0;
+uint8_t AudioPlaySerialflashRaw::flash_reads = 0;
+uint16_t AudioMixerSerialflash::choke_count = 0;
+int32_t AudioMixerSerialflash::choke_max = 0;
+int64_t AudioMixerSerialflash::choke_sum = 0;
+uint64_t AudioMixerSerialflash::choke_sum_squares = 0;
+
 void AudioPlaySerialflashRaw::begin(void)
 {
 	playing = 0;
@@ -63,6 +74,10 @@ void AudioPlaySerialflashRaw::stop(void)
 	__disable_irq();
 	if (playing) {
 		playing = 0;
+		if (block) {
+			release(block);
+			block = NULL;
+		}
 		__enable_irq();
 		rawfile.close();
 		AudioStopUsingSPI();
@@ -71,59 +86,257 @@ void AudioPlaySerialflashRaw::stop(void)
 	}
 }
 
+// Allocates a block for this voice, and fills in the read for it.  Returns
+// false if it doesn't need one, or there are no blocks left.
+bool AudioPlaySerialflashRaw::request(SerialFlashRead *r)
+{
+	if (!playing || block || !rawfile.available()) return false;
+	block = allocate();
+	if (block == NULL) return false;
+	// u-law is one byte per sample, PCM two
+	uint32_t len = (playing == 0x01) ? AUDIO_BLOCK_SAMPLES : AUDIO_BLOCK_SAMPLES * 2;
+	uint32_t position = rawfile.position();
+	if (len > rawfile.available()) len = rawfile.available();
+	r->addr = rawfile.getFlashAddress() + position;
+	r->buf = block->data;
+	r->len = len;
+	rawfile.seek(position + len);
+	block_bytes = len;
+	return true;
+}
+
+// Reads the next block for every voice which is playing, in one SPI
+// transaction, instead of each voice starting its own.  Called by the first
+// voice to update in each audio cycle; the others find their block waiting.
+void AudioPlaySerialflashRaw::readAll(AudioPlaySerialflashRaw *caller)
+{
+	SerialFlashRead list[SERIALFLASH_RAW_BATCH];
+	AudioPlaySerialflashRaw *p;
+	uint32_t cycles = ARM_DWT_CYCCNT;
+	uint8_t count = 0;
+
+	if (!caller->request(&list[count])) return;
+	count++;
+	for (p = first; p && count < SERIALFLASH_RAW_BATCH; p = p->next) {
+		if (p != caller && p->request(&list[count])) count++;
+	}
+	flash_reads = SerialFlash.read(list, count);
+	flash_voices = count;
+	cycles = (ARM_DWT_CYCCNT - cycles) >> 4;
+	flash_cycles = cycles;
+	if (cycles > flash_cycles_max) flash_cycles_max = cycles;
+}
+
+// Makes sure this voice's next block has been read (along with all the
+// others, by readAll()).  Returns false if there isn't one; at the end of the
+// file, stops playing.
+bool AudioPlaySerialflashRaw::fetch(void)
+{
+	if (!playing) return false;
+	if (block) return true;
+	if (!rawfile.available()) {
+		rawfile.close();
+		AudioStopUsingSPI();
+		playing = 0;
+		//Serial.println("Finished playing sample");		//TODO
+		return false;
+	}
+	readAll(this);
+	// no audio blocks left to read into
+	return block != NULL;
+}
+
 void AudioPlaySerialflashRaw::update(void)
 {
 	int16_t i;		//This needs to be signed for ulaw decoding
 	uint16_t n;
-	audio_block_t *block;
+	audio_block_t *b;
 
 	// only update if we're playing
-	if (!playing) return;
+	if (!fetch()) return;
+	b = block;
+	block = NULL;
+	n = block_bytes;
+	file_offset += n;
 
-	// allocate the audio blocks to transmit
-	block = allocate();
-	if (block == NULL) return;
-
-	if (rawfile.available()) {
-		switch (playing) {
-			case 0x01: // u-law encoded, 44100 Hz
-				//In ulaw we encode 16 bits of audio data (well, effectively 14 bits...) into 8 bits on file.
-				// To decode it, we first read AUDIO_BLOCK_SAMPLES bytes.  We then expand these into 
-				// AUDIO_BLOCK_SAMPLES * 2 bytes (or, AUDIO_BLOCK_SAMPLES * 16 bit samples) using the ulaw
-				// lookup table.  Be sure to zero out unused block data if this is at the end of the
-				// file.
-				n = rawfile.read(block->data, AUDIO_BLOCK_SAMPLES);
-				file_offset += n;
-				n &= 0xFFFE;	//We don't want an odd number (which would only happen at the end), or else we end samples with clicks.
-				for (i = AUDIO_BLOCK_SAMPLES-1; i >= 0; i-=2) {
-					if (i > n) {
-						block->data[i] = 0;	//Zero out data after the end of the file
-						block->data[i-1] = 0;
-					}
-					else {
-						block->data[i] = lsx_ulaw2linear16[block->data[i>>1] & 0xFF];
-						block->data[i-1] = lsx_ulaw2linear16[(block->data[i>>1] >> 8) & 0xFF];
-					}
+	switch (playing) {
+		case 0x01: // u-law encoded, 44100 Hz
+			//In ulaw we encode 16 bits of audio data (well, effectively 14 bits...) into 8 bits on file.
+			// To decode it, we first read AUDIO_BLOCK_SAMPLES bytes.  We then expand these into 
+			// AUDIO_BLOCK_SAMPLES * 2 bytes (or, AUDIO_BLOCK_SAMPLES * 16 bit samples) using the ulaw
+			// lookup table.  Be sure to zero out unused block data if this is at the end of the
+			// file.
+			n &= 0xFFFE;	//We don't want an odd number (which would only happen at the end), or else we end samples with clicks.
+			for (i = AUDIO_BLOCK_SAMPLES-1; i >= 0; i-=2) {
+				if (i > n) {
+					b->data[i] = 0;	//Zero out data after the end of the file
+					b->data[i-1] = 0;
 				}
-				break;
-			case 0x81: // 16 bit PCM, 44100 Hz
-				// we can read more data from the file...
-				n = rawfile.read(block->data, AUDIO_BLOCK_SAMPLES*2);
-				file_offset += n;
-				//Zero out any data after the end of the file
-				for (i=n/2; i < AUDIO_BLOCK_SAMPLES; i++) {
-					block->data[i] = 0;
+				else {
+					//Samples i-1 and i are the low and high bytes of word i/2
+					b->data[i] = lsx_ulaw2linear16[(b->data[i>>1] >> 8) & 0xFF];
+					b->data[i-1] = lsx_ulaw2linear16[b->data[i>>1] & 0xFF];
 				}
-				break;
+			}
+			break;
+		case 0x81: // 16 bit PCM, 44100 Hz
+			//Zero out any data after the end of the file
+			for (i=n/2; i < AUDIO_BLOCK_SAMPLES; i++) {
+				b->data[i] = 0;
+			}
+			break;
+	}
+	transmit(b);
+	release(b);
+}
+
+void AudioMixerSerialflash::update(void)
+{
+	audio_block_t *out=NULL;
+	AudioPlaySerialflashRaw *p;
+	uint32_t cycles = 0, count = 0, start, n;
+	int32_t mult, step;
+	unsigned int channel;
+
+	for (channel=0; channel < 16; channel++) {
+		p = voices[channel];
+		// the first voice to fetch reads the blocks for all of them
+		if (!p || !p->fetch()) {
+			// the file ended, or was stopped, before the fade did
+			if (!p || !p->playing) fades[channel].curve = NULL;
+			continue;
+		}
+		if (!out) {
+			out = allocate();
+			if (!out) return;
+			memset(out->data, 0, sizeof(out->data));
 		}
-		transmit(block);
+		start = ARM_DWT_CYCCNT;
+		n = p->playing == 0x01 ? p->block_bytes : p->block_bytes / 2;
+		if (fades[channel].curve) {
+			// the gain ramps down, sample by sample, and stops at the end of the fade
+			n = voice_fade_next(&fades[channel], n, multiplier[channel], &mult, &step);
+			if (p->playing == 0x01) {
+				voice_mix_ulaw_ramp(out->data, (const uint8_t *)p->block->data, n, mult, step);
+			} else {
+				voice_mix_pcm_ramp(out->data, p->block->data, n, mult, step);
+			}
+		} else if (p->playing == 0x01) {
+			voice_mix_ulaw(out->data, (const uint8_t *)p->block->data, n, multiplier[channel]);
+		} else {
+			voice_mix_pcm(out->data, p->block->data, n, multiplier[channel]);
+		}
+		cycles += ARM_DWT_CYCCNT - start;
+		count++;
+		p->file_offset += p->block_bytes;
+		release(p->block);
+		p->block = NULL;
+		if (fades[channel].curve && voice_fade_done(&fades[channel])) fadeDone(channel, n);
+	}
+	if (out) {
+		voice_cycles = cycles / count;
+		transmit(out);
+		release(out);
+	}
+}
+
+// The fade on this channel reached silence after this many samples of the
+// block just mixed; stop its player (as fetch() does at the end of the
+// file), and record how long it took.
+void AudioMixerSerialflash::fadeDone(unsigned int channel, uint32_t samples)
+{
+	AudioPlaySerialflashRaw *p = voices[channel];
+
+	fades[channel].curve = NULL;
+	p->rawfile.close();
+	AudioStopUsingSPI();
+	p->playing = 0;
+
+	if (fade_us[channel] == 0) return;
+	uint32_t silence = micros() + (uint32_t)(samples * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT);
+	int32_t late = (int32_t)(silence - fade_start[channel] - fade_us[channel]);
+	if (choke_count == 0 || late > choke_max) choke_max = late;
+	choke_sum += late;
+	choke_sum_squares += (int64_t)late * late;
+	if (choke_count < 0xFFFF) choke_count++;
+}
+
+void AudioMixerSerialflash::fade(unsigned int channel, const uint16_t *curve, uint32_t rate)
+{
+	if (channel >= 16 || !curve) return;
+	if (rate == 0) rate = 1;
+	uint32_t samples = (((uint32_t)VOICE_FADE_POINTS << 16) + rate - 1) / rate;
+	uint32_t us = samples * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT;
+
+	__disable_irq();
+	voice_fade_t *f = &fades[channel];
+	if (f->curve) {
+		if (rate > f->rate) f->rate = rate;
+		fade_us[channel] = 0;	// it no longer takes its own fade time
 	} else {
-		rawfile.close();
-		AudioStopUsingSPI();
-		playing = 0;
-		//Serial.println("Finished playing sample");		//TODO
+		f->curve = curve;
+		f->position = 0;
+		f->rate = rate;
+		fade_start[channel] = micros();
+		fade_us[channel] = us;
+	}
+	__enable_irq();
+}
+
+void AudioMixerSerialflash::fadeCancel(unsigned int channel)
+{
+	int32_t mult, step;
+
+	if (channel >= 16) return;
+	__disable_irq();
+	if (fades[channel].curve) {
+		voice_fade_next(&fades[channel], 0, multiplier[channel], &mult, &step);
+		multiplier[channel] = mult;
+		fades[channel].curve = NULL;
 	}
-	release(block);
+	__enable_irq();
+}
+
+float AudioMixerSerialflash::chokeLatencyMean(void)
+{
+	if (choke_count == 0) return 0;
+	__disable_irq();
+	float mean = (float)choke_sum / choke_count;
+	__enable_irq();
+	return mean;
+}
+
+float AudioMixerSerialflash::chokeLatencyJitter(void)
+{
+	if (choke_count == 0) return 0;
+	__disable_irq();
+	float mean = (float)choke_sum / choke_count;
+	float variance = (float)choke_sum_squares / choke_count - mean * mean;
+	__enable_irq();
+	return variance > 0 ? sqrtf(variance) : 0;
+}
+
+void AudioMixerSerialflash::chokeLatencyReset(void)
+{
+	__disable_irq();
+	choke_count = 0;
+	choke_max = 0;
+	choke_sum = 0;
+	choke_sum_squares = 0;
+	__enable_irq();
+}
+
+uint16_t AudioPlaySerialflashRaw::maxPolyphony(void)
+{
+	// one block period, in the same units as the cycle counts (CPU cycles / 16)
+	const uint32_t period = (uint32_t)(F_CPU / 16 / AUDIO_SAMPLE_RATE_EXACT * AUDIO_BLOCK_SAMPLES);
+	uint32_t cycles = flash_cycles, others = 0, n;
+
+	if (flash_voices == 0 || cycles == 0) return 0;
+	if (AudioStream::cpu_cycles_total > cycles) others = AudioStream::cpu_cycles_total - cycles;
+	if (others >= period) return 0;
+	n = (period - others) * flash_voices / cycles;
+	return n > 0xFFFF ? 0xFFFF : n;
 }
 
 #define B2M (uint32_t)((double)4294967296000.0 / AUDIO_SAMPLE_RATE_EXACT / 2.0) // 97352592
@@ -30,11 +30,26 @@
 
 #include <AudioStream.h>
 #include <SerialFlash.h>
+#include "utility/voice_mix.h"
+
+// Most voices read from flash together in one audio update; any more are read
+// in a second batch
+#ifndef SERIALFLASH_RAW_BATCH
+#define SERIALFLASH_RAW_BATCH 32
+#endif
+
+class AudioMixerSerialflash;
 
 class AudioPlaySerialflashRaw : public AudioStream
 {
+	friend class AudioMixerSerialflash;
 public:
-	AudioPlaySerialflashRaw(void) : AudioStream(0, NULL) { begin(); }
+	AudioPlaySerialflashRaw(void) : AudioStream(0, NULL) {
+		block = NULL;
+		begin();
+		next = first;
+		first = this;
+	}
 	void begin(void);
 	bool play(const char *filename);
 	void stop(void);
@@ -42,11 +57,100 @@ public:
 	uint32_t positionMillis(void);
 	uint32_t lengthMillis(void);
 	virtual void update(void);
+	// Time spent reading from flash for all voices, as a percent of the audio
+	// block time (the SPI bus is busy for all of it), like AudioProcessorUsage()
+	static int flashUsage(void) { return CYCLE_COUNTER_APPROX_PERCENT(flash_cycles); }
+	static int flashUsageMax(void) { return CYCLE_COUNTER_APPROX_PERCENT(flash_cycles_max); }
+	static void flashUsageMaxReset(void) { flash_cycles_max = flash_cycles; }
+	// Flash reads (commands) in the last block, after joining neighbouring reads
+	static uint8_t flashReads(void) { return flash_reads; }
+	// How many voices could play at once before the audio update runs out of
+	// time, going by the cost per voice of the last block and the time taken
+	// by everything else.  0 until something has played.
+	static uint16_t maxPolyphony(void);
 private:
+	static void readAll(AudioPlaySerialflashRaw *caller);
+	bool request(SerialFlashRead *r);
+	bool fetch(void);
+	static AudioPlaySerialflashRaw *first;	// all instances, for readAll()
+	static uint16_t flash_cycles;
+	static uint16_t flash_cycles_max;
+	static uint8_t flash_voices;
+	static uint8_t flash_reads;
+	AudioPlaySerialflashRaw *next;
+	audio_block_t *block;	// read by readAll(), for the next update()
+	uint16_t block_bytes;
 	SerialFlashFile rawfile;
 	uint32_t file_size;
 	volatile uint32_t file_offset;
 	volatile uint8_t playing;
 };
 
+// Mixes up to 16 AudioPlaySerialflashRaw players, decoding each one's block
+// straight into the mix with its gain, in one pass (see utility/voice_mix.h),
+// instead of the players each sending a decoded block to an AudioMixer16.
+// Use voice() in place of an AudioConnection from each player; connect the
+// output as normal.  Gains work as for AudioMixer16.  Each channel can also
+// be faded out to silence sample by sample, from inside the update, and its
+// player then stopped.
+class AudioMixerSerialflash : public AudioStream
+{
+public:
+	AudioMixerSerialflash(void) : AudioStream(0, NULL) {
+		for (int i=0; i<16; i++) {
+			voices[i] = NULL;
+			multiplier[i] = 65536;
+			fades[i].curve = NULL;
+			fade_start[i] = 0;
+			fade_us[i] = 0;
+		}
+		voice_cycles = 0;
+	}
+	virtual void update(void);
+	void voice(unsigned int channel, AudioPlaySerialflashRaw &player) {
+		if (channel >= 16) return;
+		voices[channel] = &player;
+	}
+	void gain(unsigned int channel, float gain) {
+		if (channel >= 16) return;
+		if (gain > 32767.0f) gain = 32767.0f;
+		else if (gain < 0.0f) gain = 0.0f;
+		multiplier[channel] = gain * 65536.0f;
+	}
+	// Fades the channel out from the next update, along curve (see
+	// voice_fade_curve(); it must stay in memory) at rate (see
+	// voice_fade_rate()), then stops its player.  If the channel is already
+	// fading, the fade carries on from where it is, sped up if rate is faster.
+	void fade(unsigned int channel, const uint16_t *curve, uint32_t rate);
+	// Stops a fade, leaving the gain where the fade had got to
+	void fadeCancel(unsigned int channel);
+	bool isFading(unsigned int channel) {
+		if (channel >= 16) return false;
+		return fades[channel].curve != NULL;
+	}
+	// CPU cycles to decode and mix one voice's block, over the last update
+	uint16_t voiceCycles(void) { return voice_cycles; }
+	// Choke to silence timing: how much longer than its fade time each fade
+	// took, from fade() to the sample where it reached silence, in
+	// microseconds.  This is the time until the fade starts (up to a block,
+	// wherever the main loop happens to be), plus the final block's share.
+	static uint16_t chokeCount(void) { return choke_count; }
+	static float chokeLatencyMean(void);
+	static float chokeLatencyJitter(void);	// standard deviation
+	static int32_t chokeLatencyMax(void) { return choke_count ? choke_max : 0; }
+	static void chokeLatencyReset(void);
+private:
+	void fadeDone(unsigned int channel, uint32_t samples);
+	AudioPlaySerialflashRaw *voices[16];
+	int32_t multiplier[16];
+	voice_fade_t fades[16];
+	uint32_t fade_start[16];	// micros() at fade()
+	uint32_t fade_us[16];		// the fade time, or 0 not to time it
+	uint16_t voice_cycles;
+	static uint16_t choke_count;
+	static int32_t choke_max;
+	static int64_t choke_sum;
+	static uint64_t choke_sum_squares;
+};
+
 #endif
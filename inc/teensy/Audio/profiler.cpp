@@ -0,0 +1,145 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "profiler.h"
+
+static inline uint8_t * put16(uint8_t *p, uint16_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+	return p + 2;
+}
+
+void AudioProfiler::reset(void)
+{
+	AudioStream *p;
+	uint32_t i;
+
+	__disable_irq();
+	for (p = AudioStream::first_update; p; p = p->next_update) {
+		p->cpu_cycles_max = p->cpu_cycles;
+		p->cpu_cycles_min = 0xFFFF;
+		p->cpu_cycles_sum = 0;
+		p->update_count = 0;
+		p->alloc_failures = 0;
+	}
+	for (i=0; i < AUDIO_PROFILE_OBJECTS; i++) {
+		AudioStream::blocks_held_max[i] = AudioStream::blocks_held[i];
+	}
+	for (i=0; i < AUDIO_PROFILE_BUCKETS; i++) {
+		AudioStream::update_histogram[i] = 0;
+	}
+	AudioStream::update_all_count = 0;
+	AudioStream::alloc_failure_updates = 0;
+	AudioStream::cpu_cycles_total_max = AudioStream::cpu_cycles_total;
+	AudioStream::memory_used_max = AudioStream::memory_used;
+	__enable_irq();
+}
+
+uint16_t AudioProfiler::dump(uint8_t *buf, uint16_t size)
+{
+	AudioStream *p;
+	uint8_t *b = buf;
+	uint32_t count = 0, i;
+
+	if (size < AUDIO_PROFILE_HEADER_SIZE) return 0;
+	for (p = AudioStream::first_update; p; p = p->next_update) count++;
+	if (count > 255) count = 255;
+	i = (uint32_t)(size - AUDIO_PROFILE_HEADER_SIZE) / AUDIO_PROFILE_OBJECT_SIZE;
+	if (count > i) count = i;
+
+	// each part is copied with interrupts off, so that it is consistent
+	__disable_irq();
+	*b++ = 'A';
+	*b++ = 'P';
+	*b++ = AUDIO_PROFILE_VERSION;
+	*b++ = count;
+	b = put16(b, (uint16_t)(F_CPU / 16 / AUDIO_SAMPLE_RATE * AUDIO_BLOCK_SAMPLES));
+	b = put16(b, AudioStream::cpu_cycles_total_max);
+	b = put16(b, AudioStream::update_all_count);
+	b = put16(b, AudioStream::update_all_count >> 16);
+	b = put16(b, AudioStream::alloc_failure_updates);
+	*b++ = AudioStream::memory_used;
+	*b++ = AudioStream::memory_used_max;
+	*b++ = AudioStream::blocks_held_max[0];
+	*b++ = 0;
+	for (i=0; i < AUDIO_PROFILE_BUCKETS; i++) {
+		b = put16(b, AudioStream::update_histogram[i]);
+	}
+	__enable_irq();
+
+	for (p = AudioStream::first_update; p && count; p = p->next_update, count--) {
+		__disable_irq();
+		uint8_t index = p->profile_index;
+		*b++ = index;
+		*b++ = p->active ? 0x01 : 0x00;
+		b = put16(b, p->update_count ? p->cpu_cycles_min : 0);
+		b = put16(b, p->update_count ? p->cpu_cycles_sum / p->update_count : 0);
+		b = put16(b, p->cpu_cycles_max);
+		b = put16(b, p->alloc_failures);
+		// objects past AUDIO_PROFILE_OBJECTS share index 0, so can't be told apart
+		*b++ = index ? AudioStream::blocks_held[index] : 0;
+		*b++ = index ? AudioStream::blocks_held_max[index] : 0;
+		__enable_irq();
+	}
+	return b - buf;
+}
+
+void AudioProfiler::print(Print &out)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	uint8_t buf[AUDIO_PROFILE_HEADER_SIZE + AUDIO_PROFILE_OBJECT_SIZE * 32];
+	uint16_t len, i;
+
+	len = dump(buf, sizeof(buf));
+	out.print("PROFILE ");
+	for (i=0; i < len; i++) {
+		out.write(hex[buf[i] >> 4]);
+		out.write(hex[buf[i] & 0x0F]);
+	}
+	out.println();
+}
+
+uint32_t AudioProfiler::late(void)
+{
+	uint32_t count = 0, i;
+
+	for (i=10; i < AUDIO_PROFILE_BUCKETS; i++) {
+		count += AudioStream::update_histogram[i];
+	}
+	return count;
+}
+
+AudioStream * AudioProfiler::slowest(void)
+{
+	AudioStream *p, *slowest = NULL;
+
+	for (p = AudioStream::first_update; p; p = p->next_update) {
+		if (p->active && (!slowest || p->cpu_cycles_max > slowest->cpu_cycles_max)) slowest = p;
+	}
+	return slowest;
+}
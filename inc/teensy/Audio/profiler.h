@@ -0,0 +1,82 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef profiler_h_
+#define profiler_h_
+
+#include "AudioStream.h"
+#include "Print.h"
+
+// Dump format version, the first byte after the "AP" signature
+#define AUDIO_PROFILE_VERSION 1
+#define AUDIO_PROFILE_HEADER_SIZE (18 + AUDIO_PROFILE_BUCKETS * 2)
+#define AUDIO_PROFILE_OBJECT_SIZE 12
+
+// Collects what the audio library is doing, to size AudioMemory() and the
+// number of voices by measurement rather than by listening for glitches.
+// AudioStream keeps, for every object: update() cycles (min / average /
+// max), allocations which failed in its update(), and the blocks it has
+// allocated which are still in use (now and at most); and for update_all()
+// as a whole, a histogram of how long it took against the block period.
+//
+// dump() packs it all into a few hundred bytes, all little endian:
+//   0  'A', 'P', version, object count
+//   4  block period in cycles / 16 (the unit of all the cycle counts)
+//   6  cpu_cycles_total_max
+//   8  update_all() runs (32 bits)
+//  12  update_all() runs in which an allocation failed
+//  14  blocks in use now, and at most
+//  16  blocks allocated outside of any update(), at most; 0
+//  18  histogram: update_all() runs taking 0-10%, 10-20% ... of the block
+//      period; the 11th bucket on were late, and the last counts all longer
+//  then for each object, in update order:
+//   0  profile index (1 up, in order of construction), flags (bit 0: active)
+//   2  update() cycles min, average, max
+//   8  failed allocations
+//  10  blocks in use now, and at most
+class AudioProfiler
+{
+public:
+	// Clears the minimums, maximums, averages and counts
+	static void reset(void);
+	// Writes the profile to buf; returns the bytes written.  Objects which
+	// don't fit are left off (AUDIO_PROFILE_HEADER_SIZE, plus
+	// AUDIO_PROFILE_OBJECT_SIZE per object, is enough); 0 if not even the
+	// header fits.
+	static uint16_t dump(uint8_t *buf, uint16_t size);
+	// Prints the dump (of up to 32 objects) as one line of hex after
+	// "PROFILE ", for a host to decode
+	static void print(Print &out);
+	// update_all() runs which took longer than the block period
+	static uint32_t late(void);
+	// update_all() runs in which an allocation failed
+	static uint16_t allocationFailures(void) { return AudioStream::alloc_failure_updates; }
+	// The object with the longest update() so far, or NULL
+	static AudioStream * slowest(void);
+};
+
+#endif
@@ -0,0 +1,204 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <Arduino.h>
+#include <math.h>
+#include "voice_mix.h"
+#if defined(KINETISK)
+#include "dspinst.h"
+#endif
+
+extern "C" {
+extern const int16_t lsx_ulaw2linear16[256];
+};
+
+#define MULTI_UNITYGAIN 65536
+
+static inline int32_t saturate16(int32_t val)
+{
+	if (val > 32767) return 32767;
+	if (val < -32768) return -32768;
+	return val;
+}
+
+void voice_mix_ulaw_reference(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		int32_t val = ((int64_t)mult * lsx_ulaw2linear16[src[i]]) >> 16;
+		dst[i] = saturate16(dst[i] + saturate16(val));
+	}
+}
+
+void voice_mix_pcm_reference(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		int32_t val = ((int64_t)mult * src[i]) >> 16;
+		dst[i] = saturate16(dst[i] + saturate16(val));
+	}
+}
+
+void voice_mix_ulaw_ramp(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult, int32_t step)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		int32_t val = ((int64_t)mult * lsx_ulaw2linear16[src[i]]) >> 16;
+		dst[i] = saturate16(dst[i] + saturate16(val));
+		mult += step;
+	}
+}
+
+void voice_mix_pcm_ramp(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult, int32_t step)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		int32_t val = ((int64_t)mult * src[i]) >> 16;
+		dst[i] = saturate16(dst[i] + saturate16(val));
+		mult += step;
+	}
+}
+
+#define FADE_END ((uint32_t)VOICE_FADE_POINTS << 16)
+
+void voice_fade_curve(uint16_t *curve, float range_db)
+{
+	// shifted down so that the last point is exactly silent
+	float floor = powf(10.0f, -range_db / 20.0f);
+	for (int i = 0; i <= VOICE_FADE_POINTS; i++) {
+		float gain = powf(10.0f, -range_db * i / VOICE_FADE_POINTS / 20.0f);
+		curve[i] = (gain - floor) / (1.0f - floor) * 65535.0f + 0.5f;
+	}
+	curve[VOICE_FADE_POINTS] = 0;
+}
+
+uint32_t voice_fade_rate(uint32_t ms, float sample_rate)
+{
+	float samples = ms * sample_rate / 1000.0f;
+	if (samples < 1.0f) return FADE_END;
+	return (float)FADE_END / samples + 0.5f;
+}
+
+// the curve's gain at position, with 16 fractional bits
+static uint32_t fade_gain(const uint16_t *curve, uint32_t position)
+{
+	uint32_t i = position >> 16;
+	if (i >= VOICE_FADE_POINTS) return 0;
+	int32_t slope = (int32_t)curve[i + 1] - curve[i];
+	return curve[i] + (((int64_t)slope * (position & 0xFFFF)) >> 16);
+}
+
+uint32_t voice_fade_next(voice_fade_t *fade, uint32_t n, int32_t mult, int32_t *start, int32_t *step)
+{
+	uint64_t end = fade->position + (uint64_t)fade->rate * n;
+
+	// the last samples of the fade: only as many as it takes to reach silence
+	if (end >= FADE_END) {
+		n = (FADE_END - fade->position + fade->rate - 1) / fade->rate;
+		end = FADE_END;
+	}
+	int32_t from = ((int64_t)mult * fade_gain(fade->curve, fade->position)) >> 16;
+	int32_t to = ((int64_t)mult * fade_gain(fade->curve, end)) >> 16;
+	*start = from;
+	*step = n ? (to - from) / (int32_t)n : 0;
+	fade->position = end;
+	return n;
+}
+
+#if defined(KINETISK)
+
+// scales the two samples packed in in, and adds them to the two in sum,
+// saturating; the same steps as applyGainThenAdd() in mixer.cpp
+static inline uint32_t gain_add(uint32_t sum, uint32_t in, int32_t mult) __attribute__((always_inline, unused));
+static inline uint32_t gain_add(uint32_t sum, uint32_t in, int32_t mult)
+{
+	int32_t val1 = signed_multiply_32x16b(mult, in);
+	int32_t val2 = signed_multiply_32x16t(mult, in);
+	val1 = signed_saturate_rshift(val1, 16, 0);
+	val2 = signed_saturate_rshift(val2, 16, 0);
+	return signed_add_16_and_16(sum, pack_16b_16b(val2, val1));
+}
+
+void voice_mix_ulaw(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult)
+{
+	uint32_t *d = (uint32_t *)dst;
+	const uint8_t *end = src + (n & ~3);
+	const int16_t *table = lsx_ulaw2linear16;
+
+	// four samples at a time: one byte load each, and two packed adds
+	if (mult == MULTI_UNITYGAIN) {
+		while (src < end) {
+			uint32_t lo = pack_16b_16b(table[src[1]], table[src[0]]);
+			uint32_t hi = pack_16b_16b(table[src[3]], table[src[2]]);
+			d[0] = signed_add_16_and_16(d[0], lo);
+			d[1] = signed_add_16_and_16(d[1], hi);
+			d += 2;
+			src += 4;
+		}
+	} else {
+		while (src < end) {
+			uint32_t lo = pack_16b_16b(table[src[1]], table[src[0]]);
+			uint32_t hi = pack_16b_16b(table[src[3]], table[src[2]]);
+			d[0] = gain_add(d[0], lo, mult);
+			d[1] = gain_add(d[1], hi, mult);
+			d += 2;
+			src += 4;
+		}
+	}
+	// the last few samples of a file
+	if (n & 3) voice_mix_ulaw_reference((int16_t *)d, src, n & 3, mult);
+}
+
+void voice_mix_pcm(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult)
+{
+	uint32_t *d = (uint32_t *)dst;
+	const uint32_t *s = (const uint32_t *)src;
+	const uint32_t *end = s + (n >> 1);
+
+	if (mult == MULTI_UNITYGAIN) {
+		while (s < end) {
+			*d = signed_add_16_and_16(*d, *s++);
+			d++;
+		}
+	} else {
+		while (s < end) {
+			*d = gain_add(*d, *s++, mult);
+			d++;
+		}
+	}
+	if (n & 1) voice_mix_pcm_reference((int16_t *)d, (const int16_t *)s, 1, mult);
+}
+
+#else
+
+void voice_mix_ulaw(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult)
+{
+	voice_mix_ulaw_reference(dst, src, n, mult);
+}
+
+void voice_mix_pcm(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult)
+{
+	voice_mix_pcm_reference(dst, src, n, mult);
+}
+
+#endif
@@ -0,0 +1,88 @@
+/* Audio Library for Teensy 3.X
+ * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
+ *
+ * Development of this audio library was funded by PJRC.COM, LLC by sales of
+ * Teensy and Audio Adaptor boards.  Please support PJRC's efforts to develop
+ * open source software by purchasing Teensy or other PJRC products.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, development funding notice, and this permission
+ * notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef voice_mix_h_
+#define voice_mix_h_
+
+#include <stdint.h>
+
+// Fused decode, gain and mix for sample playback: n samples from src are
+// multiplied by mult (65536 is unity gain, as in AudioMixer16) and added to
+// dst, saturating, in one pass, instead of decoding into a block which a
+// mixer then reads again.  The result is exactly what decoding and then
+// AudioMixer16 would give.  dst (and src, for PCM) must be 32 bit aligned.
+
+// src is u-law, one byte per sample
+void voice_mix_ulaw(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult);
+
+// src is 16 bit PCM
+void voice_mix_pcm(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult);
+
+// Plain C versions, one sample at a time, which define the result.  On
+// Teensy 3.x the functions above use the Cortex-M4 DSP instructions; these
+// are used everywhere else, and to test them against.
+void voice_mix_ulaw_reference(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult);
+void voice_mix_pcm_reference(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult);
+
+// The same, but with a gain ramp: mult is the gain for the first sample, and
+// step is added to it for each one after.  Plain C everywhere; only voices
+// which are fading out use these.
+void voice_mix_ulaw_ramp(int16_t *dst, const uint8_t *src, uint32_t n, int32_t mult, int32_t step);
+void voice_mix_pcm_ramp(int16_t *dst, const int16_t *src, uint32_t n, int32_t mult, int32_t step);
+
+// Fades run inside the audio update, sample by sample, so they take the same
+// time however busy the rest of the program is.  A fade follows a curve of
+// VOICE_FADE_POINTS + 1 gains, from 65535 (the voice's own gain) down to 0,
+// interpolated linearly between the points; rate is how far along the curve
+// it moves each sample, with 16 fractional bits.
+#define VOICE_FADE_POINTS 32
+
+typedef struct voice_fade_struct {
+	const uint16_t *curve;	// NULL when not fading
+	uint32_t position;	// along the curve, with 16 fractional bits
+	uint32_t rate;
+} voice_fade_t;
+
+// Fills in curve with an exponential fade, falling range_db over its length
+// and then meeting 0 at the end
+void voice_fade_curve(uint16_t *curve, float range_db);
+
+// The rate for a fade lasting ms milliseconds at sample_rate
+uint32_t voice_fade_rate(uint32_t ms, float sample_rate);
+
+// Moves a fade on by up to n samples of a voice whose gain is mult.  Sets
+// *start and *step for the ramp to mix them with, and returns how many to
+// mix; fewer than n once the fade reaches silence, after which the voice can
+// be stopped.
+uint32_t voice_fade_next(voice_fade_t *fade, uint32_t n, int32_t mult, int32_t *start, int32_t *step);
+
+static inline int voice_fade_done(const voice_fade_t *fade)
+{
+	return fade->position >= ((uint32_t)VOICE_FADE_POINTS << 16);
+}
+
+#endif
@@ -39,6 +39,14 @@ uint16_t AudioStream::cpu_cycles_total = 0;
 uint16_t AudioStream::cpu_cycles_total_max = 0;
 uint8_t AudioStream::memory_used = 0;
 uint8_t AudioStream::memory_used_max = 0;
+uint8_t AudioStream::profile_count = 0;
+uint8_t AudioStream::blocks_held[AUDIO_PROFILE_OBJECTS];
+uint8_t AudioStream::blocks_held_max[AUDIO_PROFILE_OBJECTS];
+uint16_t AudioStream::update_histogram[AUDIO_PROFILE_BUCKETS];
+uint32_t AudioStream::update_all_count = 0;
+uint16_t AudioStream::alloc_failure_updates = 0;
+AudioStream * AudioStream::update_current = NULL;
+bool AudioStream::alloc_failed = false;
 
 
 
@@ -73,9 +81,10 @@ audio_block_t * AudioStream::allocate(void)
 	uint32_t n, index, avail;
 	uint32_t *p;
 	audio_block_t *block;
-	uint8_t used;
+	uint8_t used, owner, held;
 
 	p = memory_pool_available_mask;
+	owner = update_current ? update_current->profile_index : 0;
 	__disable_irq();
 	do {
 		avail = *p; if (avail) break;
@@ -86,17 +95,23 @@ audio_block_t * AudioStream::allocate(void)
 		p++; avail = *p; if (avail) break;
 		__enable_irq();
 		//Serial.println("alloc:null");
+		if (update_current && update_current->alloc_failures < 0xFFFF) update_current->alloc_failures++;
+		alloc_failed = true;
 		return NULL;
 	} while (0);
 	n = __builtin_clz(avail);
 	*p = avail & ~(0x80000000 >> n);
 	used = memory_used + 1;
 	memory_used = used;
+	held = blocks_held[owner] + 1;
+	blocks_held[owner] = held;
 	__enable_irq();
 	index = p - memory_pool_available_mask;
 	block = memory_pool + ((index << 5) + (31 - n));
 	block->ref_count = 1;
+	block->owner = owner;
 	if (used > memory_used_max) memory_used_max = used;
+	if (held > blocks_held_max[owner]) blocks_held_max[owner] = held;
 	//Serial.print("alloc:");
 	//Serial.println((uint32_t)block, HEX);
 	return block;
@@ -119,6 +134,7 @@ void AudioStream::release(audio_block_t *block)
 		//Serial.println((uint32_t)block, HEX);
 		memory_pool_available_mask[index] |= mask;
 		memory_used--;
+		if (block->owner < AUDIO_PROFILE_OBJECTS && blocks_held[block->owner]) blocks_held[block->owner]--;
 	}
 	__enable_irq();
 }
@@ -223,16 +239,23 @@ void software_isr(void) // AudioStream::update_all()
 	ARM_DEMCR |= ARM_DEMCR_TRCENA;
 	ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
 	uint32_t totalcycles = ARM_DWT_CYCCNT;
+	uint32_t bucket;
+	AudioStream::alloc_failed = false;
 	//digitalWriteFast(2, HIGH);
 	for (p = AudioStream::first_update; p; p = p->next_update) {
 		if (p->active) {
 			uint32_t cycles = ARM_DWT_CYCCNT;
+			AudioStream::update_current = p;
 			p->update();
+			AudioStream::update_current = NULL;
 			// TODO: traverse inputQueueArray and release
 			// any input blocks that weren't consumed?
 			cycles = (ARM_DWT_CYCCNT - cycles) >> 4;
 			p->cpu_cycles = cycles;
 			if (cycles > p->cpu_cycles_max) p->cpu_cycles_max = cycles;
+			if (cycles < p->cpu_cycles_min) p->cpu_cycles_min = cycles;
+			p->cpu_cycles_sum += cycles;
+			p->update_count++;
 		}
 	}
 	//digitalWriteFast(2, LOW);
@@ -240,5 +263,11 @@ void software_isr(void) // AudioStream::update_all()
 	AudioStream::cpu_cycles_total = totalcycles;
 	if (totalcycles > AudioStream::cpu_cycles_total_max)
 		AudioStream::cpu_cycles_total_max = totalcycles;
+	// in tenths of the block period; anything from 1.0 up means the next
+	// update started late
+	bucket = totalcycles * 10 / (uint32_t)(F_CPU / 16 / AUDIO_SAMPLE_RATE * AUDIO_BLOCK_SAMPLES);
+	if (bucket >= AUDIO_PROFILE_BUCKETS) bucket = AUDIO_PROFILE_BUCKETS - 1;
+	if (AudioStream::update_histogram[bucket] < 0xFFFF) AudioStream::update_histogram[bucket]++;
+	AudioStream::update_all_count++;
+	if (AudioStream::alloc_failed && AudioStream::alloc_failure_updates < 0xFFFF) AudioStream::alloc_failure_updates++;
 }
-
@@ -43,7 +43,7 @@ class AudioConnection;
 typedef struct audio_block_struct {
 	unsigned char ref_count;
 	unsigned char memory_pool_index;
-	unsigned char reserved1;
+	unsigned char owner;	// profile_index of the object which allocated it
 	unsigned char reserved2;
 	int16_t data[AUDIO_BLOCK_SAMPLES];
 } audio_block_t;
@@ -87,6 +87,13 @@ protected:
 #define AudioMemoryUsageMax() (AudioStream::memory_used_max)
 #define AudioMemoryUsageMaxReset() (AudioStream::memory_used_max = AudioStream::memory_used)
 
+// Objects whose blocks are counted separately (see AudioProfiler); blocks
+// allocated by any more, or outside of an update, are counted under 0
+#define AUDIO_PROFILE_OBJECTS 48
+// Buckets in the update_all() duration histogram, each a tenth of the block
+// period; the last also counts anything longer
+#define AUDIO_PROFILE_BUCKETS 16
+
 class AudioStream
 {
 public:
@@ -109,6 +116,11 @@ public:
 			next_update = NULL;
 			cpu_cycles = 0;
 			cpu_cycles_max = 0;
+			cpu_cycles_min = 0xFFFF;
+			cpu_cycles_sum = 0;
+			update_count = 0;
+			alloc_failures = 0;
+			profile_index = (profile_count < AUDIO_PROFILE_OBJECTS - 1) ? ++profile_count : 0;
 		}
 	static void initialize_memory(audio_block_t *data, unsigned int num);
 	int processorUsage(void) { return CYCLE_COUNTER_APPROX_PERCENT(cpu_cycles); }
@@ -120,6 +132,18 @@ public:
 	static uint16_t cpu_cycles_total_max;
 	static uint8_t memory_used;
 	static uint8_t memory_used_max;
+	// Profiling, since the last AudioProfiler::reset()
+	uint16_t cpu_cycles_min;
+	uint32_t cpu_cycles_sum;	// with update_count, for the average
+	uint32_t update_count;
+	uint16_t alloc_failures;	// allocate() returned NULL during update()
+	uint8_t profile_index;		// 1 up, in order of construction; 0 if too many
+	static uint8_t profile_count;
+	static uint8_t blocks_held[AUDIO_PROFILE_OBJECTS];	// by profile_index; in use now
+	static uint8_t blocks_held_max[AUDIO_PROFILE_OBJECTS];
+	static uint16_t update_histogram[AUDIO_PROFILE_BUCKETS];
+	static uint32_t update_all_count;
+	static uint16_t alloc_failure_updates;	// update_all() runs where an allocate() failed
 protected:
 	bool active;
 	unsigned char num_inputs;
@@ -133,6 +157,7 @@ protected:
 	static void update_all(void) { NVIC_SET_PENDING(IRQ_SOFTWARE); }
 	friend void software_isr(void);
 	friend class AudioConnection;
+	friend class AudioProfiler;
 private:
 	AudioConnection *destination_list;
 	audio_block_t **inputQueue;
@@ -142,6 +167,8 @@ private:
 	AudioStream *next_update; // for update_all
 	static audio_block_t *memory_pool;
 	static uint32_t memory_pool_available_mask[6];
+	static AudioStream *update_current;	// the object in update(), if any
+	static bool alloc_failed;
 };
 
 #endif
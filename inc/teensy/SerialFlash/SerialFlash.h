@@ -34,6 +34,20 @@
 
 class SerialFlashFile;
 
+// Reads which start within this many bytes of the end of the one before are
+// done with the same read command, clocking through the gap, as that costs
+// less than releasing chip select and sending a new command and address
+#ifndef SERIALFLASH_COALESCE_GAP
+#define SERIALFLASH_COALESCE_GAP 8
+#endif
+
+// One read in a batch, for SerialFlashChip::read(SerialFlashRead *, uint8_t)
+typedef struct SerialFlashRead {
+	uint32_t addr;
+	void *buf;
+	uint32_t len;
+} SerialFlashRead;
+
 class SerialFlashChip
 {
 public:
@@ -43,6 +57,10 @@ public:
 	static uint32_t blockSize();
 	static void readID(uint8_t *buf);
 	static void read(uint32_t addr, void *buf, uint32_t len);
+	// Do a list of reads (e.g. the next block for each playing voice) in one
+	// SPI transaction.  The list is sorted by address; reads which overlap or
+	// nearly touch share one read command.  Returns the commands sent.
+	static uint8_t read(SerialFlashRead *list, uint8_t count);
 	static bool ready();
 	static void wait();
 	static void write(uint32_t addr, const void *buf, uint32_t len);
@@ -59,7 +77,16 @@ public:
 	static bool remove(SerialFlashFile &file);
 	static void opendir() { dirindex = 0; }
 	static bool readdir(char *filename, uint32_t strsize, uint32_t &filesize);
+	// Keep a copy of the directory in RAM (about 14 bytes per file slot, plus
+	// 512 bytes; 8.9K with the default 600 slots), so that open() needs at most
+	// one flash read and readdir() reads names in bulk.  Call after begin().
+	// Returns false if there isn't enough memory, or no valid filesystem.
+	static bool cacheDirectory();
 private:
+	static void directoryErased(uint32_t addr);
+	static uint8_t suspend();
+	static void resume(uint8_t b);
+	static void readCommand(uint32_t addr);
 	static uint8_t cs_pin;	//CS pin (defaults to 6)
 	static uint16_t dirindex; // current position for readdir()
 	static uint8_t flags;	// chip features
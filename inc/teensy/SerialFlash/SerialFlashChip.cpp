@@ -76,14 +76,14 @@ void SerialFlashChip::wait(void)
 	//Serial.println();
 }
 
-void SerialFlashChip::read(uint32_t addr, void *buf, uint32_t len)
+// Called with the SPI transaction begun.  If the chip is busy with a program
+// or erase which can be suspended, suspends it; returns the busy state to
+// pass to resume() once the reads are done.
+uint8_t SerialFlashChip::suspend()
 {
-	uint8_t *p = (uint8_t *)buf;
 	uint8_t b, f, status, cmd;
 
-	memset(p, 0, len);
 	f = flags;
-	SPI.beginTransaction(SPICONFIG);
 	b = busy;
 	if (b) {
 		// read status register ... chip may no longer be busy
@@ -139,6 +139,51 @@ void SerialFlashChip::read(uint32_t addr, void *buf, uint32_t len)
 			SPI.beginTransaction(SPICONFIG);
 		}
 	}
+	return b;
+}
+
+void SerialFlashChip::resume(uint8_t b)
+{
+	uint8_t cmd;
+
+	if (b) {
+		digitalWriteFast(cs_pin, LOW); //CSASSERT
+		SPI.transfer(0x06); // write enable (Micron req'd)
+		digitalWriteFast(cs_pin, HIGH); //CSRELEASE
+		delayMicroseconds(1);
+		cmd = 0x7A;
+		if ((flags & FLAG_DIFF_SUSPEND) && (b == 1)) cmd = 0x8A;
+		digitalWriteFast(cs_pin, LOW); //CSASSERT
+		SPI.transfer(cmd); // Resume program/erase
+		digitalWriteFast(cs_pin, HIGH); //CSRELEASE
+	}
+}
+
+// Asserts chip select and sends the read command for addr; the data
+// follows for as long as chip select is held.
+void SerialFlashChip::readCommand(uint32_t addr)
+{
+	digitalWriteFast(cs_pin, LOW); //CSASSERT
+	// TODO: FIFO optimize....
+	if (flags & FLAG_32BIT_ADDR) {
+		SPI.transfer(0x03);
+		SPI.transfer16(addr >> 16);
+		SPI.transfer16(addr);
+	} else {
+		SPI.transfer16(0x0300 | ((addr >> 16) & 255));
+		SPI.transfer16(addr);
+	}
+}
+
+void SerialFlashChip::read(uint32_t addr, void *buf, uint32_t len)
+{
+	uint8_t *p = (uint8_t *)buf;
+	uint8_t b, f;
+
+	memset(p, 0, len);
+	f = flags;
+	SPI.beginTransaction(SPICONFIG);
+	b = suspend();
 	do {
 		uint32_t rdlen = len;
 		if (f & FLAG_MULTI_DIE) {
@@ -146,34 +191,88 @@ void SerialFlashChip::read(uint32_t addr, void *buf, uint32_t len)
 				rdlen = 0x2000000 - (addr & 0x1FFFFFF);
 			}
 		}
-		digitalWriteFast(cs_pin, LOW); //CSASSERT
-		// TODO: FIFO optimize....
-		if (f & FLAG_32BIT_ADDR) {
-			SPI.transfer(0x03);
-			SPI.transfer16(addr >> 16);
-			SPI.transfer16(addr);
-		} else {
-			SPI.transfer16(0x0300 | ((addr >> 16) & 255));
-			SPI.transfer16(addr);
-		}
+		readCommand(addr);
 		SPI.transfer(p, rdlen);
 		digitalWriteFast(cs_pin, HIGH); //CSRELEASE
 		p += rdlen;
 		addr += rdlen;
 		len -= rdlen;
 	} while (len > 0);
-	if (b) {
-		digitalWriteFast(cs_pin, LOW); //CSASSERT
-		SPI.transfer(0x06); // write enable (Micron req'd)
-		digitalWriteFast(cs_pin, HIGH); //CSRELEASE
-		delayMicroseconds(1);
-		cmd = 0x7A;
-		if ((f & FLAG_DIFF_SUSPEND) && (b == 1)) cmd = 0x8A;
-		digitalWriteFast(cs_pin, LOW); //CSASSERT
-		SPI.transfer(cmd); // Resume program/erase
+	resume(b);
+	SPI.endTransaction();
+}
+
+uint8_t SerialFlashChip::read(SerialFlashRead *list, uint8_t count)
+{
+	SerialFlashRead *r, *last = NULL;
+	uint8_t i, j, b, f, commands = 0;
+	uint32_t pos = 0;
+
+	// sort by address; the list is short (a voice or two per pad), so
+	// insertion sort is plenty
+	for (i = 1; i < count; i++) {
+		SerialFlashRead t = list[i];
+		for (j = i; j > 0 && list[j - 1].addr > t.addr; j--) {
+			list[j] = list[j - 1];
+		}
+		list[j] = t;
+	}
+	f = flags;
+	SPI.beginTransaction(SPICONFIG);
+	b = suspend();
+	for (i = 0; i < count; i++) {
+		r = &list[i];
+		uint8_t *p = (uint8_t *)r->buf;
+		uint32_t addr = r->addr;
+		uint32_t len = r->len;
+		if (len == 0) continue;
+		if (last && addr < pos) {
+			// overlaps the read which reaches furthest so far (the
+			// same sample playing twice), so copy what it already has
+			uint32_t n = pos - addr;
+			if (n > len) n = len;
+			memcpy(p, (uint8_t *)last->buf + (addr - last->addr), n);
+			p += n;
+			addr += n;
+			len -= n;
+			if (len == 0) continue;
+		}
+		memset(p, 0, len);
+		if (last && addr - pos <= SERIALFLASH_COALESCE_GAP
+		  && !((f & FLAG_MULTI_DIE) && ((pos ^ (addr + len - 1)) & 0xFE000000))) {
+			// close enough to keep reading with the same command
+			while (pos < addr) {
+				SPI.transfer(0);
+				pos++;
+			}
+			SPI.transfer(p, len);
+		} else {
+			if (last) {
+				digitalWriteFast(cs_pin, HIGH); //CSRELEASE
+			}
+			while ((f & FLAG_MULTI_DIE) && ((addr ^ (addr + len - 1)) & 0xFE000000)) {
+				uint32_t rdlen = 0x2000000 - (addr & 0x1FFFFFF);
+				readCommand(addr);
+				SPI.transfer(p, rdlen);
+				digitalWriteFast(cs_pin, HIGH); //CSRELEASE
+				commands++;
+				p += rdlen;
+				addr += rdlen;
+				len -= rdlen;
+			}
+			readCommand(addr);
+			SPI.transfer(p, len);
+			commands++;
+		}
+		pos = addr + len;
+		last = r;
+	}
+	if (last) {
 		digitalWriteFast(cs_pin, HIGH); //CSRELEASE
 	}
+	resume(b);
 	SPI.endTransaction();
+	return commands;
 }
 
 void SerialFlashChip::write(uint32_t addr, const void *buf, uint32_t len)
@@ -215,6 +314,7 @@ void SerialFlashChip::write(uint32_t addr, const void *buf, uint32_t len)
 void SerialFlashChip::eraseAll()
 {
 	if (busy) wait();
+	directoryErased(0);
 	uint8_t id[3];
 	readID(id);
 	//Serial.printf("ID: %02X %02X %02X\n", id[0], id[1], id[2]);
@@ -265,6 +365,7 @@ void SerialFlashChip::eraseBlock(uint32_t addr)
 {
 	uint8_t f = flags;
 	if (busy) wait();
+	directoryErased(addr);
 	SPI.beginTransaction(SPICONFIG);
 	digitalWriteFast(cs_pin, LOW); //CSASSERT
 	SPI.transfer(0x06); // write enable command
@@ -115,6 +115,180 @@ static bool filename_compare(const char *filename, uint32_t straddr)
 	}
 }
 
+/* Optional RAM copy of the directory (see cacheDirectory()).  The hashes and
+fileinfo of the allocated files are read in bulk, and the hashes are chained
+into buckets so that open() only has to read the name of a file whose hash
+matches.  create() and remove() keep it up to date; eraseAll() and erasing a
+block under the directory mark it stale, and it is read again when next used.
+*/
+
+#define CACHE_BUCKETS  256
+#define CACHE_NONE     0xFFFF
+#define NAME_BUFSIZE   256
+
+typedef struct {
+	uint32_t address;
+	uint32_t length;
+	uint16_t string_index;  // div 4
+	uint16_t hash;
+} cache_entry_t;
+
+static cache_entry_t *cache_entries = NULL;  // [maxfiles]
+static uint16_t *cache_next = NULL;          // [maxfiles], next entry in the same bucket
+static uint16_t cache_buckets[CACHE_BUCKETS];
+static uint32_t cache_maxfiles;
+static uint32_t cache_stringsize;
+static uint32_t cache_used;                  // first unallocated index
+static uint32_t cache_end;                   // end of the directory in flash
+static bool cache_stale;
+
+// names read ahead for readdir()
+static char name_buf[NAME_BUFSIZE];
+static uint32_t name_buf_addr = 0xFFFFFFFF;
+static uint32_t name_buf_len;
+
+static void cache_link(uint32_t index)
+{
+	uint16_t *p = &cache_buckets[cache_entries[index].hash & (CACHE_BUCKETS - 1)];
+	while (*p != CACHE_NONE) p = &cache_next[*p];
+	*p = index;
+	cache_next[index] = CACHE_NONE;
+}
+
+// reads the directory into the (already allocated) cache
+static bool cache_load(uint32_t sig)
+{
+	uint32_t maxfiles, i;
+	uint16_t *hashes;
+	uint8_t *raw, *p;
+
+	maxfiles = sig & 0xFFFF;
+	if (!sig || maxfiles != cache_maxfiles) return false;
+	cache_stringsize = (sig & 0xFFFF0000) >> 14;
+	name_buf_addr = 0xFFFFFFFF;
+
+	// the hashes go into the next[] array for the moment
+	hashes = cache_next;
+	SerialFlash.read(8, hashes, maxfiles * 2);
+	for (i=0; i < maxfiles; i++) {
+		if (hashes[i] == 0xFFFF) break;
+	}
+	cache_used = i;
+
+	// fileinfo is 10 bytes each on the flash; unpack from the end, so that
+	// nothing is overwritten before it has been read
+	raw = (uint8_t *)cache_entries;
+	if (cache_used > 0) {
+		SerialFlash.read(8 + maxfiles * 2, raw, cache_used * 10);
+	}
+	for (i=cache_used; i > 0; i--) {
+		cache_entry_t e;
+		p = raw + (i-1) * 10;
+		memcpy(&e.address, p, 4);
+		memcpy(&e.length, p + 4, 4);
+		memcpy(&e.string_index, p + 8, 2);
+		e.hash = hashes[i-1];
+		cache_entries[i-1] = e;
+	}
+
+	for (i=0; i < CACHE_BUCKETS; i++) cache_buckets[i] = CACHE_NONE;
+	for (i=0; i < cache_used; i++) cache_link(i);
+	cache_end = 8 + maxfiles * 12 + cache_stringsize;
+	cache_stale = false;
+	return true;
+}
+
+// returns true if the cache is in use (reading it again first if it is stale)
+static bool cache_ready(void)
+{
+	if (!cache_entries) return false;
+	if (cache_stale) {
+		if (!cache_load(check_signature())) {
+			free(cache_entries);
+			free(cache_next);
+			cache_entries = NULL;
+			cache_next = NULL;
+			cache_end = 0;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SerialFlashChip::cacheDirectory()
+{
+	uint32_t sig = check_signature();
+	if (!sig) return false;
+	if (cache_entries && cache_maxfiles != (sig & 0xFFFF)) {
+		free(cache_entries);
+		free(cache_next);
+		cache_entries = NULL;
+		cache_next = NULL;
+	}
+	if (!cache_entries) {
+		cache_maxfiles = sig & 0xFFFF;
+		cache_entries = (cache_entry_t *)malloc(cache_maxfiles * sizeof(cache_entry_t));
+		cache_next = (uint16_t *)malloc(cache_maxfiles * 2);
+		if (!cache_entries || !cache_next) {
+			free(cache_entries);
+			free(cache_next);
+			cache_entries = NULL;
+			cache_next = NULL;
+			return false;
+		}
+	}
+	return cache_load(sig);
+}
+
+void SerialFlashChip::directoryErased(uint32_t addr)
+{
+	if (addr < cache_end) cache_stale = true;
+}
+
+// returns the index of the file, or CACHE_NONE
+static uint32_t cache_find(const char *filename)
+{
+	uint16_t hash;
+	uint32_t i, len, straddr;
+	char buf[NAME_BUFSIZE];
+
+	hash = filename_hash(filename);
+	len = strlen(filename) + 1;
+	for (i = cache_buckets[hash & (CACHE_BUCKETS - 1)]; i != CACHE_NONE; i = cache_next[i]) {
+		if (cache_entries[i].hash != hash) continue;
+		straddr = 8 + cache_maxfiles * 12 + cache_entries[i].string_index * 4;
+		if (len <= sizeof(buf)) {
+			SerialFlash.read(straddr, buf, len);
+			if (memcmp(buf, filename, len) == 0) return i;
+		} else if (filename_compare(filename, straddr)) {
+			return i;
+		}
+	}
+	return CACHE_NONE;
+}
+
+// copies the name at straddr, reading ahead so that the following names
+// (which are stored one after another) come from RAM
+static bool cache_name(uint32_t straddr, char *filename, uint32_t strsize)
+{
+	uint32_t i, end;
+
+	end = 8 + cache_maxfiles * 12 + cache_stringsize;
+	for (i=0; i < strsize; i++) {
+		if (straddr + i >= end) break;
+		if (straddr + i < name_buf_addr || straddr + i >= name_buf_addr + name_buf_len) {
+			name_buf_addr = straddr + i;
+			name_buf_len = end - name_buf_addr;
+			if (name_buf_len > sizeof(name_buf)) name_buf_len = sizeof(name_buf);
+			SerialFlash.read(name_buf_addr, name_buf, name_buf_len);
+		}
+		filename[i] = name_buf[straddr + i - name_buf_addr];
+		if (filename[i] == 0) return true;
+	}
+	if (i > 0) filename[i - 1] = 0;
+	return true;
+}
+
 #if 0
 void pbuf(const void *buf, uint32_t len)
 {
@@ -134,6 +308,16 @@ SerialFlashFile SerialFlashChip::open(const char *filename)
 	uint32_t buf[3];
 	SerialFlashFile file;
 
+	if (cache_ready()) {
+		index = cache_find(filename);
+		if (index != CACHE_NONE) {
+			file.address = cache_entries[index].address;
+			file.length = cache_entries[index].length;
+			file.offset = 0;
+			file.dirindex = index;
+		}
+		return file;
+	}
 	maxfiles = check_signature();
 	 //Serial.printf("sig: %08X\n", maxfiles);
 	if (!maxfiles) return file;
@@ -205,6 +389,9 @@ bool SerialFlashChip::remove(SerialFlashFile &file)
 		 //Serial.printf("remove failed, hash %04X\n", hash);
 		return false;
 	}
+	if (cache_ready() && file.dirindex < cache_used) {
+		cache_entries[file.dirindex].hash = 0;
+	}
 	file.address = 0;
 	file.length = 0;
 	return true;
@@ -259,19 +446,27 @@ bool SerialFlashChip::create(const char *filename, uint32_t length, uint32_t ali
 	uint32_t maxfiles, stringsize;
 	uint32_t index, buf[3];
 	uint32_t address, straddr, len;
+	bool cached;
 	SerialFlashFile file;
 
 	// check if the file already exists
 	if (exists(filename)) return false;
 
 	// first, get the filesystem parameters
-	maxfiles = check_signature();
-	if (!maxfiles) return false;
-	stringsize = (maxfiles & 0xFFFF0000) >> 14;
-	maxfiles &= 0xFFFF;
+	cached = cache_ready();
+	if (cached) {
+		maxfiles = cache_maxfiles;
+		stringsize = cache_stringsize;
+	} else {
+		maxfiles = check_signature();
+		if (!maxfiles) return false;
+		stringsize = (maxfiles & 0xFFFF0000) >> 14;
+		maxfiles &= 0xFFFF;
+	}
 
 	// find the first unused slot for this file
-	index = find_first_unallocated_file_index(maxfiles);
+	if (cached) index = cache_used;
+	else index = find_first_unallocated_file_index(maxfiles);
 	if (index >= maxfiles) return false;
 	 //Serial.printf("index = %u\n", index);
 	// compute where to store the filename and actual data
@@ -279,8 +474,14 @@ bool SerialFlashChip::create(const char *filename, uint32_t length, uint32_t ali
 	if (index == 0) {
 		address = straddr + stringsize;
 	} else {
-		buf[2] = 0;
-		SerialFlash.read(8 + maxfiles * 2 + (index-1) * 10, buf, 10);
+		if (cached) {
+			buf[0] = cache_entries[index-1].address;
+			buf[1] = cache_entries[index-1].length;
+			buf[2] = cache_entries[index-1].string_index;
+		} else {
+			buf[2] = 0;
+			SerialFlash.read(8 + maxfiles * 2 + (index-1) * 10, buf, 10);
+		}
 		address = buf[0] + buf[1];
 		straddr += buf[2] * 4;
 		straddr += string_length(straddr);
@@ -328,6 +529,15 @@ bool SerialFlashChip::create(const char *filename, uint32_t length, uint32_t ali
 	 //Serial.printf("hash = %04X\n", buf[0]);
 	SerialFlash.write(8 + index * 2, buf, 2);
 	while (!SerialFlash.ready()) ;  // TODO: timeout
+	if (cached) {
+		cache_entries[index].address = address;
+		cache_entries[index].length = length;
+		cache_entries[index].string_index = (straddr - (8 + maxfiles * 12)) / 4;
+		cache_entries[index].hash = buf[0];
+		cache_link(index);
+		cache_used = index + 1;
+		name_buf_addr = 0xFFFFFFFF;  // the new name may be in it
+	}
 	return true;
 }
 
@@ -340,6 +550,18 @@ bool SerialFlashChip::readdir(char *filename, uint32_t strsize, uint32_t &filesi
 	char str[16], *p=filename;
 
 	filename[0] = 0;
+	if (cache_ready()) {
+		index = dirindex;
+		while (1) {
+			if (index >= cache_used) return false;
+			if (cache_entries[index].hash != 0) break;
+			index++;  // skip deleted entries
+		}
+		dirindex = index + 1;
+		filesize = cache_entries[index].length;
+		straddr = 8 + cache_maxfiles * 12 + cache_entries[index].string_index * 4;
+		return cache_name(straddr, filename, strsize);
+	}
 	maxfiles = check_signature();
 	if (!maxfiles) return false;
 	maxfiles &= 0xFFFF; 
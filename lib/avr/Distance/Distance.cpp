@@ -1,45 +1,350 @@
 #include "Distance.h"
+#include <avr/interrupt.h>
 
-#define TEN_MICROSECONDS (F_CPU / 100000)
+//Timer 1 runs at F_CPU / 8 (the F_CPU / 1000000 means that F_CPU must be a whole number of MHz)
+#define TICKS(us) ((uint32_t) (us) * (F_CPU / 1000000) / 8)
+#define TICKS_PER_MS ((uint32_t) F_CPU / 8000)
+#define TRIGGER_TICKS TICKS(12)
+#define TIMEOUT_TICKS TICKS(DISTANCE_TIMEOUT_US)
+#define MIN_TICKS 8					//Soonest that a compare can be set for, allowing for the ISR itself
+#define MAX_STEP 0x8000				//Longest single compare; longer waits are done in steps
+#define GATE_COUNT 3				//Readings in a row outside the Kalman gate before the filter starts again
+
+#if defined(__AVR_ATmega164P__) || defined(__AVR_ATmega324P__) || defined(__AVR_ATmega644__) || defined(__AVR_ATmega644P__) || defined(__AVR_ATmega644PA__) || defined(__AVR_ATmega1284P__)
+	#define ICP_PIN PIND
+	#define ICP_BIT 6
+	#define PCINT_PORTS 4
+#else
+	#define ICP_PIN PINB
+	#define ICP_BIT 0
+	#define PCINT_PORTS 3
+#endif
+
+#define STATE_STOPPED 0
+#define STATE_TRIGGER 1				//Trigger pulse
+#define STATE_WAIT 2				//Waiting for the echo pulse to start
+#define STATE_ECHO 3				//Timing the echo pulse
+#define STATE_SETTLE 4				//Waiting for the rest of the interval, for echoes to die away
 
 using namespace digitalcave;
 
+typedef struct result_t {
+	uint8_t sensor;
+	uint16_t width;					//Echo pulse in timer ticks; 0 = no echo
+	uint32_t overflows;				//Time the echo ended (high part)
+	uint16_t time;					//Time the echo ended (low part)
+} result_t;
+
+// non-class variables for the ISR
+static Distance* _sensors[DISTANCE_MAX_SENSORS];
+static volatile uint8_t *_trigger_port[DISTANCE_MAX_SENSORS];
+static uint8_t _trigger_bv[DISTANCE_MAX_SENSORS];
+static volatile uint8_t *_echo_pin[DISTANCE_MAX_SENSORS];
+static uint8_t _echo_bv[DISTANCE_MAX_SENSORS];
+static volatile uint8_t *_pcmsk[DISTANCE_MAX_SENSORS];	//Pin change mask register, or 0 if the echo is on ICP1
+static uint8_t _pcie[DISTANCE_MAX_SENSORS];
+static uint8_t _sensor_count;
+
+static volatile uint8_t _state;
+static volatile uint8_t _stopping;
+static volatile uint8_t _current;			//Sensor being pinged
+static uint32_t _interval;					//Ticks from one trigger to the next
+static volatile uint32_t _wait;				//Ticks still to wait after the current compare
+static volatile uint16_t _trigger_time;
+static volatile uint16_t _echo_start;
+static volatile uint32_t _overflows;
+
+static volatile result_t _results[DISTANCE_QUEUE_SIZE];
+static volatile uint8_t _head;				//Readings made (the ISR writes into slot _head % DISTANCE_QUEUE_SIZE)
+static volatile uint8_t _tail;				//Readings polled
+static volatile uint8_t _overruns;
+
 Distance::Distance(volatile uint8_t *trigger_port, uint8_t trigger_num, volatile uint8_t *data_pin, uint8_t data_num){
 	this->trigger_port = trigger_port;
 	this->trigger_num = _BV(trigger_num);
 	this->data_pin = data_pin;
 	this->data_num = _BV(data_num);
+	this->window_count = 0;
+	this->window_position = 0;
+	this->rejected = 0;
+	this->distance = 0;
+	this->setFilter(25, 100);
+
+	*(trigger_port - 0x1) |= this->trigger_num;	//Trigger pin output
+	*trigger_port &= ~this->trigger_num;
+	*(data_pin + 0x1) &= ~this->data_num;		//Data pin input
+
+	if (_sensor_count >= DISTANCE_MAX_SENSORS){
+		this->index = 0xFF;
+		return;
+	}
+	this->index = _sensor_count;
+	_sensors[index] = this;
+	_trigger_port[index] = trigger_port;
+	_trigger_bv[index] = this->trigger_num;
+	_echo_pin[index] = data_pin;
+	_echo_bv[index] = this->data_num;
+
+	//Pin change interrupts are grouped by port.  An echo pin which is neither ICP1 nor on a port with
+	// pin change interrupts can't be timed, so the sensor is not added.
+	_pcmsk[index] = 0;
+	if (data_pin != &ICP_PIN || data_num != ICP_BIT){
+#if PCINT_PORTS == 4
+		if (data_pin == &PINA) { _pcmsk[index] = &PCMSK0; _pcie[index] = PCIE0; }
+		else if (data_pin == &PINB) { _pcmsk[index] = &PCMSK1; _pcie[index] = PCIE1; }
+		else if (data_pin == &PINC) { _pcmsk[index] = &PCMSK2; _pcie[index] = PCIE2; }
+		else if (data_pin == &PIND) { _pcmsk[index] = &PCMSK3; _pcie[index] = PCIE3; }
+#else
+		if (data_pin == &PINB) { _pcmsk[index] = &PCMSK0; _pcie[index] = PCIE0; }
+		else if (data_pin == &PINC) { _pcmsk[index] = &PCMSK1; _pcie[index] = PCIE1; }
+		else if (data_pin == &PIND) { _pcmsk[index] = &PCMSK2; _pcie[index] = PCIE2; }
+#endif
+		if (_pcmsk[index] == 0){
+			this->index = 0xFF;
+			return;
+		}
+	}
+	_sensor_count++;
 }
 
-uint16_t Distance::read(){
-	//Bring trigger high for more than 10uS.  20uS seems to work fine.
-	*this->trigger_port |= this->trigger_num;
-	_delay_us(20);
-	*this->trigger_port &= ~this->trigger_num;
-	
-	//Set up timer2 to run at F_CPU (no prescaler), in normal mode
-	TCCR2A = 0x0;
-	TCCR2B = _BV(CS20);
-
-	//Determine how long the data pin is high.  Wait until it goes high, then start timing...
-	while ((*this->data_pin & this->data_num) == 0x00);
-	TCNT2 = 0;
-	uint16_t micros = 0;
-	
-	//Delay until C4 goes low
-	while (*this->data_pin & this->data_num){
-		if (TCNT2 > TEN_MICROSECONDS) {
-			TCNT2 = 0x00;
-			micros += 10;
+//Sets the next compare interrupt for ticks after from (which must be in the last 65536 ticks)
+static void schedule(uint16_t from, uint32_t ticks){
+	uint16_t now = TCNT1;
+	uint16_t elapsed = now - from;
+	uint32_t remaining = ticks > (uint32_t) elapsed + MIN_TICKS ? ticks - elapsed : MIN_TICKS;
+	uint16_t step = remaining > MAX_STEP ? MAX_STEP : remaining;
+	_wait = remaining - step;
+	OCR1A = now + step;
+	TIFR1 = _BV(OCF1A);
+}
+
+static void ping(){
+	*_trigger_port[_current] |= _trigger_bv[_current];
+	_trigger_time = TCNT1;
+	_state = STATE_TRIGGER;
+	schedule(_trigger_time, TRIGGER_TICKS);
+}
+
+static void arm(uint8_t on){
+	uint8_t s = _current;
+	if (_pcmsk[s] == 0){
+		if (on){
+			TCCR1B |= _BV(ICES1);			//Rising edge first
+			TIFR1 = _BV(ICF1);
+			TIMSK1 |= _BV(ICIE1);
 		}
+		else {
+			TIMSK1 &= ~_BV(ICIE1);
+		}
+	}
+	else if (on){
+		PCIFR = _BV(_pcie[s]);
+		*_pcmsk[s] |= _echo_bv[s];
+		PCICR |= _BV(_pcie[s]);
 	}
-	
-	//Turn off the timer
-	TCCR2B = 0x00;
-	
-	//Get any partial time remaining
-	micros += ((TCNT2 * (uint16_t) 10) / TEN_MICROSECONDS);
-	
-	//Calculate distance
-	return (uint16_t) (micros / 5.8);
-}
\ No newline at end of file
+	else {
+		*_pcmsk[s] &= ~_echo_bv[s];
+	}
+}
+
+//The ping is over, with an echo width ticks long (0 for none) ending at time
+static void finish(uint16_t width, uint16_t time){
+	arm(0);
+	if ((uint8_t) (_head - _tail) >= DISTANCE_QUEUE_SIZE){
+		_overruns++;
+	}
+	else {
+		volatile result_t* r = &_results[_head % DISTANCE_QUEUE_SIZE];
+		r->sensor = _current;
+		r->width = width;
+		r->overflows = _overflows;
+		//It has overflowed, but the ISR hasn't run yet
+		if ((TIFR1 & _BV(TOV1)) && time < 0x8000) r->overflows++;
+		r->time = time;
+		_head++;
+	}
+	_state = STATE_SETTLE;
+	schedule(_trigger_time, _interval);
+}
+
+static void echo(uint16_t time, uint8_t high){
+	if (_state == STATE_WAIT && high){
+		_echo_start = time;
+		_state = STATE_ECHO;
+	}
+	else if (_state == STATE_ECHO && !high){
+		uint16_t width = time - _echo_start;
+		finish(width ? width : 1, time);
+	}
+}
+
+void Distance::start(uint16_t interval){
+	if (_sensor_count == 0) return;
+	cli();
+	uint32_t ticks = TICKS((uint32_t) interval * 1000);
+	_interval = ticks > TIMEOUT_TICKS + TICKS(1000) ? ticks : TIMEOUT_TICKS + TICKS(1000);
+	_stopping = 0;
+	if (_state == STATE_STOPPED){
+		TCCR1A = 0x00;							//Normal mode
+		TCCR1B = _BV(ICNC1) | _BV(CS11);		//Noise canceller, F_CPU / 8 prescaler
+		TCNT1 = 0;
+		_overflows = 0;
+		TIFR1 = _BV(TOV1) | _BV(OCF1A) | _BV(ICF1);
+		TIMSK1 = _BV(TOIE1) | _BV(OCIE1A);
+		_current = 0;
+		ping();
+	}
+	sei();
+}
+
+void Distance::stop(){
+	_stopping = 1;
+}
+
+uint8_t Distance::poll(distance_reading_t* reading){
+	if (_head == _tail) return 0;
+
+	volatile result_t* r = &_results[_tail % DISTANCE_QUEUE_SIZE];
+	uint8_t sensor = r->sensor;
+	uint16_t width = r->width;
+	uint32_t overflows = r->overflows;
+	uint16_t time = r->time;
+	_tail++;				//Only now can the ISR re-use the slot
+
+	//Sound takes 5.8us to go 1mm and back
+	uint16_t raw = ((uint32_t) width * 8 * 10 + (F_CPU / 1000000) * 29) / ((F_CPU / 1000000) * 58);
+	if (width && raw == 0) raw = 1;
+
+	reading->sensor = sensor;
+	reading->raw = raw;
+	reading->distance = _sensors[sensor]->filter(raw);
+	//ms is (overflows * 65536 + time) / TICKS_PER_MS, without 64 bit math: taking whole multiples of
+	// TICKS_PER_MS out of overflows first keeps the rest under 2^32 (for F_CPU up to 32MHz)
+	reading->time = (overflows / TICKS_PER_MS) * 65536 + ((overflows % TICKS_PER_MS) * 65536 + time) / TICKS_PER_MS;
+	return 1;
+}
+
+uint8_t Distance::getOverruns(){
+	uint8_t result = _overruns;
+	_overruns = 0;
+	return result;
+}
+
+void Distance::setFilter(float q, float r){
+	this->q = q;
+	this->r = r;
+	this->variance = r;
+}
+
+uint16_t Distance::filter(uint16_t raw){
+	//No echo; nothing to go on, so keep the last distance
+	if (raw == 0) return this->distance;
+
+	//Median of the last few pings
+	this->window[this->window_position] = raw;
+	this->window_position = (this->window_position + 1) % DISTANCE_MEDIAN;
+	if (this->window_count < DISTANCE_MEDIAN) this->window_count++;
+	uint16_t sorted[DISTANCE_MEDIAN];
+	for (uint8_t i = 0; i < this->window_count; i++){
+		uint16_t v = this->window[i];
+		uint8_t j = i;
+		for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+		sorted[j] = v;
+	}
+	float measured = sorted[this->window_count / 2];
+
+	//Kalman filter, with the distance modelled as a random walk.  A reading more than 4 standard
+	//deviations out is ignored, unless it happens GATE_COUNT times in a row (the target really moved).
+	float error = measured - this->estimate;
+	this->variance += this->q;
+	float expected = this->variance + this->r;
+	if (this->window_count == 1 || this->r == 0 || this->rejected >= GATE_COUNT){
+		this->estimate = measured;
+		this->variance = this->r;
+		this->rejected = 0;
+	}
+	else if (error * error > 16 * expected){
+		this->rejected++;
+	}
+	else {
+		float gain = this->variance / expected;
+		this->estimate += gain * error;
+		this->variance *= (1 - gain);
+		this->rejected = 0;
+	}
+	this->distance = (uint16_t) (this->estimate + 0.5f);
+	return this->distance;
+}
+
+uint16_t Distance::read(){
+	return this->distance;
+}
+
+ISR(TIMER1_OVF_vect){
+	_overflows++;
+}
+
+ISR(TIMER1_COMPA_vect){
+	if (_wait){
+		uint16_t step = _wait > MAX_STEP ? MAX_STEP : _wait;
+		_wait -= step;
+		OCR1A += step;
+		return;
+	}
+
+	switch (_state){
+		case STATE_TRIGGER:
+			*_trigger_port[_current] &= ~_trigger_bv[_current];
+			_state = STATE_WAIT;
+			arm(1);
+			schedule(_trigger_time, TIMEOUT_TICKS);
+			break;
+		case STATE_WAIT:
+		case STATE_ECHO:
+			//Nothing in range
+			finish(0, OCR1A);
+			break;
+		case STATE_SETTLE:
+			if (_stopping){
+				_state = STATE_STOPPED;
+				TIMSK1 &= ~_BV(OCIE1A);
+				break;
+			}
+			_current = (_current + 1) % _sensor_count;
+			ping();
+			break;
+	}
+}
+
+ISR(TIMER1_CAPT_vect){
+	uint16_t time = ICR1;
+	uint8_t high = TCCR1B & _BV(ICES1);
+	TCCR1B ^= _BV(ICES1);				//The other edge next
+	TIFR1 = _BV(ICF1);					//Changing the edge can set the flag
+	echo(time, high);
+}
+
+static void pin_change(){
+	uint16_t time = TCNT1;
+	uint8_t s = _current;
+	if (_pcmsk[s] == 0) return;
+	echo(time, *_echo_pin[s] & _echo_bv[s]);
+}
+
+ISR(PCINT0_vect){
+	pin_change();
+}
+
+ISR(PCINT1_vect){
+	pin_change();
+}
+
+ISR(PCINT2_vect){
+	pin_change();
+}
+
+#if PCINT_PORTS == 4
+ISR(PCINT3_vect){
+	pin_change();
+}
+#endif
@@ -3,12 +3,51 @@
 
 #include <avr/io.h>
 #include <stdlib.h>
-#include <util/delay.h>
+
+#ifndef DISTANCE_MAX_SENSORS
+#define DISTANCE_MAX_SENSORS 4
+#endif
+#ifndef DISTANCE_QUEUE_SIZE
+#define DISTANCE_QUEUE_SIZE 8
+#endif
+#ifndef DISTANCE_TIMEOUT_US
+#define DISTANCE_TIMEOUT_US 25000
+#endif
+#ifndef DISTANCE_MEDIAN
+#define DISTANCE_MEDIAN 3
+#endif
 
 namespace digitalcave {
 	/*
-	 * C++ implementation of distance sensor library.  Uses timer2 for measuring time, but turns it on
-	 * and off within the read loop, so can be shared among multiple instances of this class.
+	 * A reading from one ping, as returned by Distance::poll().
+	 */
+	typedef struct distance_reading_t {
+		uint8_t sensor;			//Index of the sensor, in the order they were created
+		uint16_t distance;		//Filtered distance in mm
+		uint16_t raw;			//Distance in mm from this ping alone; 0 if there was no echo
+		uint32_t time;			//ms since Distance::start(), when the echo ended (or timed out)
+	} distance_reading_t;
+
+	/*
+	 * C++ implementation of distance sensor library (HC-SR04 and compatible).
+	 *
+	 * Pinging happens in the background: the sensors are triggered one after another, round robin,
+	 * and the echo pulses are timed by interrupts.  Timer 1 runs at F_CPU / 8 (0.5us at 16MHz); an
+	 * echo on the ICP1 pin (PB0 on the ATmega48/88/168/328, PD6 on the ATmega164/324/644/1284) is
+	 * timed by input capture, and any other echo pin by its pin change interrupt.  This uses Timer 1
+	 * (overflow, compare A and input capture interrupts) and the pin change interrupt vectors, so
+	 * they can't be used for anything else.
+	 *
+	 * Each reading goes through a median filter (over the last DISTANCE_MEDIAN pings of that sensor,
+	 * to throw away odd reflections) and a Kalman filter (to smooth out the noise), which also ignores
+	 * readings which are far from its estimate unless several come in a row.
+	 *
+	 * You can set the following defines (either in code or in the Makefile):
+	 * DISTANCE_MAX_SENSORS		Most sensors which can be created.  Defaults to 4
+	 * DISTANCE_QUEUE_SIZE		Readings which can be waiting for poll().  Defaults to 8
+	 * DISTANCE_TIMEOUT_US		No echo by this long after the trigger means nothing in range (25000 is about 4.3m).
+	 *							Must be less than 65536 timer ticks.  Defaults to 25000
+	 * DISTANCE_MEDIAN			Number of pings in the median filter; odd, and at most 7.  Defaults to 3
 	 */
 	class Distance {
 		private:
@@ -16,19 +55,67 @@ namespace digitalcave {
 			uint8_t trigger_num;					//The pin number (on trigger_port) for the trigger
 			volatile uint8_t *data_pin;				//The PIN for reading the response
 			uint8_t data_num;						//The pin number (on data_pin) for the data line
-	
+			uint8_t index;							//Position in the round robin
+
+			//Filter state
+			uint16_t window[DISTANCE_MEDIAN];		//The last few raw readings, for the median filter
+			uint8_t window_count;
+			uint8_t window_position;
+			float estimate;							//Kalman filter estimate (mm) and its variance
+			float variance;
+			float q;								//Process noise (mm^2 per ping)
+			float r;								//Measurement noise (mm^2)
+			uint8_t rejected;						//Readings in a row which were too far from the estimate
+			uint16_t distance;						//Last filtered distance
+
+			uint16_t filter(uint16_t raw);
+
 		public:
 			/*
-			 * To initialize this, you must pass in references to the port and pin.  E.g. if you were 
+			 * To initialize this, you must pass in references to the port and pin.  E.g. if you were
 			 * to use pins C5 and C4 for the trigger and data respectively, you would init with
 			 * values:
 			 * Distance(&PORTC, PORTC5, &PINC, PINC4);
+			 * The trigger pin is set to output.  Create all of the sensors before calling start().
+			 * The data pin must be ICP1 or on a port with pin change interrupts; otherwise (or if there
+			 * are already DISTANCE_MAX_SENSORS) the sensor is not added, and read() always returns 0.
 			 */
 			Distance(volatile uint8_t *trigger_port, uint8_t trigger_num, volatile uint8_t *data_pin, uint8_t data_num);
-			
+
+			/*
+			 * Starts pinging the sensors in turn, one every interval ms (at least DISTANCE_TIMEOUT_US
+			 * plus 1ms; the HC-SR04 wants 60ms between pings so that old echoes have died away).
+			 * Enables interrupts.
+			 */
+			static void start(uint16_t interval = 60);
+
+			/*
+			 * Stops pinging, once the current ping has finished.
+			 */
+			static void stop();
+
+			/*
+			 * Takes the oldest reading off the queue, filters it, and copies it into reading.  Returns
+			 * 1 if there was one, 0 if not; never waits.  Call this often enough that the queue doesn't
+			 * fill up (readings are dropped, and counted in getOverruns(), if it does).
+			 */
+			static uint8_t poll(distance_reading_t* reading);
+
+			/*
+			 * Returns the number of readings dropped because the queue was full, and resets it.
+			 */
+			static uint8_t getOverruns();
+
+			/*
+			 * Sets the Kalman filter tuning.  q is how much the distance is expected to change between
+			 * pings, and r how noisy each ping is (both as a variance, in mm^2).  Larger r / q is
+			 * smoother but slower to follow; r = 0 turns the Kalman filter off.  Defaults to 25, 100.
+			 */
+			void setFilter(float q, float r);
+
 			/*
-			 * Signals the distance sensor to ping, and reads the distance value.  Returns the distance
-			 * in mm to the object.
+			 * Returns the last filtered distance in mm to the object (0 until the first echo).  This
+			 * does not wait for a ping; readings are only filtered by poll(), so that must be called.
 			 */
 			uint16_t read();
 	} ;
@@ -15,6 +15,12 @@ uint8_t Ring::isFull(){
 	return ((this->head + 1) % this->size == this->tail);
 }
 
+uint8_t Ring::count(){
+	uint8_t head = this->head;
+	uint8_t tail = this->tail;
+	return (head >= tail) ? (head - tail) : (this->size - tail + head);
+}
+
 uint8_t Ring::get(){
 	char c = this->buffer[this->tail];
 	if (++this->tail >= this->size) this->tail = 0;
@@ -26,6 +26,7 @@ class Ring {
 		
 		uint8_t isEmpty();
 		uint8_t isFull();
+		uint8_t count();	//Number of bytes waiting to be read
 		
 		uint8_t get();
 		void put(uint8_t data);
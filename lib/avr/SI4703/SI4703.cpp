@@ -5,6 +5,11 @@ using namespace digitalcave;
 Si4703_Breakout::Si4703_Breakout(volatile uint8_t *resetPort, uint8_t resetPin){
 	this->resetPort = resetPort;
 	this->resetPin = resetPin;
+	this->dirty = 0;
+	this->state = STATE_IDLE;
+	this->seekFailed = 0;
+	this->rdsHeld = 0;
+	for (uint8_t i = 0; i < 4; i++) this->rdsGroup[i] = 0;
 
 	//Set up /RST pin in output mode
 	*(resetPort - 0x01) |= _BV(resetPin);
@@ -21,27 +26,27 @@ Si4703_Breakout::Si4703_Breakout(volatile uint8_t *resetPort, uint8_t resetPin){
 	twi_init(); //Now that the unit is reset and I2C inteface mode, we need to begin I2C
 
 	//Configure the si4703 to use the crystal
-	readRegisters(); //Read the current register set
-	this->si4703_registers[0x07] = 0x8100; //Enable the oscillator, from AN230 page 9, rev 0.61 (works)
+	readRegisters(16); //Read the current register set
+	this->si4703_registers[TEST1] = 0x8100; //Enable the oscillator, from AN230 page 9, rev 0.61 (works)
+	this->dirty |= _BV(TEST1);
 	updateRegisters(); //Update
 	_delay_ms(500); //Wait for clock to settle - from AN230 page 9
 
 	//Power up the si4703 with our default settings
-	//(No Mute, RDS Enabled, 200kHz channel spacing, lowest volume
-	readRegisters(); //Read the current register set
-	this->si4703_registers[POWERCFG] = 0x4001; //Enable the IC
-	//this->si4703_registers[SYSCONFIG1] |= (1<<RDS); //Enable RDS
+	//(No Mute, RDS Enabled (verbose, so that we get the block errors), 200kHz channel spacing, lowest volume
+	readRegisters(16); //Read the current register set
+	this->si4703_registers[POWERCFG] = 0x4001 | (1<<RDSM); //Enable the IC
+	this->si4703_registers[SYSCONFIG1] |= (1<<RDS); //Enable RDS
 
 	this->si4703_registers[SYSCONFIG2] &= ~(1<<SPACE1 | 1<<SPACE0) ; //Force 200kHz channel spacing for USA
 
 	this->si4703_registers[SYSCONFIG2] &= 0xFFF0; //Clear volume bits
 	this->si4703_registers[SYSCONFIG2] |= 0x0001; //Set volume to lowest
+	this->dirty |= _BV(POWERCFG) | _BV(SYSCONFIG1) | _BV(SYSCONFIG2);
 	updateRegisters(); //Update
 
 	//Give the si4703 enough time to power up.
 	_delay_ms(110); //Max powerup time, from datasheet page 13
-
-	readRegisters();
 }
 void Si4703_Breakout::powerOn()
 {
@@ -49,149 +54,179 @@ void Si4703_Breakout::powerOn()
 }
 
 
-//Reads the current channel from READCHAN
-//Returns a number like 973 for 97.3MHz
+//Returns the current channel, like 973 for 97.3MHz.  Once tuned it comes from the shadow copy of CHANNEL;
+// while seeking, from READCHAN.
 uint16_t Si4703_Breakout::getChannel() {
 	//Freq (MHZ) = channel / 10 = 0.2 * 10_bit_register_value + 87.5 MHz, therefore
 	//Freq (KHz * 100) = channel = 2 * 10_bit_register_value * 10 + 8750
 	// channel = 20 * 10_bit_register_value + 8750
 
-  readRegisters();
-  uint16_t regValue = si4703_registers[CHANNEL] & 0x03FF; //Mask out everything but the lower 10 bits
-  return 2 * regValue + 875;
+	uint16_t regValue;
+	if (state == STATE_SEEKING) {
+		readRegisters(2);
+		regValue = si4703_registers[READCHAN] & 0x03FF;
+	}
+	else {
+		regValue = si4703_registers[CHANNEL] & 0x03FF; //Mask out everything but the lower 10 bits
+	}
+	return 2 * regValue + 875;
 }
 
 void Si4703_Breakout::setChannel(uint16_t channel) {
 	uint16_t regValue = (channel - 875) / 2;
 
-	//These steps come from AN230 page 20 rev 0.5
-	readRegisters();
-	si4703_registers[CHANNEL] &= 0xFE00; //Clear out the channel bits
+	//These steps come from AN230 page 20 rev 0.5; tick() does the rest.
+	if (state == STATE_SEEKING) {
+		si4703_registers[POWERCFG] &= ~(1<<SEEK); //Tuning stops a seek
+		dirty |= _BV(POWERCFG);
+	}
+	si4703_registers[CHANNEL] &= 0xFC00; //Clear out the channel bits
 	si4703_registers[CHANNEL] |= regValue; //Mask in the new channel
 	si4703_registers[CHANNEL] |= (1<<TUNE); //Set the TUNE bit to start
+	dirty |= _BV(CHANNEL);
 	updateRegisters();
 
-	//_delay_ms(60); //Wait 60ms - you can use or skip this delay
-
-	//Poll to see if STC is set
-	while(1) {
-		readRegisters();
-		if( (si4703_registers[STATUSRSSI] & (1<<STC)) != 0) break; //Tuning complete!
-	}
+	state = STATE_TUNING;
+	rdsHeld = 0;
+}
 
-	readRegisters();
-	si4703_registers[CHANNEL] &= ~(1<<TUNE); //Clear the tune after a tune has completed
-	updateRegisters();
+void Si4703_Breakout::seekUp()
+{
+	seek(SEEK_UP);
+}
 
-	//Wait for the si4703 to clear the STC as well
-	while(1) {
-		readRegisters();
-		if( (si4703_registers[STATUSRSSI] & (1<<STC)) == 0) break; //Tuning complete!
-	}
+void Si4703_Breakout::seekDown()
+{
+	seek(SEEK_DOWN);
 }
 
-uint16_t Si4703_Breakout::seekUp()
+uint8_t Si4703_Breakout::isBusy()
 {
-	return seek(SEEK_UP);
+	return state != STATE_IDLE;
 }
 
-uint16_t Si4703_Breakout::seekDown()
+uint8_t Si4703_Breakout::getVolume()
 {
-	return seek(SEEK_DOWN);
+	return si4703_registers[SYSCONFIG2] & 0x000F;
 }
 
-void Si4703_Breakout::setVolume(uint16_t volume)
+void Si4703_Breakout::setVolume(uint8_t volume)
 {
-  readRegisters(); //Read the current register set
-  if(volume < 0) volume = 0;
   if (volume > 15) volume = 15;
-  si4703_registers[SYSCONFIG2] &= 0xFFF0; //Clear volume bits
-  si4703_registers[SYSCONFIG2] |= volume; //Set new volume
+  uint16_t value = (si4703_registers[SYSCONFIG2] & 0xFFF0) | volume;
+  if (value == si4703_registers[SYSCONFIG2]) return;
+  si4703_registers[SYSCONFIG2] = value; //Set new volume
+  dirty |= _BV(SYSCONFIG2);
   updateRegisters(); //Update
 }
-/*
-void Si4703_Breakout::readRDS(char* buffer, long timeout){
-	long endTime = millis() + timeout;
-  boolean completed[] = {false, false, false, false};
-  int completedCount = 0;
-  while(completedCount < 4 && millis() < endTime) {
-	readRegisters();
-	if(si4703_registers[STATUSRSSI] & (1<<RDSR)){
-		// ls 2 bits of B determine the 4 letter pairs
-		// once we have a full set return
-		// if you get nothing after 20 readings return with empty string
-	  uint16_t b = si4703_registers[RDSB];
-	  int index = b & 0x03;
-	  if (! completed[index] && b < 500)
-	  {
-		completed[index] = true;
-		completedCount ++;
-	  	char Dh = (si4703_registers[RDSD] & 0xFF00) >> 8;
-      	char Dl = (si4703_registers[RDSD] & 0x00FF);
-		buffer[index * 2] = Dh;
-		buffer[index * 2 +1] = Dl;
-		// Serial.print(si4703_registers[RDSD]); Serial.print(" ");
-		// Serial.print(index);Serial.print(" ");
-		// Serial.write(Dh);
-		// Serial.write(Dl);
-		// Serial.println();
-      }
-      _delay_ms(40); //Wait for the RDS bit to clear
-	}
-	else {
-	  _delay_ms(30); //From AN230, using the polling method 40ms should be sufficient amount of time between checks
+
+uint16_t* Si4703_Breakout::getRdsGroup()
+{
+	return rdsGroup;
+}
+
+uint8_t Si4703_Breakout::tick()
+{
+	if (state == STATE_TUNING || state == STATE_SEEKING) {
+		//Poll to see if STC is set (and for a seek, where it got to)
+		readRegisters(state == STATE_SEEKING ? 2 : 1);
+		if ((si4703_registers[STATUSRSSI] & (1<<STC)) == 0) return 0;
+
+		if (state == STATE_SEEKING) {
+			seekFailed = (si4703_registers[STATUSRSSI] & (1<<SFBL)) ? 1 : 0; //The bit is set if we hit a band limit or failed to find a station
+			si4703_registers[POWERCFG] &= ~(1<<SEEK); //Clear the seek bit after seek has completed
+			dirty |= _BV(POWERCFG);
+
+			//After a seek has completed, set CHANNEL with the newly seek'd channel (from READCHAN).  It goes
+			// to the chip with the next write which reaches it; the chip doesn't need it.
+			if (!seekFailed) {
+				si4703_registers[CHANNEL] &= ~0x03FF;	//Clear 10 LSB in CHANNEL
+				si4703_registers[CHANNEL] |= (si4703_registers[READCHAN] & 0x03FF);
+			}
+		}
+		else {
+			seekFailed = 0;
+			si4703_registers[CHANNEL] &= ~(1<<TUNE); //Clear the tune after a tune has completed
+			dirty |= _BV(CHANNEL);
+		}
+		updateRegisters();
+		state = STATE_CLEARING;
+		return 0;
 	}
-  }
-	if (millis() >= endTime) {
-		buffer[0] ='\0';
-		return;
+	if (state == STATE_CLEARING) {
+		//Wait for the si4703 to clear the STC as well
+		readRegisters(1);
+		if ((si4703_registers[STATUSRSSI] & (1<<STC)) != 0) return 0;
+		state = STATE_IDLE;
+		return SI4703_TUNED | (seekFailed ? SI4703_SEEK_FAILED : 0);
 	}
+	if ((si4703_registers[SYSCONFIG1] & (1<<RDS)) == 0) return 0;
 
-  buffer[8] = '\0';
+	//Just STATUSRSSI, to see if there is a new group; then through RDSD, to get it
+	readRegisters(1);
+	if ((si4703_registers[STATUSRSSI] & (1<<RDSR)) == 0) {
+		rdsHeld = 0;
+		return 0;
+	}
+	//RDSR stays set for about 40ms after each group (and they come every 88ms), so the group is only read
+	// when it goes up; unless it seems to be stuck up.
+	if (rdsHeld && rdsHeld++ < SI4703_RDSR_POLLS) return 0;
+	rdsHeld = 1;
+	readRegisters(6);
+
+	//Drop groups with any block which couldn't be corrected
+	if (((si4703_registers[STATUSRSSI] >> BLERA) & 0x03) == 0x03) return 0;
+	if (((si4703_registers[READCHAN] >> BLERB) & 0x03) == 0x03) return 0;
+	if (((si4703_registers[READCHAN] >> BLERC) & 0x03) == 0x03) return 0;
+	if (((si4703_registers[READCHAN] >> BLERD) & 0x03) == 0x03) return 0;
+
+	//A stuck ready flag can give us a group we have already seen
+	uint8_t same = 1;
+	for (uint8_t i = 0; i < 4; i++) {
+		if (rdsGroup[i] != si4703_registers[RDSA + i]) same = 0;
+		rdsGroup[i] = si4703_registers[RDSA + i];
+	}
+	return same ? 0 : SI4703_RDS;
 }
-*/
 
-//Read the entire register control set from 0x00 to 0x0F
+//Read the first count registers, starting from 0x0A (0x0A to 0x0F then 0x00 to 0x09; 16 is the entire set)
 //Re-written by Wyatt Olson to use i2c_master library instead of Arduino Wire library.
-void Si4703_Breakout::readRegisters(){
+void Si4703_Breakout::readRegisters(uint8_t count){
 	uint8_t message[32];	//32 uint8_t
 
 	//Si4703 begins reading from register upper register of 0x0A and reads to 0x0F, then loops to 0x00. (see datasheet page 19)
-	// We want to read the entire register set from 0x0A to 0x09 = 32 uint8_ts.
-	twi_read_from(SI4703_ADDRESS, message, 32, TWI_STOP);
-	//i2c_get_data_from_transceiver(message, 33);
+	twi_read_from(SI4703_ADDRESS, message, count * 2, TWI_STOP);
 
 	//Remember, register 0x0A comes in first so we have to shuffle the array around a bit
-	uint8_t j = 1;
-	for (uint8_t i = 0x0A; ; i++) { //Read in these 32 uint8_ts
-		if (i == 0x10) i = 0; //Loop back to zero
-		this->si4703_registers[i] = ((uint16_t) message[j++]) << 8;
-		this->si4703_registers[i] |= message[j++];
-
-		if (j == 34 || i == 0x09) break; //We're done!
+	uint8_t j = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		uint8_t r = (0x0A + i) & 0x0F; //Loop back to zero
+		this->si4703_registers[r] = ((uint16_t) message[j++]) << 8;
+		this->si4703_registers[r] |= message[j++];
 	}
 }
 
-//Write the current 9 control registers (0x02 to 0x07) to the Si4703
+//Write the control registers which changed to the Si4703
 //It's a little weird, you don't write an I2C addres
-//The Si4703 assumes you are writing to 0x02 first, then increments
+//The Si4703 assumes you are writing to 0x02 first, then increments; so we write from 0x02 up to the last changed one.
 //Re-written by Wyatt Olson to use i2c_master library instead of Arduino Wire library.
-uint8_t Si4703_Breakout::updateRegisters() {
-	uint8_t message[12];		//12 uint8_ts (registers 0x02..0x07, two uint8_ts each)
+void Si4703_Breakout::updateRegisters() {
+	if (dirty == 0) return;
+	uint8_t last = TEST1;
+	while (!(dirty & _BV(last))) last--;
+
+	uint8_t message[12];		//up to 12 uint8_ts (registers 0x02..0x07, two uint8_ts each)
 	uint8_t j = 0;
-	for (uint8_t i = 0x02; i <= 0x07; i++){
+	for (uint8_t i = POWERCFG; i <= last; i++){
 		message[j++] = this->si4703_registers[i] >> 8;
 		message[j++] = this->si4703_registers[i] & 0xFF;
 	}
-	twi_write_to(SI4703_ADDRESS, message, 12, TWI_BLOCK, TWI_STOP);
-	return 1;
+	twi_write_to(SI4703_ADDRESS, message, j, TWI_BLOCK, TWI_STOP);
+	dirty = 0;
 }
 
-//Seeks out the next available station
-//Returns the freq if it made it
-//Returns zero if failed
-uint16_t Si4703_Breakout::seek(uint8_t seekDirection){
-  readRegisters();
+//Starts seeking out the next available station; tick() returns SI4703_TUNED when it is done
+void Si4703_Breakout::seek(uint8_t seekDirection){
   //Set seek mode wrap bit
   si4703_registers[POWERCFG] |= (1<<SKMODE); //Allow wrap
   //si4703_registers[POWERCFG] &= ~(1<<SKMODE); //Disallow wrap - if you disallow wrap, you may want to tune to 87.5 first
@@ -199,34 +234,9 @@ uint16_t Si4703_Breakout::seek(uint8_t seekDirection){
   else si4703_registers[POWERCFG] |= 1<<SEEKUP; //Set the bit to seek up
 
   si4703_registers[POWERCFG] |= (1<<SEEK); //Start seek
+  dirty |= _BV(POWERCFG);
   updateRegisters(); //Seeking will now start
 
-  //Poll to see if STC is set
-  while(1) {
-    readRegisters();
-    if((si4703_registers[STATUSRSSI] & (1<<STC)) != 0) break; //Tuning complete!
-  }
-
-  readRegisters();
-  uint16_t valueSFBL = si4703_registers[STATUSRSSI] & (1<<SFBL); //Store the value of SFBL
-  si4703_registers[POWERCFG] &= ~(1<<SEEK); //Clear the seek bit after seek has completed
-  updateRegisters();
-
-  //Wait for the si4703 to clear the STC as well
-  while(1) {
-    readRegisters();
-    if( (si4703_registers[STATUSRSSI] & (1<<STC)) == 0) break; //Tuning complete!
-  }
-
-  if(valueSFBL) { //The bit was set indicating we hit a band limit or failed to find a station
-    return(0);
-  }
-
-	//After a seek has completed, set CHANNEL register with the newly seek'd channel (from READCHAN).
-  si4703_registers[CHANNEL] &= ~0x03FF;	//Clear 10 LSB in CHANNEL
-  si4703_registers[CHANNEL] |= (si4703_registers[READCHAN] & 0x03FF);
-
-  updateRegisters();
-
-  return getChannel();
+  state = STATE_SEEKING;
+  rdsHeld = 0;
 }
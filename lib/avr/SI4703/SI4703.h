@@ -50,32 +50,60 @@ cables. Too short of a cable may degrade reception.
 #include <util/delay.h>
 #include "../twi/twi.h"
 
+//Flags returned from tick()
+#define SI4703_TUNED			0x01	//A tune or seek is done; getChannel() has the new channel
+#define SI4703_SEEK_FAILED		0x02	//Along with SI4703_TUNED, when a seek hit the band limit without finding anything
+#define SI4703_RDS				0x04	//A new RDS group is in getRdsGroup()
+
+//Polls with the RDS ready flag still up, after reading a group, before reading again anyway
+#define SI4703_RDSR_POLLS		4
+
 namespace digitalcave {
 
+	/*
+	 * The control registers (0x02 - 0x07) are kept in a shadow copy, which is read from the chip once at
+	 * power up; after that every change goes through it, so (as Nathan advises) nothing is written
+	 * which doesn't match what is in the chip, without reading it all back first.  Writes always start
+	 * at 0x02, so each one only goes as far as the last register which changed.  Reads always start at
+	 * 0x0A, so each one only goes as far as the status registers it needs.
+	 *
+	 * Nothing waits for the chip.  setChannel() and seekUp() / seekDown() start the operation and return;
+	 * tick() (called regularly from the main loop, every 10 - 40ms) finishes it off, and picks up each
+	 * new RDS group, dropping ones with uncorrectable errors.  Pass the groups to RDS (inc/common/RDS) to
+	 * decode them.
+	 */
 	class Si4703_Breakout{
 	  public:
 		Si4703_Breakout(volatile uint8_t *resetPort, uint8_t resetPin);
 		void powerOn();					// call in setup
-		uint16_t getChannel();
-		void setChannel(uint16_t channel);  	// 3 digit channel number
-		uint16_t seekUp(); 					// returns the tuned channel or 0
-		uint16_t seekDown();
-		void setVolume(uint16_t volume); 	// 0 to 15
-		void readRDS(char* message, long timeout);
-										// message should be at least 9 chars
-										// result will be null terminated
-										// timeout in milliseconds
+		uint16_t getChannel();			// returns a number like 973 for 97.3MHz
+		void setChannel(uint16_t channel);  	// 3 digit channel number; starts tuning
+		void seekUp(); 					// starts seeking
+		void seekDown();
+		uint8_t isBusy();				// returns 1 while tuning or seeking
+		uint8_t tick();					// returns SI4703_* flags
+		uint16_t* getRdsGroup();		// blocks A - D of the last group from tick(); valid until the next tick()
+		uint8_t getVolume();
+		void setVolume(uint8_t volume); 	// 0 to 15
 	  private:
 		// Port / pin for /RST
 		volatile uint8_t *resetPort;
 		uint8_t resetPin;
 
-		void readRegisters();
-		uint8_t updateRegisters();
-		uint16_t seek(uint8_t seekDirection);
+		void readRegisters(uint8_t count);
+		void updateRegisters();
+		void seek(uint8_t seekDirection);
 		uint16_t si4703_registers[16]; //There are 16 registers, each 16 bits large
-		static const uint8_t  FAIL = 0;
-		static const uint8_t  SUCCESS = 1;
+		uint8_t dirty;				//A bit for each control register which has changed since it was written
+		uint8_t state;				//STATE_*
+		uint8_t seekFailed;
+		uint8_t rdsHeld;			//Polls since the last RDS group was read, while the ready flag has stayed up
+		uint16_t rdsGroup[4];
+
+		static const uint8_t  STATE_IDLE = 0;
+		static const uint8_t  STATE_TUNING = 1;
+		static const uint8_t  STATE_SEEKING = 2;
+		static const uint8_t  STATE_CLEARING = 3;	//Done, waiting for the chip to clear STC
 
 		static const uint8_t SI4703_ADDRESS = 0x10;
 		static const uint8_t  SEEK_DOWN = 0; //Direction used for seeking. Default is down
@@ -88,6 +116,7 @@ namespace digitalcave {
 		static const uint8_t  CHANNEL = 0x03;
 		static const uint8_t  SYSCONFIG1 = 0x04;
 		static const uint8_t  SYSCONFIG2 = 0x05;
+		static const uint8_t  TEST1 = 0x07;
 		static const uint8_t  STATUSRSSI = 0x0A;
 		static const uint8_t  READCHAN = 0x0B;
 		static const uint8_t  RDSA = 0x0C;
@@ -98,6 +127,7 @@ namespace digitalcave {
 		//Register 0x02 - POWERCFG
 		static const uint8_t  SMUTE = 15;
 		static const uint8_t  DMUTE = 14;
+		static const uint8_t  RDSM = 11;
 		static const uint8_t  SKMODE = 10;
 		static const uint8_t  SEEKUP = 9;
 		static const uint8_t  SEEK = 8;
@@ -119,7 +149,13 @@ namespace digitalcave {
 		static const uint8_t  SFBL = 13;
 		static const uint8_t  AFCRL = 12;
 		static const uint8_t  RDSS = 11;
+		static const uint8_t  BLERA = 9;		//2 bits, in RDS verbose mode; 3 means uncorrectable
 		static const uint8_t  STEREO = 8;
+
+		//Register 0x0B - READCHAN
+		static const uint8_t  BLERB = 14;
+		static const uint8_t  BLERC = 12;
+		static const uint8_t  BLERD = 10;
 	};
 }
 #endif
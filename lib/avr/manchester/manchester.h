@@ -14,14 +14,46 @@ void manchester_write(uint8_t *data, uint8_t length);
 
 // rx
 
+//The largest frame (in bytes of data) which can be received, and the number of received frames which
+// can be waiting to be read.  Override these in the makefile (CDEFS) if needed.  The frame count must be
+// a power of two (up to 128): the queue indices are free running 8 bit counters taken modulo the count,
+// which only stays in step across the wrap at 256 for a power of two.
+#ifndef MANCHESTER_FRAME_SIZE
+#define MANCHESTER_FRAME_SIZE 32
+#endif
+#ifndef MANCHESTER_FRAME_COUNT
+#define MANCHESTER_FRAME_COUNT 4
+#endif
+#if MANCHESTER_FRAME_COUNT < 1 || MANCHESTER_FRAME_COUNT > 128 || (MANCHESTER_FRAME_COUNT & (MANCHESTER_FRAME_COUNT - 1)) != 0
+#error MANCHESTER_FRAME_COUNT must be a power of two, from 1 to 128
+#endif
+
+typedef struct manchester_stats_t {
+	uint16_t frames;		// frames received with a good checksum
+	uint16_t timing;		// frames lost to edges which came too soon or too late
+	uint16_t checksum;		// frames lost to bad checksums
+	uint16_t length;		// frames lost because they were empty or longer than MANCHESTER_FRAME_SIZE
+	uint16_t overflow;		// good frames lost because MANCHESTER_FRAME_COUNT frames were already waiting
+} manchester_stats_t;
+
 void manchester_init_rx(uint16_t baud);
 
+/*
+ * Returns the number of frames waiting to be read.
+ */
 uint8_t manchester_available();
 
 /*
- * Copies data from the buffer to the destination, up to a maximum of max.
- * Returns the number of bytes copied
- */ 
- uint8_t manchester_read(uint8_t *dst, uint8_t max);
+ * Copies the oldest waiting frame to the destination, up to a maximum of max bytes (the rest of
+ * the frame is discarded), and removes it from the queue.  Does not block.
+ * Returns the length of the frame, or 0 if there are no frames waiting.
+ */
+uint8_t manchester_read(uint8_t *dst, uint8_t max);
+
+/*
+ * Copies the receive error counters.
+ */
+void manchester_stats(manchester_stats_t *stats);
+void manchester_reset_stats();
 
 #endif
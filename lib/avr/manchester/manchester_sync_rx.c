@@ -1,157 +1,212 @@
 /*
- * A manchester signal receiver.
+ * A manchester signal receiver.  Decoding happens entirely in the INT0 ISR; each complete frame
+ * is checked against its checksum and put into a small queue of frames, so that frames which arrive
+ * while the application is busy are kept (up to MANCHESTER_FRAME_COUNT of them) rather than overwritten.
+ * manchester_read() takes the oldest frame off the queue without waiting.
+ *
+ * The bit time T is F_CPU / 1024 / baud timer ticks; at 16MHz the baud rate can be from about 160
+ * (T must be less than 255 * 2/5) up to a few thousand (beyond which the timing thresholds get too coarse).
  */
 
 #include "manchester.h"
 #include <avr/interrupt.h>
 
-#define MANCHESTER_BUFFER_SIZE 40
-// messages are escaped so that they never contain ff, fe, or 7d
-// ff and fe are escaped so that we don't mistake real data for a preamble if the current state is to listen for preamble
+// messages are escaped so that they never contain fe or 7d
+// fe is escaped so that we don't mistake real data for a preamble if the current state is to listen for preamble
 
 #define ESCAPE 0x7d
+#define PREAMBLE 0xfeff		// ff fe, as received (LSB first)
 
-static uint16_t _lower;	// 1/4
-static uint16_t _mid;   	// 3/4
-static uint16_t _upper;	// 5/4
+static uint8_t _lower;	// 1/2 T
+static uint8_t _mid;   	// 3/2 T
+static uint8_t _upper;	// 5/2 T
 
-static volatile uint8_t _buf[MANCHESTER_BUFFER_SIZE];
-static volatile uint8_t _sig;		// current signal position in the bit (1 = T, 0 = 2T)
+static volatile uint8_t _frames[MANCHESTER_FRAME_COUNT][MANCHESTER_FRAME_SIZE];
+static volatile uint8_t _lengths[MANCHESTER_FRAME_COUNT];
+static volatile uint8_t _head;		// frames received (the ISR writes into slot _head % MANCHESTER_FRAME_COUNT)
+static volatile uint8_t _tail;		// frames read
+
+static volatile manchester_stats_t _stats;
+
+static volatile uint8_t _ovf;		// the timer has overflowed since the last edge
+static volatile uint8_t _sig;		// 1 = the last edge was at a bit boundary, 0 = it was in the middle of a bit
+static volatile uint16_t _shift;	// the last 16 bits, while listening for the preamble
 static volatile uint8_t _bit;		// current bit position in the byte
 static volatile uint8_t _pos;		// current byte position in the frame
 static volatile uint8_t _len;		// current frame length
 static volatile uint8_t _b;			// current byte being read
 static volatile uint8_t _chk;		// running checksum
-static volatile uint8_t _rdy;		// 0 = not at the end of a frame, > 0 = number of bytes available to read from the frame
+static volatile uint8_t _drop;		// the queue was full when this frame started; don't keep it
 static volatile uint8_t _st; 		// current frame state: 0 = listening for preamble, 1 = reading byte, 2 = reading escaped byte
 
 void manchester_init_rx(uint16_t baud) {
 	TCCR0A = 0x0; 				// normal mode
-	TCCR0B |= _BV(CS02) | _BV(CS00);        // F_CPU / 256 prescaler
-	
-	uint8_t half = F_CPU / 1024 / baud;	//52 at 16MHz and 300 baud
-	_lower = half / 2;			//26 at "
-	_mid = _lower + half;			//78 at "
-	_upper = _mid + half;			//130 at "
+	TCCR0B |= _BV(CS02) | _BV(CS00);        // F_CPU / 1024 prescaler
+	TIMSK0 |= _BV(TOIE0);		// overflow interrupt, to tell long gaps from short ones
+
+	uint8_t t = F_CPU / 1024 / baud;	//52 at 16MHz and 300 baud
+	_lower = t / 2;				//26 at "
+	_mid = _lower + t;			//78 at "
+	_upper = _mid + t;			//130 at "
 
 	EICRA |= _BV(ISC00);		// any logical change on int0
 	EIMSK |= _BV(INT0);			// enable external interrupts on int0
-	
+
 	sei();
 }
 
 uint8_t manchester_available() {
-	return _rdy;
+	return _head - _tail;
 }
 
 uint8_t manchester_read(uint8_t *dst, uint8_t max) {
-	while (!manchester_available());  // block until a frame has been read
-	uint8_t result = _rdy;
-	_rdy = 0;
+	if (_head == _tail) return 0;
+
+	uint8_t slot = _tail % MANCHESTER_FRAME_COUNT;
+	uint8_t result = _lengths[slot];
 	for (uint8_t i = 0; i < result && i < max; i++) {
-		dst[i] = _buf[i];
+		dst[i] = _frames[slot][i];
 	}
+	_tail++;				// only now can the ISR re-use the slot
 	return result;
 }
 
-static inline void readBit() {
-	uint8_t input = PIND & _BV(PIND2);
-	
-	if (input) PORTC |= _BV(PORTC2);	//TODO remove
-	else PORTC &= ~_BV(PORTC2);			//TODO remove
-	
+void manchester_stats(manchester_stats_t *stats) {
+	uint8_t sreg = SREG;
+	cli();
+	stats->frames = _stats.frames;
+	stats->timing = _stats.timing;
+	stats->checksum = _stats.checksum;
+	stats->length = _stats.length;
+	stats->overflow = _stats.overflow;
+	SREG = sreg;
+}
+
+void manchester_reset_stats() {
+	uint8_t sreg = SREG;
+	cli();
+	_stats.frames = 0;
+	_stats.timing = 0;
+	_stats.checksum = 0;
+	_stats.length = 0;
+	_stats.overflow = 0;
+	SREG = sreg;
+}
+
+// give up on the current frame, and go back to listening for a preamble
+static inline void abort_frame() {
+	_st = 0;
+	_shift = 0;
+}
+
+static inline void read_bit(uint8_t input) {
 	if (_st == 0) {
-		// preamble
-		if (input) {
-			_bit++;
-			if (_bit > 7) _bit = 7;
-		} else {
-			if (_bit >= 7) {
-				// first zero after 7 or more ones; sync
-				_st = 1;
-				PORTC |= _BV(PORTC5);	//TODO remove
-			}
+		// preamble; eight 1s, then a 0 followed by seven 1s, which can't otherwise appear at the
+		// start of a byte (fe is escaped).
+		_shift >>= 1;
+		if (input) _shift |= 0x8000;
+		if (_shift == PREAMBLE) {
+			_st = 1;
 			_bit = 0;
 			_b = 0x00;
+			_pos = 0;
+			_chk = 0;
+			_drop = (uint8_t) (_head - _tail) >= MANCHESTER_FRAME_COUNT;
 		}
-	} else {
-		// data
-		if (input) {
-			_b |= _BV(_bit);
+		return;
+	}
+
+	// data
+	if (input) {
+		_b |= _BV(_bit);
+	}
+	_bit++;
+	if (_bit < 8) return;
+
+	uint8_t b = _b;
+	_bit = 0;
+	_b = 0x00;
+
+	if (b == ESCAPE && _st == 1) {
+		_st = 2;
+		return;
+	}
+	if (_st == 2) {
+		b = 0x20 ^ b;
+		_st = 1;
+	}
+
+	if (_pos == 0) {
+		// length byte; empty frames are not delivered, since there would be nothing to read
+		if (b == 0 || b > MANCHESTER_FRAME_SIZE) {
+			_stats.length++;
+			abort_frame();
+			return;
 		}
-		_bit++;
-		
-		if (_bit >= 8) {
-			uint8_t b = _b;
-			_bit = 0;
-			PORTC &= ~_BV(PORTC5);			// TODO remove
-			
-			if (b == ESCAPE) {
-				_st = 2;
-				return;
-			}
-			if (_st == 2) {
-				b = 0x20 ^ b;
-				_st = 1;
-			}
-			
-			if (_pos == 0) {
-				// length byte
-				_len = b;
-				_pos++;
+		_len = b;
+		_pos++;
+	} else {
+		// data byte
+		_chk += b;
+		if (_pos == (_len + 1)) {
+			// checksum byte
+			if (_chk != 0xff) {
+				_stats.checksum++;
+			} else if (_drop) {
+				_stats.overflow++;
 			} else {
-				// data byte
-				_chk += b;
-				if (_pos == (_len + 1)) {
-					if (_chk == 0xff) {
-						_rdy = _len;
-					}
-					_st = 0;
-					_pos = 0;
-					_chk = 0;
-				} else {
-					_buf[_pos - 1] = b;
-					_pos++;
-				}
+				_lengths[_head % MANCHESTER_FRAME_COUNT] = _len;
+				_head++;
+				_stats.frames++;
 			}
+			abort_frame();
+		} else {
+			// when the queue is full the slot at _head is the oldest unread frame, so leave it alone
+			if (!_drop) _frames[_head % MANCHESTER_FRAME_COUNT][_pos - 1] = b;
+			_pos++;
 		}
 	}
 }
 
 ISR(INT0_vect) {
-	PORTC ^= _BV(PORTC0);		//TODO remove
-	TIMSK0 |= _BV(OCIE0A);		// enable timer
-	
-	uint8_t ck = TCNT0;
+	uint8_t ck = _ovf ? 0xFF : TCNT0;
+	TCNT0 = 0x00;
+	_ovf = 0;
+	uint8_t input = PIND & _BV(PIND2);
+
 	if (ck < _lower) {
-		// error
-		_sig = 0; // clear signal state
+		// too soon; noise, or the edge when the transmitter enables its output
+		if (_st) {
+			_stats.timing++;
+			abort_frame();
+		}
+		_sig = 1;
 	} else if (ck < _mid) {
-		// T
+		// T; from a boundary this is the middle of a bit, and vice versa
 		if (_sig) {
-			PORTC ^= _BV(PORTC1);	//TODO
-			readBit();
+			read_bit(input);
+			_sig = 0;
+		} else {
+			_sig = 1;
 		}
-		_sig ^= _BV(1); // toggle signal state
 	} else if (ck < _upper) {
-		// 2T
-		if (_sig == 0) {
-			readBit();
-			PORTC ^= _BV(PORTC1);	//TODO
-		}
-		else {
-			_sig ^= _BV(1); // toggle signal state
+		// 2T; this can only go from the middle of one bit to the middle of the next
+		if (_sig && _st) {
+			_stats.timing++;
+			abort_frame();
 		}
-	} else {
-		// error / start of message; reset state
+		read_bit(input);
 		_sig = 0;
+	} else {
+		// long gap; this is the start of a message, so the edge is at a bit boundary
+		if (_st) {
+			_stats.timing++;
+			abort_frame();
+		}
+		_sig = 1;
 	}
-	
-	TCNT0 = 0x00;
 }
 
-EMPTY_INTERRUPT(TIMER0_COMPA_vect)
-EMPTY_INTERRUPT(TIMER0_COMPB_vect)
-EMPTY_INTERRUPT(TIMER0_OVF_vect)
-
-
+ISR(TIMER0_OVF_vect) {
+	_ovf = 1;
+}
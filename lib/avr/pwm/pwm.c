@@ -4,6 +4,7 @@ typedef struct pwm_pin_t {
 	volatile uint8_t *port;
 	uint8_t pin;
 	uint16_t compare_value;
+	uint16_t event_value;			//The compare value this pin currently has in _pwm_events_low_new.  Differs from compare_value until pwm_apply_batch() is called.
 } pwm_pin_t;
 
 typedef struct pwm_event_t {
@@ -46,7 +47,13 @@ static pwm_event_t _pwm_event_high;								//PWM event to set all pins high at s
 static pwm_event_t _pwm_event_high_new;							//Double buffer of pwm high event; copied to pwm_events in OCR1A when _set_phase is non-zero.
 
 static pwm_event_t _pwm_events_low[PWM_MAX_PINS + 1];			//Array of pwm events.  Each event will set one or more pins low.
-static pwm_event_t _pwm_events_low_new[PWM_MAX_PINS + 1];		//Double buffer of pwm events.  Calculated in each set_phase call; copied to pwm_events in OCR1A when _set_phase is non-zero.
+static pwm_event_t _pwm_events_low_new[PWM_MAX_PINS + 1];		//Double buffer of pwm events.  Updated in each apply_batch call; copied to pwm_events in OCR1A when _set_phase is non-zero.
+static uint8_t _pwm_events_count = 0;							//Number of events in _pwm_events_low_new, not including the 0xFFFF terminator.
+
+#ifdef PWM_JITTER_STATS
+volatile uint16_t _pwm_jitter_period = 0;						//Worst number of clicks between OCR1A matching and TCNT1 being reset
+volatile uint16_t _pwm_jitter_phase = 0;						//Worst number of clicks between OCR1B matching and COMPB running; updated in pwm.S
+#endif
 
 static uint16_t _prescaler = 0x0;								//Numeric prescaler (1, 8, etc).  Required for _pwm_micros_to_clicks calls.
 static uint8_t _prescaler_mask = 0x0;							//Prescaler mask corresponding to _prescaler
@@ -66,6 +73,115 @@ static uint16_t _pwm_micros_to_clicks(uint32_t micros){
 	//More testing at different F_CPU values and prescalers are still required.
 }
 
+//Returns a pointer to the mask byte within the given event which corresponds to the given port.
+static uint8_t* _pwm_event_mask(pwm_event_t *e, volatile uint8_t *port){
+#ifndef PWM_PORTA_UNUSED
+	if (port == &PORTA) return &(e->porta_mask);
+#endif
+#ifndef PWM_PORTB_UNUSED
+	if (port == &PORTB) return &(e->portb_mask);
+#endif
+#ifndef PWM_PORTC_UNUSED
+	if (port == &PORTC) return &(e->portc_mask);
+#endif
+#ifndef PWM_PORTD_UNUSED
+	if (port == &PORTD) return &(e->portd_mask);
+#endif
+	return NULL;	//Ignored port
+}
+
+//Sets the event to the 'no-op' state: all masks at 0xFF (nothing is turned off) and a
+// compare value which TCNT1 will never reach.  This is also the terminator of the table.
+static void _pwm_event_clear(pwm_event_t *e){
+	e->compare_value = 0xFFFF;
+#ifndef PWM_PORTA_UNUSED
+	e->porta_mask = 0xFF;
+#endif
+#ifndef PWM_PORTB_UNUSED
+	e->portb_mask = 0xFF;
+#endif
+#ifndef PWM_PORTC_UNUSED
+	e->portc_mask = 0xFF;
+#endif
+#ifndef PWM_PORTD_UNUSED
+	e->portd_mask = 0xFF;
+#endif
+}
+
+//Returns 1 if the event no longer turns off any pins
+static uint8_t _pwm_event_empty(pwm_event_t *e){
+	return 1
+#ifndef PWM_PORTA_UNUSED
+		&& e->porta_mask == 0xFF
+#endif
+#ifndef PWM_PORTB_UNUSED
+		&& e->portb_mask == 0xFF
+#endif
+#ifndef PWM_PORTC_UNUSED
+		&& e->portc_mask == 0xFF
+#endif
+#ifndef PWM_PORTD_UNUSED
+		&& e->portd_mask == 0xFF
+#endif
+	;
+}
+
+//Returns the index of the first event in _pwm_events_low_new with a compare value of at
+// least the given value.  The table is kept sorted, so we can binary search it.
+static uint8_t _pwm_event_find(uint16_t compare_value){
+	uint8_t low = 0;
+	uint8_t high = _pwm_events_count;
+	while (low < high){
+		uint8_t mid = (low + high) >> 1;
+		if (_pwm_events_low_new[mid].compare_value < compare_value) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+
+//Takes the pin out of the event which currently turns it off, deleting the event if
+// no other pins share it.
+static void _pwm_event_remove(pwm_pin_t *p){
+	if (p->event_value == 0) return;	//Pins with a zero phase are never turned on, so are not in the table
+
+	uint8_t *high_mask = _pwm_event_mask(&_pwm_event_high_new, p->port);
+	if (high_mask == NULL) return;
+	*high_mask &= ~_BV(p->pin);
+
+	uint8_t i = _pwm_event_find(p->event_value);
+	pwm_event_t *e = &(_pwm_events_low_new[i]);
+	*_pwm_event_mask(e, p->port) |= _BV(p->pin);
+	if (_pwm_event_empty(e)){
+		//Shift everything after this event (including the terminator) down by one
+		for (; i < _pwm_events_count; i++){
+			_pwm_events_low_new[i] = _pwm_events_low_new[i + 1];
+		}
+		_pwm_events_count--;
+	}
+}
+
+//Adds the pin to the event at its compare value, merging it into an existing event
+// when another pin already turns off at the same time.
+static void _pwm_event_insert(pwm_pin_t *p){
+	if (p->compare_value == 0) return;
+
+	uint8_t *high_mask = _pwm_event_mask(&_pwm_event_high_new, p->port);
+	if (high_mask == NULL) return;
+	*high_mask |= _BV(p->pin);
+
+	uint8_t i = _pwm_event_find(p->compare_value);
+	if (_pwm_events_low_new[i].compare_value != p->compare_value){
+		//Open up a slot by shifting everything from here on (including the terminator) up by one
+		for (uint8_t j = _pwm_events_count + 1; j > i; j--){
+			_pwm_events_low_new[j] = _pwm_events_low_new[j - 1];
+		}
+		_pwm_event_clear(&(_pwm_events_low_new[i]));
+		_pwm_events_low_new[i].compare_value = p->compare_value;
+		_pwm_events_count++;
+	}
+	*_pwm_event_mask(&(_pwm_events_low_new[i]), p->port) &= ~_BV(p->pin);
+}
+
 /*
  * Note: We extrapolate the DDR registers based off of the associated PORT 
  * register.  This assumes that the DDR registers come directly after the PORT
@@ -85,8 +201,16 @@ void pwm_init(volatile uint8_t *ports[],
 		_pwm_pins[i].port = ports[i];
 		_pwm_pins[i].pin = pins[i];
 		*(_pwm_pins[i].port - 0x1) |= _BV(_pwm_pins[i].pin);
+		_pwm_pins[i].event_value = 0;
 	}
 	
+	//Start with an empty event table; the next pwm_apply_batch() will insert any pins
+	// which already have a phase set.
+	_pwm_event_high_new = (pwm_event_t) {0};
+	_pwm_event_clear(&(_pwm_events_low_new[0]));
+	_pwm_events_count = 0;
+	_set_phase_batch = 1;
+	
 	//This is calculated by the focumula:
 	// CUTOFF_VALUE = PRESCALER * MAX_VALUE / (F_CPU / 1000000)
 	// where CUTOFF_VALUE is the period comparison for each if block,
@@ -156,15 +280,6 @@ void pwm_stop(){
 	_set_stop = 1;
 }
 
-//The comparison method used to sort pwm_pin variables
-static int16_t _compare_values(const void *pin1, const void *pin2){
-	 const pwm_pin_t *pwm1 = (const pwm_pin_t*) pin1;
-	 const pwm_pin_t *pwm2 = (const pwm_pin_t*) pin2;
-	 if (pwm1->compare_value < pwm2->compare_value) return -1;
-	 else if (pwm1->compare_value > pwm2->compare_value) return 1;
-	 else return 0;
-}
-
 void pwm_set_phase(uint8_t index, uint32_t phase){
 	pwm_set_phase_batch(index, phase);
 	pwm_apply_batch();
@@ -194,98 +309,15 @@ void pwm_apply_batch(){
 	
 	_set_phase_lock = 1;
 
-	//Copy _pwm_pins to _pwm_pins_sorted, and then sort it by value
-	pwm_pin_t _pwm_pins_sorted[PWM_MAX_PINS];
+	//Rather than sorting all pins and rebuilding the whole table, we only move the pins
+	// whose phase has changed since the last apply.  The _pwm_events_low_new table stays
+	// sorted by compare value, and pins which turn off at the same time share an event.
 	for (uint8_t i = 0; i < _count; i++){
-		_pwm_pins_sorted[i] = _pwm_pins[i];
-	}
-	qsort(_pwm_pins_sorted, _count, sizeof _pwm_pins_sorted[0], _compare_values);
-
-	//Populate the _pwm_events_high variable and _pwm_events_low_new array, used in 
-	// OCR1A and OCR1B respectively to turn pins on / off.
-	//First we reset everything in this array...
-#ifndef PWM_PORTA_UNUSED
-	_pwm_event_high_new.porta_mask = 0x00;
-#endif
-#ifndef PWM_PORTB_UNUSED
-	_pwm_event_high_new.portb_mask = 0x00;
-#endif
-#ifndef PWM_PORTC_UNUSED
-	_pwm_event_high_new.portc_mask = 0x00;
-#endif
-#ifndef PWM_PORTD_UNUSED
-	_pwm_event_high_new.portd_mask = 0x00;
-#endif
-	for (uint8_t i = 0; i < _count + 1; i++){
-		_pwm_events_low_new[i].compare_value = 0xFFFF;
-#ifndef PWM_PORTA_UNUSED
-		_pwm_events_low_new[i].porta_mask = 0xFF;
-#endif
-#ifndef PWM_PORTB_UNUSED
-		_pwm_events_low_new[i].portb_mask = 0xFF;
-#endif
-#ifndef PWM_PORTC_UNUSED
-		_pwm_events_low_new[i].portc_mask = 0xFF;
-#endif
-#ifndef PWM_PORTD_UNUSED
-		_pwm_events_low_new[i].portd_mask = 0xFF;
-#endif
-	}
-	//... then we look through the sorted _pwm_pins list, and collect all of the ports / pins which are
-	// set at the same compare values into a single event.
-	uint16_t last_compare_value = _pwm_pins_sorted[0].compare_value;
-	uint8_t last_index = 0;
-	
-	for (uint8_t i = 0; i < _count; i++){
-		pwm_pin_t *p = &(_pwm_pins_sorted[i]);
-		if (p->compare_value > last_compare_value){
-			//We don't want an empty pwm_event at the beginning of the array, so verify whether last_compare_value was zero before incrementing
-			if (last_compare_value > 0) {
-				last_index++;
-			}
-			last_compare_value = p->compare_value;
-		}
-
-		if (p->compare_value > 0){
-			//Set pins to high
-#ifndef PWM_PORTA_UNUSED
-			if (p->port == &PORTA) _pwm_event_high_new.porta_mask |= _BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTB_UNUSED
-			if (p->port == &PORTB) _pwm_event_high_new.portb_mask |= _BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTC_UNUSED
-			if (p->port == &PORTC) _pwm_event_high_new.portc_mask |= _BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTD_UNUSED
-			if (p->port == &PORTD) _pwm_event_high_new.portd_mask |= _BV(p->pin);
-			else
-#endif
-			if (0);	//Nop so that ignored ports dont break things
-
-			//Set pins to low
-			pwm_event_t *e = &(_pwm_events_low_new[last_index]);
-			e->compare_value = last_compare_value;
-#ifndef PWM_PORTA_UNUSED
-			if (p->port == &PORTA) e->porta_mask &= ~_BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTB_UNUSED
-			if (p->port == &PORTB) e->portb_mask &= ~_BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTC_UNUSED
-			if (p->port == &PORTC) e->portc_mask &= ~_BV(p->pin);
-			else
-#endif
-#ifndef PWM_PORTD_UNUSED
-			if (p->port == &PORTD) e->portd_mask &= ~_BV(p->pin);
-			else
-#endif
-			if (0);	//Nop so that ignored ports dont break things
+		pwm_pin_t *p = &(_pwm_pins[i]);
+		if (p->compare_value != p->event_value){
+			_pwm_event_remove(p);
+			_pwm_event_insert(p);
+			p->event_value = p->compare_value;
 		}
 	}
 
@@ -300,6 +332,18 @@ void pwm_set_period(uint32_t period){
 	_set_period = _pwm_micros_to_clicks(period);
 }
 
+#ifdef PWM_JITTER_STATS
+void pwm_get_jitter(uint16_t *period, uint16_t *phase){
+	uint8_t sreg = SREG;
+	cli();
+	*period = _pwm_jitter_period;
+	*phase = _pwm_jitter_phase;
+	_pwm_jitter_period = 0;
+	_pwm_jitter_phase = 0;
+	SREG = sreg;
+}
+#endif
+
 
 
 /* 
@@ -311,10 +355,13 @@ ISR(TIM0_COMPA_vect){
 #else
 EMPTY_INTERRUPT(TIMER1_OVF_vect)
 ISR(TIMER1_COMPA_vect){
+#endif
+#ifdef PWM_JITTER_STATS
+	uint16_t period = OCR1A;
 #endif
 	//Update values if needed
 	if (_set_phase && !_set_phase_lock){
-		for (uint8_t i = 0; i < _count; i++){
+		for (uint8_t i = 0; i <= _pwm_events_count; i++){
 			_pwm_events_low[i] = _pwm_events_low_new[i];
 		}
 		_pwm_event_high = _pwm_event_high_new;
@@ -343,6 +390,10 @@ ISR(TIMER1_COMPA_vect){
 		_set_stop = 0;
 		return;
 	}
+#ifdef PWM_JITTER_STATS
+	uint16_t late = TCNT1 - period;
+	if (late > _pwm_jitter_period) _pwm_jitter_period = late;
+#endif
 	//Reset counter after the new compare values are updated (otherwise it affects the phase 
 	// of the next execution, causing jitter).
 	TCNT1 = 0;	
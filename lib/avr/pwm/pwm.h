@@ -84,6 +84,8 @@ void pwm_set_phase_batch(uint8_t index, uint32_t phase);
 
 /*
  * Recalculates all pin / timer values.  Required after calling pwm_set_phase_batch().
+ * Only pins whose phase actually changed are moved within the (sorted) event table, so
+ * the cost is proportional to the number of changed pins rather than the total count.
  */
 void pwm_apply_batch();
 
@@ -109,4 +111,17 @@ void pwm_stop();
  */
 void pwm_start();
 
+#ifdef PWM_JITTER_STATS
+/*
+ * Returns the worst ISR latency (in timer clicks) seen since the last call, and resets
+ * both counters.  'period' is how late TCNT1 was reset after OCR1A matched (which
+ * stretches the period and delays the rising edge of every pin); 'phase' is how late
+ * the COMPB ISR started after OCR1B matched (which lengthens the pulse of the pins
+ * turned off by that event).  Multiply by prescaler / (F_CPU / 1000000) to get s.
+ *
+ * Enable by adding -DPWM_JITTER_STATS to CDEFS; it adds a few cycles to each ISR.
+ */
+void pwm_get_jitter(uint16_t *period, uint16_t *phase);
+#endif
+
 #endif
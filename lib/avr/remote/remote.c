@@ -1,45 +1,70 @@
 #include "remote.h"
 #include <avr/interrupt.h>
 
-#ifdef REMOTE_TIMER2
-#define TCCRxA TCCR2A
-#define TCCRxB TCCR2B
-#define PRESCALE _BV(CS22) | _BV(CS21) | _BV(CS20)
-#define TCNTx TCNT2
-#else
-#define TCCRxA TCCR0A
-#define TCCRxB TCCR0B
-#define PRESCALE _BV(CS02) | _BV(CS00)
-#define TCNTx TCNT0
-#endif
+#if defined(REMOTE_INT0) || defined(REMOTE_INT1)
+	// edges on an external interrupt, timed with an 8 bit timer at F_CPU / 64
+	#define PRESCALE_DIVIDER 64
+	#ifdef REMOTE_TIMER2
+		#define TCCRxA TCCR2A
+		#define TCCRxB TCCR2B
+		#define PRESCALE _BV(CS22)
+		#define TCNTx TCNT2
+		#define TIFRx TIFR2
+		#define TOVx TOV2
+		#define TIMSKx TIMSK2
+		#define TOIEx TOIE2
+		#define TIMERx_OVF_vect TIMER2_OVF_vect
+	#else
+		#define TCCRxA TCCR0A
+		#define TCCRxB TCCR0B
+		#define PRESCALE _BV(CS01) | _BV(CS00)
+		#define TCNTx TCNT0
+		#define TIFRx TIFR0
+		#define TOVx TOV0
+		#define TIMSKx TIMSK0
+		#define TOIEx TOIE0
+		#define TIMERx_OVF_vect TIMER0_OVF_vect
+	#endif
 
-#ifdef REMOTE_INT1
-#define ISCx0 ISC10
-#define INTx INT1
-#define PDx PD3
+	#ifdef REMOTE_INT1
+		#define ISCx0 ISC10
+		#define INTx INT1
+		#define PDx PIND3
+		#define INTx_vect INT1_vect
+	#else
+		#define ISCx0 ISC00
+		#define INTx INT0
+		#define PDx PIND2
+		#define INTx_vect INT0_vect
+	#endif
 #else
-#define ISCx0 ISC00
-#define INTx INT0
-#define PDx PD2
+	// edges captured by timer 1 at F_CPU / 8
+	#define PRESCALE_DIVIDER 8
+	#if defined(__AVR_ATmega164P__) || defined(__AVR_ATmega324P__) || defined(__AVR_ATmega644__) || defined(__AVR_ATmega644P__) || defined(__AVR_ATmega644PA__) || defined(__AVR_ATmega1284P__)
+		#define ICP_DDR DDRD
+		#define ICP_BIT 6
+	#else
+		#define ICP_DDR DDRB
+		#define ICP_BIT 0
+	#endif
 #endif
 
 /*
 NEC IR transmission protocol:
 http://techdocs.altium.com/display/ADRR/NEC+Infrared+Transmission+Protocol
-														@ 8 MHz/1024	@ 16 MHz/1024	@ 20MHz/1024
-9 ms leading pulse										70 				140				176
-4.5 ms leading space									35				70				88
-8 bit device address							
+9 ms leading pulse
+4.5 ms leading space
+8 bit device address
 8 bit logical inverse of the device address
 8 bit command
 8 bit logical inverse of the command
-562.5 us trailing pulse									4				8				11
-2250 us: 562.5 us high, 1687.5 us low = logical 1		17 = 4 + 13		43 = 17 + 26	43 = 11 + 33
-1125 us: 562.5 us high, 562.5 us low = logical 0		8 = 4 + 4		16 = 8 + 8		22 = 11 + 11
+562.5 us trailing pulse
+2250 us: 562.5 us high, 1687.5 us low = logical 1
+1125 us: 562.5 us high, 562.5 us low = logical 0
 
-9 ms leading pulse										70				140				176
-2.25 ms leading pulse									17				35				44
-562.5 us trailing pulse									4				8				11
+9 ms leading pulse
+2.25 ms leading space
+562.5 us trailing pulse
 
 Apple aluminum remote codes: (Apple ID EE 87, Command, Remote ID)
 https://en.wikipedia.org/wiki/Apple_Remote
@@ -50,154 +75,288 @@ https://en.wikipedia.org/wiki/Apple_Remote
 	Center key: EE 87 5D/5C 59
 	Menu key:   EE 87 02/03 59
 	Play key:   EE 87 5E/5F 59
-	
-TODO implement additional remote protocols all with the same interface (i.e. remote_sony.c, remote_rca.c, etc...)
-http://www.sbprojects.com/knowledge/ir/nec.php
+
+The other protocols are in remote_*.c; see http://www.sbprojects.com/knowledge/ir/
 */
 
-// leading pulse must be at least 4.5 ms
-#define LEADING_PULSE F_CPU / 1024 / 222
-// leading space must be at least 3.4 ms for a new command, otherwise it's a repeat command
-#define LEADING_SPACE F_CPU / 1024 / 296
-// bit space must be at least 1126 us for logical 1, otherwise it's logical 0
-#define BIT_SPACE F_CPU / 1024 / 888
-
-volatile uint8_t _state;	// 0 = idle; 1 = leading pulse seen; 2 = leading space seen; reading message
-volatile uint8_t _byte_pos;
-volatile uint8_t _bit_pos;
-volatile uint8_t _byte;
-volatile uint8_t _address;
-volatile uint8_t _command;
-volatile uint8_t _device;
-volatile uint8_t _paired;
-volatile uint8_t _temp;  // holds the command until the final byte is done
+// timer ticks (the F_CPU / 1000000 means that F_CPU must be a whole number of MHz)
+#define TICKS(us) ((uint32_t) (us) * (F_CPU / 1000000) / PRESCALE_DIVIDER)
+#define GAP_TICKS TICKS(REMOTE_GAP_US)
+#define IDLE_PERIODS (REMOTE_IDLE_US / REMOTE_GAP_US)
+
+// edge levels; what the line is doing from this edge on
+#define EDGE_SPACE 0
+#define EDGE_MARK 1
+#define EDGE_GAP 2		// not an edge; the space has gone on for REMOTE_GAP_US
+#define EDGE_IDLE 3		// not an edge; the space has gone on for REMOTE_IDLE_US
+
+static volatile uint16_t _edge_time[REMOTE_EDGE_COUNT];
+static volatile uint8_t _edge_level[REMOTE_EDGE_COUNT];
+static volatile uint8_t _edge_head;		// edges received (the ISR writes into slot _edge_head % REMOTE_EDGE_COUNT)
+static volatile uint8_t _edge_tail;		// edges decoded
+static volatile uint8_t _overruns;
+static volatile uint8_t _quiet;			// gap periods since the last edge, while the line is a space
+static volatile uint8_t _receiving;		// a frame is in progress
+
+#if defined(REMOTE_INT0) || defined(REMOTE_INT1)
+static volatile uint8_t _overflows;		// high byte of the time
+static volatile uint16_t _quiet_time;	// the time from which the line has been quiet (for the next gap period)
+static volatile uint8_t _armed;			// counting gap periods
+#endif
+
+static uint16_t _last_time;				// the last edge decoded
+static uint8_t _last_level;
+static uint8_t _reported = 1;			// the space since the last edge has already been given to the decoders
+
+static const remote_protocol_t* _protocols[REMOTE_PROTOCOL_COUNT];
+static uint8_t _protocol_count;
+
+static remote_event_t _events[REMOTE_EVENT_COUNT];
+static uint8_t _event_head;
+static uint8_t _event_count;
+
+static uint8_t _device;
+static uint8_t _paired;
 
 void remote_init(uint8_t deviceid) {
 	_paired = deviceid;
-	
+	remote_add_protocol(&remote_nec);
+
+#if defined(REMOTE_INT0) || defined(REMOTE_INT1)
 	// timer
 	TCCRxA = 0x0; 						// normal mode
-	TCCRxB = PRESCALE;					// F_CPU / 1024 prescaler
+	TCCRxB = PRESCALE;					// F_CPU / 64 prescaler
+	#ifdef TIMSK0
+	TIMSKx |= _BV(TOIEx);				// overflow interrupt, for the high byte of the time and for gaps
+	#else
+	TIMSK |= _BV(TOIEx);
+	#endif
 
 	// interrupts
 	DDRD &= ~_BV(PDx);  				// set pin as input
-	DDRB |= _BV(PB0);
-	
+
 	#if defined(__AVR_ATtiny13__)      || \
 		defined(__AVR_ATtiny85__)
 	MCUCR |= _BV(ISCx0);				// logical change generates interrupt
 	GIMSK |= _BV(INTx);					// enable external interrupts on int0
-	#elif defined(__AVR_ATmega48__)    || \
-		defined(__AVR_ATmega48P__)     || \
-		defined(__AVR_ATmega168__)     || \
-		defined(__AVR_ATmega328__)     || \
-		defined(__AVR_ATmega328P__)    || \
-		defined(__AVR_ATmega324P__)    || \
-		defined(__AVR_ATmega644__)     || \
-		defined(__AVR_ATmega644P__)    || \
-		defined(__AVR_ATmega644PA__)   || \
-		defined(__AVR_ATmega1284P__)
-	EICRA = _BV(ISCx0);					// logical change generates interrupt
+	#else
+	EICRA |= _BV(ISCx0);				// logical change generates interrupt
 	EIMSK |= _BV(INTx);					// enable external interrupts on intx
 	#endif
-	
+#else
+	ICP_DDR &= ~_BV(ICP_BIT);			// set pin as input
+	TCCR1A = 0x0;						// normal mode
+	TCCR1B = _BV(ICNC1) | _BV(CS11);	// noise canceller, falling edge (start of a mark) first, F_CPU / 8 prescaler
+	TIFR1 = _BV(ICF1);
+	TIMSK1 |= _BV(ICIE1);				// input capture interrupt; compare A (for gaps) is enabled as needed
+#endif
+
 	sei();
 }
 
+uint8_t remote_add_protocol(const remote_protocol_t* protocol) {
+	for (uint8_t i = 0; i < _protocol_count; i++) {
+		if (_protocols[i] == protocol) return 1;
+	}
+	if (_protocol_count >= REMOTE_PROTOCOL_COUNT) return 0;
+	protocol->reset();
+	_protocols[_protocol_count++] = protocol;
+	return 1;
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	for (uint8_t i = 0; i < _protocol_count; i++) {
+		_protocols[i]->decode(mark, us);
+	}
+}
+
+uint8_t remote_poll() {
+	while (_edge_tail != _edge_head) {
+		uint8_t slot = _edge_tail % REMOTE_EDGE_COUNT;
+		uint16_t time = _edge_time[slot];
+		uint8_t level = _edge_level[slot];
+		_edge_tail++;			// only now can the ISR re-use the slot
+
+		if (level == EDGE_GAP) {
+			decode(0, REMOTE_GAP);
+			_reported = 1;
+		} else if (level == EDGE_IDLE) {
+			decode(0, REMOTE_IDLE);
+		} else {
+			if (!_reported) {
+				uint32_t us = (uint32_t) (uint16_t) (time - _last_time) * PRESCALE_DIVIDER / (F_CPU / 1000000);
+				decode(_last_level == EDGE_MARK, us < REMOTE_IDLE ? us : REMOTE_IDLE - 1);
+			}
+			_reported = 0;
+			_last_time = time;
+			_last_level = level;
+		}
+	}
+	return _event_count;
+}
+
+void remote_push(uint8_t protocol, uint8_t flags, uint16_t address, uint16_t command) {
+	if (_event_count >= REMOTE_EVENT_COUNT) return;
+	remote_event_t* e = &_events[(_event_head + _event_count) % REMOTE_EVENT_COUNT];
+	e->protocol = protocol;
+	e->flags = flags;
+	e->address = address;
+	e->command = command;
+	_event_count++;
+}
+
+uint8_t remote_event(remote_event_t* event) {
+	if (_event_count == 0) return 0;
+	*event = _events[_event_head];
+	_event_head = (_event_head + 1) % REMOTE_EVENT_COUNT;
+	_event_count--;
+	return 1;
+}
+
+uint8_t remote_overruns() {
+	uint8_t result = _overruns;
+	_overruns = 0;
+	return result;
+}
+
+uint8_t remote_match(uint16_t us, uint16_t nominal) {
+	uint16_t tolerance = nominal / 4 + 50;
+	return us + tolerance >= nominal && us <= nominal + tolerance;
+}
+
+uint8_t remote_units(uint16_t us, uint16_t unit) {
+	uint32_t units = ((uint32_t) us + unit / 2) / unit;
+	return units > 0xFF ? 0xFF : units;
+}
+
 uint8_t remote_state() {
-	return _state;
+	return _receiving;
 }
 
 void remote_reset() {
-	_state = 0;
+	uint8_t sreg = SREG;
+	cli();
+	_edge_tail = _edge_head;
+	SREG = sreg;
+
+	_reported = 1;
+	for (uint8_t i = 0; i < _protocol_count; i++) {
+		_protocols[i]->reset();
+	}
 }
 
 uint8_t remote_command() {
-	uint8_t result = _command;
-	_command = 0;
-	return result;
-}
-#ifdef REMOTE_INT1
-ISR(INT1_vect) {
-#else
-ISR(INT0_vect) {
-#endif
-	if (PIND & _BV(PDx)) {
-		// receiver high; protocol low
-		PORTB &= ~_BV(PB0);
-		if (_state == 0) {
-			if (TCNTx > LEADING_PULSE) {
-				_state = 1;
-			}
-		}
-	} else {
-		// receiver low; protocol high
-		PORTB |= _BV(PB0);
-		if (_state == 1) {
-			if (TCNTx > LEADING_SPACE) {
-				_state = 2;
-				_byte_pos = 0;
-				_bit_pos = 0;
-				_byte = 0;
+	remote_poll();
+
+	remote_event_t e;
+	while (remote_event(&e)) {
+		// these are the only two addresses that are expected, followed by the magic 0x87
+		// 0xEE is for normal commands
+		// 0xE0 is for pairing commands
+		if (e.protocol != REMOTE_NEC || (e.flags & REMOTE_REPEAT)) continue;
+		uint8_t address = e.address & 0xff;
+		if ((address != 0xee && address != 0xe0) || (e.address >> 8) != 0x87) continue;
+
+		uint8_t command = e.command & 0xfe;
+		_device = e.command >> 8;
+		if (((_device ^ command) & 0x01) == 0x01) {
+			if (address == 0xee) {
+				// command bit 0 is an odd parity bit with the device
+				if (_paired == 0 || _paired == _device) {
+					return command;
+				}
 			} else {
-				_state = 0;
-				// TODO implement repeats
-			}
-		} else if (_state == 2) {
-			if (TCNTx > BIT_SPACE) {
-				_byte |= _BV(_bit_pos);
-			} 
-			if (_bit_pos++ == 7) {
-				if (_byte_pos == 0) {
-					if (_byte == 0xee || _byte == 0xe0) {
-						// these are the only two addresses that are expected, anything else just go back to state 0
-						// 0xEE is for normal commands
-						// 0xE0 is for pairing commands
-						_address = _byte;
-					} else {
-						_state = 0;
-					}
-					_byte_pos++;
-				} else if (_byte_pos == 1) {
-					if (_byte != 0x87) {
-						// this is the only magic value expected here
-						_state = 0;
-					}
-					_byte_pos++;
-				} else if (_byte_pos == 2) {
-					_temp = _byte;
-					_command = _byte & 0xfe;
-					_byte_pos++;
-				} else if (_byte_pos == 3) {
-					_device = _byte;
-					if (((_device ^ _command) & 0x01) == 0x01) {
-						if (_address == 0xee) {
-							// command bit 0 is an odd parity bit with the device
-							if (_paired == 0 || _paired == _device) {
-								_command = _temp & 0xfe;
-							}
-						} else {
-							_command = (_temp & 0xfe) | 0xe0;
-							if (_command == REMOTE_PAIR) {
-								_paired = _device;
-							}
-						}
-					}
-					_state = 0;
-				} else {
-					_state = 0;
+				command |= 0xe0;
+				if (command == REMOTE_PAIR) {
+					_paired = _device;
 				}
-				_bit_pos = 0;
-				_byte = 0;
+				return command;
 			}
 		}
 	}
-	TCNTx = 0;
+	return 0;
+}
+
+uint8_t remote_deviceid() {
+	return _device;
+}
+
+static inline void push_edge(uint16_t time, uint8_t level) {
+	if ((uint8_t) (_edge_head - _edge_tail) >= REMOTE_EDGE_COUNT) {
+		_overruns++;
+		return;
+	}
+	uint8_t slot = _edge_head % REMOTE_EDGE_COUNT;
+	_edge_time[slot] = time;
+	_edge_level[slot] = level;
+	_edge_head++;
+}
+
+// called each time the line has been a space for another REMOTE_GAP_US; returns 1 to keep counting
+static inline uint8_t quiet(uint16_t time) {
+	if (_quiet == 0) {
+		push_edge(time, EDGE_GAP);
+		_receiving = 0;
+	}
+	if (++_quiet < IDLE_PERIODS) return 1;
+	push_edge(time, EDGE_IDLE);
+	return 0;
+}
+
+#if defined(REMOTE_INT0) || defined(REMOTE_INT1)
+static inline uint16_t now() {
+	uint8_t low = TCNTx;
+	uint8_t high = _overflows;
+	if ((TIFRx & _BV(TOVx)) && low < 0x80) high++;	// it has overflowed, but the ISR hasn't run yet
+	return (high << 8) | low;
+}
+
+ISR(INTx_vect) {
+	uint16_t time = now();
+	// receiver high; protocol low
+	uint8_t level = (PIND & _BV(PDx)) ? EDGE_SPACE : EDGE_MARK;
+	push_edge(time, level);
+	_receiving = 1;
+	_quiet = 0;
+	_quiet_time = time;
+	_armed = (level == EDGE_SPACE);
 }
 
-#ifdef REMOTE_TIMER2
-EMPTY_INTERRUPT(TIMER2_OVF_vect)
+ISR(TIMERx_OVF_vect) {
+	_overflows++;
+	if (_armed) {
+		uint16_t time = now();
+		if ((uint16_t) (time - _quiet_time) >= GAP_TICKS) {
+			_quiet_time += GAP_TICKS;
+			_armed = quiet(time);
+		}
+	}
+}
 #else
-EMPTY_INTERRUPT(TIMER0_OVF_vect)
-#endif
+ISR(TIMER1_CAPT_vect) {
+	uint16_t time = ICR1;
+	// rising edge: receiver high; protocol low
+	uint8_t level = (TCCR1B & _BV(ICES1)) ? EDGE_SPACE : EDGE_MARK;
+	TCCR1B ^= _BV(ICES1);			// the other edge next
+	TIFR1 = _BV(ICF1);				// changing the edge can set the flag
+	push_edge(time, level);
+	_receiving = 1;
+	_quiet = 0;
+
+	if (level == EDGE_SPACE) {
+		OCR1A = time + GAP_TICKS;
+		TIFR1 = _BV(OCF1A);
+		TIMSK1 |= _BV(OCIE1A);
+	} else {
+		TIMSK1 &= ~_BV(OCIE1A);
+	}
+}
 
+ISR(TIMER1_COMPA_vect) {
+	if (quiet(OCR1A)) {
+		OCR1A += GAP_TICKS;
+	} else {
+		TIMSK1 &= ~_BV(OCIE1A);
+	}
+}
+#endif
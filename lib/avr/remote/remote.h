@@ -3,6 +3,79 @@
 
 #include <avr/io.h>
 
+/*
+ * Infrared remote control receiver, for a demodulating receiver (TSOP38xx etc; output low while
+ * IR is received).
+ *
+ * The edges are timestamped with Timer 1 input capture (ICP1; PB0 on the ATmega48/88/168/328,
+ * PD6 on the ATmega164/324/644/1284), and put into a buffer by the ISR.  Nothing else happens in
+ * interrupt context: remote_poll() (called from the main loop) turns the edges into marks and
+ * spaces, and hands them to each of the protocol decoders which have been added with
+ * remote_add_protocol().  Decoded key presses go into a queue, to be read with remote_event().
+ *
+ * Boards which have the receiver on INT0 / INT1 instead can define REMOTE_INT0 or REMOTE_INT1;
+ * the edges are then timed with Timer 0 (or Timer 2 if REMOTE_TIMER2 is defined) at F_CPU / 64,
+ * extended to 16 bits by its overflow interrupt, and Timer 1 is left alone.
+ *
+ * You can set the following defines (either in code or in the Makefile):
+ * REMOTE_EDGE_COUNT		Edges which can be waiting for remote_poll(); a power of 2.  Defaults to 32
+ * REMOTE_EVENT_COUNT		Decoded events which can be waiting for remote_event().  Defaults to 8
+ * REMOTE_PROTOCOL_COUNT	Most protocols which can be added.  Defaults to 5
+ * REMOTE_GAP_US			A space this long ends a frame.  Defaults to 6000
+ * REMOTE_IDLE_US			Nothing at all for this long means that the key was released.  Defaults to 150000
+ */
+
+#ifndef REMOTE_EDGE_COUNT
+#define REMOTE_EDGE_COUNT 32
+#endif
+#ifndef REMOTE_EVENT_COUNT
+#define REMOTE_EVENT_COUNT 8
+#endif
+#ifndef REMOTE_PROTOCOL_COUNT
+#define REMOTE_PROTOCOL_COUNT 5
+#endif
+#ifndef REMOTE_GAP_US
+#define REMOTE_GAP_US 6000
+#endif
+#ifndef REMOTE_IDLE_US
+#define REMOTE_IDLE_US 150000
+#endif
+
+// protocols
+#define REMOTE_NEC 1
+#define REMOTE_RC5 2
+#define REMOTE_RC6 3
+#define REMOTE_SIRC 4
+#define REMOTE_LEGO 5
+
+// event flags
+#define REMOTE_REPEAT 0x01		// the key is being held (NEC repeat code, or the same frame again)
+#define REMOTE_TOGGLE 0x02		// the toggle bit (RC5, RC6 and LEGO)
+
+// lengths passed to the decoders in place of a time, for spaces which go on and on
+#define REMOTE_GAP 0xFFFF		// the space went on for REMOTE_GAP_US; the frame is over
+#define REMOTE_IDLE 0xFFFE		// there has been nothing for REMOTE_IDLE_US (comes after REMOTE_GAP)
+
+typedef struct remote_event_t {
+	uint8_t protocol;		// REMOTE_NEC etc
+	uint8_t flags;			// REMOTE_REPEAT / REMOTE_TOGGLE
+	uint16_t address;		// protocol dependent; see the decoder
+	uint16_t command;
+} remote_event_t;
+
+typedef struct remote_protocol_t {
+	void (*reset)(void);
+	// called with each mark (IR on) / space (IR off) in turn, and its length in us, or REMOTE_GAP / REMOTE_IDLE
+	void (*decode)(uint8_t mark, uint16_t us);
+} remote_protocol_t;
+
+// the protocol decoders; add the file for each one that is used to the Makefile
+extern const remote_protocol_t remote_nec;		// remote_nec.c
+extern const remote_protocol_t remote_rc5;		// remote_rc5.c
+extern const remote_protocol_t remote_rc6;		// remote_rc6.c
+extern const remote_protocol_t remote_sirc;		// remote_sirc.c
+extern const remote_protocol_t remote_lego;		// remote_lego.c
+
 // all of these constants are even
 // the remote may actually send odd codes depending on the odd parity with the device id
 // but the library always clears the low bit and returns an even code
@@ -31,22 +104,53 @@
 // the remote does not forget it's pairing code when unpaired
 #define REMOTE_UNPAIR 0xe4
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
- * Initializes the AVR hardware to receive IR data.
+ * Initializes the AVR hardware to receive IR data, and adds the NEC decoder.
  * If a paired device id is stored it should be supplied, otherwise initialize with 0x00 to accept commands from all devices.
+ * (The device id only applies to remote_command(), for the Apple remote.)
  */
 void remote_init(uint8_t deviceid);
 
+/*
+ * Adds a protocol decoder (e.g. &remote_rc5).  Returns 0 if there is no room for it.
+ */
+uint8_t remote_add_protocol(const remote_protocol_t* protocol);
+
+/*
+ * Decodes the edges received since the last call.  Call this often enough that the edge buffer
+ * doesn't fill up (REMOTE_EDGE_COUNT edges; an NEC frame is 68).  Returns the number of events
+ * waiting.
+ */
+uint8_t remote_poll();
+
+/*
+ * Takes the oldest decoded event off the queue.  Returns 1 if there was one, 0 if not.
+ */
+uint8_t remote_event(remote_event_t* event);
+
+/*
+ * Returns the number of edges lost because the buffer was full, and resets it.
+ */
+uint8_t remote_overruns();
+
 /*
  * Returns 0 when idle.  Applications should only disable interrupts when idle.
  */
 uint8_t remote_state();
 
+/*
+ * Throws away any edges which haven't been decoded, and resets the decoders; e.g. after interrupts
+ * have been disabled for long enough that edges may have been missed.  Decoded events are kept.
+ */
 void remote_reset();
 
 /*
- * Returns the last command that has been received; or 0 if there is no new command available.
- * The command is reset when read.
+ * Apple remote: polls, and returns the next command from the paired (or any) remote; or 0 if
+ * there is no new command available.  Other events are discarded.
  */
 uint8_t remote_command();
 
@@ -56,4 +160,18 @@ uint8_t remote_command();
  */
 uint8_t remote_deviceid();
 
-#endif
\ No newline at end of file
+/*
+ * For the protocol decoders.
+ */
+// queue a decoded event
+void remote_push(uint8_t protocol, uint8_t flags, uint16_t address, uint16_t command);
+// returns 1 if us is within 25% (+ 50us for receiver distortion) of nominal
+uint8_t remote_match(uint16_t us, uint16_t nominal);
+// returns us as the nearest whole number of units (for bi-phase protocols)
+uint8_t remote_units(uint16_t us, uint16_t unit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
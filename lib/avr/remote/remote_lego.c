@@ -0,0 +1,66 @@
+/*
+ * LEGO Power Functions protocol (see http://www.philohome.com/pf/LEGO_Power_Functions_RC.pdf).
+ * Each bit is a 158us mark followed by a space; the time from one mark to the next gives the bit:
+ * 421us for a 0, 711us for a 1, and 1184us for the start / stop bit.  A message is a start bit,
+ * 16 bits MSB first (4 nibbles: toggle / escape / channel, address / mode, data, checksum) and a stop
+ * bit.  Each message is sent 5 times.
+ *
+ * Events: address = channel (bits 0 - 1), escape (bit 2) and address (bit 3); command = mode (bits
+ * 4 - 6) and data (bits 0 - 3).  REMOTE_TOGGLE is the toggle bit, which changes with each new
+ * message, so REMOTE_REPEAT is set for the copies (the same message, toggle included, as the last).
+ */
+
+#include "remote.h"
+
+#define WAITING 0xFF
+
+static uint16_t _mark;		// length of the last mark
+static uint8_t _bits;		// bits received since the start bit; WAITING = waiting for the start bit
+static uint16_t _data;
+static uint16_t _last;		// the last message, for repeats
+static uint8_t _valid;
+
+static void reset() {
+	_bits = WAITING;
+	_valid = 0;
+}
+
+static void finish() {
+	uint8_t checksum = 0x0F ^ (_data >> 12) ^ (_data >> 8) ^ (_data >> 4);
+	if ((checksum & 0x0F) != (_data & 0x0F)) return;
+
+	uint8_t flags = (_data & 0x8000) ? REMOTE_TOGGLE : 0;
+	if (_valid && _data == _last) flags |= REMOTE_REPEAT;
+	_last = _data;
+	_valid = 1;
+
+	uint8_t address = ((_data >> 12) & 0x03) | ((_data >> 12) & 0x04) | ((_data >> 8) & 0x08);
+	remote_push(REMOTE_LEGO, flags, address, (_data >> 4) & 0x7f);
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	if (mark) {
+		_mark = us;
+		return;
+	}
+	if (_mark > 400) {
+		// the marks are 6 cycles of the carrier; this is something else
+		_bits = WAITING;
+		return;
+	}
+
+	uint16_t period = us >= 1579 ? 1579 : _mark + us;
+	if (period >= 947) {
+		// start / stop bit
+		if (_bits == 16) finish();
+		_bits = 0;
+		_data = 0;
+	} else if (period >= 316 && _bits < 16) {
+		_data = (_data << 1) | (period >= 526 ? 1 : 0);
+		_bits++;
+	} else {
+		_bits = WAITING;
+	}
+}
+
+const remote_protocol_t remote_lego = { reset, decode };
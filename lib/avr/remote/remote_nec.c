@@ -0,0 +1,80 @@
+/*
+ * NEC protocol (and its extended address form, which Apple remotes use).
+ * 9ms mark, 4.5ms space, then 32 bits LSB first (address, inverse address, command, inverse command)
+ * each a 562.5us mark followed by a 562.5us (0) or 1687.5us (1) space, then a 562.5us stop mark.
+ * While the key is held, a repeat code is sent every 110ms: 9ms mark, 2.25ms space, 562.5us mark.
+ *
+ * Events: address = the first two bytes (byte 0 in the low byte), command = the last two bytes
+ * (command in the low byte); the inverses are not checked, since not all remotes send them.  Repeat
+ * codes give an event with REMOTE_REPEAT set and the same address / command as the last frame.
+ */
+
+#include "remote.h"
+
+#define STATE_IDLE 0
+#define STATE_LEADER 1		// leading mark seen
+#define STATE_MARK 2		// waiting for a bit's mark (or the stop mark)
+#define STATE_SPACE 3		// waiting for a bit's space
+#define STATE_REPEAT 4		// repeat code leader seen, waiting for the stop mark
+
+static uint8_t _state;
+static uint8_t _bits;
+static uint32_t _data;
+static uint32_t _last;		// the last frame, for repeats
+static uint8_t _valid;		// _last has been received
+
+static void reset() {
+	_state = STATE_IDLE;
+	_valid = 0;
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	if (mark && remote_match(us, 9000)) {
+		_state = STATE_LEADER;
+		return;
+	}
+
+	switch (_state) {
+		case STATE_LEADER:
+			if (!mark && remote_match(us, 4500)) {
+				_state = STATE_MARK;
+				_bits = 0;
+				_data = 0;
+			} else if (!mark && remote_match(us, 2250)) {
+				_state = STATE_REPEAT;
+			} else {
+				_state = STATE_IDLE;
+			}
+			break;
+		case STATE_MARK:
+			if (!mark || !remote_match(us, 562)) {
+				_state = STATE_IDLE;
+			} else if (_bits == 32) {
+				_last = _data;
+				_valid = 1;
+				remote_push(REMOTE_NEC, 0, _data & 0xffff, _data >> 16);
+				_state = STATE_IDLE;
+			} else {
+				_state = STATE_SPACE;
+			}
+			break;
+		case STATE_SPACE:
+			if (remote_match(us, 1687)) {
+				_data |= (uint32_t) 1 << _bits;
+			} else if (!remote_match(us, 562)) {
+				_state = STATE_IDLE;
+				break;
+			}
+			_bits++;
+			_state = STATE_MARK;
+			break;
+		case STATE_REPEAT:
+			if (mark && remote_match(us, 562) && _valid) {
+				remote_push(REMOTE_NEC, REMOTE_REPEAT, _last & 0xffff, _last >> 16);
+			}
+			_state = STATE_IDLE;
+			break;
+	}
+}
+
+const remote_protocol_t remote_nec = { reset, decode };
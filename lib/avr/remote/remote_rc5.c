@@ -0,0 +1,84 @@
+/*
+ * Philips RC5 protocol.  14 bits, MSB first, bi-phase with a bit time of 1.778ms: a 0 is a mark
+ * then a space, a 1 is a space then a mark.  The bits are 2 start bits (the second one is the
+ * inverse of command bit 6 in RC5X), a toggle bit which changes with each key press, 5 address bits
+ * and 6 command bits.  The frame is repeated every 114ms while the key is held.
+ *
+ * Events: address = 5 bit address, command = 7 bit command (including the RC5X bit), REMOTE_TOGGLE
+ * is the toggle bit, and REMOTE_REPEAT is set when the frame is the same as the last one (toggle
+ * included).
+ */
+
+#include "remote.h"
+
+#define HALF_BIT 889
+#define HALVES 28
+
+static uint8_t _count;		// half bits received; 0 = waiting for a frame
+static uint32_t _halves;	// bit n is half bit n; 1 = mark
+static uint8_t _ready;		// the line has been quiet for long enough that a frame can start
+static uint16_t _last;		// the last frame, for repeats
+static uint8_t _valid;
+
+static void reset() {
+	_count = 0;
+	_ready = 1;
+	_valid = 0;
+}
+
+static void finish() {
+	uint16_t frame = 0;
+	for (uint8_t i = 0; i < HALVES; i += 2) {
+		uint8_t first = (_halves >> i) & 0x01;
+		uint8_t second = (_halves >> (i + 1)) & 0x01;
+		if (first == second) return;		// not bi-phase
+		frame = (frame << 1) | second;
+	}
+
+	uint8_t flags = (frame & 0x0800) ? REMOTE_TOGGLE : 0;
+	if (_valid && frame == _last) flags |= REMOTE_REPEAT;
+	_last = frame;
+	_valid = 1;
+
+	uint8_t command = (frame & 0x3f) | ((frame & 0x1000) ? 0 : 0x40);
+	remote_push(REMOTE_RC5, flags, (frame >> 6) & 0x1f, command);
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	uint8_t units = remote_units(us, HALF_BIT);
+
+	// a frame is only accepted when it is followed by a long space, so that bits of other
+	// protocols which happen to look like bi-phase aren't mistaken for one
+	if (!mark && units > 2) {
+		if (_count == HALVES - 1) {
+			// the last bit was a 0; its second half runs into this space
+			_count++;
+		}
+		if (_count == HALVES) finish();
+		_count = 0;
+		_ready = 1;
+		return;
+	}
+
+	if (_count == 0) {
+		if (!mark || !_ready || units < 1 || units > 2) {
+			_ready = 0;
+			return;
+		}
+		// the first half of the first start bit is a space, which can't be told from the idle line
+		_halves = 0;
+		_count = 1;
+		_ready = 0;
+	}
+
+	if (units < 1 || units > 2 || _count + units > HALVES) {
+		_count = 0;
+		return;
+	}
+	for (uint8_t i = 0; i < units; i++) {
+		if (mark) _halves |= (uint32_t) 1 << _count;
+		_count++;
+	}
+}
+
+const remote_protocol_t remote_rc5 = { reset, decode };
@@ -0,0 +1,94 @@
+/*
+ * Philips RC6 protocol, mode 0.  Bi-phase with a unit of t = 444us, where (unlike RC5) a 1 is a
+ * mark then a space.  A 6t leader mark and 2t space, a start bit (1), 3 mode bits, a double length
+ * trailer bit (the toggle bit), then 8 address and 8 command bits, all MSB first, each 2t.  The
+ * frame is repeated while the key is held.  Other modes (e.g. mode 6, used by MCE remotes) have
+ * longer frames, and are ignored.
+ *
+ * Events: address = 8 bit address, command = 8 bit command, REMOTE_TOGGLE is the trailer bit, and
+ * REMOTE_REPEAT is set when the frame is the same as the last one (toggle included).
+ */
+
+#include "remote.h"
+
+#define UNIT 444
+#define UNITS 46			// units after the leader mark: 2 leader space, 2 start, 6 mode, 4 trailer, 32 data
+
+static uint8_t _count;		// units received after the leader mark; 0xFF = waiting for a leader
+static uint64_t _units;		// bit n is unit n; 1 = mark
+static uint32_t _last;		// the last frame, for repeats
+static uint8_t _valid;
+
+static void reset() {
+	_count = 0xFF;
+	_valid = 0;
+}
+
+static inline uint8_t unit(uint8_t n) {
+	return (_units >> n) & 0x01;
+}
+
+// decodes the bi-phase bit starting at unit n; returns 0 / 1, or 0xFF if it isn't valid
+static uint8_t bit(uint8_t n) {
+	if (unit(n) == unit(n + 1)) return 0xFF;
+	return unit(n);
+}
+
+static void finish() {
+	// leader space, start bit (1), mode 0
+	if (unit(0) || unit(1) || bit(2) != 1) return;
+	for (uint8_t i = 0; i < 3; i++) {
+		if (bit(4 + i * 2) != 0) return;
+	}
+
+	// the trailer bit is twice as long as the others
+	uint8_t trailer = (_units >> 10) & 0x0F;
+	if (trailer != 0x03 && trailer != 0x0C) return;
+	uint8_t flags = trailer == 0x03 ? REMOTE_TOGGLE : 0;		// unit 10 is bit 0; 0x03 = mark, mark, space, space
+
+	uint16_t data = 0;
+	for (uint8_t i = 0; i < 16; i++) {
+		uint8_t b = bit(14 + i * 2);
+		if (b == 0xFF) return;
+		data = (data << 1) | b;
+	}
+
+	uint32_t frame = ((uint32_t) flags << 16) | data;
+	if (_valid && frame == _last) flags |= REMOTE_REPEAT;
+	_last = frame;
+	_valid = 1;
+
+	remote_push(REMOTE_RC6, flags, data >> 8, data & 0xff);
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	uint8_t units = remote_units(us, UNIT);
+
+	if (mark && units == 6) {
+		_units = 0;
+		_count = 0;
+		return;
+	}
+	if (_count == 0xFF) return;
+
+	if (!mark && units > 3) {
+		if (_count == UNITS - 1) {
+			// the last bit was a 1; its second half runs into this space
+			_count++;
+		}
+		if (_count == UNITS) finish();
+		_count = 0xFF;
+		return;
+	}
+
+	if (units < 1 || units > 3 || _count + units > UNITS) {
+		_count = 0xFF;
+		return;
+	}
+	for (uint8_t i = 0; i < units; i++) {
+		if (mark) _units |= (uint64_t) 1 << _count;
+		_count++;
+	}
+}
+
+const remote_protocol_t remote_rc6 = { reset, decode };
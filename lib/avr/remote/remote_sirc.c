@@ -0,0 +1,79 @@
+/*
+ * Sony SIRC protocol.  A 2.4ms mark and 600us space, then 12, 15 or 20 bits LSB first, each a
+ * 1.2ms (1) or 600us (0) mark followed by a 600us space.  The bits are a 7 bit command, then a 5 bit
+ * (12 bit version) or 8 bit (15 bit version) address, or a 5 bit address and 8 bit extended address
+ * (20 bit version).  Frames start every 45ms, and are sent at least 3 times.
+ *
+ * Events: command = 7 bit command, address = the rest of the bits (with the extended address in bits
+ * 5 - 12 for the 20 bit version).  SIRC has no toggle bit, so REMOTE_REPEAT is set when the frame is
+ * the same as the last one, and there was no pause (REMOTE_IDLE) in between.
+ */
+
+#include "remote.h"
+
+#define STATE_IDLE 0
+#define STATE_HEADER 1		// leading mark seen
+#define STATE_MARK 2		// waiting for a bit's mark
+#define STATE_SPACE 3		// waiting for a bit's space, or the end of the frame
+
+static uint8_t _state;
+static uint8_t _bits;
+static uint32_t _data;
+static uint32_t _last;		// the last frame (with its length in the top byte), for repeats
+static uint8_t _valid;
+
+static void reset() {
+	_state = STATE_IDLE;
+	_valid = 0;
+}
+
+static void finish() {
+	if (_bits != 12 && _bits != 15 && _bits != 20) return;
+
+	uint32_t frame = ((uint32_t) _bits << 24) | _data;
+	uint8_t flags = (_valid && frame == _last) ? REMOTE_REPEAT : 0;
+	_last = frame;
+	_valid = 1;
+
+	remote_push(REMOTE_SIRC, flags, _data >> 7, _data & 0x7f);
+}
+
+static void decode(uint8_t mark, uint16_t us) {
+	if (us == REMOTE_IDLE) {
+		// the key was let go
+		_valid = 0;
+	}
+	if (mark && remote_match(us, 2400)) {
+		_state = STATE_HEADER;
+		_bits = 0;
+		_data = 0;
+		return;
+	}
+
+	switch (_state) {
+		case STATE_HEADER:
+			_state = (!mark && remote_match(us, 600)) ? STATE_MARK : STATE_IDLE;
+			break;
+		case STATE_MARK:
+			if (mark && remote_match(us, 1200)) {
+				_data |= (uint32_t) 1 << _bits;
+			} else if (!mark || !remote_match(us, 600)) {
+				_state = STATE_IDLE;
+				break;
+			}
+			_bits++;
+			_state = _bits > 20 ? STATE_IDLE : STATE_SPACE;
+			break;
+		case STATE_SPACE:
+			if (!mark && remote_match(us, 600)) {
+				_state = STATE_MARK;
+			} else {
+				// the space after the last bit runs on until the next frame
+				if (!mark && us > 2000) finish();
+				_state = STATE_IDLE;
+			}
+			break;
+	}
+}
+
+const remote_protocol_t remote_sirc = { reset, decode };
@@ -16,6 +16,27 @@
 #define SERIAL_BUFFER_SIZE 64
 #endif
 
+//Separate rx / tx buffer sizes for the async implementations.  A large tx buffer lets
+// longer messages be queued without blocking, while rx can often stay small.
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE SERIAL_BUFFER_SIZE
+#endif
+#if SERIAL_RX_BUFFER_SIZE > 255
+#undef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 255
+#endif
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE SERIAL_BUFFER_SIZE
+#endif
+#if SERIAL_TX_BUFFER_SIZE > 255
+#undef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 255
+#endif
+
+//What the async tx implementation does when the tx buffer is full.  By default writes block until 
+// there is space (which the UDRE interrupt will make).  Define SERIAL_TX_FULL_DROP to discard the 
+// byte instead, which keeps writes from ever blocking; dropped bytes are counted, see serial_tx_dropped().
+
 /*
  * Initializes the USART with the given parameters.  Valid arguments include:
  *  baud: Any valid baud rate based on hardware support
@@ -93,4 +114,20 @@ void serial_write_b(uint8_t data);
  */
 uint8_t serial_available();
 
+/*
+ * Returns the number of bytes which were discarded because a buffer was full: for tx
+ * only with SERIAL_TX_FULL_DROP, for rx when data arrives faster than it is read.  
+ * Only available in the async implementations.
+ */
+uint16_t serial_tx_dropped();
+uint16_t serial_rx_dropped();
+
+/*
+ * Returns the most bytes that have been waiting in the tx / rx buffer at once.  Use
+ * this to size SERIAL_TX_BUFFER_SIZE / SERIAL_RX_BUFFER_SIZE.  Only available in the async
+ * implementations.
+ */
+uint8_t serial_tx_high_water();
+uint8_t serial_rx_high_water();
+
 #endif
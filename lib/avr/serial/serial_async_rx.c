@@ -7,7 +7,9 @@
 #include "../Ring/Ring.h"
 #include <avr/interrupt.h>
 
-static Ring rx_buffer(SERIAL_BUFFER_SIZE);
+static Ring rx_buffer(SERIAL_RX_BUFFER_SIZE);
+static volatile uint16_t rx_dropped = 0;
+static volatile uint8_t rx_high_water = 0;
 
 void _serial_init_rx(){
 	//Enable RX interrupts
@@ -37,6 +39,17 @@ uint8_t serial_read_c(char *c){
 	return 0;
 }
 
+uint16_t serial_rx_dropped(){
+	UCSR0B &= ~_BV(RXCIE0);
+	uint16_t result = rx_dropped;
+	UCSR0B |= _BV(RXCIE0);
+	return result;
+}
+
+uint8_t serial_rx_high_water(){
+	return rx_high_water;
+}
+
 uint8_t serial_read_s(char *s, uint8_t len){
 	uint8_t count = 0;
 	char data = 0;
@@ -85,5 +98,10 @@ void error1() {
 	char data = UDR0;
 	if (!rx_buffer.isFull()){
 		rx_buffer.put(data);
+		uint8_t count = rx_buffer.count();
+		if (count > rx_high_water) rx_high_water = count;
+	}
+	else {
+		rx_dropped++;
 	}
 }
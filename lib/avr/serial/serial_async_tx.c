@@ -24,7 +24,9 @@
 #include "../Ring/Ring.h"
 #include <avr/interrupt.h>
 
-static Ring tx_buffer(SERIAL_BUFFER_SIZE);
+static Ring tx_buffer(SERIAL_TX_BUFFER_SIZE);
+static volatile uint16_t tx_dropped = 0;
+static uint8_t tx_high_water = 0;
 
 void _serial_init_tx(){
 	//Enable interrupts if the NO_INTERRUPT_ENABLE define is not set.  If it is, you need to call sei() elsewhere.
@@ -36,8 +38,25 @@ void _serial_init_tx(){
 void serial_write_c(char data){
 	//Disable UCSR interrupts temporarily to avoid clobbering the buffer
 	UCSR0B &= ~_BV(UDRIE0);
+	
+	if (tx_buffer.isFull()){
+#ifdef SERIAL_TX_FULL_DROP
+		tx_dropped++;
+		UCSR0B |= _BV(UDRIE0);
+		return;
+#else
+		//Make room by sending the oldest byte ourselves.  This works whether or not global
+		// interrupts are enabled (if we were called from an ISR, for instance, the UDRE
+		// interrupt would never get the chance to run).
+		while (!(UCSR0A & _BV(UDRE0)));
+		UDR0 = tx_buffer.get();
+#endif
+	}
 	tx_buffer.put(data);
 	
+	uint8_t count = tx_buffer.count();
+	if (count > tx_high_water) tx_high_water = count;
+	
 	//Signal that there is data available; the UDRE interrupt will fire.
 	UCSR0B |= _BV(UDRIE0);
 }
@@ -58,6 +77,16 @@ void serial_write_b(uint8_t data){
 	serial_write_c((char) data);
 }
 
+uint16_t serial_tx_dropped(){
+	UCSR0B &= ~_BV(UDRIE0);
+	uint16_t result = tx_dropped;
+	if (!tx_buffer.isEmpty()) UCSR0B |= _BV(UDRIE0);
+	return result;
+}
+
+uint8_t serial_tx_high_water(){
+	return tx_high_water;
+}
 
 #if defined(__AVR_ATtiny2313__)    || \
 	defined(__AVR_ATmega48P__)     || \
@@ -24,13 +24,40 @@
 #include <avr/interrupt.h>
 #include <compat/twi.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+
+#ifndef __AVR_ATmega32U2__
+
+#include <util/delay.h>
 
 #include "twi.h"
 
+//Pins used to clock a stuck bus free in twi_recover()
+#if defined(__AVR_ATmega48__) || defined(__AVR_ATmega48P__) || defined(__AVR_ATmega88__) || defined(__AVR_ATmega88P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega328P__)
+	#define TWI_PORT PORTC
+	#define TWI_DDR DDRC
+	#define TWI_PIN PINC
+	#define TWI_SCL 5
+	#define TWI_SDA 4
+#elif defined(__AVR_ATmega164P__) || defined(__AVR_ATmega324P__) || defined(__AVR_ATmega644__) || defined(__AVR_ATmega644P__) || defined(__AVR_ATmega1284P__)
+	#define TWI_PORT PORTC
+	#define TWI_DDR DDRC
+	#define TWI_PIN PINC
+	#define TWI_SCL 0
+	#define TWI_SDA 1
+#elif defined(__AVR_ATmega32U4__) || defined(__AVR_AT90USB646__) || defined(__AVR_AT90USB1286__)
+	#define TWI_PORT PORTD
+	#define TWI_DDR DDRD
+	#define TWI_PIN PIND
+	#define TWI_SCL 0
+	#define TWI_SDA 1
+#endif
+
 static volatile uint8_t twi_state;
 static volatile uint8_t twi_slarw;
-static volatile uint8_t twi_send_stop;			// should the transaction end with a stop
-static volatile uint8_t twi_inRepStart;			// in the middle of a repeated start
+static volatile uint8_t twi_inRepStart;			// holding the bus, to send a repeated start
+static volatile uint8_t twi_progress;			// incremented on every interrupt, so that waiting code can tell a stuck bus
 
 #ifndef TWI_DISABLE_MASTER
 	#ifdef TWI_MASTER_RX_READER
@@ -40,15 +67,27 @@ static volatile uint8_t twi_inRepStart;			// in the middle of a repeated start
 		static uint8_t (*twi_master_tx_writer)(uint16_t);
 	#endif
 
+	//Used for non-blocking writes, which have to copy the data
 	#ifdef TWI_CUSTOM_BUFFERS
 		static uint8_t* twi_masterBuffer;
 	#else
 		static uint8_t twi_masterBuffer[TWI_BUFFER_LENGTH];
 	#endif
-	
-	
-	static volatile uint16_t twi_masterBufferIndex;
-	static volatile uint16_t twi_masterBufferLength;
+	static twi_buffer_t twi_masterSegment;
+	static twi_transaction_t twi_masterTransaction;
+
+	//The transaction queue; the head is the one on the bus
+	static twi_transaction_t* volatile twi_head;
+	static twi_transaction_t* volatile twi_tail;
+
+	//Where the current transaction is up to
+	static volatile uint8_t twi_segment;			// buffer
+	static volatile uint16_t twi_position;			// byte within the buffer
+	static volatile uint16_t twi_index;				// byte within the whole transaction
+	static volatile uint16_t twi_length;			// total bytes in the transaction
+
+	static uint16_t (*twi_clock)(void);
+	static twi_stats_t twi_stats;
 #endif
 
 #ifndef TWI_DISABLE_SLAVE
@@ -69,14 +108,14 @@ static volatile uint8_t twi_inRepStart;			// in the middle of a repeated start
 		static volatile uint16_t twi_txBufferIndex;
 		static volatile uint16_t twi_txBufferLength;
 	#endif
-	
+
 	#ifndef TWI_DISABLE_SLAVE_RX
 		#ifdef TWI_SLAVE_RX_READER
 			static void (*twi_slave_rx_reader)(uint8_t, uint16_t);
 		#else
 			static void (*twi_slave_rx_callback)(uint8_t*, uint16_t);
 		#endif
-		
+
 		#ifdef TWI_CUSTOM_BUFFERS
 			static uint8_t* twi_rxBuffer;
 		#else
@@ -87,8 +126,6 @@ static volatile uint8_t twi_inRepStart;			// in the middle of a repeated start
 	#endif
 #endif
 
-static volatile uint8_t twi_error;
-
 #if !defined(TWI_DISABLE_MASTER) && defined(TWI_CUSTOM_BUFFERS)
 	void twi_set_master_buffer(uint8_t* buffer){
 		twi_masterBuffer = buffer;
@@ -135,9 +172,8 @@ static volatile uint8_t twi_error;
 void twi_init(){
 	// initialize state
 	twi_state = TWI_READY;
-	twi_send_stop = true;		// default value
 	twi_inRepStart = false;
-	
+
 	// initialize twi prescaler and bit rate
 	TWSR &= ~_BV(TWPS0);
 	TWSR &= ~_BV(TWPS1);
@@ -146,149 +182,343 @@ void twi_init(){
 	//See TWI bit rate formula from atmega128 manual pg 204
 	// SCL Frequency = CPU Clock Frequency / (16 + (2 * TWBR))
 	// note: TWBR should be 10 or higher for master mode
-	// It is 72 for a 16mhz Wiring board with 100kHz TWI 
+	// It is 72 for a 16mhz Wiring board with 100kHz TWI
 
 	// enable twi module, acks, and twi interrupt
 	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
-	
+
 	//Enable interrupts if the NO_INTERRUPT_ENABLE define is not set.	If it is, you need to call sei() elsewhere.
 #ifndef NO_INTERRUPT_ENABLE
 	sei();
 #endif
 }
 
+static void twi_stop(void){
+	// send stop condition
+	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTO);
+
+	// wait for stop condition to be exectued on bus
+	// TWINT is not set after a stop condition!
+	while(TWCR & _BV(TWSTO)){
+		continue;
+	}
+
+	// update twi state
+	twi_state = TWI_READY;
+}
+
+static void twi_release_bus(void){
+	// release bus
+	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT);
+
+	// update twi state
+	twi_state = TWI_READY;
+}
+
 #if !defined(TWI_DISABLE_MASTER)
-	uint8_t twi_read_from(uint8_t address, uint8_t* data, uint16_t length, uint8_t send_stop){
-		uint16_t i;
-	
-		// ensure data will fit into buffer
-		if(TWI_BUFFER_LENGTH < length){
-			return 0;
+	static uint16_t twi_transaction_length(twi_transaction_t* t){
+		uint16_t length = 0;
+		for (uint8_t i = 0; i < t->buffer_count; i++){
+			length += t->buffers[i].length;
+		}
+		return length;
+	}
+
+	// set up to run the transaction at the head of the queue
+	static void twi_setup(void){
+		twi_transaction_t* t = twi_head;
+		twi_state = (t->flags & TWI_READ) ? TWI_MRX : TWI_MTX;
+		twi_slarw = (t->address << 1) | ((t->flags & TWI_READ) ? TW_READ : TW_WRITE);
+		twi_segment = 0;
+		twi_position = 0;
+		twi_index = 0;
+		twi_length = twi_transaction_length(t);
+		t->transferred = 0;
+		if (twi_clock) t->start = twi_clock();
+	}
+
+	// start the transaction at the head of the queue; the bus must be idle, or held after the previous one
+	static void twi_begin(void){
+		twi_setup();
+
+		// if we're in the repeated start state the bus is still ours, and this start is a repeated one
+		twi_inRepStart = false;
+		// send start condition
+		TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA);	// enable INTs
+	}
+
+	// start the next transaction, if there is one and the bus is ours to use
+	static void twi_begin_next(void){
+		if (twi_head != NULL && TWI_READY == twi_state){
+			twi_begin();
 		}
-	
-		// block until twi is ready, become master receiver
-		while(TWI_READY != twi_state){
-			continue;
+	}
+
+	// take the current transaction off the queue, and count it
+	static twi_transaction_t* twi_dequeue(uint8_t status){
+		twi_transaction_t* t = twi_head;
+		twi_head = t->next;
+		if (twi_head == NULL) twi_tail = NULL;
+
+		if (twi_clock){
+			t->duration = twi_clock() - t->start;
+			twi_stats.time_total += t->duration;
+			if (t->duration > twi_stats.time_max) twi_stats.time_max = t->duration;
 		}
-		twi_state = TWI_MRX;
-		twi_send_stop = send_stop;
-		// reset error state (0xFF.. no error occured)
-		twi_error = 0xFF;
-	
-		// initialize buffer iteration vars
-		twi_masterBufferIndex = 0;
-		twi_masterBufferLength = length-1;	// This is not intuitive, read on...
-		// On receive, the previously configured ACK/NACK setting is transmitted in
-		// response to the received byte before the interrupt is signalled. 
-		// Therefor we must actually set NACK when the _next_ to last byte is
-		// received, causing that NACK to be sent in response to receiving the last
-		// expected byte of data.
-	
-		// build sla+w, slave device address + w bit
-		twi_slarw = TW_READ;
-		twi_slarw |= address << 1;
-	
-		if (true == twi_inRepStart) {
-			// if we're in the repeated start state, then we've already sent the start,
-			// (@@@ we hope), and the TWI statemachine is just waiting for the address byte.
-			// We need to remove ourselves from the repeated start state before we enable interrupts,
-			// since the ISR is ASYNC, and we could get confused if we hit the ISR before cleaning
-			// up. Also, don't enable the START interrupt. There may be one pending from the 
-			// repeated start that we sent outselves, and that would really confuse things.
-			twi_inRepStart = false;			// remember, we're dealing with an ASYNC ISR
-			TWDR = twi_slarw;
-			TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE);	// enable INTs, but not START
+		twi_stats.transactions++;
+		twi_stats.bytes += t->transferred;
+		if (status != TWI_SUCCESS) twi_stats.errors++;
+		return t;
+	}
+
+	// report the result; the transaction is done with, so this must be the last thing that touches it
+	static void twi_notify(twi_transaction_t* t, uint8_t status){
+		void (*callback)(twi_transaction_t*) = t->callback;
+		t->status = status;
+		if (callback) callback(t);
+	}
+
+	// finish the current transaction, and go on to the next one
+	static void twi_complete(uint8_t status){
+		twi_transaction_t* t = twi_dequeue(status);
+
+		if (status == TWI_ERROR_OTHER){
+			// lost arbitration; the bus belongs to someone else
+			twi_release_bus();
+			twi_begin_next();
 		}
-		else
-			// send start condition
-			TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTA);
-	
-		// wait for read operation to complete
-		while(TWI_MRX == twi_state){
-			continue;
+		else if (status != TWI_SUCCESS || !(t->flags & TWI_REPEATED_START)){
+			twi_stop();
+			twi_begin_next();
 		}
-	
-		if (twi_masterBufferIndex < length)
-			length = twi_masterBufferIndex;
-	
-		// copy twi buffer to data
-		for(i = 0; i < length; ++i){
-			data[i] = twi_masterBuffer[i];
+		else if (twi_head != NULL){
+			// chain straight into the next transaction; its address goes out from the TW_REP_START interrupt
+			twi_begin();
 		}
-		
-		return length;
+		else {
+			// keep hold of the bus until the next transaction is queued.  SCL is held low for as long
+			// as TWINT is set, so leave it set (writing 0 doesn't clear it), and disable the interrupt
+			// so that it doesn't keep firing.  twi_begin() sends the repeated start.
+			twi_inRepStart = true;
+			TWCR = _BV(TWEN);
+			twi_state = TWI_READY;
+		}
+
+		twi_notify(t, status);
 	}
+
+	// the next byte of the current transaction's buffers
+	static uint8_t* twi_next_byte(void){
+		twi_transaction_t* t = twi_head;
+		while (twi_position >= t->buffers[twi_segment].length){
+			twi_segment++;
+			twi_position = 0;
+		}
+		twi_index++;
+		return &t->buffers[twi_segment].data[twi_position++];
+	}
+
+	static void twi_transmit_byte(void){
+#ifdef TWI_MASTER_TX_WRITER
+		if (twi_master_tx_writer){
+			// call the master tx writer function to get the byte to send
+			TWDR = twi_master_tx_writer(twi_index++);
+			return;
+		}
 #endif
+		TWDR = *twi_next_byte();
+	}
 
-#if !defined(TWI_DISABLE_MASTER)
-	uint8_t twi_write_to(uint8_t address, uint8_t* data, uint16_t length, uint8_t block, uint8_t send_stop){
-		// ensure data will fit into buffer
-		if(TWI_BUFFER_LENGTH < length){
-			return 1;
+	static void twi_receive_byte(uint8_t b){
+		twi_head->transferred++;
+#ifdef TWI_MASTER_RX_READER
+		if (twi_master_rx_reader){
+			// pass data to master rx reader function, to handle as appropriate.
+			twi_master_rx_reader(b, twi_index++);
+			return;
+		}
+#endif
+		*twi_next_byte() = b;
+	}
+
+	void twi_queue(twi_transaction_t* transaction){
+		transaction->status = TWI_PENDING;
+		transaction->transferred = 0;
+		transaction->duration = 0;
+		transaction->next = NULL;
+
+		if ((transaction->flags & TWI_READ) && twi_transaction_length(transaction) == 0){
+			// a read can't be ended until one byte has been received
+			twi_notify(transaction, TWI_ERROR_LENGTH);
+			return;
+		}
+
+		uint8_t sreg = SREG;
+		cli();
+		if (twi_tail == NULL){
+			twi_head = transaction;
+			twi_tail = transaction;
+			twi_begin_next();
+		}
+		else {
+			twi_tail->next = transaction;
+			twi_tail = transaction;
 		}
-	
-		// wait until twi is ready, become master transmitter
-		while(TWI_READY != twi_state){
-			continue;
+		SREG = sreg;
+	}
+
+	uint8_t twi_wait(twi_transaction_t* transaction){
+		uint8_t progress = twi_progress;
+		uint32_t polls = 0;
+		while (TWI_PENDING == transaction->status){
+			if (progress != twi_progress){
+				progress = twi_progress;
+				polls = 0;
+			}
+			else if (++polls >= TWI_TIMEOUT){
+				// nothing has happened on the bus for too long
+				twi_recover();
+				polls = 0;
+			}
+		}
+		return transaction->status;
+	}
+
+	uint8_t twi_busy(){
+		return twi_head != NULL;
+	}
+
+	void twi_set_clock(uint16_t (*clock)(void)){
+		twi_clock = clock;
+	}
+
+	void twi_get_stats(twi_stats_t* stats){
+		uint8_t sreg = SREG;
+		cli();
+		*stats = twi_stats;
+		SREG = sreg;
+	}
+
+	void twi_reset_stats(){
+		uint8_t sreg = SREG;
+		cli();
+		twi_stats.transactions = 0;
+		twi_stats.errors = 0;
+		twi_stats.recoveries = 0;
+		twi_stats.bytes = 0;
+		twi_stats.time_total = 0;
+		twi_stats.time_max = 0;
+		SREG = sreg;
+	}
+
+	uint16_t twi_read_from(uint8_t address, uint8_t* data, uint16_t length, uint8_t send_stop){
+		if (length == 0){
+			return 0;
 		}
-		twi_state = TWI_MTX;
-		twi_send_stop = send_stop;
-		// reset error state (0xFF.. no error occured)
-		twi_error = 0xFF;
-	
-		// initialize buffer iteration vars
-		twi_masterBufferIndex = 0;
-		twi_masterBufferLength = length;
-		
-		//If we have custom buffers we don't need to copy the data.
-		#if !defined(TWI_CUSTOM_BUFFERS)
-			// copy data to twi buffer
-			for(uint16_t i = 0; i < length; ++i){
-				twi_masterBuffer[i] = data[i];
+
+		twi_buffer_t buffer = { data, length };
+		twi_transaction_t t;
+		t.address = address;
+		t.flags = TWI_READ | (send_stop ? 0 : TWI_REPEATED_START);
+		t.buffers = &buffer;
+		t.buffer_count = 1;
+		t.callback = NULL;
+		twi_queue(&t);
+		twi_wait(&t);
+
+		return t.transferred;
+	}
+
+	uint8_t twi_write_to(uint8_t address, uint8_t* data, uint16_t length, uint8_t block, uint8_t send_stop){
+		twi_buffer_t buffer = { data, length };
+		twi_transaction_t t;
+		twi_transaction_t* transaction = &t;
+		transaction->buffers = &buffer;
+
+		if (!block){
+			// the caller's data may be gone before it is sent, so it goes through the master buffer
+			if(TWI_BUFFER_LENGTH < length){
+				return TWI_ERROR_LENGTH;
 			}
-		#endif
-		
-		// build sla+w, slave device address + w bit
-		twi_slarw = TW_WRITE;
-		twi_slarw |= address << 1;
-		
-		// if we're in a repeated start, then we've already sent the START
-		// in the ISR. Don't do it again.
-		//
-		if (true == twi_inRepStart) {
-			// if we're in the repeated start state, then we've already sent the start,
-			// (@@@ we hope), and the TWI statemachine is just waiting for the address byte.
-			// We need to remove ourselves from the repeated start state before we enable interrupts,
-			// since the ISR is ASYNC, and we could get confused if we hit the ISR before cleaning
-			// up. Also, don't enable the START interrupt. There may be one pending from the 
-			// repeated start that we sent outselves, and that would really confuse things.
-			twi_inRepStart = false;			// remember, we're dealing with an ASYNC ISR
-			TWDR = twi_slarw;				
-			TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE);	// enable INTs, but not START
+			// wait for the previous non-blocking write to finish with the buffer
+			twi_wait(&twi_masterTransaction);
+			//If we have custom buffers we don't need to copy the data.
+			#if !defined(TWI_CUSTOM_BUFFERS)
+				// copy data to twi buffer
+				for(uint16_t i = 0; i < length; ++i){
+					twi_masterBuffer[i] = data[i];
+				}
+			#endif
+			twi_masterSegment.data = twi_masterBuffer;
+			twi_masterSegment.length = length;
+			transaction = &twi_masterTransaction;
+			transaction->buffers = &twi_masterSegment;
 		}
-		else
-			// send start condition
-			TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA);	// enable INTs
-	
-		// wait for write operation to complete
-		while(block && (TWI_MTX == twi_state)){
-			continue;
+
+		transaction->address = address;
+		transaction->flags = TWI_WRITE | (send_stop ? 0 : TWI_REPEATED_START);
+		transaction->buffer_count = 1;
+		transaction->callback = NULL;
+		twi_queue(transaction);
+
+		if (!block){
+			return TWI_SUCCESS;
 		}
-		
-		if (twi_error == 0xFF)
-			return 0;	// success
-		else if (twi_error == TW_MT_SLA_NACK)
-			return 2;	// error: address send, nack received
-		else if (twi_error == TW_MT_DATA_NACK)
-			return 3;	// error: data send, nack received
-		else
-			return 4;	// other twi error
+		return twi_wait(transaction);
 	}
 #endif
 
+void twi_recover(){
+	uint8_t sreg = SREG;
+	cli();
+
+	// take the pins away from the TWI hardware
+	TWCR = 0x00;
+
+#ifdef TWI_SCL
+	// drive the lines open drain: low by making the pin an output, high by letting the pull ups have it
+	uint8_t port = TWI_PORT;
+	TWI_PORT &= ~(_BV(TWI_SCL) | _BV(TWI_SDA));
+	TWI_DDR &= ~(_BV(TWI_SCL) | _BV(TWI_SDA));
+	_delay_us(5);
+
+	// a slave which is holding SDA low is part way through sending a byte; clock it out
+	for (uint8_t i = 0; i < 9 && !(TWI_PIN & _BV(TWI_SDA)); i++){
+		TWI_DDR |= _BV(TWI_SCL);
+		_delay_us(5);
+		TWI_DDR &= ~_BV(TWI_SCL);
+		_delay_us(5);
+	}
 
+	// stop: SDA goes high while SCL is high
+	TWI_DDR |= _BV(TWI_SCL);
+	_delay_us(5);
+	TWI_DDR |= _BV(TWI_SDA);
+	_delay_us(5);
+	TWI_DDR &= ~_BV(TWI_SCL);
+	_delay_us(5);
+	TWI_DDR &= ~_BV(TWI_SDA);
+	_delay_us(5);
+
+	TWI_PORT = port;
+#endif
 
+	twi_state = TWI_READY;
+	twi_inRepStart = false;
+	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
 
+#if !defined(TWI_DISABLE_MASTER)
+	twi_stats.recoveries++;
+	// the transaction which was on the bus is abandoned, and the rest carry on
+	if (twi_head != NULL){
+		twi_transaction_t* t = twi_dequeue(TWI_ERROR_TIMEOUT);
+		twi_begin_next();
+		twi_notify(t, TWI_ERROR_TIMEOUT);
+	}
+#endif
+
+	SREG = sreg;
+}
 
 #if !defined(TWI_DISABLE_SLAVE)
 	void twi_set_slave_address(uint8_t address){
@@ -301,23 +531,23 @@ void twi_init(){
 #if !defined(TWI_DISABLE_SLAVE) && !defined(TWI_DISABLE_SLAVE_TX)
 	uint8_t twi_transmit(const uint8_t* data, uint16_t length){
 		uint16_t i;
-	
+
 		// ensure data will fit into buffer
 		if(TWI_BUFFER_LENGTH < length){
 			return 1;
 		}
-		
+
 		// ensure we are currently a slave transmitter
 		if(TWI_STX != twi_state){
 			return 2;
 		}
-		
+
 		// set length and copy data into tx buffer
 		twi_txBufferLength = length;
 		for(i = 0; i < length; ++i){
 			twi_txBuffer[i] = data[i];
 		}
-		
+
 		return 0;
 	}
 #endif
@@ -344,29 +574,9 @@ static void twi_reply(uint8_t ack){
 	}
 }
 
-static void twi_stop(void){
-	// send stop condition
-	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTO);
-
-	// wait for stop condition to be exectued on bus
-	// TWINT is not set after a stop condition!
-	while(TWCR & _BV(TWSTO)){
-		continue;
-	}
-
-	// update twi state
-	twi_state = TWI_READY;
-}
-
-static void twi_release_bus(void){
-	// release bus
-	TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT);
-
-	// update twi state
-	twi_state = TWI_READY;
-}
-
 ISR(TWI_vect){
+	twi_progress++;
+
 	switch(TW_STATUS){
 		// All Master
 		case TW_START:		 // sent start condition
@@ -378,58 +588,35 @@ ISR(TWI_vect){
 
 	#ifndef TWI_DISABLE_MASTER
 		// Master Transmitter
-		case TW_MT_SLA_ACK:	// slave receiver acked address
 		case TW_MT_DATA_ACK: // slave receiver acked data
-			// if there is data to send, send it, otherwise stop 
-			if(twi_masterBufferIndex < twi_masterBufferLength){
-#ifdef TWI_MASTER_TX_WRITER
-				// call the master tx writer function to get the byte to send
-				TWDR = twi_master_tx_writer(twi_masterBufferIndex++);
-#else
-				// copy data from buffer to output register
-				TWDR = twi_masterBuffer[twi_masterBufferIndex++];
-#endif
+			twi_head->transferred++;
+		case TW_MT_SLA_ACK:	// slave receiver acked address
+			// if there is data to send, send it, otherwise finish
+			if(twi_index < twi_length){
+				twi_transmit_byte();
 				twi_reply(1);
-			} 
+			}
 			else{
-				if (twi_send_stop) {
-					twi_stop();
-				}
-				else {
-					twi_inRepStart = true;	// we're gonna send the START
-					// don't enable the interrupt. We'll generate the start, but we 
-					// avoid handling the interrupt until we're in the next transaction,
-					// at the point where we would normally issue the start.
-					TWCR = _BV(TWINT) | _BV(TWSTA)| _BV(TWEN) ;
-					twi_state = TWI_READY;
-				}
+				twi_complete(TWI_SUCCESS);
 			}
 			break;
 		case TW_MT_SLA_NACK:	// address sent, nack received
-			twi_error = TW_MT_SLA_NACK;
-			twi_stop();
+			twi_complete(TWI_ERROR_ADDRESS_NACK);
 			break;
 		case TW_MT_DATA_NACK: // data sent, nack received
-			twi_error = TW_MT_DATA_NACK;
-			twi_stop();
+			twi_complete(TWI_ERROR_DATA_NACK);
 			break;
 		case TW_MT_ARB_LOST: // lost bus arbitration
-			twi_error = TW_MT_ARB_LOST;
-			twi_release_bus();
+			twi_complete(TWI_ERROR_OTHER);
 			break;
 
 		// Master Receiver
 		case TW_MR_DATA_ACK: // data received, ack sent
-#ifdef TWI_MASTER_RX_READER
-			// pass data to master rx reader function, to handle as appropriate.
-			twi_slave_rx_reader(TWDR, twi_masterBufferIndex++);
-#else
-			// put byte into buffer
-			twi_masterBuffer[twi_masterBufferIndex++] = TWDR;
-#endif
+			twi_receive_byte(TWDR);
 		case TW_MR_SLA_ACK:	// address sent, ack received
-			// ack if more bytes are expected, otherwise nack
-			if(twi_masterBufferIndex < twi_masterBufferLength){
+			// ack if more bytes are expected after the next one, otherwise nack
+			// (the ack / nack goes out in response to the byte which is about to be received)
+			if(twi_index + 1 < twi_length){
 				twi_reply(1);
 			}else{
 				twi_reply(0);
@@ -437,21 +624,11 @@ ISR(TWI_vect){
 			break;
 		case TW_MR_DATA_NACK: // data received, nack sent
 			// put final byte into buffer
-			twi_masterBuffer[twi_masterBufferIndex++] = TWDR;
-			if (twi_send_stop) {
-				twi_stop();
-			}
-			else {
-				twi_inRepStart = true;	// we're gonna send the START
-				// don't enable the interrupt. We'll generate the start, but we 
-				// avoid handling the interrupt until we're in the next transaction,
-				// at the point where we would normally issue the start.
-				TWCR = _BV(TWINT) | _BV(TWSTA)| _BV(TWEN) ;
-				twi_state = TWI_READY;
-			}		
+			twi_receive_byte(TWDR);
+			twi_complete(TWI_SUCCESS);
 			break;
 		case TW_MR_SLA_NACK: // address sent, nack received
-			twi_stop();
+			twi_complete(TWI_ERROR_ADDRESS_NACK);
 			break;
 		// TW_MR_ARB_LOST handled by TW_MT_ARB_LOST case
 	#endif
@@ -463,7 +640,8 @@ ISR(TWI_vect){
 		case TW_SR_GCALL_ACK: // addressed generally, returned ack
 		case TW_SR_ARB_LOST_SLA_ACK:	 // lost arbitration, returned ack
 		case TW_SR_ARB_LOST_GCALL_ACK: // lost arbitration, returned ack
-			// enter slave receiver mode
+			// enter slave receiver mode; if we lost a master transaction to get here, it stays
+			// at the head of the queue and starts again from the beginning afterwards
 			twi_state = TWI_SRX;
 			// indicate that rx buffer can be overwritten and ack
 			twi_rxBufferIndex = 0;
@@ -501,6 +679,9 @@ ISR(TWI_vect){
 			twi_rxBufferIndex = 0;
 			// ack future responses and leave slave receiver state
 			twi_release_bus();
+		#ifndef TWI_DISABLE_MASTER
+			twi_begin_next();
+		#endif
 			break;
 		case TW_SR_DATA_NACK:			 // data received, returned nack
 		case TW_SR_GCALL_DATA_NACK: // data received generally, returned nack
@@ -508,7 +689,7 @@ ISR(TWI_vect){
 			twi_reply(0);
 			break;
 	#endif
-		
+
 	#ifndef TWI_DISABLE_SLAVE_TX
 		// Slave Transmitter
 		case TW_ST_SLA_ACK:					// addressed, returned ack
@@ -546,23 +727,37 @@ ISR(TWI_vect){
 			}
 	#endif
 			break;
-		case TW_ST_DATA_NACK: // received nack, we are done 
+		case TW_ST_DATA_NACK: // received nack, we are done
 		case TW_ST_LAST_DATA: // received ack, but we are done already!
 			// ack future responses
 			twi_reply(1);
 			// leave slave receiver state
 			twi_state = TWI_READY;
+		#ifndef TWI_DISABLE_MASTER
+			twi_begin_next();
+		#endif
 			break;
 	#endif
 	#endif
-	
+
 		// All
 		case TW_NO_INFO:	 // no state information
 			break;
 		case TW_BUS_ERROR: // bus error, illegal stop/start
-			twi_error = TW_BUS_ERROR;
+		#ifndef TWI_DISABLE_MASTER
+			if (TWI_MTX == twi_state || TWI_MRX == twi_state){
+				twi_complete(TWI_ERROR_BUS);
+				break;
+			}
+		#endif
 			twi_stop();
+		#ifndef TWI_DISABLE_MASTER
+			twi_begin_next();
+		#endif
 			break;
 	}
 }
+#else
+static volatile uint8_t dummy = 0;	//Needed to prevent complaints about empty translation unit
 
+#endif //__AVR_ATmega32U2__
@@ -381,6 +381,45 @@ int16_t usb_serial_getchar(void)
 	return c;
 }
 
+// receive up to size bytes.  Each bank is drained with a single endpoint
+// select, and released as soon as it is empty so the host can refill it
+// while the other bank is being read.  Returns the number of bytes read;
+// does not wait for more data to arrive.
+uint16_t usb_serial_read(uint8_t *buffer, uint16_t size)
+{
+	uint8_t c, n, intr_state;
+	uint16_t count = 0;
+
+	while (count < size) {
+		intr_state = SREG;
+		cli();
+		if (!usb_configuration) {
+			SREG = intr_state;
+			break;
+		}
+		UENUM = CDC_RX_ENDPOINT;
+		c = UEINTX;
+		if (!(c & (1<<RWAL))) {
+			// no data in buffer; release an empty packet and try the other bank
+			if (c & (1<<RXOUTI)) {
+				UEINTX = 0x6B;
+				SREG = intr_state;
+				continue;
+			}
+			SREG = intr_state;
+			break;
+		}
+		n = UEBCLX;
+		if (n > size - count) n = size - count;
+		count += n;
+		while (n--) *buffer++ = UEDATX;
+		// if buffer completely used, release it
+		if (!(UEINTX & (1<<RWAL))) UEINTX = 0x6B;
+		SREG = intr_state;
+	}
+	return count;
+}
+
 // number of bytes available in the receive buffer
 uint8_t usb_serial_available(void)
 {
@@ -78,6 +78,7 @@ uint8_t usb_configured(void);		// is the USB port configured
 uint8_t usb_serial_read_c(char *c);		// receive a character
 uint8_t usb_serial_read_b(uint8_t *b);	// receive a byte
 uint8_t usb_serial_available();			// number of bytes in receive buffer
+uint16_t usb_serial_read(uint8_t *buffer, uint16_t size); // receive up to size bytes, a bank at a time
 void usb_serial_flush_input();			// discard any buffered input
 
 // transmitting data
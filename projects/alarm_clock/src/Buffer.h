@@ -8,6 +8,7 @@
 #include <avr/pgmspace.h>
 
 #include <font/font.h>
+#include <font/glyph.h>
 
 namespace digitalcave {
 
@@ -18,6 +19,8 @@ namespace digitalcave {
 			uint8_t width;
 			uint8_t height;
 
+			glyph_cache_t glyphs;
+
 		public:
 
 			/*
@@ -12,16 +12,23 @@ static uint8_t current_folder = 1;
 static uint8_t current_file_count = MAX_SOUND_FILE_COUNT;
 static uint8_t queue[MAX_SOUND_FILE_COUNT];
 static uint8_t currentFileIndex;
+static uint32_t lastTrackCheck = 0;
+static uint32_t lastTunerTick = 0;
 
 void music_shuffle_queue(uint8_t file_count);
 
+static uint32_t music_millis(){
+	return timer_millis();
+}
+
 
 void music_init(){
 	serialAVR = new SerialAVR(9600, 8, 0, 1, 1);		//Serial Port 1 is the hardware serial port
 
 	rda5807 = new RDA5807(i2c);		//Init FM
+	rda5807->setRdsEnabled(0);		//Nothing shows RDS yet; without it, the tuner is only polled while tuning
 
-	dfplayermini_init(serialAVR);	//Init MP3
+	dfplayermini_init(serialAVR, music_millis);	//Init MP3
 }
 
 void music_shuffle_queue(uint8_t file_count){
@@ -52,11 +59,24 @@ void music_shuffle_queue(uint8_t file_count){
 	currentFileIndex = 0;
 }
 
-//This should not be called more than once every 50ms or so.  Calling it from the 1Hz update in state.cpp is fine.
+//Call this from every pass of the main loop; it keeps the DFPlayer's command queue moving, and lets the
+// FM tuner finish a tune or scan.  About once a second it also checks whether the last song has finished.
 void music_poll(){
-	//Clear out and ignore any waiting messages from the input buffer.
+	//Nothing the module tells us about needs an answer; ignore it.
 	while (dfplayermini_poll());
 
+	uint32_t now = music_millis();
+	if (now - lastTunerTick >= 20){
+		lastTunerTick = now;
+		rda5807->tick();
+	}
+
+	//Wait for the last track change to go through before checking again
+	if (now - lastTrackCheck < 1000 || dfplayermini_pending()){
+		return;
+	}
+	lastTrackCheck = now;
+
 	if (playbackState == SOUND_STATE_PLAY && musicSource == SOUND_SOURCE_DFPLAYER && (PINF & _BV(PINF1))){		//If we are supposed to be playing MP3s, but PINF1 has gone high (meaning the last song is finished), we go to the next one.
 		dfplayermini_send_command(DFPLAYER_COMMAND_FOLDER_SET, (current_folder << 8) + queue[currentFileIndex]);
 
@@ -5,6 +5,7 @@
 #include <DFPlayerMini.h>
 #include <RDA5807.h>
 #include <I2CAVR.h>
+#include <timer/timer.h>
 
 #include "config.h"
 
@@ -101,10 +101,10 @@ void state_poll(){
 	uint8_t update_display = get_update_display();
 	if (update_display){
 		update_time(&now, &now_tm);
-
-		music_poll();
 	}
 
+	music_poll();
+
 	lampButton->sample(timer_millis());
 	musicButton->sample(timer_millis());
 	int8_t lamp_encoder_movement = encoder_get_movement_1();
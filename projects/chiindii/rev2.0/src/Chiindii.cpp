@@ -25,7 +25,7 @@
 using namespace digitalcave;
 
 //This cannot be a class variable, since it needs to be accessed by an ISR
-static SerialAVR serialAvr(38400, 8, 0, 1, 1, 128);
+static SerialAVR serialAvr(38400, 8, 0, 1, 1, 128, 64);
 
 //Reset WDT after system reset
 void get_mcusr(void) __attribute__((naked))  __attribute__((used))  __attribute__((section(".init3")));
@@ -455,3 +455,7 @@ void Chiindii::saveConfig(){
 ISR(USART1_RX_vect){
 	serialAvr.isr();
 }
+
+ISR(USART1_UDRE_vect){
+	serialAvr.txIsr();
+}
@@ -23,6 +23,7 @@ int main(){
 	SPI.setMISO(MISO);
 	SPI.setSCK(SCK);
 	SerialFlash.begin(CS_FLASH);
+	SerialFlash.cacheDirectory();	//Samples are opened by name on every hit
 	SD.begin(CS_SD);
 
 	//Encoder pushbutton
@@ -39,6 +40,8 @@ int main(){
 	KitSelect::loadKitIndexFromEeprom();
 	VolumeLineIn::loadVolumeFromEeprom();
 	VolumeHeadphones::loadVolumeFromEeprom();
+	VelocityCurve::loadCurvesFromEeprom();
+	LearnCrosstalk::loadCouplingFromEeprom();
 
 	//Set up ADC and build filename tables
 	Pad::init();
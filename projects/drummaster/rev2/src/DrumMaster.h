@@ -10,6 +10,8 @@
 #include "menu/Menu.h"
 #include "menu/CalibrateChannel.h"
 #include "menu/KitSelect.h"
+#include "menu/LearnCrosstalk.h"
+#include "menu/VelocityCurve.h"
 #include "menu/VolumeLineIn.h"
 #include "menu/VolumeHeadphones.h"
 #include "menu/VolumePad.h"
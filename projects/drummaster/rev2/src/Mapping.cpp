@@ -8,6 +8,7 @@ using namespace digitalcave;
 Mapping Mapping::mappings[KIT_COUNT];
 uint8_t Mapping::kitCount;
 uint8_t Mapping::selectedKit;
+uint32_t Mapping::fadeRates[PAD_COUNT];
 
 void Mapping::loadMappings(){
 // 	Serial.println("loadMappings()");
@@ -31,6 +32,8 @@ void Mapping::loadMappings(){
 			}
 			
 			mappings[i].filenamePrefixCount[j] = 0;
+			mappings[i].fadeTimes[j] = 0;
+			mappings[i].chokeGroups[j] = 0;
 		}
 	}
 
@@ -46,6 +49,11 @@ void Mapping::loadMappings(){
 	//Current filename index.  Starts at 0, and increments with each comma separated filename.
 	// Must be less than FILENAME_COUNT.
 	uint8_t filenameIndex = 0;
+	
+	//The current entry on an FD or CK line, and the number of CK lines so far in this kit
+	char option[8];
+	uint8_t optionIndex = 0;
+	uint8_t chokeGroup = 0;
 
 	SerialFlashFile mappingsFile = SerialFlash.open("MAPPINGS.TXT");
 	if (!mappingsFile) {
@@ -85,6 +93,7 @@ void Mapping::loadMappings(){
 						return;
 					}
 					kitNameIndex = 0;
+					chokeGroup = 0;
 					for (uint8_t j = 0; j < KITNAME_STRING_SIZE; j++){
 						mappings[kitIndex].kitName[j] = 0x00;	//Null out string
 					}
@@ -97,6 +106,7 @@ void Mapping::loadMappings(){
 					mappingIndex = 0;
 					lastMappingKey = 0xFF;
 					padIndex = 0xFF;
+					optionIndex = 0;
 				}
 				//Hash starts a comment
 				else if (buffer[i] == '#'){
@@ -138,6 +148,11 @@ void Mapping::loadMappings(){
 				}
 				//Newline
 				else if (buffer[i] == '\n' || buffer[i] == '\r'){
+					if (optionIndex){
+						option[optionIndex] = 0x00;
+						mappings[kitIndex].setOption(padIndex, option, chokeGroup);
+						optionIndex = 0;
+					}
 					state = STATE_NEWLINE;
 				}
 				//Some character other than A-Z, 0-9, comma, period, colon, dash, underscore
@@ -150,20 +165,15 @@ void Mapping::loadMappings(){
 				}
 				//Second char of mapping key
 				else if (mappingIndex == 1){
-					if (lastMappingKey == 'H' && buffer[i] == 'H') padIndex = 0;
-					else if (lastMappingKey == 'S' && buffer[i] == 'N') padIndex = 1;
-					else if (lastMappingKey == 'B' && buffer[i] == 'S') padIndex = 2;
-					else if (lastMappingKey == 'T' && buffer[i] == '1') padIndex = 3;
-					else if (lastMappingKey == 'C' && buffer[i] == 'R') padIndex = 4;
-					else if (lastMappingKey == 'T' && buffer[i] == '2') padIndex = 5;
-					else if (lastMappingKey == 'T' && buffer[i] == '3') padIndex = 6;
-					else if (lastMappingKey == 'S' && buffer[i] == 'P') padIndex = 7;
-					else if (lastMappingKey == 'R' && buffer[i] == 'D') padIndex = 8;
-					else if (lastMappingKey == 'X' && buffer[i] == '0') padIndex = 9;
-					else if (lastMappingKey == 'X' && buffer[i] == '1') padIndex = 10;
-					else {
+					if (lastMappingKey == 'F' && buffer[i] == 'D') padIndex = MAPPING_FADE;
+					else if (lastMappingKey == 'C' && buffer[i] == 'K') padIndex = MAPPING_CHOKE;
+					else padIndex = getPadIndex(lastMappingKey, buffer[i]);
+					
+					if (padIndex == MAPPING_CHOKE){
+						chokeGroup++;
+					}
+					else if (padIndex == 0xFF){
 						state = STATE_INVALID;
-						padIndex = 0xFF;
 					}
 				}
 				//Separator character (colon)
@@ -175,6 +185,17 @@ void Mapping::loadMappings(){
 						state = STATE_INVALID;
 					}
 				}
+				//Fade times and choke groups are a comma separated list of entries
+				else if (padIndex == MAPPING_FADE || padIndex == MAPPING_CHOKE){
+					if (buffer[i] == ','){
+						option[optionIndex] = 0x00;
+						mappings[kitIndex].setOption(padIndex, option, chokeGroup);
+						optionIndex = 0;
+					}
+					else if (optionIndex < sizeof(option) - 1){
+						option[optionIndex++] = buffer[i];
+					}
+				}
 				//Filling up filename
 				else if ((buffer[i] >= 'A' && buffer[i] <= 'Z') || (buffer[i] >= '0' && buffer[i] <= '9') || buffer[i] == '.' || buffer[i] == '-' || buffer[i] == '_'){
 					if ((mappingIndex - 3) < FILENAME_PREFIX_STRING_SIZE - 1){
@@ -200,6 +221,12 @@ void Mapping::loadMappings(){
 		}
 	}
 	
+	//The last line might not end with a newline
+	if (state == STATE_MAPPING && optionIndex){
+		option[optionIndex] = 0x00;
+		mappings[kitIndex].setOption(padIndex, option, chokeGroup);
+	}
+	
 	mappingsFile.close();
 	kitCount = kitIndex + 1;
 	
@@ -223,6 +250,36 @@ void Mapping::loadMappings(){
 // 	}
 }
 
+uint8_t Mapping::getPadIndex(char first, char second){
+	if (first == 'H' && second == 'H') return 0;
+	else if (first == 'S' && second == 'N') return 1;
+	else if (first == 'B' && second == 'S') return 2;
+	else if (first == 'T' && second == '1') return 3;
+	else if (first == 'C' && second == 'R') return 4;
+	else if (first == 'T' && second == '2') return 5;
+	else if (first == 'T' && second == '3') return 6;
+	else if (first == 'S' && second == 'P') return 7;
+	else if (first == 'R' && second == 'D') return 8;
+	else if (first == 'X' && second == '0') return 9;
+	else if (first == 'X' && second == '1') return 10;
+	return 0xFF;
+}
+
+void Mapping::setOption(uint8_t type, char* entry, uint8_t chokeGroup){
+	if (strlen(entry) < 2) return;
+	uint8_t padIndex = getPadIndex(entry[0], entry[1]);
+	if (padIndex == 0xFF) return;
+
+	if (type == MAPPING_FADE){
+		uint16_t fadeTime = atoi(entry + 2);
+		if (fadeTime > 10000) fadeTime = 10000;
+		fadeTimes[padIndex] = fadeTime;
+	}
+	else if (type == MAPPING_CHOKE){
+		chokeGroups[padIndex] = chokeGroup;
+	}
+}
+
 Mapping* Mapping::getSelectedMapping(){
 	return &mappings[selectedKit];
 }
@@ -242,6 +299,12 @@ void Mapping::setSelectedKit(uint8_t kitIndex){
 	
 	Mapping* selected = &mappings[selectedKit];
 	
+	//Work out the fade rates now, rather than every time something fades
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		uint16_t fadeTime = selected->fadeTimes[i] ? selected->fadeTimes[i] : Pad::getPad(i)->getFadeTime();
+		fadeRates[i] = voice_fade_rate(fadeTime, AUDIO_SAMPLE_RATE_EXACT);
+	}
+	
 	//Clear the sample volumes
 	for (uint8_t i = 0; i < PAD_COUNT; i++){
 		for (uint8_t j = 0; j < FILENAME_COUNT; j++){
@@ -328,6 +391,16 @@ char* Mapping::getKitName(){
 	return kitName;
 }
 
+uint8_t Mapping::getChokeGroup(uint8_t padIndex){
+	if (padIndex >= PAD_COUNT) return 0;
+	return chokeGroups[padIndex];
+}
+
+uint32_t Mapping::getFadeRate(uint8_t padIndex){
+	if (padIndex >= PAD_COUNT) return 0;
+	return fadeRates[padIndex];
+}
+
 inline uint8_t getClosestVolume(int8_t closestVolume, uint8_t pedalPositionIndex, uint16_t* sampleVolumes){
 	if (sampleVolumes[pedalPositionIndex] == 0) return 0xFF;
 	
@@ -22,6 +22,12 @@
 //Maximum number of kits.  Allocates enough memory to load all these kits, so keep the number low
 #define KIT_COUNT						20
 
+//Pad index values for the mapping lines which aren't samples: FD sets fade times (in ms) for
+// pads in this kit, e.g. "FD:HH80,CR1500", and each CK line is a choke group, e.g. "CK:CR,SP";
+// hitting any pad in the group fades out the others.
+#define MAPPING_FADE					0xFE
+#define MAPPING_CHOKE					0xFD
+
 //Maximum number of filenames to be defined for a single pad.  More than one allows you to layer
 // multiple samples to the same pad (i.e. hi hat and tambourine)
 #define FILENAME_COUNT					2
@@ -51,17 +57,36 @@ namespace digitalcave {
 			// each filename.
 			uint8_t getFilenames(uint8_t padIndex, double volume, uint8_t switchPosition, uint8_t pedalPosition, char filenames[FILENAME_COUNT][FILENAME_STRING_SIZE]);
 
+			//Returns the choke group for this pad (0 if it is not in one)
+			uint8_t getChokeGroup(uint8_t padIndex);
+
+			//Returns the fade rate (see voice_fade_rate()) for this pad in the selected kit
+			static uint32_t getFadeRate(uint8_t padIndex);
+
 		private:
 			static Mapping mappings[KIT_COUNT];		//All defined mappings, loaded from the mappings file
 			static uint8_t kitCount;				//Total number of kits defined in the mappings file
 			static uint8_t selectedKit;				//Currently selected kit
 			
+			//Fade rates for the selected kit, from its fade times or the pads' defaults
+			static uint32_t fadeRates[PAD_COUNT];
+			
+			//Returns the pad index for a two character mapping key, or 0xFF if there is no such pad
+			static uint8_t getPadIndex(char first, char second);
+			
 			char kitName[KITNAME_STRING_SIZE];
 			
 			/** Variables to store filename / pad mappings.  Initialized when loading mappings from file. **/
 			uint8_t filenamePrefixCount[PAD_COUNT];
 			char filenamePrefixes[PAD_COUNT][FILENAME_COUNT][FILENAME_PREFIX_STRING_SIZE];
 			
+			//Fade times in ms (0 uses the pad's default) and choke groups (0 is none), from the FD and CK lines
+			uint16_t fadeTimes[PAD_COUNT];
+			uint8_t chokeGroups[PAD_COUNT];
+			
+			//Applies one entry (e.g. "HH80" or "CR") of an FD or CK line
+			void setOption(uint8_t type, char* entry, uint8_t chokeGroup);
+			
 			/** Variables to optimize returning a specific sample when playing sounds.  Initialized when
 				setting the selected kit. **/
 			//Multi dimensional bit mask showing which samples are available
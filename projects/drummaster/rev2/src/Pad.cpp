@@ -4,18 +4,18 @@ using namespace digitalcave;
 
 ADC* Pad::adc = NULL;
 Pad* Pad::pads[PAD_COUNT] = {
-	//		Type				Piezo	Switch	Pedal	DT		Fade
-	new Pad(PAD_TYPE_HIHAT,		MUX_0,	MUX_15,	MUX_1,	50,		0.95),	//Hihat + Pedal
-	new Pad(PAD_TYPE_DRUM,		MUX_2,	MUX_NA, MUX_NA,	50,		0),		//Snare
-	new Pad(PAD_TYPE_DRUM,		MUX_3,	MUX_NA, MUX_NA,	50,		0),		//Bass
-	new Pad(PAD_TYPE_DRUM,		MUX_4,	MUX_NA, MUX_NA,	50,		0),		//Tom1
-	new Pad(PAD_TYPE_CYMBAL,	MUX_5,	MUX_14, MUX_NA,	50,		0.990),	//Crash
-	new Pad(PAD_TYPE_DRUM,		MUX_6,	MUX_NA, MUX_NA,	50,		0),		//Tom2
-	new Pad(PAD_TYPE_DRUM,		MUX_7,	MUX_NA, MUX_NA,	50,		0),		//Tom3
-	new Pad(PAD_TYPE_CYMBAL,	MUX_8,	MUX_13, MUX_NA,	50,		0.992),	//Splash
-	new Pad(PAD_TYPE_CYMBAL,	MUX_9,	MUX_12,	MUX_1,	50,		0.995),	//Ride
-	new Pad(PAD_TYPE_DRUM,		MUX_10,	MUX_NA, MUX_NA,	50,		0),		//X0
-	new Pad(PAD_TYPE_DRUM,		MUX_11,	MUX_NA, MUX_NA,	50,		0)		//X1
+	//		Type				Piezo	Switch	Pedal	DT		Fade (ms)
+	new Pad(PAD_TYPE_HIHAT,		MUX_0,	MUX_15,	MUX_1,	50,		140),	//Hihat + Pedal
+	new Pad(PAD_TYPE_DRUM,		MUX_2,	MUX_NA, MUX_NA,	50,		100),	//Snare
+	new Pad(PAD_TYPE_DRUM,		MUX_3,	MUX_NA, MUX_NA,	50,		100),	//Bass
+	new Pad(PAD_TYPE_DRUM,		MUX_4,	MUX_NA, MUX_NA,	50,		100),	//Tom1
+	new Pad(PAD_TYPE_CYMBAL,	MUX_5,	MUX_14, MUX_NA,	50,		700),	//Crash
+	new Pad(PAD_TYPE_DRUM,		MUX_6,	MUX_NA, MUX_NA,	50,		100),	//Tom2
+	new Pad(PAD_TYPE_DRUM,		MUX_7,	MUX_NA, MUX_NA,	50,		100),	//Tom3
+	new Pad(PAD_TYPE_CYMBAL,	MUX_8,	MUX_13, MUX_NA,	50,		860),	//Splash
+	new Pad(PAD_TYPE_CYMBAL,	MUX_9,	MUX_12,	MUX_1,	50,		1400),	//Ride
+	new Pad(PAD_TYPE_DRUM,		MUX_10,	MUX_NA, MUX_NA,	50,		100),	//X0
+	new Pad(PAD_TYPE_DRUM,		MUX_11,	MUX_NA, MUX_NA,	50,		100)	//X1
 };
 
 //Initialize static pads array
@@ -46,26 +46,21 @@ void Pad::init(){
 	digitalWriteFast(DRAIN_EN, MUX_DISABLE);
 }
 
-Pad::Pad(uint8_t padType, uint8_t piezoMuxIndex, uint8_t switchMuxIndex, uint8_t pedalMuxIndex, uint8_t doubleHitThreshold, double fadeGain) : 
+Pad::Pad(uint8_t padType, uint8_t piezoMuxIndex, uint8_t switchMuxIndex, uint8_t pedalMuxIndex, uint8_t doubleHitThreshold, uint16_t fadeTime) : 
 		padType(padType),
 		padIndex(currentIndex),
 		piezoMuxIndex(piezoMuxIndex),
 		switchMuxIndex(switchMuxIndex),
 		pedalMuxIndex(pedalMuxIndex),
-		fadeGain(fadeGain),
-		strikeTime(0),
-		peakValue(0),
-		playTime(0),
-		lastPiezo(0),
-		lastRaw(0),
+		fadeTime(fadeTime),
+		trigger(padIndex, doubleHitThreshold),
 		switchValue(0),
 		lastSwitchValue(0),
 		pedalPosition(0),
 		lastPedalPosition(0),
 		averagePedalPosition(0),
 		lastChicTime(0),
-		lastChicVolume(0),
-		doubleHitThreshold(doubleHitThreshold) {
+		lastChicVolume(0) {
 	currentIndex++;
 	
 	for (uint8_t i = 0; i < FILENAME_COUNT; i++){
@@ -90,7 +85,7 @@ void Pad::poll(){
 
 			if (volume > 0 && lastChicTime + 200 < millis()){
 				for (uint8_t i = 0; i < filePrefixCount; i++){
-					Sample::startFade(padIndex, 0.95);
+					Sample::startFade(padIndex, Mapping::getFadeRate(padIndex));
 					lastSample[i] = Sample::findAvailableSample(padIndex, volume);
 					lastSample[i]->play(filenames[i], padIndex, volume, 1);
 					lastChicTime = millis();
@@ -98,13 +93,13 @@ void Pad::poll(){
 				}
 			}
 			else {
-				Sample::startFade(padIndex, fadeGain);
+				Sample::startFade(padIndex, Mapping::getFadeRate(padIndex));
 			}
 		}
 		
 		if (getPadType() == PAD_TYPE_CYMBAL){
 			if (!lastSwitchValue && switchValue){
-				Sample::startFade(padIndex, fadeGain);
+				Sample::startFade(padIndex, Mapping::getFadeRate(padIndex));
 			}
 			else if (lastSwitchValue && !switchValue){
 				Sample::stopFade(padIndex);
@@ -121,9 +116,17 @@ void Pad::poll(){
 			lastSample[i] = Sample::findAvailableSample(padIndex, volume);
 			lastSample[i]->play(filenames[i], padIndex, volume, 0);
 		}
+		
+		//Fade out the other pads in this pad's choke group
+		uint8_t chokeGroup = Mapping::getSelectedMapping()->getChokeGroup(padIndex);
+		if (chokeGroup){
+			for (uint8_t i = 0; i < PAD_COUNT; i++){
+				if (i != padIndex && Mapping::getSelectedMapping()->getChokeGroup(i) == chokeGroup){
+					Sample::startFade(i, Mapping::getFadeRate(i));
+				}
+			}
+		}
 	}
-	
-	Sample::processFade(padIndex);
 }
 
 double Pad::readPiezo(uint8_t muxIndex){
@@ -149,55 +152,29 @@ double Pad::readPiezo(uint8_t muxIndex){
 	//... and disable MUX again
 	digitalWriteFast(ADC_EN, MUX_DISABLE);
 
-	//If we are within double trigger threshold, AND the currentValue is greater than the last played value, 
-	// then we adjust the volume of the last played sample.  We don't enable the drain this time through;
-	// if the volume is stable then it will be enabled next time around, and if it is still increasing we
-	// want to go through here again.
- 	if (playTime + doubleHitThreshold > millis() && currentValue > lastRaw){
- 		double adjustedVolume = (currentValue - MIN_VALUE) / 256.0 * padVolume;
+	uint8_t result = trigger.read(currentValue, millis());
+	
+	//The last hit is still rising; adjust the volume of the last played sample.  We don't enable the drain 
+	// this time through; if the volume is stable then it will be enabled next time around, and if it is 
+	// still increasing we want to go through here again.
+	if (result == TRIGGER_ADJUST){
+		double adjustedVolume = trigger.getVelocity() * padVolume;
+		if (adjustedVolume > 2.0) adjustedVolume = 2;
 		for (uint8_t i = 0; i < FILENAME_COUNT; i++){
 			if (lastSample[i] != NULL){
 				lastSample[i]->setVolume(adjustedVolume);
 			}
 		}
-// 		Serial.print("Adjusting volume to ");
-// 		Serial.println(adjustedVolume);
- 		lastRaw = currentValue;
- 		return 0;
- 	}
-	
-	//If we are still within the double hit threshold, OR if we are within 4x the double hit threshold 
-	// time-span AND the currently read value is less than one quarter of the previous one, then we 
-	// assume this is just a ghost double trigger.  Re-enable the drain each time we go through here.
-	if (playTime + doubleHitThreshold > millis() 
-			|| (playTime + (doubleHitThreshold * 4) > millis() && ((currentValue - MIN_VALUE) / 256.0 * padVolume) < (lastPiezo / 4))){
+	}
+	//A double trigger, ghost or crosstalk; re-enable the drain each time we go through here.
+	else if (result == TRIGGER_DRAIN){
 		digitalWriteFast(DRAIN_EN, MUX_ENABLE);
 		delayMicroseconds(50);
-		return 0;
 	}
-	
-	if (currentValue < MIN_VALUE && peakValue < MIN_VALUE){
-		//No hit in progress
-	}
-	else if (currentValue >= MIN_VALUE && peakValue == 0){
-		//A new hit has started; record the time
-		strikeTime = millis();
-		peakValue = currentValue;
-	}
-	else if (currentValue > peakValue){
-		//Volume is still increasing; record this as the new peak value
-		peakValue = currentValue;
-	}
-	
-	if (peakValue && (millis() - strikeTime) > MAX_RESPONSE_TIME){
-		//We have timed out; send whatever the peak value currently is
-		double result = (peakValue - MIN_VALUE) / 256.0 * padVolume;
-		if (result > 2.0) result = 2;
-		lastRaw = peakValue;
-		playTime = millis();
-		peakValue = 0;
-		lastPiezo = result;
-		return result;
+	else if (result == TRIGGER_HIT){
+		double volume = trigger.getVelocity() * padVolume;
+		if (volume > 2.0) volume = 2;
+		return volume;
 	}
 	
 	return 0;
@@ -277,6 +254,14 @@ Pad* Pad::getPad(uint8_t padIndex){
 	return pads[padIndex];
 }
 
+Trigger* Pad::getTrigger(){
+	return &trigger;
+}
+
+uint16_t Pad::getFadeTime(){
+	return fadeTime;
+}
+
 uint8_t Pad::getPadType(){
 	return padType;
 }
@@ -7,6 +7,7 @@
 
 #include "Mapping.h"
 #include "Sample.h"
+#include "Trigger.h"
 #include "hardware.h"
 
 #define MUX_0		0
@@ -27,13 +28,6 @@
 #define MUX_15		15
 #define MUX_NA		0xFF
 
-//The maximum time (in ms) between a new hit being detected and when we return
-// the value.
-#define MAX_RESPONSE_TIME			1
-
-//Minimum ADC value to register as a hit
-#define MIN_VALUE					16
-
 #define PAD_TYPE_DRUM				0
 #define PAD_TYPE_CYMBAL				1
 #define PAD_TYPE_HIHAT				2
@@ -58,17 +52,23 @@ namespace digitalcave {
 			static Pad* getPad(uint8_t padIndex);
 		
 			//Constructor
-			Pad(uint8_t padType, uint8_t piezoMuxIndex, uint8_t switchMuxIndex, uint8_t pedalMuxIndex, uint8_t doubleHitThreshold, double fadeGain);
+			Pad(uint8_t padType, uint8_t piezoMuxIndex, uint8_t switchMuxIndex, uint8_t pedalMuxIndex, uint8_t doubleHitThreshold, uint16_t fadeTime);
 			
 			//Returns the pad type.
 			uint8_t getPadType();
 			
+			//Returns the default time (in ms) to fade this pad's samples out when muted or choked
+			uint16_t getFadeTime();
+			
 			//Method called repeatedly from main code.  If the pad was hit, start playing appropriate sample(s)
 			void poll();
 			
 			//Get / set the per-pad volume.
 			double getPadVolume();
 			void setPadVolume(double padVolume);
+			
+			//Returns the trigger, to get / set the velocity curve
+			Trigger* getTrigger();
 
 		private:
 			//ADC Object
@@ -88,23 +88,13 @@ namespace digitalcave {
 			uint8_t switchMuxIndex;
 			uint8_t pedalMuxIndex;
 			
-			//The gain applied to the fade algorithm for this cymbal.  0.99 results in a 
-			// fairly long fade out; 0.97 is much quicker.
-			double fadeGain;
+			//The default time (in ms) to fade out this pad's samples, from full volume to silence.  A kit
+			// mapping can override it.
+			uint16_t fadeTime;
 
 			/*** State variables used in reading the pizeo value ***/
-			//The time at which this hit was first read.  We must return a value within
-			// at most MAX_RESPONSE_TIME ms from this time.
-			uint32_t strikeTime;
-			//The peak value read from the ADC for this particular strike.
-			// We repeatedly read the ADC, keeping track of the peak value, until the 
-			// readings have stabilized or the maximum time has passed.
-			uint16_t peakValue;
-			//The time at which the last value was considered stable and returned
-			uint32_t playTime;
-			//The last piezo value which was returned / the last raw value used to obtain the piezo value
-			double lastPiezo;
-			uint16_t lastRaw;
+			//Peak detection, double hit / crosstalk rejection, and velocity curve
+			Trigger trigger;
 
 			/*** State variables used in reading switch values ***/
 			//The current switch value and previous value.
@@ -126,9 +116,6 @@ namespace digitalcave {
 			//Volume that the last chic was played at
 			double lastChicVolume;
 
-			
-			//Maximum time in ms after a sample has been played before we can play another one.
-			uint8_t doubleHitThreshold;
 
 			/*** Internal state ***/
 			//The per-pad volume gain.  Limited from 0 - 5.
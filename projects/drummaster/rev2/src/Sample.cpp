@@ -17,7 +17,7 @@ AudioInputI2S Sample::input;
 AudioOutputI2S Sample::output;
 
 //Mixers
-AudioMixer16 Sample::sampleMixer;
+AudioMixerSerialflash Sample::sampleMixer;
 AudioMixer4 Sample::outputMixer;
 
 //Sample mixer to output mixer
@@ -31,6 +31,9 @@ AudioConnection Sample::inputToOutputMixer1(input, 1, outputMixer, 1);
 AudioConnection Sample::mixerToOutput0(outputMixer, 0, output, 0);
 AudioConnection Sample::mixerToOutput1(outputMixer, 0, output, 1);
 
+//Fade curve, filled in by the first sample's constructor
+uint16_t Sample::fadeCurve[VOICE_FADE_POINTS + 1];
+
 //Initialize samples array
 uint8_t Sample::currentIndex = 0;
 Sample Sample::samples[SAMPLE_COUNT];
@@ -175,11 +178,10 @@ Sample* Sample::findAvailableSample(uint8_t pad, double volume){
 Sample::Sample(): 
 		index(currentIndex & 0x0F), 
 		playSerialRaw(),
-		playSerialRawToMixer(playSerialRaw, 0, sampleMixer, index),
 		lastPad(0xFF),
-		fadeGain(1),
-		fading(0),
 		volume(0){
+	if (currentIndex == 0) voice_fade_curve(fadeCurve, 60);
+	sampleMixer.voice(index, playSerialRaw);
 	currentIndex++;	//Increment current index
 }
 
@@ -190,8 +192,7 @@ void Sample::play(char* filename, uint8_t pad, double volume, uint8_t ignoreFade
 	else if (volume >= 5.0) volume = 5.0;
 	
 	this->ignoreFade = ignoreFade;
-	fading = 0;
-	fadeGain = 1;
+	sampleMixer.fadeCancel(index);
 	
 	lastPad = pad;
 	setVolume(volume);
@@ -235,57 +236,32 @@ void Sample::stop(uint8_t pad){
 	}
 }
 
-void Sample::startFade(uint8_t pad, double gain){
+void Sample::startFade(uint8_t pad, uint32_t rate){
 	for (uint8_t i = 0; i < SAMPLE_COUNT; i++){
 		if (samples[i].lastPad == pad && samples[i].isPlaying()){
-			samples[i].startFade(gain);
+			samples[i].startFade(rate);
 		}
 	}
 }
 
-void Sample::startFade(double gain){
+void Sample::startFade(uint32_t rate){
 	if (ignoreFade) return;
 	
-	if (gain < 1){
-		fading = 1;
-		if (gain < 1 && gain < fadeGain) fadeGain = gain;	//If we are already fading, keep the highest value
-// 		Serial.print("Fading out sample at rate ");
-// 		Serial.println(fadeGain);
-	}
-	else {
-// 		Serial.println("No fade selected");
-		fading = 0;
-		fadeGain = 1;
-	}
+	sampleMixer.fade(index, fadeCurve, rate);
 }
 
 void Sample::stopFade(uint8_t pad){
 	for (uint8_t i = 0; i < SAMPLE_COUNT; i++){
 		if (samples[i].lastPad == pad && samples[i].isPlaying()){
-			samples[i].fading = 0;
-			samples[i].fadeGain = 1;
-		}
-	}
-}
-
-void Sample::processFade(uint8_t pad){
-	for (uint8_t i = 0; i < SAMPLE_COUNT; i++){
-		Sample* s = &samples[i];
-		if (s->lastPad == pad && s->isPlaying() && s->fading){
-			s->volume = s->volume * s->fadeGain;
-			sampleMixer.gain(s->index, s->volume);
-			if (s->volume <= 0.001){
-				s->playSerialRaw.stop();
-				s->lastPad = 0xFF;		//Once we have finished fading, we consider it valid to re-use this sample object
-			}
+			sampleMixer.fadeCancel(samples[i].index);
 		}
 	}
 }
 
 void Sample::stop(){
 	playSerialRaw.stop();
+	sampleMixer.fadeCancel(index);
 	lastPad = 0xFF;
-	fading = 0;
 }
 
 double Sample::getVolume(){
@@ -18,7 +18,7 @@ namespace digitalcave {
 	 * between everything.
 	 * 2) Static methods for finding an available Sample object and mapping between a Sample / volume
 	 * tuple and a filename
-	 * 3) Private instance variables for SPI audio sample and the connection between it and the mixer
+	 * 3) Private instance variables for SPI audio sample, which the sample mixer decodes and mixes
  	 * 4) Methods to play a sample, set gain (volume) on a given Sample, query state, stop playback, etc.
  	 *
  	 * Note that the Sample objects can only be accessed from the singleton array samples[], via
@@ -38,15 +38,14 @@ namespace digitalcave {
 			//Find the best available Sample object from the singleton array
 			static Sample* findAvailableSample(uint8_t pad, double volume);
 			
-			//Starts fading out all currently playing samples for the selected pad.
-			static void startFade(uint8_t pad, double gain);
+			//Starts fading out all currently playing samples for the selected pad, at the given rate (see
+			// Mapping::getFadeRate()).  The sample mixer does the fading in the audio update, and stops
+			// each sample once it is silent.
+			static void startFade(uint8_t pad, uint32_t rate);
 			
-			//Stops a previously started fade
+			//Stops a previously started fade, leaving the samples at the volume they had faded to
 			static void stopFade(uint8_t pad);
 			
-			//Call this repeatedly to handle the actual fading (since using an envelope object uses way too much CPU)
-			static void processFade(uint8_t pad);
-			
 			//Start playback using this sample's SPI playback object for the given filename
 			void play(char* filename, uint8_t pad, double volume, uint8_t ignoreFade);
 			
@@ -57,7 +56,7 @@ namespace digitalcave {
 			uint32_t getPositionMillis();
 			
 			//Fade a specific sample
-			void startFade(double gain);
+			void startFade(uint32_t rate);
 			
 			//Stops playback
 			void stop();
@@ -82,7 +81,7 @@ namespace digitalcave {
 			static AudioInputI2S input;
 
 			//Mixers
-			static AudioMixer16 sampleMixer;	//Up to 16 channels used
+			static AudioMixerSerialflash sampleMixer;	//Up to 16 channels used; decodes and mixes the samples in one pass
 			static AudioMixer4 outputMixer;		//Channel 0 and 1 are from line in; channel 2 is from sampleMixer.
 
 			//Output
@@ -103,6 +102,9 @@ namespace digitalcave {
 			static uint8_t currentIndex;
 			static Sample samples[];
 			
+			//The shape of all fades; an exponential fall of 60dB, to silence
+			static uint16_t fadeCurve[VOICE_FADE_POINTS + 1];
+			
 			//Volumes for line in and headphones
 			static uint8_t volumeHeadphones;
 			static uint8_t volumeLineIn;
@@ -114,19 +116,12 @@ namespace digitalcave {
 			//This sample's index into mixer
 			uint8_t index;
 			
-			//SPI flash playback object
+			//SPI flash playback object; mixed by sampleMixer rather than through an AudioConnection
 			AudioPlaySerialflashRaw playSerialRaw;
-
-			//Connection from playSerialRaw to mixer
-			AudioConnection playSerialRawToMixer;
 			
 			//The most recently played pad index.
 			uint8_t lastPad;
 			
-			//Allow for fade out when muting cymbals
-			double fadeGain;
-			uint8_t fading;
-			
 			//The last filename which was played
 			char filename[FILENAME_STRING_SIZE];
 
@@ -0,0 +1,268 @@
+#include "Trigger.h"
+
+using namespace digitalcave;
+
+uint8_t Trigger::coupling[PAD_COUNT][PAD_COUNT];
+Trigger* Trigger::triggers[PAD_COUNT];
+uint8_t Trigger::learning = 0;
+uint32_t Trigger::suppressed = 0;
+
+Trigger::Trigger(uint8_t index, uint8_t doubleHitThreshold) :
+		index(index),
+		doubleHitThreshold(doubleHitThreshold),
+		curve(VELOCITY_CURVE_LINEAR),
+		strikeTime(0),
+		peakValue(0),
+		playTime(0),
+		hitTime(0),
+		lastPeak(0),
+		lastRaw(0),
+		velocity(0),
+		suppressTime(0),
+		suppressPeak(0) {
+	if (index < PAD_COUNT) triggers[index] = this;
+
+	//The default custom curve is the linear one
+	for (uint8_t i = 0; i < VELOCITY_CUSTOM_POINTS; i++){
+		customPoints[i] = 255 * (i + 1) / VELOCITY_CUSTOM_POINTS;
+	}
+	buildCurve();
+}
+
+uint8_t Trigger::read(uint16_t value, uint32_t time){
+	//If we are within double trigger threshold, AND the value is greater than the last played value,
+	// then we adjust the volume of the last played sample.  We don't drain the channel this time through;
+	// if the volume is stable then it will be drained next time around, and if it is still increasing we
+	// want to go through here again.
+	if (playTime + doubleHitThreshold > time && value > lastRaw){
+		lastRaw = value;
+		velocity = velocities[value >> 2];
+		return TRIGGER_ADJUST;
+	}
+
+	//If we are still within the double hit threshold, OR if we are within 4x the double hit threshold
+	// time-span AND the value is less than one quarter of the previous peak, then we assume this is just
+	// a ghost double trigger.  Drain each time we go through here.
+	if (playTime + doubleHitThreshold > time
+			|| (playTime + (doubleHitThreshold * 4) > time && (value - MIN_VALUE) < (lastPeak - MIN_VALUE) / 4)){
+		peakValue = 0;
+		return TRIGGER_DRAIN;
+	}
+
+	if (value < MIN_VALUE && peakValue < MIN_VALUE){
+		//No hit in progress
+	}
+	else if (value >= MIN_VALUE && peakValue == 0){
+		//A new hit has started; record the time
+		strikeTime = time;
+		peakValue = value;
+	}
+	else if (value > peakValue){
+		//Volume is still increasing; record this as the new peak value
+		peakValue = value;
+	}
+
+	if (peakValue && (time - strikeTime) > MAX_RESPONSE_TIME){
+		//We have timed out; decide whether this is a hit on its own or crosstalk from another pad
+		uint16_t peak = peakValue;
+		peakValue = 0;
+
+		if (learning){
+			learn(peak, strikeTime);
+		}
+		else if (isCrosstalk(peak, strikeTime)){
+			suppressTime = time;
+			if (peak > suppressPeak) suppressPeak = peak;
+			suppressed++;
+			return TRIGGER_DRAIN;
+		}
+
+		playTime = time;
+		hitTime = strikeTime;
+		lastRaw = peak;
+		lastPeak = peak;
+		velocity = velocities[peak >> 2];
+		return TRIGGER_HIT;
+	}
+
+	return TRIGGER_NONE;
+}
+
+uint8_t Trigger::isCrosstalk(uint16_t peak, uint32_t time){
+	//The rack keeps ringing for a while after a suppressed hit; anything no louder than it was is more of the same
+	if (suppressTime + doubleHitThreshold > time && peak <= suppressPeak){
+		return 1;
+	}
+	if (suppressTime + doubleHitThreshold <= time) suppressPeak = 0;
+
+	//Crosstalk from hits on several pads at once adds up; this is the largest we would expect from them all
+	uint32_t expected = 0;
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		Trigger* other = triggers[i];
+		if (other == NULL || other == this || coupling[i][index] == 0) continue;
+
+		//The other pad's hit can either still be in progress, or have been played already
+		uint16_t otherPeak;
+		uint32_t otherTime;
+		if (other->peakValue){
+			otherPeak = other->peakValue;
+			otherTime = other->strikeTime;
+		}
+		else if (other->lastPeak){
+			otherPeak = other->lastPeak;
+			otherTime = other->hitTime;
+		}
+		else {
+			continue;
+		}
+		if (otherTime > time + CROSSTALK_WINDOW || time > otherTime + doubleHitThreshold) continue;
+
+		//The rack keeps ringing after a hit, and draining this pad can't stop it re-triggering; allow for crosstalk
+		// from hits which started a while before this one, dying away with time.
+		uint32_t elapsed = time > otherTime ? time - otherTime : 0;
+		if (elapsed > CROSSTALK_WINDOW){
+			expected += (uint32_t) otherPeak * coupling[i][index] * CROSSTALK_WINDOW / elapsed;
+		}
+		else {
+			expected += (uint32_t) otherPeak * coupling[i][index];
+		}
+	}
+
+	return peak <= expected * CROSSTALK_MARGIN / (256 * 16);
+}
+
+void Trigger::learn(uint16_t peak, uint32_t time){
+	if (peak <= MIN_VALUE) return;
+	
+	//Find the loudest hit on another pad which started at about the same time, either still in progress or
+	// already played.  If it is louder than this one, this is crosstalk from it.
+	uint8_t loudest = 0xFF;
+	uint16_t loudestPeak = peak;
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		Trigger* other = triggers[i];
+		if (other == NULL || other == this) continue;
+		
+		uint16_t otherPeak = other->peakValue ? other->peakValue : other->lastPeak;
+		uint32_t otherTime = other->peakValue ? other->strikeTime : other->hitTime;
+		if (otherPeak > loudestPeak && (time > otherTime ? time - otherTime : otherTime - time) <= CROSSTALK_WINDOW){
+			loudest = i;
+			loudestPeak = otherPeak;
+		}
+	}
+	
+	if (loudest != 0xFF){
+		uint16_t ratio = (uint32_t) peak * 256 / loudestPeak;
+		if (ratio > coupling[loudest][index]) coupling[loudest][index] = ratio > 255 ? 255 : ratio;
+		return;
+	}
+	
+	//This is the loudest; any quieter hits already played were crosstalk from it.  (Quieter ones still in 
+	// progress will learn from this one when they finish.)
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		Trigger* other = triggers[i];
+		if (other == NULL || other == this || other->peakValue || other->lastPeak <= MIN_VALUE) continue;
+		if ((time > other->hitTime ? time - other->hitTime : other->hitTime - time) > CROSSTALK_WINDOW) continue;
+		
+		uint16_t ratio = (uint32_t) other->lastPeak * 256 / peak;
+		if (ratio > coupling[index][i]) coupling[index][i] = ratio > 255 ? 255 : ratio;
+	}
+}
+
+double Trigger::getVelocity(){
+	return velocity / 128.0;
+}
+
+double Trigger::lookupVelocity(uint16_t value){
+	if (value > 1023) value = 1023;
+	return velocities[value >> 2] / 128.0;
+}
+
+uint8_t Trigger::getCurve(){
+	return curve;
+}
+
+void Trigger::setCurve(uint8_t curve){
+	if (curve >= VELOCITY_CURVE_COUNT) curve = VELOCITY_CURVE_LINEAR;
+	this->curve = curve;
+	buildCurve();
+}
+
+uint8_t* Trigger::getCustomPoints(){
+	return customPoints;
+}
+
+void Trigger::setCustomPoints(uint8_t* points){
+	for (uint8_t i = 0; i < VELOCITY_CUSTOM_POINTS; i++){
+		customPoints[i] = points[i];
+	}
+	if (curve == VELOCITY_CURVE_CUSTOM) buildCurve();
+}
+
+void Trigger::buildCurve(){
+	for (uint16_t i = 0; i < 256; i++){
+		//Position along the curve, from 0 at MIN_VALUE to 1 at VELOCITY_FULL_SCALE
+		double x = ((i << 2) - MIN_VALUE) / (double) (VELOCITY_FULL_SCALE - MIN_VALUE);
+		if (x < 0) x = 0;
+		else if (x > 1) x = 1;
+
+		double y;
+		if (curve == VELOCITY_CURVE_LOG){
+			y = log(1 + 15 * x) / log(16);
+		}
+		else if (curve == VELOCITY_CURVE_EXP){
+			y = (exp(3 * x) - 1) / (exp(3) - 1);
+		}
+		else if (curve == VELOCITY_CURVE_CUSTOM){
+			//Linear interpolation between (0, 0) and the custom points
+			double position = x * VELOCITY_CUSTOM_POINTS;
+			uint8_t segment = position;
+			if (segment >= VELOCITY_CUSTOM_POINTS) segment = VELOCITY_CUSTOM_POINTS - 1;
+			double from = segment == 0 ? 0 : customPoints[segment - 1];
+			double to = customPoints[segment];
+			y = (from + (to - from) * (position - segment)) / 255.0;
+		}
+		else {
+			y = x;
+		}
+
+		velocities[i] = (uint8_t) (y * 255 + 0.5);
+	}
+}
+
+uint8_t Trigger::isLearning(){
+	return learning;
+}
+
+void Trigger::startLearning(){
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		for (uint8_t j = 0; j < PAD_COUNT; j++){
+			coupling[i][j] = 0;
+		}
+	}
+	learning = 1;
+}
+
+void Trigger::stopLearning(){
+	learning = 0;
+}
+
+void Trigger::reset(){
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		Trigger* t = triggers[i];
+		if (t == NULL) continue;
+		t->strikeTime = 0;
+		t->peakValue = 0;
+		t->playTime = 0;
+		t->hitTime = 0;
+		t->lastPeak = 0;
+		t->lastRaw = 0;
+		t->velocity = 0;
+		t->suppressTime = 0;
+		t->suppressPeak = 0;
+	}
+	suppressed = 0;
+}
+
+uint32_t Trigger::getSuppressed(){
+	return suppressed;
+}
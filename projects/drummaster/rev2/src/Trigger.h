@@ -0,0 +1,134 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+#include <math.h>
+
+#include "hardware.h"
+
+//Minimum ADC value to register as a hit
+#define MIN_VALUE					16
+
+//The maximum time (in ms) between a new hit being detected and when we return
+// the value.
+#define MAX_RESPONSE_TIME			1
+
+//The ADC value at which the velocity reaches full scale (2.0).  This is where the original linear
+// scale of (value - MIN_VALUE) / 256 tops out; all the curves share these end points.
+#define VELOCITY_FULL_SCALE			(MIN_VALUE + 512)
+
+//Velocity curves.  LOG is more sensitive to soft hits, EXP less so; CUSTOM is interpolated between
+// VELOCITY_CUSTOM_POINTS points spaced evenly along the ADC range.
+#define VELOCITY_CURVE_LINEAR		0
+#define VELOCITY_CURVE_LOG			1
+#define VELOCITY_CURVE_EXP			2
+#define VELOCITY_CURVE_CUSTOM		3
+#define VELOCITY_CURVE_COUNT		4
+
+#define VELOCITY_CUSTOM_POINTS		8
+
+//Hits on other pads starting within this many ms of each other are compared for crosstalk at full strength
+#define CROSSTALK_WINDOW			3
+//Coupling factors are learned as the largest ratio seen; this margin (in 1/16) is added on top
+// when suppressing, so that crosstalk a little louder than anything seen in calibration is still caught.
+#define CROSSTALK_MARGIN			24
+
+//Results from Trigger::read()
+#define TRIGGER_NONE				0
+#define TRIGGER_HIT					1		//A new hit; getVelocity() is the velocity
+#define TRIGGER_ADJUST				2		//The last hit is still rising; getVelocity() is the new velocity
+#define TRIGGER_DRAIN				3		//Ignoring a double / ghost trigger; drain the channel
+
+namespace digitalcave {
+
+	/*
+	 * The hardware independent part of reading a piezo: peak detection, double hit / ghost rejection,
+	 * crosstalk cancellation and the velocity curve.  Pad reads the ADC and passes each value to
+	 * read(); the host test harness (test/trigger) passes in recorded values instead.
+	 *
+	 * Crosstalk is when hitting one pad (A) shakes the rack enough for another (B) to register a
+	 * hit.  The peak seen on B is roughly proportional to the peak on A, so for each pair we keep a
+	 * coupling factor (the largest B / A ratio seen while learning, in 1/256).  A hit on B is dropped
+	 * if it is no louder than the crosstalk expected from the other pads: the sum of their peaks
+	 * scaled by the coupling factors (plus CROSSTALK_MARGIN), for hits which started within
+	 * CROSSTALK_WINDOW ms, and dying away for ones which started up to the double hit threshold
+	 * before.  The coupling factors are learned by calling startLearning(), hitting each pad on its
+	 * own a few times, and then stopLearning().
+	 */
+	class Trigger {
+		public:
+			//Crosstalk coupling factors, in 1/256.  coupling[a][b] is how much of a hit on a shows up on b.
+			static uint8_t coupling[PAD_COUNT][PAD_COUNT];
+
+			Trigger(uint8_t index, uint8_t doubleHitThreshold);
+
+			//Pass in each ADC reading (10 bit) along with the time in ms.  Returns one of TRIGGER_*.
+			uint8_t read(uint16_t value, uint32_t time);
+
+			//Returns the velocity (0 - 2.0) of the last TRIGGER_HIT or TRIGGER_ADJUST
+			double getVelocity();
+
+			//Returns the velocity (0 - 2.0) which the current curve gives for an ADC reading
+			double lookupVelocity(uint16_t value);
+
+			//Get / set the velocity curve (VELOCITY_CURVE_*).  Setting it rebuilds the lookup table.
+			uint8_t getCurve();
+			void setCurve(uint8_t curve);
+
+			//Get / set the points for VELOCITY_CURVE_CUSTOM, as velocities in 1/128 (so 255 is about 2.0).
+			// The curve starts from 0 at MIN_VALUE.  Setting these rebuilds the lookup table if the custom
+			// curve is selected.
+			uint8_t* getCustomPoints();
+			void setCustomPoints(uint8_t* points);
+
+			//Start / stop learning the coupling factors.  Starting clears them.  While learning, crosstalk
+			// is not suppressed.
+			static void startLearning();
+			static void stopLearning();
+			static uint8_t isLearning();
+
+			//Clears the peak detection and crosstalk state (e.g. when replaying a new recording).
+			static void reset();
+
+			//Count of hits suppressed as crosstalk since the last reset().
+			static uint32_t getSuppressed();
+
+		private:
+			static Trigger* triggers[PAD_COUNT];
+			static uint8_t learning;
+			static uint32_t suppressed;
+
+			uint8_t index;
+			uint8_t doubleHitThreshold;
+
+			//Velocity lookup table, indexed by the ADC value >> 2, in 1/128
+			uint8_t curve;
+			uint8_t customPoints[VELOCITY_CUSTOM_POINTS];
+			uint8_t velocities[256];
+
+			//The time at which this hit was first read, and the peak so far (0 when there is no hit in progress)
+			uint32_t strikeTime;
+			uint16_t peakValue;
+			//The time at which the last hit was returned, when it started, and its peak
+			uint32_t playTime;
+			uint32_t hitTime;
+			uint16_t lastPeak;
+			//The last raw value used to adjust the velocity of the last hit
+			uint16_t lastRaw;
+			//The result for getVelocity()
+			uint8_t velocity;
+			//The time and peak of the last hit suppressed as crosstalk
+			uint32_t suppressTime;
+			uint16_t suppressPeak;
+
+			//Returns 1 if this peak on this pad is explained by a hit on another pad
+			uint8_t isCrosstalk(uint16_t peak, uint32_t time);
+			//Updates the coupling factors from a hit on this pad
+			void learn(uint16_t peak, uint32_t time);
+			//Fills in velocities[] for the current curve
+			void buildCurve();
+	};
+
+}
+
+#endif
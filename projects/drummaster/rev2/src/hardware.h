@@ -72,4 +72,12 @@
 // EEPROM_PAD_VOLUME + (PAD_COUNT * kit_index).
 #define EEPROM_PAD_VOLUME				0x30
 
+//Per-pad velocity curves (VELOCITY_CURVE_*) are stored as 11x1 bytes, starting at 0x110 (after the pad volumes 
+// for KIT_COUNT kits).  The custom curve points follow, as 11x8 bytes from 0x120 to 0x178.
+#define EEPROM_VELOCITY_CURVE			0x110
+#define EEPROM_VELOCITY_CUSTOM			0x120
+
+//Crosstalk coupling factors are stored as 11x11 bytes, from 0x180 to 0x1F9.
+#define EEPROM_CROSSTALK				0x180
+
 #endif
@@ -0,0 +1,84 @@
+#include "LearnCrosstalk.h"
+
+using namespace digitalcave;
+
+static const char* labels[] = {
+	"Cancel             ",
+	"Start              "
+};
+
+LearnCrosstalk::LearnCrosstalk() : Menu(2){
+}
+
+void LearnCrosstalk::loadCouplingFromEeprom(){
+	EEPROM.get(EEPROM_CROSSTALK, Trigger::coupling);
+	
+	//A blank EEPROM would suppress almost everything; treat it as no crosstalk
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		for (uint8_t j = 0; j < PAD_COUNT; j++){
+			if (Trigger::coupling[i][j] == 0xFF) Trigger::coupling[i][j] = 0;
+		}
+	}
+}
+
+void LearnCrosstalk::saveCouplingToEeprom(){
+	EEPROM.put(EEPROM_CROSSTALK, Trigger::coupling);
+}
+
+/* 
+ * Display layout while learning:
+ *  01234567890123456789
+ * 0Learn Crosstalk     
+ * 1Hit each pad alone  
+ * 2Pairs: xx Max: xxx% 
+ * 3Push=Save Hold=Undo 
+ */
+
+Menu* LearnCrosstalk::handleAction(){
+	display->write_text(0, 0, "Learn Crosstalk     ", 20);
+	
+	if (!Trigger::isLearning()){
+		int8_t positionOffset = getPositionOffset();
+		writeSelection(positionOffset);
+
+		display->write_text(1, 1, labels[getMenuPosition(positionOffset - 1)], 19);
+		display->write_text(2, 1, labels[getMenuPosition(positionOffset + 1)], 19);
+
+		if (button.longPressEvent() || (button.releaseEvent() && getMenuPosition(0) == 0)){
+			return Menu::settings;
+		}
+		else if (button.releaseEvent() && getMenuPosition(0) == 1){
+			Trigger::startLearning();
+			display->clear();
+		}
+		
+		return NULL;
+	}
+	
+	//Show how many pad pairs have crosstalk so far, and the worst one
+	uint8_t pairs = 0;
+	uint8_t max = 0;
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		for (uint8_t j = 0; j < PAD_COUNT; j++){
+			if (Trigger::coupling[i][j]) pairs++;
+			if (Trigger::coupling[i][j] > max) max = Trigger::coupling[i][j];
+		}
+	}
+	display->write_text(1, 0, "Hit each pad alone  ", 20);
+	snprintf(buf, sizeof(buf), "Pairs: %2d Max: %3d%% ", pairs, max * 100 / 256);
+	display->write_text(2, 0, buf, 20);
+	display->write_text(3, 0, "Push=Save Hold=Undo ", 20);
+	
+	if (button.releaseEvent()){
+		Trigger::stopLearning();
+		saveCouplingToEeprom();
+		return Menu::settings;
+	}
+	else if (button.longPressEvent()){
+		Trigger::stopLearning();
+		loadCouplingFromEeprom();
+		return Menu::settings;
+	}
+	
+	return NULL;
+}
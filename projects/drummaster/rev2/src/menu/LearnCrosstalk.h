@@ -0,0 +1,25 @@
+#ifndef LEARN_CROSSTALK_H
+#define LEARN_CROSSTALK_H
+
+#include <EEPROM/EEPROM.h>
+
+#include "../DrumMaster.h"
+#include "../hardware.h"
+#include "Menu.h"
+
+namespace digitalcave {
+
+	class LearnCrosstalk : public Menu {
+	
+		private:
+			
+		public:
+			static void loadCouplingFromEeprom();
+			static void saveCouplingToEeprom();
+			
+			LearnCrosstalk();
+			Menu* handleAction();
+	};
+}
+
+#endif
@@ -5,10 +5,13 @@
 #include "LoadSamplesFromSD.h"
 #include "LoadSamplesFromSerial.h"
 #include "KitSelect.h"
+#include "LearnCrosstalk.h"
 #include "MainMenu.h"
 #include "ResetEeprom.h"
 #include "Settings.h"
 #include "Stats.h"
+#include "VelocityCurve.h"
+#include "VelocityCurveSelect.h"
 #include "VolumeLineIn.h"
 #include "VolumeHeadphones.h"
 #include "VolumePad.h"
@@ -30,10 +33,13 @@ Menu* Menu::calibrateChannelSelect = new CalibrateChannelSelect();
 Menu* Menu::loadSamplesFromSD = new LoadSamplesFromSD();
 Menu* Menu::loadSamplesFromSerial = new LoadSamplesFromSerial();
 Menu* Menu::kitSelect = new KitSelect();
+Menu* Menu::learnCrosstalk = new LearnCrosstalk();
 Menu* Menu::mainMenu = new MainMenu();
 Menu* Menu::resetEeprom = new ResetEeprom();
 Menu* Menu::settings = new Settings();
 Menu* Menu::stats = new Stats();
+Menu* Menu::velocityCurve = new VelocityCurve();
+Menu* Menu::velocityCurveSelect = new VelocityCurveSelect();
 Menu* Menu::volumeLineIn = new VolumeLineIn();
 Menu* Menu::volumeHeadphones = new VolumeHeadphones();
 Menu* Menu::volumePad = new VolumePad();
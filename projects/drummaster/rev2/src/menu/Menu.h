@@ -50,11 +50,14 @@ namespace digitalcave {
 			static Menu* calibrateChannel;
 			static Menu* calibrateChannelSelect;
 			static Menu* kitSelect;
+			static Menu* learnCrosstalk;
 			static Menu* loadSamplesFromSD;
 			static Menu* loadSamplesFromSerial;
 			static Menu* mainMenu;
 			static Menu* resetEeprom;
 			static Menu* settings;
+			static Menu* velocityCurve;
+			static Menu* velocityCurveSelect;
 			static Menu* volumeHeadphones;
 			static Menu* volumeLineIn;
 			static Menu* volumePad;
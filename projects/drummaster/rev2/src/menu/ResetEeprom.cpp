@@ -48,11 +48,26 @@ Menu* ResetEeprom::handleAction(){
 			}
 		}
 		
+		//Velocity curves are linear, and the custom curve points are linear too
+		for (uint8_t i = 0; i < PAD_COUNT; i++){
+			EEPROM.update(EEPROM_VELOCITY_CURVE + i, VELOCITY_CURVE_LINEAR);
+			for (uint8_t j = 0; j < VELOCITY_CUSTOM_POINTS; j++){
+				EEPROM.update(EEPROM_VELOCITY_CUSTOM + (VELOCITY_CUSTOM_POINTS * i) + j, 255 * (j + 1) / VELOCITY_CUSTOM_POINTS);
+			}
+		}
+		
+		//No crosstalk has been learned
+		for (uint8_t i = 0; i < PAD_COUNT * PAD_COUNT; i++){
+			EEPROM.update(EEPROM_CROSSTALK + i, 0);
+		}
+		
 		//Load settings from EEPROM
 		CalibrateChannel::loadPotentiometerFromEeprom();
 		KitSelect::loadKitIndexFromEeprom();
 		VolumeLineIn::loadVolumeFromEeprom();
 		VolumeHeadphones::loadVolumeFromEeprom();
+		VelocityCurve::loadCurvesFromEeprom();
+		LearnCrosstalk::loadCouplingFromEeprom();
 		
 		return Menu::settings;
 	}
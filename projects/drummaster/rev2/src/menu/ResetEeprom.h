@@ -7,6 +7,8 @@
 #include "../Pad.h"
 #include "Menu.h"
 #include "KitSelect.h"
+#include "LearnCrosstalk.h"
+#include "VelocityCurve.h"
 
 namespace digitalcave {
 
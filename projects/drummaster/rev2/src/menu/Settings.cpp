@@ -5,6 +5,8 @@ using namespace digitalcave;
 static const char* labels[] = {
 	"Pads Volume         ",
 	"Calibrate Channels  ",
+	"Velocity Curves     ",
+	"Learn Crosstalk     ",
 	"Load From SD        ",
 	"Load From Serial    ",
 	"Reset EEPROM        ",
@@ -31,12 +33,16 @@ Menu* Settings::handleAction(){
 			case 1:
 				return Menu::calibrateChannelSelect;
 			case 2:
-				return Menu::loadSamplesFromSD;
+				return Menu::velocityCurveSelect;
 			case 3:
-				return Menu::loadSamplesFromSerial;
+				return Menu::learnCrosstalk;
 			case 4:
-				return Menu::resetEeprom;
+				return Menu::loadSamplesFromSD;
 			case 5:
+				return Menu::loadSamplesFromSerial;
+			case 6:
+				return Menu::resetEeprom;
+			case 7:
 				return Menu::stats;
 		}
 	}
@@ -7,24 +7,69 @@ using namespace digitalcave;
 #define STRINGIFY(x) XSTRINGIFY(x)
 #define XSTRINGIFY(x) #x
 
-Stats::Stats() : Menu(1), lastUpdate(0), forceUpdate(1) {
+Stats::Stats() : Menu(3), lastUpdate(0), forceUpdate(1), page(0) {
 }
 
 Menu* Stats::handleAction(){
-	display->write_text(0, 0, "System Status        ", 20);
-	
-	if (millis() - lastUpdate > 5000 || forceUpdate){
+	//Turn the encoder to change between the system, audio profile and choke timing pages
+	if (getMenuPosition(0) != page){
+		page = getMenuPosition(0);
+		display->clear();
+		forceUpdate = 1;
+	}
+
+	if (page == 2 && (millis() - lastUpdate > 1000 || forceUpdate)){
+		//How much longer than their fade time chokes and mutes took to reach silence
+		display->write_text(0, 0, "Choke Timing        ", 20);
+		snprintf(buf, sizeof(buf), "Count: %5u          ", AudioMixerSerialflash::chokeCount());
+		display->write_text(1, 0, buf, 20);
+		snprintf(buf, sizeof(buf), "Late: %5.1fms        ", AudioMixerSerialflash::chokeLatencyMean() / 1000);
+		display->write_text(2, 0, buf, 20);
+		snprintf(buf, sizeof(buf), "Jit %4.1f Max %5.1f     ", AudioMixerSerialflash::chokeLatencyJitter() / 1000, AudioMixerSerialflash::chokeLatencyMax() / 1000.0);
+		display->write_text(3, 0, buf, 20);
+		lastUpdate = millis();
+		forceUpdate = 0;
+	}
+	else if (page == 1 && (millis() - lastUpdate > 1000 || forceUpdate)){
+		//Audio profile; the full profile goes out on the serial port, for python/drummaster-profile
+		display->write_text(0, 0, "Audio Profile       ", 20);
+		snprintf(buf, sizeof(buf), "Late: %4lu Fail: %4u      ", AudioProfiler::late(), AudioProfiler::allocationFailures());
+		display->write_text(1, 0, buf, 20);
+		AudioStream* slowest = AudioProfiler::slowest();
+		if (slowest){
+			snprintf(buf, sizeof(buf), "Slowest: %3d%%          ", (uint8_t) slowest->processorUsageMax());
+			display->write_text(2, 0, buf, 20);
+		}
+		snprintf(buf, sizeof(buf), "Blocks: %3d / %3d      ", AudioMemoryUsageMax(), AUDIO_MEMORY);
+		display->write_text(3, 0, buf, 20);
+		AudioProfiler::print(Serial);
+		lastUpdate = millis();
+		forceUpdate = 0;
+	}
+	else if (page == 0 && (millis() - lastUpdate > 5000 || forceUpdate)){
+		snprintf(buf, sizeof(buf), "Version: %s                ", STRINGIFY(GIT_VERSION));
+		display->write_text(0, 0, buf, 20);
 		snprintf(buf, sizeof(buf), "CPU: %3d%% Mem: %3d%%      ", (uint8_t) AudioProcessorUsage(), (uint8_t) ((double) AudioMemoryUsage() / AUDIO_MEMORY * 100));
 		display->write_text(1, 0, buf, 20);
 		snprintf(buf, sizeof(buf), "Max: %3d%% Max: %3d%%      ", (uint8_t) AudioProcessorUsageMax(), (uint8_t) ((double) AudioMemoryUsageMax() / AUDIO_MEMORY * 100));
 		display->write_text(2, 0, buf, 20);
-		snprintf(buf, sizeof(buf), "Version: %s                ", STRINGIFY(GIT_VERSION));
+		//SPI time reading samples from flash, and the voices it could keep up with
+		snprintf(buf, sizeof(buf), "SPI: %3d%% Poly: %3d      ", (uint8_t) AudioPlaySerialflashRaw::flashUsageMax(), AudioPlaySerialflashRaw::maxPolyphony());
 		display->write_text(3, 0, buf, 20);
 		lastUpdate = millis();
 		forceUpdate = 0;
 	}
 	
-	if (button.releaseEvent() || button.longPressEvent()){
+	if (button.longPressEvent() && page == 1){
+		//Start profiling afresh
+		AudioProfiler::reset();
+		forceUpdate = 1;
+	}
+	else if (button.longPressEvent() && page == 2){
+		AudioMixerSerialflash::chokeLatencyReset();
+		forceUpdate = 1;
+	}
+	else if (button.releaseEvent() || button.longPressEvent()){
 		display->clear();
 		forceUpdate = 1;
 		return Menu::settings;
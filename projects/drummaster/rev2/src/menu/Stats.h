@@ -10,6 +10,7 @@ namespace digitalcave {
 		private:
 			uint32_t lastUpdate;
 			uint8_t forceUpdate;
+			int16_t page;
 			
 		public:
 			Stats();
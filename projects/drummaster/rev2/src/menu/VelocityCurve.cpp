@@ -0,0 +1,141 @@
+#include "VelocityCurve.h"
+
+using namespace digitalcave;
+
+static const char* labels[PAD_COUNT] = {
+	"Hi Hat             ",
+	"Snare              ",
+	"Bass               ",
+	"Tom 1              ",
+	"Crash              ",
+	"Tom 2              ",
+	"Tom 3              ",
+	"Splash             ",
+	"Ride               ",
+	"X0                 ",
+	"X1                 "
+};
+
+static const char* curves[VELOCITY_CURVE_COUNT] = {
+	"Linear             ",
+	"Logarithmic        ",
+	"Exponential        ",
+	"Custom             "
+};
+
+VelocityCurve::VelocityCurve() : Menu(VELOCITY_CURVE_COUNT), value(-1), pad(0), point(-1) {
+}
+
+void VelocityCurve::loadCurvesFromEeprom(){
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		uint8_t points[VELOCITY_CUSTOM_POINTS];
+		EEPROM.get(EEPROM_VELOCITY_CUSTOM + (VELOCITY_CUSTOM_POINTS * i), points);
+		if (points[VELOCITY_CUSTOM_POINTS - 1] != 0xFF || points[0] != 0xFF){
+			Pad::pads[i]->getTrigger()->setCustomPoints(points);
+		}
+		
+		uint8_t curve = EEPROM.read(EEPROM_VELOCITY_CURVE + i);
+		if (curve >= VELOCITY_CURVE_COUNT) curve = VELOCITY_CURVE_LINEAR;
+		Pad::pads[i]->getTrigger()->setCurve(curve);
+	}
+}
+
+void VelocityCurve::saveCurvesToEeprom(){
+	for (uint8_t i = 0; i < PAD_COUNT; i++){
+		Trigger* trigger = Pad::pads[i]->getTrigger();
+		EEPROM.update(EEPROM_VELOCITY_CURVE + i, trigger->getCurve());
+		for (uint8_t j = 0; j < VELOCITY_CUSTOM_POINTS; j++){
+			EEPROM.update(EEPROM_VELOCITY_CUSTOM + (VELOCITY_CUSTOM_POINTS * i) + j, trigger->getCustomPoints()[j]);
+		}
+	}
+}
+
+/* 
+ * Display layout:
+ *  01234567890123456789
+ * 0Velocity Curve      
+ * 1 Pad Name           
+ * 2>Curve name / Point n: xxx%
+ * 3Quarter hit: xxx%   
+ */
+
+Menu* VelocityCurve::handleAction(){
+	Trigger* trigger = Pad::pads[pad]->getTrigger();
+	
+	display->write_text(0, 0, "Velocity Curve      ", 20);
+	display->write_text(1, 1, labels[pad], 19);
+	display->write_text(2, 0, ARROW_NORMAL);
+	
+	//How the curve treats a hit a quarter of the way to full scale; 50% is linear
+	snprintf(buf, sizeof(buf), "Quarter hit: %3d%%   ", (uint16_t) (trigger->lookupVelocity(MIN_VALUE + (VELOCITY_FULL_SCALE - MIN_VALUE) / 4) * 100));
+	display->write_text(3, 0, buf, 20);
+	
+	if (point == -1){
+		//Choosing the curve
+		setMenuCount(VELOCITY_CURVE_COUNT);
+		if (value == -1){
+			value = trigger->getCurve();
+			setMenuPosition(value);
+		}
+		
+		display->write_text(2, 1, curves[value], 19);
+		
+		encoderState = getMenuPosition(0);
+		if (getMenuPosition(0) != value){
+			value = getMenuPosition(0);
+			trigger->setCurve(value);
+		}
+		
+		if (button.releaseEvent()){
+			if (value == VELOCITY_CURVE_CUSTOM){
+				//Edit the custom points, one at a time
+				point = 0;
+				setMenuCount(256);
+				setMenuPosition(trigger->getCustomPoints()[point]);
+				return NULL;
+			}
+			saveCurvesToEeprom();
+			return Menu::velocityCurveSelect;
+		}
+		else if (button.longPressEvent()){
+			loadCurvesFromEeprom();
+			return Menu::velocityCurveSelect;
+		}
+	}
+	else {
+		//Editing the custom curve points; each is a velocity in 1/128
+		uint8_t points[VELOCITY_CUSTOM_POINTS];
+		for (uint8_t i = 0; i < VELOCITY_CUSTOM_POINTS; i++){
+			points[i] = trigger->getCustomPoints()[i];
+		}
+		
+		snprintf(buf, sizeof(buf), "Point %d: %3d%%        ", point + 1, (uint16_t) (points[point] * 100 / 128));
+		display->write_text(2, 1, buf, 19);
+		
+		encoderState = getMenuPosition(0);
+		if (getMenuPosition(0) != points[point]){
+			points[point] = getMenuPosition(0);
+			trigger->setCustomPoints(points);
+		}
+		
+		if (button.releaseEvent()){
+			point++;
+			if (point < VELOCITY_CUSTOM_POINTS){
+				setMenuPosition(points[point]);
+				return NULL;
+			}
+			point = -1;
+			setMenuCount(VELOCITY_CURVE_COUNT);
+			saveCurvesToEeprom();
+			return Menu::velocityCurveSelect;
+		}
+		else if (button.longPressEvent()){
+			point = -1;
+			setMenuCount(VELOCITY_CURVE_COUNT);
+			loadCurvesFromEeprom();
+			return Menu::velocityCurveSelect;
+		}
+	}
+	
+	return NULL;
+}
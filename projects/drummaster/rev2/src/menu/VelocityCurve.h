@@ -0,0 +1,30 @@
+#ifndef VELOCITY_CURVE_H
+#define VELOCITY_CURVE_H
+
+#include <EEPROM/EEPROM.h>
+
+#include "../DrumMaster.h"
+#include "../hardware.h"
+#include "Menu.h"
+
+namespace digitalcave {
+
+	class VelocityCurve : public Menu {
+	
+		private:
+			
+		public:
+			static void loadCurvesFromEeprom();
+			static void saveCurvesToEeprom();
+			
+			int16_t value;
+			uint8_t pad;
+			//The custom curve point being edited, or -1 when choosing the curve
+			int8_t point;
+
+			VelocityCurve();
+			Menu* handleAction();
+	};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#include "VelocityCurveSelect.h"
+
+using namespace digitalcave;
+
+static const char* labels[] = {
+	"Hi Hat             ",
+	"Snare              ",
+	"Bass               ",
+	"Tom 1              ",
+	"Crash              ",
+	"Tom 2              ",
+	"Tom 3              ",
+	"Splash             ",
+	"Ride               ",
+	"X0                 ",
+	"X1                 "
+};
+
+VelocityCurveSelect::VelocityCurveSelect() : Menu(PAD_COUNT){
+}
+
+Menu* VelocityCurveSelect::handleAction(){
+	display->write_text(0, 0, "Velocity Curve      ", 20);
+	
+	int8_t positionOffset = getPositionOffset();
+	writeSelection(positionOffset);
+
+	display->write_text(1, 1, labels[getMenuPosition(positionOffset - 1)], 19);
+	display->write_text(2, 1, labels[getMenuPosition(positionOffset)], 19);
+	display->write_text(3, 1, labels[getMenuPosition(positionOffset + 1)], 19);
+	
+	if (button.releaseEvent()){
+		((VelocityCurve*) Menu::velocityCurve)->value = -1;
+		((VelocityCurve*) Menu::velocityCurve)->point = -1;
+		((VelocityCurve*) Menu::velocityCurve)->pad = getMenuPosition(0);
+		return Menu::velocityCurve;
+	}
+	else if (button.longPressEvent()){
+		display->clear();
+		return Menu::settings;
+	}
+
+	return NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef VELOCITY_CURVE_SELECT_H
+#define VELOCITY_CURVE_SELECT_H
+
+#include "../DrumMaster.h"
+#include "../hardware.h"
+#include "Menu.h"
+#include "VelocityCurve.h"
+
+namespace digitalcave {
+
+	class VelocityCurveSelect : public Menu {
+	
+		private:
+			
+		public:
+			VelocityCurveSelect();
+			Menu* handleAction();
+	};
+}
+
+#endif
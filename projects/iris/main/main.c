@@ -2,6 +2,7 @@
 
 #include <avr/interrupt.h>
 #include "lib/ws281x/ws2812.h"
+#include "led_output.h"
 #include "lib/rtc/ds1307/ds1307.h"
 #include "lib/twi/twi.h"
 //#include "lib/serial/serial.h"
@@ -21,6 +22,9 @@
 #define MODE_SPECTRUM 6
 #define MODE_PLASMA 7
 
+// current cap for the ring in mA (e.g. the supply rating); 0 for no limit
+#define POWER_BUDGET_MA 0
+
 #define MODE_YEAR 127
 #define MODE_MONTH 128
 #define MODE_DAY 129
@@ -34,43 +38,7 @@ int r(int max) {
 }
 // translate hue to rgb
 void h2rgb(struct ws2812_t *rgb, float h) {
-	h /= 60;		// sector 0 to 5
-	int i = floor(h);
-	float f = h - i;	// factorial part of h
-	float q = 1 - f;
-	float t = 1 - (1 - f);
-	switch(i) {
-		case 0:
-		rgb->red = 255;
-		rgb->green = 255 * t;
-		rgb->blue = 0;
-		break;
-		case 1:
-		rgb->red = 255 * q;
-		rgb->green = 255;
-		rgb->blue = 0;
-		break;
-		case 2:
-		rgb->red = 0;
-		rgb->green = 255;
-		rgb->blue = 255 * t;
-		break;
-		case 3:
-		rgb->red = 0;
-		rgb->green = 255 * q;
-		rgb->blue = 255;
-		break;
-		case 4:
-		rgb->red = 255 * t;
-		rgb->green = 0;
-		rgb->blue = 255;
-		break;
-		default:
-		rgb->red = 255;
-		rgb->green = 0;
-		rgb->blue = 255 * q;
-		break;
-	}
+	hsv2rgb((uint16_t) h, 255, 255, &rgb->red, &rgb->green, &rgb->blue);
 }
 // recursive function to fill in the the spaces between two points in the plasma
 void a(uint8_t p1, uint8_t p2, float *hues) {
@@ -138,6 +106,12 @@ int main() {
 
 	struct ws2812_t colors[60];
 
+	// gamma and power limit; no dithering, since the clock modes only update once a second
+	led_output_t output;
+	led_output_init(&output);
+	output.dither = 0;
+	output.budget_ma = POWER_BUDGET_MA;
+
 	// initialize hardware
 	DDRB |= _BV(PB0);			// test output
 
@@ -414,6 +388,7 @@ int main() {
 			//for (int i = 0; i < 60; i++) tx[i] = colors[i];
 			// translate the top to the bottom
 			for (int i = 0; i < 60; i++) tx[i] = colors[(i + 30) % 60];
+			led_output_apply(&output, (uint8_t*) tx, (uint8_t*) tx, 60);
 			ws281x_set(tx);
 			remote_reset();
 
@@ -4,6 +4,7 @@
 #include "Module.h"
 #include "Matrix.h"
 #include <stdint.h>
+#include <LifeBoard.h>
 
 #define LIFE_HASH_COUNT			20
 #define LIFE_MATCH_COUNT		20
@@ -12,8 +13,7 @@ namespace digitalcave {
 	class Life : public Module {
 	private:
 		uint8_t baseColor;
-		uint8_t state[MATRIX_WIDTH][MATRIX_HEIGHT];
-		uint8_t tempstate[MATRIX_WIDTH][MATRIX_HEIGHT];
+		LifeBoard board;
 		uint32_t hashes[LIFE_HASH_COUNT];
 		uint8_t running = 0;
 		uint8_t matches = 0;
@@ -24,12 +24,6 @@ namespace digitalcave {
 		void run();
 
 	private:
-		/* bounds-safe way of getting the current state of each pixel */
-		uint8_t getState(int8_t x, int8_t y);
-
-		uint8_t getNeighborCount(int8_t x, int8_t y);
-		uint32_t getStateHash();
-	
 		/* write the board state to the matrix */
 		void flush();
 	
@@ -15,6 +15,9 @@ void Matrix::setColor(uint8_t gr) {
 void Matrix::setColor(uint8_t red, uint8_t green) {
 	color = ((green / 16) << 4) | (red / 16);
 }
+void Matrix::setColor(uint8_t red, uint8_t green, uint8_t blue) {
+	setColor(red, green);	//No blue LEDs
+}
 
 void Matrix::setPixel(int16_t x, int16_t y) {
 	changed = 1;
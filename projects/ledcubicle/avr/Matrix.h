@@ -26,6 +26,7 @@ namespace digitalcave {
 		void setDepth(uint8_t d);
 		void setColor(uint8_t gr);
 		void setColor(uint8_t r, uint8_t g);
+		void setColor(uint8_t r, uint8_t g, uint8_t b);
 	};
 }
 
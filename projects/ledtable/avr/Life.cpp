@@ -14,7 +14,7 @@ extern ButtonAVR b2;
 extern Matrix matrix;
 extern Hsv hsv;
 
-Life::Life() {
+Life::Life() : board(MATRIX_WIDTH, MATRIX_HEIGHT) {
 }
 
 Life::~Life() {
@@ -37,42 +37,13 @@ void Life::run() {
 		} else {
 			frame = delay;
 
-			for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
-				for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-					tempstate[x][y] = state[x][y];
-				}
-			}
-			for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
-				for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-					uint8_t count = getNeighborCount(x, y);
-					if (state[x][y] > 0) {
-						// alive
-						if (count == 2 || count == 3) {
-							// staying alive; do nothing
-							tempstate[x][y] = 0x01;
-						}
-						else {
-							// overpopulation or underpopulation
-							tempstate[x][y] = 0x00;
-						}
-					}
-					else if (count == 3) {
-						// birth
-						tempstate[x][y] = 0x01;
-					}
-				}
-			}
-			for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
-				for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-					state[x][y] = tempstate[x][y];
-				}
-			}
+			board.step();
 
 			//Store board hash
 			for (uint8_t i = LIFE_HASH_COUNT - 1; i > 0; i--) {
 				hashes[i] = hashes[i - 1];
 			}
-			hashes[0] = getStateHash();
+			hashes[0] = board.getHash();
 
 			uint8_t m = 0;
 			for (uint8_t i = 0; i < LIFE_HASH_COUNT; i++) {
@@ -109,43 +80,12 @@ void Life::run() {
 	}
 }
 
-uint8_t Life::getState(int8_t x, int8_t y) {
-	if (x < 0) x = 11;
-	else if (x > 11) x = 0;
-	if (y < 0) y = 11;
-	else if (y > 11) y = 0;
-	return state[x][y];
-}
-
-uint8_t Life::getNeighborCount(int8_t x, int8_t y) {
-	uint8_t count = 0;
-	if (getState(x - 1, y - 1)) count++;
-	if (getState(x - 1, y)) count++;
-	if (getState(x - 1, y + 1)) count++;
-	if (getState(x, y - 1)) count++;
-	if (getState(x, y + 1)) count++;
-	if (getState(x + 1, y - 1)) count++;
-	if (getState(x + 1, y)) count++;
-	if (getState(x + 1, y + 1)) count++;
-	return count;
-}
-
-uint32_t Life::getStateHash() {
-	uint32_t hash = 0;
-	for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
-		for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-			hash += x * y * (state[x][y] ? 1 : 0);
-		}
-	}
-	return hash;
-}
-
 void Life::flush() {
 	hsv.addHue(1);
 	Rgb rgb = Rgb(hsv);
     for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
 		for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-			if (state[x][y] > 0) {
+			if (board.get(x, y)) {
 				matrix.setColor(rgb);
 			} else {
 				matrix.setColor(0,0,0);
@@ -172,11 +112,7 @@ void Life::reset() {
 	// random start positions
 	for (uint8_t x = 0; x < MATRIX_WIDTH; x++) {
 		for (uint8_t y = 0; y < MATRIX_HEIGHT; y++) {
-			if ((random() & 0x3) == 0x3) {		//25% chance
-				state[x][y] = 0x01; // birth
-			} else {
-				state[x][y] = 0x00;
-			}
+			board.set(x, y, (random() & 0x3) == 0x3);		//25% chance of birth
 		}
 	}
 }
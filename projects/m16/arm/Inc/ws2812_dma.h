@@ -0,0 +1,81 @@
+/*
+ * Parallel WS2812 output for STM32F4, using TIM1 and three DMA2 streams to write the GPIO
+ * BSRR register once per bit for up to 16 strips on one port.  Generalised from the
+ * m16 ws2812b library by Martin Hubacek (http://www.martinhubacek.cz, MIT License).
+ *
+ * Each bit period, the TIM1 update event drives all strip pins high, CC1 drives the pins
+ * with a 0 bit low (after 0.35us), and CC2 drives the rest low (after 0.85us).  The CC1
+ * data comes from a small circular buffer of bit planes, which is refilled from the frame
+ * buffers by ws2812_transpose() in the DMA half / full transfer interrupts.
+ *
+ * Frames are double buffered: render into ws2812_dma_frame(), and call ws2812_dma_show() to
+ * swap buffers and start sending.  The next frame can be rendered while the previous one
+ * is being sent; ws2812_dma_show() waits for the previous transfer to finish if needed.
+ * Note that after a swap the back buffer holds the frame before last, not a copy of the
+ * one just shown.
+ *
+ * Uses TIM1, DMA2 streams 1 / 2 / 5 (channel 6), and the DMA2_Stream2_IRQHandler and
+ * TIM1_UP_TIM10_IRQHandler vectors; they must not be used elsewhere.  It lives with m16
+ * rather than in inc/stm32f4 (which every STM32F4 project builds) because it needs the
+ * HAL timer module and the F411 vector names, and defines those interrupt handlers.
+ */
+
+#ifndef WS2812_DMA_H
+#define WS2812_DMA_H
+
+#include "stm32f4xx_hal.h"
+
+#include <ws2812_transpose.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+//LEDs per half of the circular bit plane buffer.  Larger values mean fewer interrupts,
+// at the cost of 96 bytes of RAM per LED.
+#ifndef WS2812_DMA_LEDS
+#define WS2812_DMA_LEDS		2
+#endif
+
+/*
+ * Sets up the GPIO pins, timer and DMA.  Strip s is on pin first_pin + s of port, and
+ * has lengths[s] LEDs; first_pin + strip_count must be at most 16.  Allocates two frame
+ * buffers of 3 * lengths[s] bytes for each strip.  Returns 1 on success, or 0 (leaving
+ * the hardware alone and nothing allocated) if the strips don't fit on the port or there
+ * is not enough memory.
+ */
+uint8_t ws2812_dma_init(GPIO_TypeDef* port, uint8_t first_pin, uint8_t strip_count, const uint16_t* lengths);
+
+/*
+ * Returns the back (rendering) frame buffer for the given strip; RGB triples.
+ */
+uint8_t* ws2812_dma_frame(uint8_t strip);
+
+/*
+ * Swaps the front and back buffers and starts sending the new front buffer.  Waits for
+ * any transfer in progress to finish first.
+ */
+void ws2812_dma_show();
+
+/*
+ * Returns non-zero while a frame (including its reset time) is being sent.
+ */
+uint8_t ws2812_dma_busy();
+
+/*
+ * Returns the number of frames sent since init; sample it over time to get the achieved
+ * refresh rate, and compare with ws2812_dma_max_refresh().
+ */
+uint32_t ws2812_dma_frames();
+
+/*
+ * The theoretical limits for the configured strips (see ws2812_transpose.h).
+ */
+uint32_t ws2812_dma_max_refresh();
+uint32_t ws2812_dma_leds_per_second();
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
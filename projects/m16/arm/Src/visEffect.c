@@ -15,11 +15,17 @@
 #include <stdint.h>
 
 #include "stm32f4xx_hal.h"
-#include "ws2812b/ws2812b.h"
+#include <ws2812_dma.h>
+#include <led_output.h>
 #include <stdlib.h>
 
-// RGB Framebuffers
-uint8_t frameBuffer[3*6];
+// Strip lengths; one strip on PC0
+#define STRIP_COUNT 1
+#define STRIP_PIN 0
+static const uint16_t stripLengths[STRIP_COUNT] = { 6 };
+
+// Gamma, brightness and dithering, applied just before sending
+static led_output_t output;
 
 // Helper defines
 #define newColor(r, g, b) (((uint32_t)(r) << 16) | ((uint32_t)(g) <<  8) | (b))
@@ -108,52 +114,33 @@ void visHandle2()
 		timestamp = HAL_GetTick();
 
 		// Animate next frame, each effect into each output RGB framebuffer
-		visRainbow(frameBuffer, sizeof(frameBuffer), 15);
+		for (uint8_t i = 0; i < STRIP_COUNT; i++)
+		{
+			uint8_t *frameBuffer = ws2812_dma_frame(i);
+			uint32_t frameBufferSize = stripLengths[i] * 3;
+
+			visRainbow(frameBuffer, frameBufferSize, 15);
+			led_output_apply(&output, frameBuffer, frameBuffer, stripLengths[i]);
+		}
+
+		// Swap buffers and transfer new data; the next frame is rendered while this one is sent
+		ws2812_dma_show();
 	}
 }
 
 
 void visInit()
 {
-
-	uint8_t i;
-
-	// HELP
-	// Fill the 8 structures to simulate overhead of 8 paralel strips
-	// The pins are not enabled in the WS2812B init. There are enabled only PC0-3
-	// The 16 channels are possible at 168MHz with 60% IRQ overhead during data TX
-
-	// 4 paralel output LED strips needs 18% overhead during TX
-	// 8 paralel output LED strips overhead is 8us of 30us period which is 28% - see the debug output PD15/13
-
-	// If you need more parallel LED strips, increase the WS2812_BUFFER_COUNT value
-	for( i = 0; i < WS2812_BUFFER_COUNT; i++)
-	{
-
-		// Set output channel/pin, GPIO_PIN_0 = 0, for GPIO_PIN_5 = 5 - this has to correspond to WS2812B_PINS
-		ws2812b.item[i].channel = i;
-
-		// Your RGB framebuffer
-		ws2812b.item[i].frameBufferPointer = frameBuffer;
-		// RAW size of framebuffer
-		ws2812b.item[i].frameBufferSize = sizeof(frameBuffer);
+	// Up to 16 parallel strips on consecutive pins of one port are supported, each with its
+	// own length; at 168MHz 16 strips use about 60% of the CPU during transmission.
+	if (!ws2812_dma_init(GPIOC, STRIP_PIN, STRIP_COUNT, stripLengths)){
+		_Error_Handler(__FILE__, __LINE__);
 	}
-
-
-	ws2812b_init();
+	led_output_init(&output);
 }
 
 
 void visHandle()
 {
-
-	if(ws2812b.transferComplete)
-	{
-		// Update your framebuffer here or swap buffers
-		visHandle2();
-
-		// Signal that buffer is changed and transfer new data
-		ws2812b.startTransfer = 1;
-		ws2812b_handle();
-	}
+	visHandle2();
 }
@@ -0,0 +1,323 @@
+#include "ws2812_dma.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WS2812_DMA_BUFFER_SIZE		(2 * WS2812_DMA_LEDS * WS2812_BITS_PER_LED)
+
+static GPIO_TypeDef* port;
+static uint8_t first_pin;
+static uint8_t strip_count;
+static uint16_t longest;
+
+//The frames for each strip; strips[front] is being sent, the other is for rendering
+static ws2812_strip_t strips[2][WS2812_MAX_STRIPS];
+static volatile uint8_t front;
+
+//DMA sources; the pins to drive high at the start of each bit, and low at the end
+static uint32_t pins_high;
+static uint32_t pins_low;
+//Circular bit plane buffer for the CC1 DMA (pins to drive low early for a 0 bit); two halves
+static uint16_t buffer[WS2812_DMA_BUFFER_SIZE];
+
+static volatile uint8_t busy;
+static volatile uint32_t frames;
+static uint16_t next_led;			//Next LED to be loaded into the buffer
+static uint16_t halves_remaining;	//Buffer halves still to be sent for this frame
+
+static uint32_t tim_period;
+static uint32_t tim_reset_period;
+
+static TIM_HandleTypeDef tim;
+static DMA_HandleTypeDef dma_update;
+static DMA_HandleTypeDef dma_cc1;
+static DMA_HandleTypeDef dma_cc2;
+
+static void ws2812_dma_half_complete(DMA_HandleTypeDef* hdma);
+static void ws2812_dma_complete(DMA_HandleTypeDef* hdma);
+
+static void ws2812_dma_gpio_init(uint16_t pins){
+#if defined(GPIOA)
+	if (port == GPIOA) __HAL_RCC_GPIOA_CLK_ENABLE();
+#endif
+#if defined(GPIOB)
+	if (port == GPIOB) __HAL_RCC_GPIOB_CLK_ENABLE();
+#endif
+#if defined(GPIOC)
+	if (port == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
+#endif
+#if defined(GPIOD)
+	if (port == GPIOD) __HAL_RCC_GPIOD_CLK_ENABLE();
+#endif
+#if defined(GPIOE)
+	if (port == GPIOE) __HAL_RCC_GPIOE_CLK_ENABLE();
+#endif
+#if defined(GPIOH)
+	if (port == GPIOH) __HAL_RCC_GPIOH_CLK_ENABLE();
+#endif
+
+	GPIO_InitTypeDef gpio;
+	gpio.Pin = pins;
+	gpio.Mode = GPIO_MODE_OUTPUT_PP;
+	gpio.Pull = GPIO_NOPULL;
+	gpio.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(port, &gpio);
+}
+
+static void ws2812_dma_tim_init(){
+	__HAL_RCC_TIM1_CLK_ENABLE();
+
+	//One bit is 1.25us (800kHz).  CC1 ends a 0 bit after 0.35us, CC2 ends a 1 bit after 0.85us.
+	tim_period = SystemCoreClock / 800000;
+	tim_reset_period = (SystemCoreClock / 1000000) * WS2812_RESET_US;
+
+	tim.Instance = TIM1;
+	tim.Init.Period = tim_period;
+	tim.Init.RepetitionCounter = 0;
+	tim.Init.Prescaler = 0;
+	tim.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	tim.Init.CounterMode = TIM_COUNTERMODE_UP;
+	HAL_TIM_PWM_Init(&tim);
+
+	HAL_NVIC_SetPriority(TIM1_UP_TIM10_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(TIM1_UP_TIM10_IRQn);
+
+	TIM_OC_InitTypeDef oc;
+	oc.OCMode = TIM_OCMODE_PWM1;
+	oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+	oc.OCNPolarity = TIM_OCNPOLARITY_HIGH;
+	oc.OCFastMode = TIM_OCFAST_DISABLE;
+	oc.OCIdleState = TIM_OCIDLESTATE_RESET;
+	oc.OCNIdleState = TIM_OCNIDLESTATE_RESET;
+	oc.Pulse = (10 * tim_period) / 36;
+	HAL_TIM_PWM_ConfigChannel(&tim, &oc, TIM_CHANNEL_1);
+	oc.Pulse = (10 * tim_period) / 15;
+	HAL_TIM_PWM_ConfigChannel(&tim, &oc, TIM_CHANNEL_2);
+
+	HAL_TIM_Base_Start(&tim);
+	HAL_TIM_PWM_Start(&tim, TIM_CHANNEL_1);
+	__HAL_TIM_DISABLE(&tim);
+}
+
+static void ws2812_dma_stream_init(DMA_HandleTypeDef* hdma, DMA_Stream_TypeDef* instance, uint32_t memInc, uint32_t alignment){
+	hdma->Instance = instance;
+	hdma->Init.Channel = DMA_CHANNEL_6;
+	hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = memInc;
+	hdma->Init.PeriphDataAlignment = (alignment == DMA_MDATAALIGN_WORD) ? DMA_PDATAALIGN_WORD : DMA_PDATAALIGN_HALFWORD;
+	hdma->Init.MemDataAlignment = alignment;
+	hdma->Init.Mode = DMA_CIRCULAR;
+	hdma->Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	hdma->Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+	hdma->Init.MemBurst = DMA_MBURST_SINGLE;
+	hdma->Init.PeriphBurst = DMA_PBURST_SINGLE;
+	HAL_DMA_DeInit(hdma);
+	HAL_DMA_Init(hdma);
+}
+
+static void ws2812_dma_dma_init(){
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	//TIM1 update; all pins high
+	ws2812_dma_stream_init(&dma_update, DMA2_Stream5, DMA_MINC_DISABLE, DMA_MDATAALIGN_WORD);
+	HAL_DMA_Start(&dma_update, (uint32_t) &pins_high, (uint32_t) &port->BSRR, WS2812_DMA_BUFFER_SIZE);
+
+	//TIM1 CC1; 0 bits low, into the reset half of BSRR
+	ws2812_dma_stream_init(&dma_cc1, DMA2_Stream1, DMA_MINC_ENABLE, DMA_MDATAALIGN_HALFWORD);
+	HAL_DMA_Start(&dma_cc1, (uint32_t) buffer, (uint32_t) &port->BSRR + 2, WS2812_DMA_BUFFER_SIZE);
+
+	//TIM1 CC2; all pins low.  Its half / full transfer interrupts refill the buffer.
+	ws2812_dma_stream_init(&dma_cc2, DMA2_Stream2, DMA_MINC_DISABLE, DMA_MDATAALIGN_WORD);
+	dma_cc2.XferHalfCpltCallback = ws2812_dma_half_complete;
+	dma_cc2.XferCpltCallback = ws2812_dma_complete;
+	HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+	HAL_DMA_Start_IT(&dma_cc2, (uint32_t) &pins_low, (uint32_t) &port->BSRR, WS2812_DMA_BUFFER_SIZE);
+}
+
+/*
+ * Loads the next WS2812_DMA_LEDS LEDs from the front buffer into the given half of the bit
+ * plane buffer.  Past the end of the longest strip, 0 bits are loaded; they are never
+ * latched, since the transfer is stopped before then, but the DMA may start on them.
+ */
+static void ws2812_dma_load(uint8_t half){
+	uint16_t* planes = buffer + half * (WS2812_DMA_BUFFER_SIZE / 2);
+	uint16_t mask = pins_high;
+	for (uint8_t i = 0; i < WS2812_DMA_LEDS; i++){
+		if (next_led < longest){
+			ws2812_transpose(strips[front], strip_count, next_led, planes);
+			for (uint8_t b = 0; b < WS2812_BITS_PER_LED; b++){
+				planes[b] = mask & ~(planes[b] << first_pin);
+			}
+		}
+		else {
+			for (uint8_t b = 0; b < WS2812_BITS_PER_LED; b++) planes[b] = mask;
+		}
+		next_led++;
+		planes += WS2812_BITS_PER_LED;
+	}
+}
+
+static void ws2812_dma_start(){
+	busy = 1;
+	next_led = 0;
+	halves_remaining = (longest + WS2812_DMA_LEDS - 1) / WS2812_DMA_LEDS;
+	if (halves_remaining == 0) halves_remaining = 1;
+	ws2812_dma_load(0);
+	ws2812_dma_load(1);
+
+	__HAL_DMA_CLEAR_FLAG(&dma_update, DMA_FLAG_TCIF1_5 | DMA_FLAG_HTIF1_5 | DMA_FLAG_TEIF1_5);
+	__HAL_DMA_CLEAR_FLAG(&dma_cc1, DMA_FLAG_TCIF1_5 | DMA_FLAG_HTIF1_5 | DMA_FLAG_TEIF1_5);
+	__HAL_DMA_CLEAR_FLAG(&dma_cc2, DMA_FLAG_TCIF2_6 | DMA_FLAG_HTIF2_6 | DMA_FLAG_TEIF2_6);
+
+	dma_update.Instance->NDTR = WS2812_DMA_BUFFER_SIZE;
+	dma_cc1.Instance->NDTR = WS2812_DMA_BUFFER_SIZE;
+	dma_cc2.Instance->NDTR = WS2812_DMA_BUFFER_SIZE;
+
+	__HAL_TIM_CLEAR_FLAG(&tim, TIM_FLAG_UPDATE | TIM_FLAG_CC1 | TIM_FLAG_CC2 | TIM_FLAG_CC3 | TIM_FLAG_CC4);
+
+	__HAL_DMA_ENABLE(&dma_update);
+	__HAL_DMA_ENABLE(&dma_cc1);
+	__HAL_DMA_ENABLE(&dma_cc2);
+
+	//The timer DMA requests must be enabled after the DMA streams
+	__HAL_TIM_ENABLE_DMA(&tim, TIM_DMA_UPDATE);
+	__HAL_TIM_ENABLE_DMA(&tim, TIM_DMA_CC1);
+	__HAL_TIM_ENABLE_DMA(&tim, TIM_DMA_CC2);
+
+	TIM1->CNT = tim_period - 1;
+	__HAL_TIM_ENABLE(&tim);
+}
+
+/*
+ * All LEDs have been sent; stop the DMA, hold the lines low, and run the timer once more
+ * for the reset time.  The update interrupt then marks the frame as done.
+ */
+static void ws2812_dma_stop(){
+	TIM1->CR1 &= ~TIM_CR1_CEN;
+
+	__HAL_DMA_DISABLE(&dma_update);
+	__HAL_DMA_DISABLE(&dma_cc1);
+	__HAL_DMA_DISABLE(&dma_cc2);
+
+	__HAL_TIM_DISABLE_DMA(&tim, TIM_DMA_UPDATE);
+	__HAL_TIM_DISABLE_DMA(&tim, TIM_DMA_CC1);
+	__HAL_TIM_DISABLE_DMA(&tim, TIM_DMA_CC2);
+
+	port->BSRR = pins_low;
+
+	TIM1->ARR = tim_reset_period;
+	TIM1->CNT = 0;
+	TIM1->EGR = TIM_EGR_UG;
+	__HAL_TIM_CLEAR_FLAG(&tim, TIM_FLAG_UPDATE);
+	__HAL_TIM_ENABLE_IT(&tim, TIM_IT_UPDATE);
+	TIM1->CR1 |= TIM_CR1_CEN;
+}
+
+static void ws2812_dma_half_sent(uint8_t half){
+	halves_remaining--;
+	if (halves_remaining == 0) ws2812_dma_stop();
+	else ws2812_dma_load(half);
+}
+
+static void ws2812_dma_half_complete(DMA_HandleTypeDef* hdma){
+	ws2812_dma_half_sent(0);
+}
+
+static void ws2812_dma_complete(DMA_HandleTypeDef* hdma){
+	ws2812_dma_half_sent(1);
+}
+
+void DMA2_Stream2_IRQHandler(void){
+	HAL_DMA_IRQHandler(&dma_cc2);
+}
+
+void TIM1_UP_TIM10_IRQHandler(void){
+	if (!(TIM1->SR & TIM_SR_UIF)) return;
+	__HAL_TIM_CLEAR_FLAG(&tim, TIM_FLAG_UPDATE);
+
+	//End of the reset time; put the bit period back for next time
+	TIM1->CR1 = 0;
+	__HAL_TIM_DISABLE_IT(&tim, TIM_IT_UPDATE);
+	TIM1->ARR = tim_period;
+	TIM1->EGR = TIM_EGR_UG;
+	__HAL_TIM_CLEAR_FLAG(&tim, TIM_FLAG_UPDATE);
+
+	frames++;
+	busy = 0;
+}
+
+uint8_t ws2812_dma_init(GPIO_TypeDef* p, uint8_t pin, uint8_t count, const uint16_t* lengths){
+	if (count > WS2812_MAX_STRIPS) count = WS2812_MAX_STRIPS;
+	if (pin + count > 16) return 0;		//The port only has 16 pins
+
+	for (uint8_t s = 0; s < count; s++){
+		for (uint8_t b = 0; b < 2; b++){
+			strips[b][s].length = lengths[s];
+			strips[b][s].frame = (uint8_t*) malloc(lengths[s] * 3);
+		}
+	}
+	for (uint8_t s = 0; s < count; s++){
+		if (strips[0][s].frame == NULL || strips[1][s].frame == NULL){
+			//Give back what we got, so that a failed init leaves nothing behind
+			for (uint8_t f = 0; f < count; f++){
+				free(strips[0][f].frame);
+				free(strips[1][f].frame);
+				strips[0][f].frame = NULL;
+				strips[1][f].frame = NULL;
+			}
+			strip_count = 0;
+			return 0;
+		}
+		memset(strips[0][s].frame, 0, lengths[s] * 3);
+		memset(strips[1][s].frame, 0, lengths[s] * 3);
+	}
+
+	port = p;
+	first_pin = pin;
+	strip_count = count;
+	longest = 0;
+	front = 0;
+	busy = 0;
+	frames = 0;
+	for (uint8_t s = 0; s < strip_count; s++){
+		if (lengths[s] > longest) longest = lengths[s];
+	}
+
+	uint16_t pins = ((1 << strip_count) - 1) << first_pin;
+	pins_high = pins;
+	pins_low = (uint32_t) pins << 16;
+
+	ws2812_dma_gpio_init(pins);
+	ws2812_dma_dma_init();
+	ws2812_dma_tim_init();
+	return 1;
+}
+
+uint8_t* ws2812_dma_frame(uint8_t strip){
+	return strips[front ^ 1][strip].frame;
+}
+
+void ws2812_dma_show(){
+	while (busy);
+	front ^= 1;
+	ws2812_dma_start();
+}
+
+uint8_t ws2812_dma_busy(){
+	return busy;
+}
+
+uint32_t ws2812_dma_frames(){
+	return frames;
+}
+
+uint32_t ws2812_dma_max_refresh(){
+	return ws2812_max_refresh(strips[0], strip_count);
+}
+
+uint32_t ws2812_dma_leds_per_second(){
+	return ws2812_leds_per_second(strips[0], strip_count);
+}
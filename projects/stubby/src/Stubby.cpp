@@ -5,6 +5,7 @@
 #include "controllers/General.h"
 #include "controllers/UniversalController.h"
 #include "gait/gait.h"
+#include "gait/trajectory.h"
 
 #define COMM_TIMEOUT_PERIOD			5000
 
@@ -108,6 +109,7 @@ Stubby::Stubby(Stream* serial) :
 	protocol(64),
 	serial(serial),
 	mode(MODE_RESETTING),
+	gait(GAIT_TRIPOD),
 	linearAngle(0),
 	linearVelocity(0),
 	rotationalVelocity(0)
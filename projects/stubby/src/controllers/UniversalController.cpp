@@ -6,6 +6,7 @@
 #include <UniversalControllerClient.h>
 
 #include "../Stubby.h"
+#include "../gait/trajectory.h"
 
 #define ANALOG_CENTER					0
 #define ANALOG_LESS_THAN_CENTER			1
@@ -118,6 +119,14 @@ void UniversalController::dispatch(FramedSerialMessage* message){
 			stubby->setMode(MODE_WALKING);
 			pwm_start();
 		}
+		//To change gait, press the triangle (top discrete) button
+		else if (button == CONTROLLER_BUTTON_VALUE_TRIANGLE){
+			uint8_t gait = (stubby->getGait() + 1) % GAIT_COUNT;
+			stubby->setGait(gait);
+			if (gait == GAIT_TRIPOD) stubby->sendStatus("Gait: Tripod  ", 14);
+			else if (gait == GAIT_RIPPLE) stubby->sendStatus("Gait: Ripple  ", 14);
+			else stubby->sendStatus("Gait: Wave    ", 14);
+		}
 	}
 }
 
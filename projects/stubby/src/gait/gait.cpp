@@ -0,0 +1,109 @@
+#include "gait.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <dcutil/dcmath.h>
+
+#include "../types/Point.h"
+#include "trajectory.h"
+
+using namespace digitalcave;
+
+void gait_step(Stubby* stubby){
+	static uint16_t phase = 0;
+	static uint32_t last_time = 0;
+	static uint32_t last_report = 0;
+	static uint32_t total_micros = 0;
+	static uint16_t max_micros = 0;
+	static uint16_t updates = 0;
+
+	uint32_t time = timer_millis();
+
+	//Legs are updated once per servo period; since the position is computed from the elapsed
+	// time rather than a step index, the motion is the same regardless of how often we get here.
+	if (time - last_time >= GAIT_STEP_INTERVAL){
+		uint32_t start = timer_micros();
+
+		float linearVelocity = stubby->getLinearVelocity();
+		float rotationalVelocity = stubby->getRotationalVelocity();
+		if (rotationalVelocity >= 0.3 || rotationalVelocity <= -0.3 || linearVelocity >= 0.3){
+			//Advance through the step cycle at a rate which depends on how fast we are going
+			uint16_t cycle = trajectory_cycle_time(fmax(linearVelocity, fabs(rotationalVelocity)));
+			phase += ((time - last_time) << 16) / cycle;
+
+			Leg** legs = stubby->getLegs();
+			for(uint8_t i = 0; i < LEG_COUNT; i++){
+				Leg* leg = legs[i];
+				leg->setOffset(trajectory_evaluate(stubby->getGait(), leg->getIndex(), leg->getMountingAngle(), phase, linearVelocity, stubby->getLinearAngle(), rotationalVelocity));
+			}
+		}
+		else {
+			Point result(0,0,0);
+			for(uint8_t i = 0; i < LEG_COUNT; i++){
+				stubby->getLegs()[i]->setOffset(result);
+			}
+			phase = 0;
+		}
+
+		pwm_apply_batch();
+		last_time = time;
+
+		//Track how long the trajectory + IK + PWM update takes, and report it periodically
+		uint16_t elapsed = timer_micros() - start;
+		total_micros += elapsed;
+		if (elapsed > max_micros) max_micros = elapsed;
+		updates++;
+		if (time - last_report >= GAIT_REPORT_INTERVAL){
+			char temp[15];
+			snprintf(temp, sizeof(temp), "t%5u m%5u ", (uint16_t) (total_micros / updates), max_micros);
+			stubby->sendDebug(temp, 14);
+			total_micros = 0;
+			max_micros = 0;
+			updates = 0;
+			last_report = time;
+		}
+	}
+}
+
+void gait_reset(Stubby* stubby){
+// 	for (uint8_t i = 0; i < 10; i++){
+// 		PORTC ^= _BV(PORTC5) | _BV(PORTC6) | _BV(PORTC7);
+// 		delay_ms(100);
+// 	}
+	stubby->sendStatus("gait_reset    ", 14);
+	
+	pwm_start();
+	
+	//TODO change this to be non blocking
+	Leg** legs = stubby->getLegs();
+	
+	for (uint8_t l = 0; l < LEG_COUNT; l+=2){
+		legs[l]->setOffset(Point(0,0,30));
+	}
+	pwm_apply_batch();
+	delay_ms(200);
+
+	for (uint8_t l = 0; l < LEG_COUNT; l+=2){
+		legs[l]->setOffset(Point(0,0,0));
+	}
+	pwm_apply_batch();
+	delay_ms(200);
+	
+	wdt_reset();
+
+	for (uint8_t l = 1; l < LEG_COUNT; l+=2){
+		legs[l]->setOffset(Point(0,0,30));
+	}
+	pwm_apply_batch();
+	delay_ms(200);
+
+	for (uint8_t l = 1; l < LEG_COUNT; l+=2){
+		legs[l]->setOffset(Point(0,0,0));
+	}
+	pwm_apply_batch();
+	delay_ms(200);
+	
+	stubby->setMode(MODE_UNARMED);
+	
+	pwm_stop();
+}
@@ -4,7 +4,12 @@
 #include <avr/io.h>
 #include "../Stubby.h"
 
-#define GAIT_STEP_INTERVAL		5
+//How often (ms) the leg positions are re-evaluated.  This matches the 20ms servo PWM period,
+// as there is no benefit to updating faster than the servos can respond.
+#define GAIT_STEP_INTERVAL		20
+
+//How often (ms) the average / maximum time for each gait update is sent as a debug message.
+#define GAIT_REPORT_INTERVAL	1000
 
 using namespace digitalcave;
 
@@ -0,0 +1,101 @@
+#include "trajectory.h"
+
+#include <math.h>
+
+//A cubic Bezier segment in normalized foot space.  x is the position along the stride
+// (-64 is fully back, 64 is fully forward) and z is the lift (0 is on the ground, 64 is
+// full height).
+typedef struct bezier_t {
+	int8_t x[4];
+	int8_t z[4];
+} bezier_t;
+
+typedef struct gait_t {
+	uint16_t duty;						//Fraction of the cycle that each foot is on the ground
+	uint16_t offset[LEG_COUNT];			//Phase offset of each leg, indexed by leg index
+} gait_t;
+
+//While on the ground, the foot moves at a constant speed from front to back.  The
+// control points are evenly spaced, so this is a straight line with constant velocity.
+static const bezier_t stance[] = {
+	{ { 64, 21, -21, -64 }, { 0, 0, 0, 0 } },
+};
+
+//While in the air, the foot lifts straight up, sweeps forward, and then drops straight
+// down.  The two segments share a tangent where they meet, so the motion is smooth.
+static const bezier_t swing[] = {
+	{ { -64, -64, -32, 0 }, { 0, 48, 64, 64 } },
+	{ { 0, 32, 64, 64 }, { 64, 64, 48, 0 } },
+};
+
+#define STANCE_COUNT	(sizeof(stance) / sizeof(stance[0]))
+#define SWING_COUNT		(sizeof(swing) / sizeof(swing[0]))
+
+//Leg indices are FRONT_LEFT, MIDDLE_LEFT, REAR_LEFT, REAR_RIGHT, MIDDLE_RIGHT, FRONT_RIGHT
+static const gait_t gaits[GAIT_COUNT] = {
+	//Tripod: two groups of three legs, alternating.  Fastest, least stable.
+	{ TRAJECTORY_PHASE(1, 2), { 0, TRAJECTORY_PHASE(1, 2), 0, TRAJECTORY_PHASE(1, 2), 0, TRAJECTORY_PHASE(1, 2) } },
+	//Ripple: a wave runs back to front down each side, with the two sides half a cycle apart.
+	{ TRAJECTORY_PHASE(2, 3), { TRAJECTORY_PHASE(2, 3), TRAJECTORY_PHASE(1, 3), 0, TRAJECTORY_PHASE(1, 2), TRAJECTORY_PHASE(5, 6), TRAJECTORY_PHASE(1, 6) } },
+	//Wave: one leg at a time, back to front on the left and then on the right.  Slowest, most stable.
+	{ TRAJECTORY_PHASE(5, 6), { TRAJECTORY_PHASE(2, 6), TRAJECTORY_PHASE(1, 6), 0, TRAJECTORY_PHASE(3, 6), TRAJECTORY_PHASE(4, 6), TRAJECTORY_PHASE(5, 6) } },
+};
+
+//Evaluates a cubic Bezier with control points p[0..3] at t (0..255 maps to 0..1), returning
+// the result scaled by 256.
+static int16_t bezier(const int8_t p[4], uint8_t t){
+	uint32_t u = 256 - t;
+	//Bernstein weights, each scaled by 2^16
+	uint32_t w0 = (u * u * u) >> 8;
+	uint32_t w1 = (3 * u * u * t) >> 8;
+	uint32_t w2 = (3 * u * t * t) >> 8;
+	uint32_t w3 = ((uint32_t) t * t * t) >> 8;
+	return (int16_t) (((int32_t) p[0] * w0 + (int32_t) p[1] * w1 + (int32_t) p[2] * w2 + (int32_t) p[3] * w3) >> 8);
+}
+
+//Finds the segment at the given fraction (0..0xFFFF) of a path, and evaluates it.
+static void path_evaluate(const bezier_t *path, uint8_t count, uint16_t fraction, int16_t *x, int16_t *z){
+	uint32_t position = (uint32_t) fraction * count;
+	const bezier_t *segment = &path[position >> 16];
+	uint8_t t = (position >> 8) & 0xFF;
+	*x = bezier(segment->x, t);
+	*z = bezier(segment->z, t);
+}
+
+uint16_t trajectory_cycle_time(float velocity){
+	if (velocity > 1) velocity = 1;
+	return TRAJECTORY_CYCLE_SLOW - (TRAJECTORY_CYCLE_SLOW - TRAJECTORY_CYCLE_FAST) * velocity;
+}
+
+Point trajectory_evaluate(uint8_t gait, uint8_t leg, double mounting_angle, uint16_t phase, float linearVelocity, float linearAngle, float rotationalVelocity){
+	if (gait >= GAIT_COUNT) gait = GAIT_TRIPOD;
+	const gait_t *g = &gaits[gait];
+
+	//Find where this leg is in its own cycle, and from that the position along the foot path
+	phase += g->offset[leg];
+	int16_t x, z;
+	if (phase < g->duty){
+		path_evaluate(stance, STANCE_COUNT, ((uint32_t) phase << 16) / g->duty, &x, &z);
+	}
+	else {
+		path_evaluate(swing, SWING_COUNT, ((uint32_t) (phase - g->duty) << 16) / (0x10000 - g->duty), &x, &z);
+	}
+
+	//x and z are now in the range -64..64 (scaled by 256).  Scale the stride by velocity and
+	// rotate it into the direction of travel.
+	Point result(0, 0, 0);
+	Point linear(((int32_t) x * TRAJECTORY_STRIDE * linearVelocity) / (64 * 256), 0, 0);
+	linear.rotateXY(linearAngle);
+	result.add(linear);
+
+	//Rotation moves each foot tangentially, i.e. along the leg's own Y axis.  A foot moving
+	// backwards along X for linear motion moves in +Y for clockwise rotation.
+	Point rotational(0, ((int32_t) -x * TRAJECTORY_ROTATION * rotationalVelocity) / (64 * 256), 0);
+	rotational.rotateXY(mounting_angle);
+	result.add(rotational);
+
+	//The foot lift is the same regardless of velocity
+	result.z = ((int32_t) z * TRAJECTORY_LIFT) / (64 * 256);
+
+	return result;
+}
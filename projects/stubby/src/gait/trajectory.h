@@ -0,0 +1,46 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <avr/io.h>
+
+#include "../hardware.h"
+#include "../types/Point.h"
+
+//Available gaits.  The gait determines how long each foot stays on the ground (duty factor)
+// and the phase offset of each leg; the foot path itself is shared by all gaits.
+#define GAIT_TRIPOD				0
+#define GAIT_RIPPLE				1
+#define GAIT_WAVE				2
+#define GAIT_COUNT				3
+
+//Phase is expressed as a fraction of a full step cycle, where 0x10000 is one full cycle.  This
+// lets the phase wrap around naturally when incremented.
+#define TRAJECTORY_PHASE(numerator, denominator)	((uint16_t) (((uint32_t) (numerator) << 16) / (denominator)))
+
+//Maximum distance (mm) that the foot travels either side of neutral in the direction of travel,
+// and tangentially when rotating.
+#define TRAJECTORY_STRIDE		28
+#define TRAJECTORY_ROTATION		24
+//Height (mm) that the foot is lifted during the swing.
+#define TRAJECTORY_LIFT			50
+
+//Time (ms) for one full step cycle at minimum and maximum velocity.  The cadence is interpolated
+// between these based on the requested velocity; the stride length is scaled as well.
+#define TRAJECTORY_CYCLE_SLOW	1200
+#define TRAJECTORY_CYCLE_FAST	600
+
+/*
+ * Returns the number of ms that one full step cycle should take at the given velocity (0..1).
+ */
+uint16_t trajectory_cycle_time(float velocity);
+
+/*
+ * Returns the foot offset (relative to the leg's neutral position) for the given leg at the
+ * given phase of the step cycle.  The foot path is a set of cubic Bezier segments (one for
+ * stance, two for the swing) which is scaled and rotated by the requested linear and rotational
+ * velocity, so any combination of speed, direction and turning rate can be walked without
+ * needing separate lookup tables.
+ */
+Point trajectory_evaluate(uint8_t gait, uint8_t leg, double mounting_angle, uint16_t phase, float linearVelocity, float linearAngle, float rotationalVelocity);
+
+#endif
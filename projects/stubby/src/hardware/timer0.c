@@ -41,6 +41,18 @@ uint32_t timer_millis(){
 	return (_timer_millis_counter << 8) + _timer_millis;
 }
 
+uint32_t timer_micros(){
+	uint8_t sreg = SREG;
+	cli();
+	uint32_t millis = timer_millis();
+	uint8_t ticks = TCNT0;
+	//If the compare match happened after we disabled interrupts, the ISR has not incremented
+	// the millis count yet.
+	if ((TIFR0 & _BV(OCF0A)) && ticks < (OCR0A >> 1)) millis++;
+	SREG = sreg;
+	return millis * 1000 + ((uint16_t) ticks * 256) / (F_CPU / 1000000);
+}
+
 /* 
  * The ISR for timer0 overflow.  Increment the _timer_count here, and do the calculcations
  * to increment _timer_millis as needed.
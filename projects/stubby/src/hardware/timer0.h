@@ -20,6 +20,13 @@ void timer0_init();
  */
 uint32_t timer_millis();
 
+/*
+ * Returns the number of microseconds which have elapsed since the last time timer_init()
+ * was called.  Resolution is one timer0 tick (256 / F_CPU, 12.8us at 20MHz); this is meant
+ * for profiling short sections of code, and overflows after about 71 minutes.
+ */
+uint32_t timer_micros();
+
 #if defined (__cplusplus)
 }
 #endif
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * File Name          : main.h
+  * Description        : This file contains the common defines of the application
+  ******************************************************************************
+  *
+  * COPYRIGHT(c) 2016 STMicroelectronics
+  *
+  * Redistribution and use in source and binary forms, with or without modification,
+  * are permitted provided that the following conditions are met:
+  *   1. Redistributions of source code must retain the above copyright notice,
+  *      this list of conditions and the following disclaimer.
+  *   2. Redistributions in binary form must reproduce the above copyright notice,
+  *      this list of conditions and the following disclaimer in the documentation
+  *      and/or other materials provided with the distribution.
+  *   3. Neither the name of STMicroelectronics nor the names of its contributors
+  *      may be used to endorse or promote products derived from this software
+  *      without specific prior written permission.
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAIN_H
+#define __MAIN_H
+  /* Includes ------------------------------------------------------------------*/
+
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+
+/* Private define ------------------------------------------------------------*/
+
+#define LED_G_Pin GPIO_PIN_0
+#define LED_G_GPIO_Port GPIOC
+#define LED_B_Pin GPIO_PIN_1
+#define LED_B_GPIO_Port GPIOC
+#define LED_R_Pin GPIO_PIN_2
+#define LED_R_GPIO_Port GPIOC
+#define MOTOR_1_Pin GPIO_PIN_0
+#define MOTOR_1_GPIO_Port GPIOA
+#define MOTOR_5_Pin GPIO_PIN_1
+#define MOTOR_5_GPIO_Port GPIOA
+#define MOTOR_8_Pin GPIO_PIN_2
+#define MOTOR_8_GPIO_Port GPIOA
+#define MOTOR_4_Pin GPIO_PIN_3
+#define MOTOR_4_GPIO_Port GPIOA
+#define IMU_I2C2_SCL_Pin GPIO_PIN_10
+#define IMU_I2C2_SCL_GPIO_Port GPIOB
+#define MOTOR_3_Pin GPIO_PIN_8
+#define MOTOR_3_GPIO_Port GPIOA
+#define MOTOR_7_Pin GPIO_PIN_9
+#define MOTOR_7_GPIO_Port GPIOA
+#define MOTOR_6_Pin GPIO_PIN_10
+#define MOTOR_6_GPIO_Port GPIOA
+#define MOTOR_2_Pin GPIO_PIN_11
+#define MOTOR_2_GPIO_Port GPIOA
+#define IMU_I2C2_SDA_Pin GPIO_PIN_11
+#define IMU_I2C2_SDA_GPIO_Port GPIOB
+/* USER CODE BEGIN Private defines */
+
+/* USER CODE END Private defines */
+
+/**
+  * @}
+  */ 
+
+/**
+  * @}
+*/ 
+
+#endif /* __MAIN_H */
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,63 @@
+/*
+ * Serial throughput test for the DMA SerialHAL driver.  USART6 (PC6 / PC7) runs at 921600 baud with rx / tx DMA
+ * and echoes everything it receives; run samples/python/serial/serial_throughput.py against it to measure the
+ * throughput and check for lost bytes.  Once a second the driver statistics are printed on USART1 (PB6 / PB7,
+ * 115200 baud, no DMA).
+ */
+
+#include "stm32f4xx_hal.h"
+
+#include <stdio.h>
+
+#include <SerialHAL.h>
+#include <TimerHAL.h>
+
+using namespace digitalcave;
+
+extern UART_HandleTypeDef huart1;
+extern UART_HandleTypeDef huart6;
+extern IWDG_HandleTypeDef hiwdg;
+
+extern "C" {
+	void dc_main();
+}
+
+void dc_main(){
+	HAL_GPIO_WritePin(GPIOC, GPIO_PIN_0, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(GPIOC, GPIO_PIN_1, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(GPIOC, GPIO_PIN_2, GPIO_PIN_SET);
+
+	timer_init();
+
+	SerialHAL serial(&huart6, 1024, 1024);
+	SerialHAL console(&huart1, 64);
+	serial.setIdleDetection(1);
+
+	uint32_t lastReport = timer_millis();
+	serial_hal_stats_t last = serial.getStats();
+
+	while (1){
+		HAL_IWDG_Refresh(&hiwdg);
+
+		uint8_t buffer[128];
+		uint16_t count = 0;
+		while (count < sizeof(buffer) && serial.read(buffer + count)){
+			count++;
+		}
+		if (count > 0) serial.write(buffer, count);
+
+		if (serial.isIdle()) HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_1);
+
+		if ((timer_millis() - lastReport) >= 1000){
+			HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_0);
+			serial_hal_stats_t stats = serial.getStats();
+			char line[96];
+			snprintf(line, sizeof(line), "rx %lu B/s, tx %lu B/s, isr %lu/s, idle %lu, overruns %lu\n",
+				stats.rxBytes - last.rxBytes, stats.txBytes - last.txBytes, stats.isrs - last.isrs,
+				stats.idles, stats.overruns);
+			console.write(line);
+			last = stats;
+			lastReport = timer_millis();
+		}
+	}
+}
@@ -18,7 +18,8 @@ int main (){
 	uint8_t data[32];
 	
 	while (1){
-		manchester_read(data, 32);
-		serial_write_s(data);
+		uint8_t length = manchester_read(data, 32);
+		if (length > 32) length = 32;
+		if (length) serial_write_a(data, length);
 	}   
 }
@@ -10,21 +10,18 @@ int main (void){
 	
 	Distance d(&PORTC, PORTC5, &PINC, PINC4);
 	
-	DDRC |= _BV(PORTC5);	//A5 output mode
-	
-	//1ms is this many clock ticks
-#define TEN_MICROSECONDS (F_CPU / 100000)
-	
 	serial_init_b(9600);
 	
+	Distance::start();
+	
 	//Main program loop
 	while (1){
-		uint16_t distance = d.read();
-		
-		serial_write_b((distance >> 8) & 0xFF);
-		serial_write_b(distance & 0xFF);
-		
-		_delay_ms(1000);
+		distance_reading_t reading;
+		if (Distance::poll(&reading)){
+			uint16_t distance = reading.distance;
+			
+			serial_write_b((distance >> 8) & 0xFF);
+			serial_write_b(distance & 0xFF);
+		}
 	}
 }
-
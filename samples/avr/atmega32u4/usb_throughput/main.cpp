@@ -0,0 +1,55 @@
+/*
+ * Device end of the USB serial throughput test; run samples/python/serial/usb_throughput.py against it.
+ *
+ * Commands (lengths are 32 bit little endian):
+ *  'T' <length>: send <length> bytes (0, 1, 2, ... 255, 0, ...) to the host.
+ *  'R' <length> <data>: receive <length> bytes, then reply with the number of bytes received and the
+ *      8 bit sum of the data, so the host can check it.
+ */
+#include <stdint.h>
+#include <SerialUSB.h>
+
+using namespace digitalcave;
+
+static uint8_t buffer[64];
+
+static uint32_t readLength(SerialUSB* serial){
+	uint8_t length[4];
+	uint8_t count = 0;
+	while (count < 4) count += serial->readBlock(length + count, 4 - count);
+	return (uint32_t) length[0] | ((uint32_t) length[1] << 8) | ((uint32_t) length[2] << 16) | ((uint32_t) length[3] << 24);
+}
+
+int main (void) {
+	SerialUSB serial;
+	uint8_t command;
+
+	while (1) {
+		if (!serial.isConnected() || !serial.read(&command)) continue;
+
+		if (command == 'T'){
+			uint32_t remaining = readLength(&serial);
+			uint8_t value = 0;
+			while (remaining > 0){
+				uint8_t count = remaining > sizeof(buffer) ? sizeof(buffer) : remaining;
+				for (uint8_t i = 0; i < count; i++) buffer[i] = value++;
+				if (serial.writeBlock(buffer, count) != count) break;
+				remaining -= count;
+			}
+			serial.flushOutput();
+		}
+		else if (command == 'R'){
+			uint32_t remaining = readLength(&serial);
+			uint32_t received = 0;
+			uint8_t sum = 0;
+			while (received < remaining){
+				uint8_t count = serial.readBlock(buffer, remaining - received > sizeof(buffer) ? sizeof(buffer) : remaining - received);
+				for (uint8_t i = 0; i < count; i++) sum += buffer[i];
+				received += count;
+			}
+			uint8_t reply[5] = { (uint8_t) received, (uint8_t) (received >> 8), (uint8_t) (received >> 16), (uint8_t) (received >> 24), sum };
+			serial.writeBlock(reply, sizeof(reply));
+			serial.flushOutput();
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+#
+# Throughput test for an echoing serial device (e.g. samples/arm/stm32f410/serial_throughput).
+# Streams pseudo random data at the device while reading the echo back, checks that every
+# byte comes back in order, and reports the throughput.
+#
+# Usage: serial_throughput.py <port> [baud] [kilobytes]
+#
+###################
+
+import os, serial, sys, threading, time
+
+port = sys.argv[1]
+baud = int(sys.argv[2]) if len(sys.argv) > 2 else 921600
+size = (int(sys.argv[3]) if len(sys.argv) > 3 else 256) * 1024
+
+ser = serial.Serial(port, baud, timeout=1)
+ser.reset_input_buffer()
+
+data = os.urandom(size)
+received = bytearray()
+
+def reader():
+	while len(received) < size:
+		chunk = ser.read(max(1, min(4096, ser.in_waiting)))
+		if not chunk: break
+		received.extend(chunk)
+
+thread = threading.Thread(target=reader)
+thread.start()
+
+start = time.time()
+# Send in blocks, so that a slow device shows up as lost bytes rather than a huge OS buffer
+for i in range(0, size, 1024):
+	ser.write(data[i:i + 1024])
+thread.join()
+elapsed = time.time() - start
+
+errors = sum(1 for a, b in zip(data, received) if a != b)
+lost = size - len(received)
+theoretical = baud / 10.0
+
+print('%d bytes in %.2f s: %.0f B/s each way (%.1f%% of %d baud)' % (len(received), elapsed, len(received) / elapsed, 100.0 * len(received) / elapsed / theoretical, baud))
+if lost or errors:
+	print('FAILED: %d bytes lost, %d bytes differ (first %d)' % (lost, errors, next((i for i, (a, b) in enumerate(zip(data, received)) if a != b), len(received))))
+	sys.exit(1)
+print('OK')
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+#
+# Throughput test for USB serial (CDC) devices running samples/avr/atmega32u4/usb_throughput.
+# Measures device -> host and host -> device transfers separately, checks the data, and
+# reports KB/s in each direction.
+#
+# Usage: usb_throughput.py <port> [kilobytes]
+#
+###################
+
+import serial, struct, sys, time
+
+port = sys.argv[1]
+size = (int(sys.argv[2]) if len(sys.argv) > 2 else 1024) * 1024
+
+# The baud rate is ignored by USB CDC devices
+ser = serial.Serial(port, 115200, timeout=2)
+ser.reset_input_buffer()
+failed = False
+
+# Device -> host
+start = time.time()
+ser.write(b'T' + struct.pack('<I', size))
+received = bytearray()
+while len(received) < size:
+	chunk = ser.read(min(65536, size - len(received)))
+	if not chunk: break
+	received.extend(chunk)
+elapsed = time.time() - start
+
+expected = bytes(i & 0xFF for i in range(size))
+print('Device -> host: %d bytes in %.2f s: %.1f KB/s' % (len(received), elapsed, len(received) / elapsed / 1024))
+if received != expected:
+	lost = size - len(received)
+	first = next((i for i, (a, b) in enumerate(zip(expected, received)) if a != b), len(received))
+	print('FAILED: %d bytes lost, first difference at %d' % (lost, first))
+	failed = True
+
+# Host -> device
+data = bytes((i * 7) & 0xFF for i in range(size))
+start = time.time()
+ser.write(b'R' + struct.pack('<I', size))
+for i in range(0, size, 4096):
+	ser.write(data[i:i + 4096])
+reply = ser.read(5)
+elapsed = time.time() - start
+
+if len(reply) != 5:
+	print('Host -> device: FAILED: no reply from device')
+	failed = True
+else:
+	count, checksum = struct.unpack('<IB', reply)
+	print('Host -> device: %d bytes in %.2f s: %.1f KB/s' % (count, elapsed, count / elapsed / 1024))
+	if count != size or checksum != sum(data) & 0xFF:
+		print('FAILED: device received %d bytes, checksum %02x (expected %02x)' % (count, checksum, sum(data) & 0xFF))
+		failed = True
+
+if failed: sys.exit(1)
+print('OK')